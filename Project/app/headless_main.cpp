@@ -0,0 +1,67 @@
+// Runs the simulation without a window and prints a summary, for balance
+// sweeps and profiling on machines with no GPU.
+//
+// Usage: WorldBoxHeadless [ticks] [seed] [settlements] [workers]
+// workers > 0 runs NPC behaviors in World::UpdateMode::PARALLEL
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "environment/fixed_step.h"
+#include "environment/world.h"
+
+int main(int argc, char** argv) {
+    int ticks = (argc > 1) ? atoi(argv[1]) : 3600;
+    unsigned int seed = (argc > 2) ? (unsigned int)strtoul(argv[2], nullptr, 10) : 1u;
+    int settlementCount = (argc > 3) ? atoi(argv[3]) : 8;
+    int workers = (argc > 4) ? atoi(argv[4]) : 0;
+
+    World world;
+    world.worldW = 2200;
+    world.worldH = 1400;
+    world.worldSeed = seed;
+    world.Init();
+
+    if (workers > 0) {
+        world.updateMode = World::UpdateMode::PARALLEL;
+        world.SetWorkerCount(workers);
+    }
+
+    std::vector<Vector2> land;
+    for (int y = 40; y < world.worldH - 40; y += 23) {
+        for (int x = 40; x < world.worldW - 40; x += 29) {
+            if (world.terrain.canBuild((float)x, (float)y)) land.push_back({(float)x, (float)y});
+        }
+    }
+
+    // Each settlement starts with 6 civilians, 6 warriors and a captain
+    for (int k = 0; k < settlementCount && !land.empty(); k++) {
+        Vector2 p = land[((size_t)k * 7919) % land.size()];
+        for (int c = 0; c < 6; c++) world.SpawnCivilian({p.x + c * 3.0f, p.y + c * 2.0f});
+        for (int c = 0; c < 6; c++) world.SpawnWarrior({p.x + (c % 3) * 4.0f, p.y - 6.0f - (c / 3) * 4.0f});
+        world.SpawnCaptain({p.x - 6.0f, p.y});
+    }
+
+    const FixedStepper clock(60.0f);
+    const float dt = clock.GetTickDt();
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < ticks; t++) {
+        world.Update(dt, &world.terrain);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int aliveSettlements = 0;
+    for (const auto& s : world.settlements) {
+        if (s.alive) aliveSettlements++;
+    }
+
+    printf("ticks %d  sim time %.1fs  wall %.3fs  %.0f ticks/s\n",
+           ticks, ticks * dt, seconds, seconds > 0.0 ? ticks / seconds : 0.0);
+    printf("npcs %zu  settlements %d alive / %zu  animals %zu  plants %zu\n",
+           world.npcs.size(), aliveSettlements, world.settlements.size(),
+           world.animals.size(), world.plants.size());
+    printf("state hash %016llx\n", (unsigned long long)world.ComputeStateHash());
+    return 0;
+}
@@ -1,11 +1,19 @@
 #include "raylib.h"
 #include "raymath.h"
 #include "environment/world.h"
+#include "environment/sim_thread.h"
+#include "render/world_renderer.h"
 #include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+#include <thread>
 
 enum class AppState
 {
     MAP_MENU,
+    LOADING,
     GAME,
     PAUSED
 };
@@ -43,12 +51,39 @@ static void ApplyWindowedMode(int width, int height) {
     SetWindowPosition(x, y);
 }
 
+// Seed and size of the last map started, kept beside the generated-world
+// cache so the menu can replay it from its cached generation
+struct LastWorld {
+    unsigned int seed = 0;
+    int w = 0;
+    int h = 0;
+};
+
+static bool LoadLastWorld(const std::filesystem::path& path, LastWorld& out) {
+    std::FILE* f = std::fopen(path.string().c_str(), "r");
+    if (!f) return false;
+    LastWorld read;
+    bool ok = std::fscanf(f, "%u %d %d", &read.seed, &read.w, &read.h) == 3 && read.w > 0 && read.h > 0;
+    std::fclose(f);
+    if (ok) out = read;
+    return ok;
+}
+
+static void SaveLastWorld(const std::filesystem::path& path, const LastWorld& last) {
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    std::FILE* f = std::fopen(path.string().c_str(), "w");
+    if (!f) return;
+    std::fprintf(f, "%u %d %d\n", last.seed, last.w, last.h);
+    std::fclose(f);
+}
+
 // Picks the nearest alive NPC of a specific role near the cursor
 static int PickNpcIndexByRole(const World& world, Vector2 mouseWorld, NPC::HumanRole role, float radius) {
     const float r2 = radius * radius;
 
     for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const NPC& n = world.npcs[i];
+        ConstNpcRef n = world.npcs[i];
         if (!n.alive || n.isDying) continue;
         if (n.humanRole != role) continue;
 
@@ -65,11 +100,13 @@ static int PickNpcIndexByRole(const World& world, Vector2 mouseWorld, NPC::Human
 }
 
 // Returns a short label for the selected captain mode
-static const char* GetCaptainModeLabel(const NPC& cap) {
-    if (cap.captainHasAttackOrder) return "MANUAL ATTACK";
-    if (!cap.captainAutoMode && cap.captainHasMoveOrder) return "MANUAL MOVE";
-    if (!cap.captainAutoMode) return "MANUAL IDLE";
-    return "AUTO";
+static const char* GetCaptainModeLabel(WorldSnapshot::CaptainMode mode) {
+    switch (mode) {
+        case WorldSnapshot::CaptainMode::MANUAL_ATTACK: return "MANUAL ATTACK";
+        case WorldSnapshot::CaptainMode::MANUAL_MOVE: return "MANUAL MOVE";
+        case WorldSnapshot::CaptainMode::MANUAL_IDLE: return "MANUAL IDLE";
+        default: return "AUTO";
+    }
 }
 
 // Picks the nearest alive NPC regardless of role
@@ -79,7 +116,7 @@ static int PickAnyNpcIndex(const World& world, Vector2 mouseWorld, float radius)
     float bestD2 = r2;
 
     for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const NPC& n = world.npcs[i];
+        ConstNpcRef n = world.npcs[i];
         if (!n.alive || n.isDying) continue;
 
         Vector2 pickPos = { n.pos.x, n.pos.y - 8.0f };
@@ -98,10 +135,10 @@ static int PickAnyNpcIndex(const World& world, Vector2 mouseWorld, float radius)
 }
 
 // Finds the settlement under the cursor
-static int PickSettlementIndexAtWorldPos(const World& world, Vector2 mouseWorld)
+static int PickSettlementIndexAtWorldPos(const WorldSnapshot& snapshot, Vector2 mouseWorld)
 {
-    for (int i = 0; i < (int)world.settlements.size(); i++) {
-        const Settlement& s = world.settlements[i];
+    for (int i = 0; i < (int)snapshot.settlements.size(); i++) {
+        const SettlementSnapshot& s = snapshot.settlements[i];
         if (!s.alive) continue;
 
         if (CheckCollisionPointRec(mouseWorld, s.boundsPx)) {
@@ -111,43 +148,34 @@ static int PickSettlementIndexAtWorldPos(const World& world, Vector2 mouseWorld)
     return -1;
 }
 
-// Resolves the current mode icon texture
-static const Texture2D* GetCurrentModeIcon(const World& world,
-                                           SpawnMode mode,
-                                           WarriorRank warriorRank,
-                                           bool toolsOpen,
-                                           ToolMode toolMode,
-                                           bool& loaded)
+// Resolves the current mode icon's atlas sprite, -1 when missing
+static int GetCurrentModeIcon(const WorldRenderer& renderer,
+                              SpawnMode mode,
+                              WarriorRank warriorRank,
+                              bool toolsOpen,
+                              ToolMode toolMode)
 {
-    loaded = false;
-
     if (toolsOpen && toolMode == ToolMode::KILL) {
-        loaded = world.npcTexBanditLoaded[0];
-        return &world.npcTexBandit[0];
+        return renderer.NpcSprite(NPC::HumanRole::BANDIT, 0);
     }
 
     if (toolsOpen && toolMode == ToolMode::WAR) {
-        loaded = world.npcTexCaptainLoaded[0];
-        return &world.npcTexCaptain[0];
+        return renderer.NpcSprite(NPC::HumanRole::CAPTAIN, 0);
     }
 
     if (!toolsOpen && mode == SpawnMode::BUILD_BARRACKS) {
-        loaded = world.barracksTexLoaded;
-        return &world.barracksTex;
+        return renderer.barracksSprite;
     }
 
     if (mode == SpawnMode::CIVILIAN) {
-        loaded = world.npcTexCivilianLoaded[0];
-        return &world.npcTexCivilian[0];
+        return renderer.NpcSprite(NPC::HumanRole::CIVILIAN, 0);
     }
 
     if (warriorRank == WarriorRank::CAPTAIN) {
-        loaded = world.npcTexCaptainLoaded[0];
-        return &world.npcTexCaptain[0];
+        return renderer.NpcSprite(NPC::HumanRole::CAPTAIN, 0);
     }
 
-    loaded = world.npcTexWarriorLoaded[0];
-    return &world.npcTexWarrior[0];
+    return renderer.NpcSprite(NPC::HumanRole::WARRIOR, 0);
 }
 
 int main() {
@@ -164,6 +192,33 @@ int main() {
     AppState appState = AppState::MAP_MENU;
 
     World world;
+    // Seeds played before start from their cached generation; R on the map
+    // menu replays the last one, which is what makes a cache hit likely
+    world.generatedCacheDir = "worldcache";
+    const std::filesystem::path lastWorldPath = std::filesystem::path(world.generatedCacheDir) / "last_world.txt";
+    LastWorld lastWorld;
+    bool hasLastWorld = LoadLastWorld(lastWorldPath, lastWorld);
+    WorldRenderer renderer;
+
+    // Sprites decode on worker threads from startup and the world generates
+    // on its own thread once a map is chosen; only the GPU upload waits for
+    // this thread, when both are done
+    std::atomic<bool> assetsDecoded{false};
+    std::thread assetThread([&] {
+        renderer.DecodeAssets();
+        assetsDecoded = true;
+    });
+    bool assetsUploaded = false;
+    std::atomic<bool> worldReady{false};
+    std::thread worldThread;
+    // Time from choosing a map to its first drawn frame
+    double loadStart = 0.0;
+    bool firstFramePending = false;
+    float firstFrameMs = 0.0f;
+
+    // Simulation runs at a fixed 60 Hz on its own thread; input reaches it
+    // as posted commands and frames draw its latest snapshot
+    SimulationThread sim(world, 60.0f);
     Camera2D camera = {0};
 
     float userZoom = 1.0f;
@@ -173,10 +228,31 @@ int main() {
     ToolMode toolMode = ToolMode::NONE;
     int pendingWarSettlementA = -1;
     Vector2 lastMouse = GetMousePosition();
+    // F3: culling counters from the last frame, and per-thread timings
+    bool showDrawStats = false;
+    // Render thread busy time over the current one-second window
+    double renderWindowStart = GetTime();
+    double renderBusyMs = 0.0;
+    int renderFrames = 0;
+    float renderBusyMsPerSecond = 0.0f;
+    int renderFramesPerSecond = 0;
 
     while (!WindowShouldClose()) {
         float dt = GetFrameTime();
 
+        if (IsKeyPressed(KEY_F3)) showDrawStats = !showDrawStats;
+
+        // F4 cycles the NPC detail tier: by zoom, then each tier forced
+        if (IsKeyPressed(KEY_F4)) {
+            if (!renderer.npcLodOverride) {
+                renderer.npcLodOverride = WorldRenderer::NpcLod::SPRITES;
+            } else if (*renderer.npcLodOverride == WorldRenderer::NpcLod::DENSITY) {
+                renderer.npcLodOverride.reset();
+            } else {
+                renderer.npcLodOverride = (WorldRenderer::NpcLod)((int)*renderer.npcLodOverride + 1);
+            }
+        }
+
         if (IsKeyPressed(KEY_F5)) {
             borderlessFullscreen = !borderlessFullscreen;
 
@@ -196,9 +272,12 @@ int main() {
             Rectangle btnSmall = { (float)sw / 2 - btnW / 2, (float)sh / 2 - 100, btnW, btnH };
             Rectangle btnMedium = { (float)sw / 2 - btnW / 2, (float)sh / 2 - 30, btnW, btnH };
             Rectangle btnLarge = { (float)sw / 2 - btnW / 2, (float)sh / 2 + 40, btnW, btnH };
+            Rectangle btnHuge = { (float)sw / 2 - btnW / 2, (float)sh / 2 + 110, btnW, btnH };
+            Rectangle btnReplay = { (float)sw / 2 - btnW / 2, (float)sh / 2 + 180, btnW, btnH };
 
             int selectedW = 0;
             int selectedH = 0;
+            bool replay = false;
 
             if (IsKeyPressed(KEY_ONE) || (click && CheckCollisionPointRec(mouse, btnSmall))) {
                 selectedW = 1400; selectedH = 900;
@@ -206,20 +285,27 @@ int main() {
                 selectedW = 2200; selectedH = 1400;
             } else if (IsKeyPressed(KEY_THREE) || (click && CheckCollisionPointRec(mouse, btnLarge))) {
                 selectedW = 3200; selectedH = 2000;
+            } else if (IsKeyPressed(KEY_FOUR) || (click && CheckCollisionPointRec(mouse, btnHuge))) {
+                // Large enough that terrain streams in by chunk
+                static_assert((size_t)(36864 / CELL_SIZE) * (32768 / CELL_SIZE) > World::EAGER_TERRAIN_TILES);
+                selectedW = 36864; selectedH = 32768;
+            } else if (hasLastWorld && (IsKeyPressed(KEY_R) || (click && CheckCollisionPointRec(mouse, btnReplay)))) {
+                selectedW = lastWorld.w; selectedH = lastWorld.h;
+                replay = true;
             }
 
             if (selectedW > 0) {
                 world.worldW = selectedW;
                 world.worldH = selectedH;
-                world.worldSeed = (unsigned int)GetRandomValue(1, 999999);
-                world.Init();
-
-                camera.target = { world.worldW * 0.5f, world.worldH * 0.5f };
-                camera.offset = { (float)sw * 0.5f, (float)sh * 0.5f };
-                camera.rotation = 0.0f;
-
-                appState = AppState::GAME;
-                lastMouse = GetMousePosition();
+                world.worldSeed = replay ? lastWorld.seed : (unsigned int)GetRandomValue(1, 999999);
+                SaveLastWorld(lastWorldPath, { world.worldSeed, selectedW, selectedH });
+                worldReady = false;
+                worldThread = std::thread([&] {
+                    world.Init();
+                    worldReady = true;
+                });
+                loadStart = GetTime();
+                appState = AppState::LOADING;
             }
 
             BeginDrawing();
@@ -244,26 +330,87 @@ int main() {
             DrawRectangleRec(btnLarge, hoverL ? hoverColor : baseColor);
             DrawRectangleLinesEx(btnLarge, 2.0f, outlineColor);
 
+            bool hoverH = CheckCollisionPointRec(mouse, btnHuge);
+            DrawRectangleRec(btnHuge, hoverH ? hoverColor : baseColor);
+            DrawRectangleLinesEx(btnHuge, 2.0f, outlineColor);
+
             const char* txt1 = "1. SMALL (1400x900)";
             const char* txt2 = "2. MEDIUM (2200x1400)";
             const char* txt3 = "3. LARGE (3200x2000)";
+            const char* txt4 = "4. HUGE (36864x32768)";
 
             DrawText(txt1, btnSmall.x + btnW / 2 - MeasureText(txt1, 20) / 2, btnSmall.y + 15, 20, WHITE);
             DrawText(txt2, btnMedium.x + btnW / 2 - MeasureText(txt2, 20) / 2, btnMedium.y + 15, 20, WHITE);
             DrawText(txt3, btnLarge.x + btnW / 2 - MeasureText(txt3, 20) / 2, btnLarge.y + 15, 20, WHITE);
+            DrawText(txt4, btnHuge.x + btnW / 2 - MeasureText(txt4, 20) / 2, btnHuge.y + 15, 20, WHITE);
+
+            if (hasLastWorld) {
+                bool hoverR = CheckCollisionPointRec(mouse, btnReplay);
+                DrawRectangleRec(btnReplay, hoverR ? hoverColor : baseColor);
+                DrawRectangleLinesEx(btnReplay, 2.0f, outlineColor);
+                const char* txtR = TextFormat("R. REPLAY SEED %u", lastWorld.seed);
+                DrawText(txtR, btnReplay.x + btnW / 2 - MeasureText(txtR, 20) / 2, btnReplay.y + 15, 20, WHITE);
+            }
 
             EndDrawing();
         }
-        else {
-            if (appState == AppState::GAME) {
-                if (world.selectedCaptainId != 0 && world.FindNpcById(world.selectedCaptainId) == nullptr) {
-                    world.selectedCaptainId = 0;
+        else if (appState == AppState::LOADING) {
+            if (worldReady && assetsDecoded) {
+                worldThread.join();
+                if (assetThread.joinable()) assetThread.join();
+                if (!assetsUploaded) {
+                    renderer.FinishLoad();
+                    assetsUploaded = true;
                 }
 
+                camera.target = { world.worldW * 0.5f, world.worldH * 0.5f };
+                camera.offset = { (float)sw * 0.5f, (float)sh * 0.5f };
+                camera.rotation = 0.0f;
+
+                sim.Start();
+
+                appState = AppState::GAME;
+                lastMouse = GetMousePosition();
+                firstFramePending = true;
+            }
+
+            static const char* stageNames[World::INIT_STAGES] = {
+                "Generating terrain", "Building routes", "Finding land regions", "Growing nature"
+            };
+            int stagesDone = std::min((int)world.initStagesDone, World::INIT_STAGES);
+            float worldProgress = (float)stagesDone / World::INIT_STAGES;
+            float spriteProgress = assetsDecoded ? 1.0f : renderer.DecodeProgress();
+            const char* worldLabel = stagesDone < World::INIT_STAGES ? stageNames[stagesDone] : "World ready";
+
+            BeginDrawing();
+            ClearBackground(BLACK);
+
+            const char* title = "LOADING";
+            DrawText(title, sw / 2 - MeasureText(title, 30) / 2, sh / 2 - 120, 30, RAYWHITE);
+
+            float barW = 420;
+            float barH = 18;
+            auto drawBar = [&](float y, float progress, const char* label) {
+                Rectangle bar = { (float)sw / 2 - barW / 2, y, barW, barH };
+                DrawRectangleRec(bar, Color{ 40, 40, 40, 255 });
+                DrawRectangleRec({ bar.x, bar.y, barW * progress, barH }, Color{ 120, 170, 90, 255 });
+                DrawRectangleLinesEx(bar, 2.0f, Color{ 100, 100, 100, 255 });
+                DrawText(label, (int)bar.x, (int)(y - 24), 20, LIGHTGRAY);
+            };
+            drawBar((float)sh / 2 - 30, worldProgress, worldLabel);
+            drawBar((float)sh / 2 + 40, spriteProgress, spriteProgress < 1.0f ? "Decoding sprites" : "Sprites ready");
+
+            EndDrawing();
+        }
+        else {
+            double frameStart = GetTime();
+            const WorldSnapshot& snapshot = sim.Acquire();
+
+            if (appState == AppState::GAME) {
                 camera.offset = { sw * 0.5f, sh * 0.5f };
 
-                float fitZoom = std::max((float)sw / (float)world.worldW,
-                                         (float)sh / (float)world.worldH);
+                float fitZoom = std::max((float)sw / (float)snapshot.worldW,
+                                         (float)sh / (float)snapshot.worldH);
                 camera.zoom = fitZoom * userZoom;
 
                 if (IsKeyPressed(KEY_ZERO)) {
@@ -305,33 +452,39 @@ int main() {
                         pendingWarSettlementA = -1;
                     }
                     if (IsKeyPressed(KEY_FOUR)) {
-                        if (world.armageddonMode) {
-                            world.StopArmageddon();
-                        } else {
-                            world.StartArmageddon();
-                        }
+                        sim.Post([](World& w) {
+                            if (w.armageddonMode) {
+                                w.StopArmageddon();
+                            } else {
+                                w.StartArmageddon();
+                            }
+                        });
                     }
                 }
 
-                if (IsKeyPressed(KEY_A) && world.selectedCaptainId != 0) {
-                    NPC* cap = world.FindNpcById(world.selectedCaptainId);
-                    if (cap && cap->humanRole == NPC::HumanRole::CAPTAIN) {
-                        cap->captainAutoMode = !cap->captainAutoMode;
-
-                        if (cap->captainAutoMode) {
-                            cap->captainHasMoveOrder = false;
-                            cap->captainHasAttackOrder = false;
-                            cap->captainAttackGroupId = -1;
-                            cap->captainAttackTargetId = 0;
+                if (IsKeyPressed(KEY_A) && snapshot.selectedCaptainId != 0) {
+                    sim.Post([](World& w) {
+                        if (w.selectedCaptainId == 0) return;
+                        std::optional<NpcRef> cap = w.FindNpcById(w.selectedCaptainId);
+                        if (cap && cap->humanRole == NPC::HumanRole::CAPTAIN) {
+                            cap->captain.captainAutoMode = !cap->captain.captainAutoMode;
+
+                            if (cap->captain.captainAutoMode) {
+                                cap->captain.captainHasMoveOrder = false;
+                                cap->captain.captainHasAttackOrder = false;
+                                cap->captain.captainAttackGroupId = -1;
+                                cap->captain.captainAttackTargetId = 0;
+                            }
                         }
-                    }
+                    });
                 }
 
                 if (IsKeyPressed(KEY_ESCAPE)) {
-                    if (world.selectedCaptainId != 0) {
-                        world.selectedCaptainId = 0;
+                    if (snapshot.selectedCaptainId != 0) {
+                        sim.Post([](World& w) { w.selectedCaptainId = 0; });
                     } else {
                         appState = AppState::PAUSED;
+                        sim.SetPaused(true);
                     }
                 }
 
@@ -352,78 +505,93 @@ int main() {
                 if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && !IsMouseButtonDown(MOUSE_BUTTON_RIGHT)) {
                     Vector2 mouseWorld = GetScreenToWorld2D(GetMousePosition(), camera);
 
-                    if (mouseWorld.x >= 0 && mouseWorld.x <= world.worldW &&
-                        mouseWorld.y >= 0 && mouseWorld.y <= world.worldH) {
+                    if (mouseWorld.x >= 0 && mouseWorld.x <= snapshot.worldW &&
+                        mouseWorld.y >= 0 && mouseWorld.y <= snapshot.worldH) {
 
                         const bool shiftDown = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
 
                         if (shiftDown) {
-                            int clickedCaptain = PickNpcIndexByRole(world, mouseWorld, NPC::HumanRole::CAPTAIN, 18.0f);
-                            int clickedBandit  = PickNpcIndexByRole(world, mouseWorld, NPC::HumanRole::BANDIT, 18.0f);
+                            sim.Post([mouseWorld](World& w) {
+                                int clickedCaptain = PickNpcIndexByRole(w, mouseWorld, NPC::HumanRole::CAPTAIN, 18.0f);
+                                int clickedBandit  = PickNpcIndexByRole(w, mouseWorld, NPC::HumanRole::BANDIT, 18.0f);
 
-                            if (clickedCaptain != -1) {
-                                world.selectedCaptainId = world.npcs[clickedCaptain].id;
-                            }
-                            else if (clickedBandit != -1 && world.selectedCaptainId != 0) {
-                                NPC* cap = world.FindNpcById(world.selectedCaptainId);
-                                if (cap && cap->humanRole == NPC::HumanRole::CAPTAIN) {
-                                    const NPC& b = world.npcs[clickedBandit];
-
-                                    cap->captainAutoMode = false;
-                                    cap->captainHasMoveOrder = false;
-                                    cap->captainMoveTarget = cap->pos;
-
-                                    cap->captainHasAttackOrder = true;
-                                    cap->captainAttackGroupId = b.banditGroupId;
-                                    cap->captainAttackTargetId = b.id;
+                                if (clickedCaptain != -1) {
+                                    w.selectedCaptainId = w.npcs[clickedCaptain].id;
                                 }
-                            }
-                            else if (world.selectedCaptainId != 0) {
-                                world.IssueCaptainMoveOrder(world.selectedCaptainId, mouseWorld);
-                            }
+                                else if (clickedBandit != -1 && w.selectedCaptainId != 0) {
+                                    std::optional<NpcRef> cap = w.FindNpcById(w.selectedCaptainId);
+                                    if (cap && cap->humanRole == NPC::HumanRole::CAPTAIN) {
+                                        ConstNpcRef b = w.npcs[clickedBandit];
+
+                                        cap->captain.captainAutoMode = false;
+                                        cap->captain.captainHasMoveOrder = false;
+                                        cap->captain.captainMoveTarget = cap->pos;
+
+                                        cap->captain.captainHasAttackOrder = true;
+                                        cap->captain.captainAttackGroupId = b.banditGroupId;
+                                        cap->captain.captainAttackTargetId = b.id;
+                                    }
+                                }
+                                else if (w.selectedCaptainId != 0) {
+                                    w.IssueCaptainMoveOrder(w.selectedCaptainId, mouseWorld);
+                                }
+                            });
                         }
                         else {
                             if (toolsOpen && toolMode == ToolMode::KILL) {
-                                int clickedNpc = PickAnyNpcIndex(world, mouseWorld, 18.0f);
-                                if (clickedNpc != -1) {
-                                    world.BeginNpcDeath(world.npcs[clickedNpc]);
-                                }
+                                sim.Post([mouseWorld](World& w) {
+                                    int clickedNpc = PickAnyNpcIndex(w, mouseWorld, 18.0f);
+                                    if (clickedNpc != -1) {
+                                        w.BeginNpcDeath(w.npcs[clickedNpc]);
+                                    }
+                                });
                             }
                             else if (toolsOpen && toolMode == ToolMode::WAR) {
-                                int clickedSettlement = PickSettlementIndexAtWorldPos(world, mouseWorld);
+                                int clickedSettlement = PickSettlementIndexAtWorldPos(snapshot, mouseWorld);
                                 if (clickedSettlement != -1) {
                                     if (pendingWarSettlementA == -1) {
                                         pendingWarSettlementA = clickedSettlement;
                                     } else if (pendingWarSettlementA != clickedSettlement) {
-                                        world.StartSettlementWar(pendingWarSettlementA, clickedSettlement);
+                                        int a = pendingWarSettlementA;
+                                        sim.Post([a, clickedSettlement](World& w) {
+                                            w.StartSettlementWar(a, clickedSettlement);
+                                        });
                                         pendingWarSettlementA = -1;
                                     }
                                 }
                             }
                             else if (toolsOpen && toolMode == ToolMode::METEOR) {
-                                world.SpawnMeteor(mouseWorld);
+                                sim.Post([mouseWorld](World& w) { w.SpawnMeteor(mouseWorld); });
                             }
                             else if (mode == SpawnMode::BUILD_BARRACKS) {
-                                world.TryBuildBarracksAt(mouseWorld);
+                                sim.Post([mouseWorld](World& w) { w.TryBuildBarracksAt(mouseWorld); });
                             }
                             else if (mode == SpawnMode::CIVILIAN) {
-                                world.SpawnCivilian(mouseWorld);
+                                sim.Post([mouseWorld](World& w) { w.SpawnCivilian(mouseWorld); });
                             } else if (mode == SpawnMode::WARRIOR) {
                                 if (warriorRank == WarriorRank::CAPTAIN) {
-                                    world.SpawnCaptain(mouseWorld);
+                                    sim.Post([mouseWorld](World& w) { w.SpawnCaptain(mouseWorld); });
                                 } else {
-                                    world.SpawnWarrior(mouseWorld);
+                                    sim.Post([mouseWorld](World& w) { w.SpawnWarrior(mouseWorld); });
                                 }
                             }
                         }
                     }
                 }
 
-                world.Update(dt, &world.terrain);
+                // The next snapshot reports whether barracks fit under the cursor
+                if (!toolsOpen && mode == SpawnMode::BUILD_BARRACKS) {
+                    sim.SetBarracksPreview(GetScreenToWorld2D(GetMousePosition(), camera));
+                } else {
+                    sim.SetBarracksPreview(std::nullopt);
+                }
+
+                renderer.Update(dt);
             }
             else if (appState == AppState::PAUSED) {
                 if (IsKeyPressed(KEY_ESCAPE)) {
                     appState = AppState::GAME;
+                    sim.SetPaused(false);
                     lastMouse = GetMousePosition();
                 }
             }
@@ -431,56 +599,20 @@ int main() {
             BeginDrawing();
             ClearBackground(BLACK);
 
+            renderer.Sync(snapshot);
             BeginMode2D(camera);
-            world.Draw();
+            renderer.Draw(snapshot, CameraViewRect(camera, sw, sh), camera.zoom);
 
             if (!toolsOpen && mode == SpawnMode::BUILD_BARRACKS) {
                 Vector2 mouseWorld = GetScreenToWorld2D(GetMousePosition(), camera);
                 int tileX = (int)(mouseWorld.x / CELL_SIZE);
                 int tileY = (int)(mouseWorld.y / CELL_SIZE);
-                bool canBuild = false;
+                bool canBuild = snapshot.barracksPreviewOk;
                 Vector2 previewPos = {
                     (tileX + 0.5f) * CELL_SIZE,
                     (tileY + 0.5f) * CELL_SIZE
                 };
 
-                if (tileX >= 0 && tileX < world.cols && tileY >= 0 && tileY < world.rows) {
-                    int tileId = tileY * world.cols + tileX;
-
-                    for (const auto& s : world.settlements) {
-                        if (!s.alive) continue;
-                        if (!world.PointInSettlementPx(s, mouseWorld)) continue;
-
-                        float dxFire = mouseWorld.x - s.campfirePosPx.x;
-                        float dyFire = mouseWorld.y - s.campfirePosPx.y;
-                        float fireDist2 = dxFire * dxFire + dyFire * dyFire;
-                        if (fireDist2 < (CELL_SIZE * 5.0f) * (CELL_SIZE * 5.0f)) break;
-
-                        if (s.tiles.find(tileId) == s.tiles.end()) break;
-
-                        bool overlapsBarracks = false;
-                        Vector2 snappedPos = {
-                            (tileX + 0.5f) * CELL_SIZE,
-                            (tileY + 0.5f) * CELL_SIZE
-                        };
-                        for (const auto& b : s.barracksList) {
-                            if (!b.alive) continue;
-
-                            float dx = snappedPos.x - b.posPx.x;
-                            float dy = snappedPos.y - b.posPx.y;
-                            float d2 = dx * dx + dy * dy;
-                            if (d2 < (CELL_SIZE * 4.0f) * (CELL_SIZE * 4.0f)) {
-                                overlapsBarracks = true;
-                                break;
-                            }
-                        }
-                        if (overlapsBarracks) break;
-
-                        canBuild = true;
-                        break;
-                    }
-                }
-
                 Color previewColor = canBuild
                                      ? Color{255, 220, 120, 220}
                                      : Color{255, 100, 100, 220};
@@ -504,19 +636,18 @@ int main() {
             int uiY = 20;
             int spacing = 26;
 
-            bool modeIconLoaded = false;
-            const Texture2D* modeIcon = GetCurrentModeIcon(world, mode, warriorRank, toolsOpen, toolMode, modeIconLoaded);
+            int modeIcon = GetCurrentModeIcon(renderer, mode, warriorRank, toolsOpen, toolMode);
 
             DrawRectangle(iconX - 4, iconY - 4, 40, 40, Color{0, 0, 0, 120});
             DrawRectangleLines(iconX - 4, iconY - 4, 40, 40, Fade(RAYWHITE, 0.25f));
 
-            if (modeIcon && modeIconLoaded && modeIcon->id != 0) {
-                Rectangle src = {0.0f, 0.0f, (float)modeIcon->width, (float)modeIcon->height};
+            if (modeIcon >= 0) {
+                Rectangle src = renderer.atlas.Rect(modeIcon);
                 Rectangle dst = {(float)iconX, (float)iconY, 32.0f, 32.0f};
                 Color iconTint = (toolsOpen && toolMode == ToolMode::KILL)
                                  ? Color{255, 140, 140, 255}
                                  : WHITE;
-                DrawTexturePro(*modeIcon, src, dst, Vector2{0,0}, 0.0f, iconTint);
+                DrawTexturePro(renderer.atlas.texture, src, dst, Vector2{0,0}, 0.0f, iconTint);
             }
 
             const char* modeStr = toolsOpen
@@ -579,33 +710,48 @@ int main() {
             DrawText(t4, uiX, uiY, 20, RAYWHITE); uiY += spacing;
             DrawText(t5, uiX, uiY, 20, RAYWHITE); uiY += spacing;
 
-            if (world.armageddonMode) {
+            if (showDrawStats) {
+                WorldRenderer::DrawCounts total = renderer.lastDrawStats.Total();
+                DrawText(TextFormat("Drawn %d  culled %d  (npcs %d/%d)", total.submitted, total.culled,
+                                    renderer.lastDrawStats.npcs.submitted, renderer.lastDrawStats.npcs.culled),
+                         uiX, uiY, 20, LIGHTGRAY);
+                uiY += spacing;
+                DrawText(TextFormat("Draw calls %d", renderer.lastDrawStats.drawCalls), uiX, uiY, 20, LIGHTGRAY);
+                uiY += spacing;
+                const WorldRenderer::DrawStats& ds = renderer.lastDrawStats;
+                const char* lodNames[] = { "SPRITES", "QUADS", "DENSITY" };
+                DrawText(TextFormat("NPC detail %s%s  %.2f ms", lodNames[(int)ds.npcLod],
+                                    renderer.npcLodOverride ? " (F4)" : "", ds.npcMs),
+                         uiX, uiY, 20, LIGHTGRAY);
+                uiY += spacing;
+                DrawText(TextFormat("Sim thread %.2f ms/tick  %d ticks/s  busy %.0f ms/s",
+                                    snapshot.simMsPerTick, snapshot.simTicksPerSecond, snapshot.simBusyMsPerSecond),
+                         uiX, uiY, 20, LIGHTGRAY);
+                uiY += spacing;
+                DrawText(TextFormat("Render thread %d fps  busy %.0f ms/s", renderFramesPerSecond, renderBusyMsPerSecond),
+                         uiX, uiY, 20, LIGHTGRAY);
+                uiY += spacing;
+                DrawText(TextFormat("First frame %.0f ms after choosing the map", firstFrameMs), uiX, uiY, 20, LIGHTGRAY);
+                uiY += spacing;
+            }
+
+            if (snapshot.armageddonMode) {
                 uiY += 10;
                 DrawText("ARMAGEDDON ACTIVE!", uiX, uiY, 24, Color{255, 50, 50, 255});
                 uiY += spacing;
             }
 
-            if (world.selectedCaptainId != 0) {
-                NPC* cap = world.FindNpcById(world.selectedCaptainId);
-                if (cap && cap->humanRole == NPC::HumanRole::CAPTAIN) {
-                    uiY += 10;
-
-                    const char* label = GetCaptainModeLabel(*cap);
-                    const char* txt = TextFormat("Selected Captain: %s", label);
+            if (snapshot.selectedCaptainId != 0) {
+                uiY += 10;
 
-                    DrawText(txt, uiX, uiY, 20, YELLOW);
-                    uiY += spacing;
+                const char* label = GetCaptainModeLabel(snapshot.selectedCaptainMode);
+                const char* txt = TextFormat("Selected Captain: %s", label);
 
-                    int squadCount = 0;
-                    for (const auto& n : world.npcs) {
-                        if (!n.alive) continue;
-                        if (n.humanRole != NPC::HumanRole::WARRIOR) continue;
-                        if (n.leaderCaptainId == cap->id) squadCount++;
-                    }
+                DrawText(txt, uiX, uiY, 20, YELLOW);
+                uiY += spacing;
 
-                    const char* squad = TextFormat("Squad: %d / 15", squadCount);
-                    DrawText(squad, uiX, uiY, 20, YELLOW);
-                }
+                const char* squad = TextFormat("Squad: %d / 15", snapshot.selectedCaptainSquad);
+                DrawText(squad, uiX, uiY, 20, YELLOW);
             }
 
             if (appState == AppState::PAUSED) {
@@ -616,11 +762,33 @@ int main() {
                 DrawText(resumeMsg, sw / 2 - MeasureText(resumeMsg, 20) / 2, sh / 2 + 30, 20, LIGHTGRAY);
             }
 
+            // Busy time stops before EndDrawing, which waits for the frame limiter
+            renderBusyMs += (GetTime() - frameStart) * 1000.0;
+            renderFrames++;
+            double renderWindow = GetTime() - renderWindowStart;
+            if (renderWindow >= 1.0) {
+                renderBusyMsPerSecond = (float)(renderBusyMs / renderWindow);
+                renderFramesPerSecond = (int)(renderFrames / renderWindow + 0.5);
+                renderWindowStart = GetTime();
+                renderBusyMs = 0.0;
+                renderFrames = 0;
+            }
+
             EndDrawing();
+
+            if (firstFramePending) {
+                firstFramePending = false;
+                firstFrameMs = (float)((GetTime() - loadStart) * 1000.0);
+                TraceLog(LOG_INFO, "WORLD: first frame %.0f ms after choosing %dx%d", firstFrameMs,
+                         snapshot.worldW, snapshot.worldH);
+            }
         }
     }
 
-    world.Shutdown();
+    sim.Stop();
+    if (worldThread.joinable()) worldThread.join();
+    if (assetThread.joinable()) assetThread.join();
+    renderer.Unload();
     CloseWindow();
     return 0;
 }
@@ -0,0 +1,98 @@
+// Times the nearest-passable / water-distance transform on the LARGE map:
+// full build, the local update after a meteor-sized edit, and
+// findNearestPassable from water tiles through the table against the ring
+// search it replaces.
+//
+// Usage: worldbox_bench_distance_field [queries] [seed]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "environment/random.h"
+#include "terrain/distance_field.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// The search findNearestPassable ran before the transform
+static bool RingSearch(const Terrain& terrain, int tx, int ty, int& outX, int& outY, int maxRadius) {
+    for (int r = 1; r <= maxRadius; ++r) {
+        for (int dy = -r; dy <= r; ++dy) {
+            for (int dx = -r; dx <= r; ++dx) {
+                if (std::abs(dx) != r && std::abs(dy) != r) continue;
+                if (terrain.isPassable(tx + dx, ty + dy)) {
+                    outX = tx + dx;
+                    outY = ty + dy;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    int queries = (argc > 1) ? atoi(argv[1]) : 200000;
+    unsigned int seed = (argc > 2) ? (unsigned int)strtoul(argv[2], nullptr, 10) : 1337u;
+
+    // LARGE: 3200x2000 px
+    Terrain terrain(400, 250, seed);
+    terrain.generate();
+
+    DistanceField field;
+    Clock::time_point start = Clock::now();
+    field.build(terrain);
+    double buildMs = MsSince(start);
+
+    // Blocked tiles near enough to land to matter for snapping
+    Rng rng(seed);
+    std::vector<int> targets;
+    while ((int)targets.size() < 4096) {
+        int x = RandomInt(rng, 0, 399);
+        int y = RandomInt(rng, 0, 249);
+        if (!terrain.isPassable(x, y)) targets.push_back(y * 400 + x);
+    }
+
+    for (int radius : { 10, DistanceField::RADIUS }) {
+        int ox = 0, oy = 0;
+        int found = 0;
+        start = Clock::now();
+        for (int q = 0; q < queries; q++) {
+            int t = targets[q & 4095];
+            found += terrain.findNearestPassable(t % 400, t / 400, ox, oy, radius) ? 1 : 0;
+        }
+        double tableMs = MsSince(start);
+
+        int ringFound = 0;
+        start = Clock::now();
+        for (int q = 0; q < queries; q++) {
+            int t = targets[q & 4095];
+            ringFound += RingSearch(terrain, t % 400, t / 400, ox, oy, radius) ? 1 : 0;
+        }
+        double ringMs = MsSince(start);
+
+        printf("radius %2d  table %.1f ns/query  ring %.1f ns/query  (%d / %d found)\n",
+               radius, tableMs * 1e6 / queries, ringMs * 1e6 / queries, found, ringFound);
+    }
+
+    // Meteor-sized crater (radius 60 px)
+    double updateMs = 0.0;
+    const int impacts = 20;
+    for (int k = 0; k < impacts; k++) {
+        int cx = RandomInt(rng, 8, 391);
+        int cy = RandomInt(rng, 8, 241);
+        start = Clock::now();
+        field.update(terrain, { cx - 7, cy - 7, 15, 15 });
+        updateMs += MsSince(start);
+    }
+
+    printf("LARGE 400x250 tiles  radius %d\n", DistanceField::RADIUS);
+    printf("build              %.2f ms\n", buildMs);
+    printf("crater update      %.2f ms avg over %d impacts\n", updateMs / impacts, impacts);
+    return 0;
+}
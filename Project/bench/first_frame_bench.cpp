@@ -0,0 +1,106 @@
+// Time from choosing a map to its first drawn frame, for each map size:
+// loading sprites and then generating the world one after the other, against
+// decoding sprites on worker threads while the world generates, as the app
+// does. Draws in a hidden window, so it needs a display.
+//
+// Usage: worldbox_bench_first_frame [runs] [seed]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "environment/sim_thread.h"
+#include "environment/world.h"
+#include "render/world_renderer.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Starts the simulation and draws one frame of the whole map, as the app's
+// first GAME frame does
+static void DrawFirstFrame(World& world, WorldRenderer& renderer, int screenW, int screenH) {
+    SimulationThread sim(world, 60.0f);
+    sim.Start();
+    const WorldSnapshot& snapshot = sim.Acquire();
+
+    Camera2D camera = {};
+    camera.zoom = std::max((float)screenW / world.worldW, (float)screenH / world.worldH);
+    camera.offset = { screenW * 0.5f, screenH * 0.5f };
+    camera.target = { world.worldW * 0.5f, world.worldH * 0.5f };
+
+    BeginDrawing();
+    ClearBackground(BLACK);
+    renderer.Sync(snapshot);
+    BeginMode2D(camera);
+    renderer.Draw(snapshot, CameraViewRect(camera, screenW, screenH), camera.zoom);
+    EndMode2D();
+    EndDrawing();
+    sim.Stop();
+}
+
+int main(int argc, char** argv) {
+    int runs = (argc > 1) ? atoi(argv[1]) : 3;
+    unsigned int seed = (argc > 2) ? (unsigned int)strtoul(argv[2], nullptr, 10) : 1337u;
+
+    const int screenW = 1600;
+    const int screenH = 900;
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(screenW, screenH, "worldbox_bench_first_frame");
+    SetTraceLogLevel(LOG_WARNING);
+
+    struct MapSize { const char* name; int w; int h; };
+    const MapSize sizes[] = { { "SMALL", 1400, 900 }, { "MEDIUM", 2200, 1400 }, { "LARGE", 3200, 2000 } };
+
+    printf("seed %u  %d runs each, no world cache\n", seed, runs);
+    for (const MapSize& size : sizes) {
+        double serialMs = 0.0, overlappedMs = 0.0, decodeMs = 0.0, initMs = 0.0;
+        for (int r = 0; r < runs; r++) {
+            // Serial: sprites, then the world, then the first frame
+            {
+                World world;
+                world.worldW = size.w;
+                world.worldH = size.h;
+                world.worldSeed = seed;
+                WorldRenderer renderer;
+                Clock::time_point start = Clock::now();
+                renderer.Load();
+                world.Init();
+                DrawFirstFrame(world, renderer, screenW, screenH);
+                serialMs += MsSince(start);
+                renderer.Unload();
+            }
+            // Overlapped: sprites decode while the world generates; only the
+            // upload and the frame follow
+            {
+                World world;
+                world.worldW = size.w;
+                world.worldH = size.h;
+                world.worldSeed = seed;
+                WorldRenderer renderer;
+                Clock::time_point start = Clock::now();
+                double decoded = 0.0;
+                std::thread decoder([&] {
+                    renderer.DecodeAssets();
+                    decoded = MsSince(start);
+                });
+                world.Init();
+                initMs += MsSince(start);
+                decoder.join();
+                decodeMs += decoded;
+                renderer.FinishLoad();
+                DrawFirstFrame(world, renderer, screenW, screenH);
+                overlappedMs += MsSince(start);
+                renderer.Unload();
+            }
+        }
+        printf("%-6s %dx%d  serial %.1f ms  overlapped %.1f ms  (world init %.1f ms, sprite decode %.1f ms)\n",
+               size.name, size.w, size.h, serialMs / runs, overlappedMs / runs, initMs / runs, decodeMs / runs);
+    }
+
+    CloseWindow();
+    return 0;
+}
@@ -0,0 +1,85 @@
+// Compares routing a war march on the LARGE map two ways: one HPA* query
+// per warrior, or one shared flow field that every warrior samples each
+// step. Also times the rebuild a meteor impact triggers.
+//
+// Usage: worldbox_bench_flow_field [warriors] [seed]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "environment/random.h"
+#include "terrain/flow_field.h"
+#include "terrain/hpa_pathfinder.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int warriors = (argc > 1) ? atoi(argv[1]) : 400;
+    unsigned int seed = (argc > 2) ? (unsigned int)strtoul(argv[2], nullptr, 10) : 1337u;
+
+    // LARGE: 3200x2000 px
+    Terrain terrain(400, 250, seed);
+    terrain.generate();
+    HpaPathfinder pathfinder;
+    pathfinder.build(terrain);
+
+    Rng rng(seed);
+    auto randomLand = [&]() {
+        for (;;) {
+            Vector2 p = { RandomFloat(rng, 0.0f, 3200.0f), RandomFloat(rng, 0.0f, 2000.0f) };
+            if (terrain.canWalk(p.x, p.y)) return p;
+        }
+    };
+    Vector2 target = randomLand();
+    std::vector<Vector2> army(warriors);
+    for (Vector2& p : army) p = randomLand();
+
+    // One route per warrior
+    std::vector<Vector2> route;
+    Clock::time_point start = Clock::now();
+    int routed = 0;
+    for (const Vector2& p : army) routed += pathfinder.findPath(terrain, p, target, route) ? 1 : 0;
+    double hpaMs = MsSince(start);
+
+    // One field for everyone
+    FlowFieldCache cache;
+    start = Clock::now();
+    cache.acquire(terrain, 0, target);
+    double buildMs = MsSince(start);
+    const FlowField* field = cache.find(0);
+
+    // Walk every warrior to the goal tile by tile, timing the samples
+    long long samples = 0;
+    int arrived = 0;
+    start = Clock::now();
+    for (Vector2 p : army) {
+        Vector2 next;
+        int steps = 0;
+        while (field->nextStep(p, next) && steps < 4000) {
+            p = next;
+            steps++;
+        }
+        samples += steps + 1;
+        arrived += (field->costAt(p) == 0.0f) ? 1 : 0;
+    }
+    double walkMs = MsSince(start);
+
+    cache.invalidate();
+    start = Clock::now();
+    cache.refresh(terrain);
+    double rebuildMs = MsSince(start);
+
+    printf("LARGE 400x250 tiles  %d warriors\n", warriors);
+    printf("HPA* per warrior   %.2f ms total  (%d routed)\n", hpaMs, routed);
+    printf("flow field build   %.2f ms  (%.0f KiB)  rebuild after edit %.2f ms\n",
+           buildMs, 400.0 * 250.0 * (sizeof(float) + 1) / 1024.0, rebuildMs);
+    printf("flow field sample  %.1f ns/step over %lld steps  (%d arrived)\n",
+           walkMs * 1e6 / (double)samples, samples, arrived);
+    return 0;
+}
@@ -0,0 +1,85 @@
+// Times labelling walkable regions on the LARGE map, the O(1) reachability
+// query against a failing HPA* search, and the relabel after a meteor-sized
+// edit against a full rebuild.
+//
+// Usage: worldbox_bench_land_regions [queries] [seed]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "environment/random.h"
+#include "terrain/hpa_pathfinder.h"
+#include "terrain/land_regions.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int queries = (argc > 1) ? atoi(argv[1]) : 1000000;
+    unsigned int seed = (argc > 2) ? (unsigned int)strtoul(argv[2], nullptr, 10) : 1337u;
+
+    // LARGE: 3200x2000 px
+    Terrain terrain(400, 250, seed);
+    terrain.generate();
+    HpaPathfinder pathfinder;
+    pathfinder.build(terrain);
+
+    LandRegions regions;
+    Clock::time_point start = Clock::now();
+    regions.build(terrain);
+    double buildMs = MsSince(start);
+
+    Rng rng(seed);
+    std::vector<Vector2> points(4096);
+    for (Vector2& p : points) p = { RandomFloat(rng, 0.0f, 3200.0f), RandomFloat(rng, 0.0f, 2000.0f) };
+
+    int same = 0;
+    start = Clock::now();
+    for (int q = 0; q < queries; q++) {
+        same += regions.sameRegion(points[q & 4095], points[(q * 7 + 1) & 4095]) ? 1 : 0;
+    }
+    double queryMs = MsSince(start);
+
+    // What the query saves: HPA* on pairs of land points it rejects
+    std::vector<Vector2> route;
+    int rejected = 0;
+    start = Clock::now();
+    for (int q = 0; q < 4096 && rejected < 50; q++) {
+        Vector2 a = points[q];
+        Vector2 b = points[(q * 7 + 1) & 4095];
+        if (!terrain.canWalk(a.x, a.y) || !terrain.canWalk(b.x, b.y) || regions.sameRegion(a, b)) continue;
+        pathfinder.findPath(terrain, a, b, route);
+        rejected++;
+    }
+    double failMs = MsSince(start);
+
+    // Meteor-sized crater (radius 60 px) flooded into water
+    double updateMs = 0.0;
+    const int impacts = 20;
+    for (int k = 0; k < impacts; k++) {
+        int cx = RandomInt(rng, 8, 391);
+        int cy = RandomInt(rng, 8, 241);
+        for (int y = cy - 7; y <= cy + 7; y++) {
+            for (int x = cx - 7; x <= cx + 7; x++) {
+                Tile tile = terrain.getTile(x, y);
+                tile.biomeIndex = 0;
+                terrain.setTile(x, y, tile);
+            }
+        }
+        start = Clock::now();
+        regions.update(terrain, { cx - 7, cy - 7, 15, 15 });
+        updateMs += MsSince(start);
+    }
+
+    printf("LARGE 400x250 tiles  %zu regions\n", regions.regionCount());
+    printf("build              %.2f ms\n", buildMs);
+    printf("sameRegion         %.1f ns/query  (%d of %d same)\n", queryMs * 1e6 / queries, same, queries);
+    printf("failing HPA*       %.1f us/query  (%d pairs)\n", rejected ? failMs * 1e3 / rejected : 0.0, rejected);
+    printf("crater update      %.2f ms avg over %d impacts\n", updateMs / impacts, impacts);
+    return 0;
+}
@@ -0,0 +1,66 @@
+// Times FbmBatch with each noise kernel the CPU supports, per octave count,
+// and reports the speedup over the scalar reference.
+//
+// Usage: worldbox_bench_noise [points] [repeats]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "environment/random.h"
+#include "terrain/noise.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps otherwise unused results alive
+static volatile float sink = 0.0f;
+
+// Nanoseconds per point, best of repeats
+static double TimeKernel(NoiseKernel kernel, const std::vector<int>& perm, const std::vector<float>& xs,
+                         const std::vector<float>& ys, std::vector<float>& out, int octaves, int repeats) {
+    SetNoiseKernel(kernel);
+    double best = 1e30;
+    for (int r = 0; r < repeats; r++) {
+        Clock::time_point start = Clock::now();
+        FbmBatch(perm.data(), xs.data(), ys.data(), (int)xs.size(), octaves, out.data());
+        best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+        sink = sink + out[r % out.size()];
+    }
+    return best / (double)xs.size();
+}
+
+int main(int argc, char** argv) {
+    int points = (argc > 1) ? atoi(argv[1]) : 1 << 16;
+    int repeats = (argc > 2) ? atoi(argv[2]) : 5;
+
+    std::vector<int> perm(512);
+    for (int i = 0; i < 256; i++) perm[i] = perm[256 + i] = (i * 167 + 13) & 255;
+
+    // Rows of adjacent tiles, like Terrain::generate feeds the kernel
+    std::vector<float> xs(points), ys(points), out(points);
+    Rng rng(3);
+    float y = 0.0f;
+    for (int i = 0; i < points; i++) {
+        if (i % 400 == 0) y = RandomFloat(rng, 0.0f, 10000.0f) * 0.03f;
+        xs[i] = (float)(i % 400) * 0.03f + 500.0f;
+        ys[i] = y;
+    }
+
+    NoiseKernel best = DetectNoiseKernel();
+    printf("%d points, best kernel %s\n", points, NoiseKernelName(best));
+    printf("%-8s %10s", "octaves", "scalar ns");
+    for (int k = 1; k <= (int)best; k++) printf(" %9s ns %8s", NoiseKernelName((NoiseKernel)k), "speedup");
+    printf("\n");
+
+    for (int octaves = 1; octaves <= 8; octaves++) {
+        double scalar = TimeKernel(NoiseKernel::SCALAR, perm, xs, ys, out, octaves, repeats);
+        printf("%-8d %10.2f", octaves, scalar);
+        for (int k = 1; k <= (int)best; k++) {
+            double t = TimeKernel((NoiseKernel)k, perm, xs, ys, out, octaves, repeats);
+            printf(" %12.2f %7.2fx", t, scalar / t);
+        }
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Measures World::Update cost against NPC count, and the nearest-enemy
+// query pass through NpcSpatialGrid against a full scan of World::npcs.
+//
+// Usage: worldbox_bench_npc_grid [ticks]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "environment/world.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Headless world: terrain only, no textures
+static void SetupWorld(World& world, int targetNpcs) {
+    world.worldW = 3200;
+    world.worldH = 2000;
+    world.worldSeed = 1337;
+    world.cols = world.worldW / CELL_SIZE;
+    world.rows = world.worldH / CELL_SIZE;
+    world.terrain = Terrain(world.cols, world.rows, world.worldSeed);
+    world.terrain.generate();
+    world.rng.Seed(world.worldSeed);
+    world.npcGrid.Clear();
+
+    std::vector<Vector2> land;
+    for (int y = 40; y < world.worldH - 40; y += 23) {
+        for (int x = 40; x < world.worldW - 40; x += 29) {
+            if (world.terrain.canBuild((float)x, (float)y)) land.push_back({(float)x, (float)y});
+        }
+    }
+    if (land.empty()) return;
+
+    // Settlement clusters of 4 civilians, 10 warriors and 2 captains
+    for (size_t k = 0; (int)world.npcs.size() < targetNpcs; k++) {
+        Vector2 p = land[(k * 7919) % land.size()];
+        for (int c = 0; c < 4; c++) world.SpawnCivilian({p.x + c * 3.0f, p.y + c * 2.0f});
+        for (int c = 0; c < 10; c++) world.SpawnWarrior({p.x + (c % 5) * 4.0f, p.y - 6.0f - (c / 5) * 4.0f});
+        for (int c = 0; c < 2; c++) world.SpawnCaptain({p.x - 6.0f, p.y + c * 4.0f});
+    }
+
+    for (int s = 0; s + 1 < (int)world.settlements.size(); s += 2) {
+        world.StartSettlementWar(s, s + 1);
+    }
+}
+
+static void BenchUpdate(int targetNpcs, int ticks) {
+    World world;
+    SetupWorld(world, targetNpcs);
+
+    const float dt = 1.0f / 60.0f;
+    for (int t = 0; t < 30; t++) world.Update(dt, &world.terrain);
+
+    size_t npcSum = 0;
+    Clock::time_point start = Clock::now();
+    for (int t = 0; t < ticks; t++) {
+        world.Update(dt, &world.terrain);
+        npcSum += world.npcs.size();
+    }
+    double ms = MsSince(start);
+
+    double avgNpcs = (double)npcSum / ticks;
+    double msPerTick = ms / ticks;
+    printf("%8d %10.0f %12zu %12.3f %14.3f\n",
+           targetNpcs, avgNpcs, world.settlements.size(), msPerTick, msPerTick * 1000.0 / avgNpcs);
+}
+
+// Legacy query shape: every NPC scans every other NPC
+static int FullScanNearestEnemy(const World& world, ConstNpcRef npc, float radiusPx) {
+    float bestD2 = radiusPx * radiusPx;
+    int bestIndex = -1;
+    int bestPriority = 999;
+
+    for (int i = 0; i < (int)world.npcs.size(); i++) {
+        ConstNpcRef other = world.npcs[i];
+        if (!other.alive || other.isDying) continue;
+        if (other.settlementId == npc.settlementId) continue;
+
+        int priority = 999;
+        if (other.humanRole == NPC::HumanRole::WARRIOR) priority = 0;
+        else if (other.humanRole == NPC::HumanRole::CAPTAIN) priority = 1;
+        else continue;
+
+        float dx = other.pos.x - npc.pos.x;
+        float dy = other.pos.y - npc.pos.y;
+        float d2 = dx*dx + dy*dy;
+        if (d2 > bestD2) continue;
+
+        if (priority < bestPriority || (priority == bestPriority && d2 < bestD2)) {
+            bestPriority = priority;
+            bestD2 = d2;
+            bestIndex = i;
+        }
+    }
+
+    return bestIndex;
+}
+
+static void BenchQueries(int targetNpcs) {
+    World world;
+    SetupWorld(world, targetNpcs);
+
+    Clock::time_point start = Clock::now();
+    world.npcGrid.Rebuild(world.npcs, world.worldW, world.worldH, (float)CELL_SIZE);
+    double rebuildMs = MsSince(start);
+
+    const float radius = CELL_SIZE * 9.0f;
+    long long checksumScan = 0;
+    long long checksumGrid = 0;
+
+    start = Clock::now();
+    for (ConstNpcRef npc : world.npcs) checksumScan += FullScanNearestEnemy(world, npc, radius);
+    double scanMs = MsSince(start);
+
+    start = Clock::now();
+    for (ConstNpcRef npc : world.npcs) checksumGrid += world.FindNearestEnemyCombatNear(npc, radius);
+    double gridMs = MsSince(start);
+
+    printf("%8zu %12.3f %12.3f %12.3f %8s\n", world.npcs.size(), rebuildMs, scanMs, gridMs,
+           checksumScan == checksumGrid ? "yes" : "NO");
+}
+
+int main(int argc, char** argv) {
+    int ticks = (argc > 1) ? atoi(argv[1]) : 120;
+    const int sizes[] = { 1000, 2000, 5000, 10000, 20000 };
+
+    printf("World::Update on 3200x2000, %d ticks\n", ticks);
+    printf("%8s %10s %12s %12s %14s\n", "target", "avg npcs", "settlements", "ms/tick", "us/npc/tick");
+    for (int n : sizes) BenchUpdate(n, ticks);
+
+    printf("\nNearest enemy combat query for every NPC\n");
+    printf("%8s %12s %12s %12s %8s\n", "npcs", "rebuild ms", "scan ms", "grid ms", "match");
+    for (int n : sizes) BenchQueries(n);
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Draws the whole LARGE map with 20k NPCs through WorldRenderer in a hidden
+// window, once per NPC detail tier, and reports the NPC pass, the whole frame
+// and the modelled draw calls for each. Needs a display for the GL context.
+//
+// Usage: worldbox_bench_npc_lod [npcs] [frames]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "environment/world.h"
+#include "environment/world_snapshot.h"
+#include "render/world_renderer.h"
+
+int main(int argc, char** argv) {
+    int target = (argc > 1) ? atoi(argv[1]) : 20000;
+    int frames = (argc > 2) ? atoi(argv[2]) : 120;
+
+    const int screenW = 1600;
+    const int screenH = 900;
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(screenW, screenH, "worldbox_bench_npc_lod");
+    SetTargetFPS(0);
+
+    World world;
+    world.worldW = 3200;
+    world.worldH = 2000;
+    world.worldSeed = 1337;
+    world.Init();
+
+    const float step = 6.0f;
+    for (float y = step; y < world.worldH && (int)world.npcs.size() < target; y += step) {
+        for (float x = step; x < world.worldW && (int)world.npcs.size() < target; x += step) {
+            if (!world.terrain.canBuild(x, y)) continue;
+            if (((int)(x / step) + (int)(y / step)) % 5 == 0) world.SpawnWarrior({ x, y });
+            else world.SpawnCivilian({ x, y });
+        }
+    }
+    for (int t = 0; t < 30; t++) world.Update(1.0f / 60.0f, &world.terrain);
+
+    WorldSnapshotWriter writer;
+    WorldSnapshot snapshot;
+    writer.Capture(world, snapshot);
+
+    WorldRenderer renderer;
+    renderer.Load();
+    renderer.Sync(snapshot);
+
+    // The whole map, as the fitted camera shows it at startup
+    Camera2D camera = {};
+    camera.zoom = std::max((float)screenW / world.worldW, (float)screenH / world.worldH);
+    camera.offset = { screenW * 0.5f, screenH * 0.5f };
+    camera.target = { world.worldW * 0.5f, world.worldH * 0.5f };
+    Rectangle view = CameraViewRect(camera, screenW, screenH);
+
+    const char* names[] = { "SPRITES", "QUADS", "DENSITY" };
+    printf("LARGE 3200x2000  %d npcs  zoom %.2f (tier by zoom: %s)  %d frames\n", (int)snapshot.npcs.size(),
+           camera.zoom, names[(int)WorldRenderer::LodForZoom(camera.zoom)], frames);
+    for (int tier = 0; tier < 3; tier++) {
+        renderer.npcLodOverride = (WorldRenderer::NpcLod)tier;
+        double npcMs = 0.0;
+        double start = GetTime();
+        for (int f = 0; f < frames; f++) {
+            BeginDrawing();
+            ClearBackground(BLACK);
+            BeginMode2D(camera);
+            renderer.Draw(snapshot, view, camera.zoom);
+            EndMode2D();
+            EndDrawing();
+            npcMs += renderer.lastDrawStats.npcMs;
+        }
+        double frameMs = (GetTime() - start) * 1000.0 / frames;
+        printf("%-8s  npc pass %.3f ms  frame %.3f ms  draw calls %d", names[tier], npcMs / frames, frameMs,
+               renderer.lastDrawStats.drawCalls);
+        if (tier == (int)WorldRenderer::NpcLod::DENSITY) printf("  (%d splats)", renderer.lastDrawStats.densitySplats);
+        printf("\n");
+    }
+
+    renderer.Unload();
+    CloseWindow();
+    return 0;
+}
@@ -0,0 +1,150 @@
+// Measures the per-tick hot passes over an AoS std::vector<NPC> against the
+// same passes over NpcStore columns, then World::Update cost at the same sizes.
+//
+// Usage: worldbox_bench_npc_store [ticks]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "environment/world.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps otherwise unused results alive
+static volatile long long sink = 0;
+
+static double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static NPC MakeNpc(Rng& rng, int i) {
+    NPC npc;
+    npc.id = (uint32_t)i + 1;
+    npc.pos = { RandomFloat(rng, 0.0f, 3200.0f), RandomFloat(rng, 0.0f, 2000.0f) };
+    npc.vel = { RandomFloat(rng, -20.0f, 20.0f), RandomFloat(rng, -20.0f, 20.0f) };
+    npc.humanRole = (NPC::HumanRole)(1 + i % 4);
+    npc.settlementId = i % 64;
+    npc.alive = (i % 50) != 0;
+    return npc;
+}
+
+// One tick of the passes World::Update runs over every NPC: settlement
+// liveness counts, position integration with world clamping, role tally
+template <typename Store>
+static float HotTick(Store& npcs, std::vector<int>& aliveBySettlement, float dt) {
+    for (int& c : aliveBySettlement) c = 0;
+    int warriors = 0;
+
+    for (auto&& npc : npcs) {
+        if (!npc.alive || npc.isDying) continue;
+        if (npc.settlementId >= 0) aliveBySettlement[npc.settlementId]++;
+        if (npc.humanRole == NPC::HumanRole::WARRIOR) warriors++;
+
+        npc.pos.x += npc.vel.x * dt;
+        npc.pos.y += npc.vel.y * dt;
+        if (npc.pos.x < 0.0f || npc.pos.x > 3200.0f) npc.vel.x = -npc.vel.x;
+        if (npc.pos.y < 0.0f || npc.pos.y > 2000.0f) npc.vel.y = -npc.vel.y;
+    }
+
+    return (float)warriors + (float)aliveBySettlement[0];
+}
+
+static void BenchLayouts(int count, int ticks) {
+    Rng rng(42);
+    std::vector<NPC> aos;
+    NpcStore soa;
+    aos.reserve(count);
+    soa.reserve(count);
+    for (int i = 0; i < count; i++) {
+        NPC npc = MakeNpc(rng, i);
+        aos.push_back(npc);
+        soa.push_back(npc);
+    }
+
+    std::vector<int> aliveBySettlement(64);
+    const float dt = 1.0f / 60.0f;
+    float checksumAos = 0.0f;
+    float checksumSoa = 0.0f;
+
+    Clock::time_point start = Clock::now();
+    for (int t = 0; t < ticks; t++) checksumAos += HotTick(aos, aliveBySettlement, dt);
+    double aosMs = MsSince(start) / ticks;
+
+    start = Clock::now();
+    for (int t = 0; t < ticks; t++) checksumSoa += HotTick(soa, aliveBySettlement, dt);
+    double soaMs = MsSince(start) / ticks;
+
+    // Column reads without building a handle
+    start = Clock::now();
+    long long active = 0;
+    for (int t = 0; t < ticks; t++) {
+        for (int i = 0; i < (int)soa.size(); i++) active += soa.IsActive(i) ? soa.SettlementId(i) : 0;
+    }
+    double columnMs = MsSince(start) / ticks;
+
+    sink = active;
+
+    printf("%8d %10zu %12.3f %12.3f %12.3f %8s\n", count, sizeof(NPC), aosMs, soaMs, columnMs,
+           checksumAos == checksumSoa ? "yes" : "NO");
+}
+
+// Headless world: terrain plus settlement clusters, no textures
+static void SetupWorld(World& world, int targetNpcs) {
+    world.worldW = 3200;
+    world.worldH = 2000;
+    world.worldSeed = 1337;
+    world.cols = world.worldW / CELL_SIZE;
+    world.rows = world.worldH / CELL_SIZE;
+    world.terrain = Terrain(world.cols, world.rows, world.worldSeed);
+    world.terrain.generate();
+    world.rng.Seed(world.worldSeed);
+    world.npcGrid.Clear();
+
+    std::vector<Vector2> land;
+    for (int y = 40; y < world.worldH - 40; y += 23) {
+        for (int x = 40; x < world.worldW - 40; x += 29) {
+            if (world.terrain.canBuild((float)x, (float)y)) land.push_back({(float)x, (float)y});
+        }
+    }
+    if (land.empty()) return;
+
+    world.npcs.reserve(targetNpcs + 16);
+    for (size_t k = 0; (int)world.npcs.size() < targetNpcs; k++) {
+        Vector2 p = land[(k * 7919) % land.size()];
+        for (int c = 0; c < 4; c++) world.SpawnCivilian({p.x + c * 3.0f, p.y + c * 2.0f});
+        for (int c = 0; c < 10; c++) world.SpawnWarrior({p.x + (c % 5) * 4.0f, p.y - 6.0f - (c / 5) * 4.0f});
+        for (int c = 0; c < 2; c++) world.SpawnCaptain({p.x - 6.0f, p.y + c * 4.0f});
+    }
+}
+
+static void BenchUpdate(int targetNpcs, int ticks) {
+    World world;
+    SetupWorld(world, targetNpcs);
+
+    const float dt = 1.0f / 60.0f;
+    for (int t = 0; t < 5; t++) world.Update(dt, &world.terrain);
+
+    Clock::time_point start = Clock::now();
+    for (int t = 0; t < ticks; t++) world.Update(dt, &world.terrain);
+    double msPerTick = MsSince(start) / ticks;
+
+    printf("%8d %10zu %12.3f\n", targetNpcs, world.npcs.size(), msPerTick);
+}
+
+int main(int argc, char** argv) {
+    int ticks = (argc > 1) ? atoi(argv[1]) : 200;
+    const int sizes[] = { 10000, 50000 };
+
+    printf("Hot per-tick passes, %d ticks\n", ticks);
+    printf("%8s %10s %12s %12s %12s %8s\n", "npcs", "NPC bytes", "AoS ms", "SoA ms", "column ms", "match");
+    for (int n : sizes) BenchLayouts(n, ticks);
+
+    int updateTicks = ticks / 100 > 0 ? ticks / 100 : 1;
+    printf("\nWorld::Update on 3200x2000, %d ticks\n", updateTicks);
+    printf("%8s %10s %12s\n", "target", "npcs", "ms/tick");
+    for (int n : sizes) BenchUpdate(n, updateTicks);
+
+    return 0;
+}
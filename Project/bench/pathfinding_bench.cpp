@@ -0,0 +1,142 @@
+// Times HpaPathfinder on the LARGE map: graph build, rebuilding the
+// clusters under a meteor crater, and random walkable-to-walkable queries,
+// next to a plain tile A* with the same step costs for reference.
+//
+// Usage: worldbox_bench_pathfinding [queries] [seed]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "environment/random.h"
+#include "terrain/hpa_pathfinder.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// 8-way A* over every tile, no hierarchy; returns the route cost or -1
+static float TileAStar(const Terrain& terrain, int sx, int sy, int gx, int gy, float minStepCost) {
+    const int w = terrain.getWidth();
+    const int h = terrain.getHeight();
+    static std::vector<float> g;
+    static std::vector<float> cost;
+    if (cost.size() != (size_t)w * h) {
+        cost.resize((size_t)w * h);
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) cost[(size_t)y * w + x] = terrain.getWalkCost(x, y);
+        }
+    }
+    g.assign((size_t)w * h, std::numeric_limits<float>::infinity());
+
+    auto heuristic = [&](int x, int y) {
+        int dx = std::abs(x - gx);
+        int dy = std::abs(y - gy);
+        return ((float)std::max(dx, dy) + 0.41421356f * (float)std::min(dx, dy)) * minStepCost;
+    };
+    auto open = [&](int x, int y) { return x >= 0 && x < w && y >= 0 && y < h && cost[(size_t)y * w + x] >= 0.0f; };
+
+    std::vector<std::pair<float, int>> heap;
+    g[(size_t)sy * w + sx] = 0.0f;
+    heap.push_back({ heuristic(sx, sy), sy * w + sx });
+    static const int DX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+    static const int DY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+        auto [f, i] = heap.back();
+        heap.pop_back();
+        int x = i % w;
+        int y = i / w;
+        if (x == gx && y == gy) return g[i];
+        if (f > g[i] + heuristic(x, y)) continue;
+        for (int k = 0; k < 8; k++) {
+            int nx = x + DX[k];
+            int ny = y + DY[k];
+            if (!open(nx, ny)) continue;
+            if (k >= 4 && (!open(nx, y) || !open(x, ny))) continue;
+            int j = ny * w + nx;
+            float ng = g[i] + (k >= 4 ? 1.41421356f : 1.0f) * (cost[i] + cost[j]) * 0.5f;
+            if (ng < g[j]) {
+                g[j] = ng;
+                heap.push_back({ ng + heuristic(nx, ny), j });
+                std::push_heap(heap.begin(), heap.end(), std::greater<>());
+            }
+        }
+    }
+    return -1.0f;
+}
+
+int main(int argc, char** argv) {
+    int queries = (argc > 1) ? atoi(argv[1]) : 2000;
+    unsigned int seed = (argc > 2) ? (unsigned int)strtoul(argv[2], nullptr, 10) : 1337u;
+
+    // LARGE: 3200x2000 px
+    Terrain terrain(400, 250, seed);
+    terrain.generate();
+
+    HpaPathfinder pathfinder;
+    Clock::time_point start = Clock::now();
+    pathfinder.build(terrain);
+    double buildMs = MsSince(start);
+    printf("map 400x250 tiles  clusters %dx%d  nodes %zu  edges %zu  build %.2f ms\n",
+           HpaPathfinder::CLUSTER, HpaPathfinder::CLUSTER,
+           pathfinder.nodeCount(), pathfinder.edgeCount(), buildMs);
+
+    // Meteor-sized crater (radius 40 px plus debris ring) somewhere inland
+    start = Clock::now();
+    const int craters = 50;
+    for (int k = 0; k < craters; k++) pathfinder.invalidate(terrain, { 40 + k * 6, 60 + (k % 5) * 30, 17, 17 });
+    printf("crater invalidate %.3f ms each\n", MsSince(start) / craters);
+
+    std::vector<std::pair<Vector2, Vector2>> pairs;
+    Rng rng(seed);
+    while ((int)pairs.size() < queries) {
+        Vector2 a = { RandomFloat(rng, 0.0f, 3200.0f), RandomFloat(rng, 0.0f, 2000.0f) };
+        Vector2 b = { RandomFloat(rng, 0.0f, 3200.0f), RandomFloat(rng, 0.0f, 2000.0f) };
+        if (terrain.canWalk(a.x, a.y) && terrain.canWalk(b.x, b.y)) pairs.push_back({ a, b });
+    }
+
+    std::vector<Vector2> route;
+    int found = 0;
+    size_t waypoints = 0;
+    std::vector<double> us;
+    start = Clock::now();
+    for (const auto& [a, b] : pairs) {
+        Clock::time_point q = Clock::now();
+        if (pathfinder.findPath(terrain, a, b, route)) {
+            found++;
+            waypoints += route.size();
+        }
+        us.push_back(MsSince(q) * 1000.0);
+    }
+    double hpaMs = MsSince(start);
+    std::sort(us.begin(), us.end());
+    printf("HPA*    %d queries  %d found  avg %.1f waypoints  %.1f us/query (p99 %.1f us)  %.0f queries/s\n",
+           queries, found, found ? (double)waypoints / found : 0.0,
+           hpaMs * 1000.0 / queries, us[us.size() * 99 / 100], queries / (hpaMs / 1000.0));
+
+    float fastest = 0.0f;
+    for (const Biome& b : terrain.getBiomes()) {
+        if (b.props.canWalk) fastest = std::max(fastest, b.props.moveSpeed);
+    }
+    int tileQueries = std::min(queries, 200);
+    int tileFound = 0;
+    start = Clock::now();
+    for (int i = 0; i < tileQueries; i++) {
+        const auto& [a, b] = pairs[i];
+        float c = TileAStar(terrain, (int)(a.x / 8.0f), (int)(a.y / 8.0f), (int)(b.x / 8.0f), (int)(b.y / 8.0f), 1.0f / fastest);
+        if (c >= 0.0f) tileFound++;
+    }
+    double tileMs = MsSince(start);
+    printf("tile A* %d queries  %d found  %.1f us/query  %.0f queries/s\n",
+           tileQueries, tileFound, tileMs * 1000.0 / tileQueries, tileQueries / (tileMs / 1000.0));
+    return 0;
+}
@@ -0,0 +1,120 @@
+// Populates the LARGE map and measures the cost of capturing a WorldSnapshot
+// next to a tick, then runs SimulationThread for a few seconds while this
+// thread consumes snapshots with a stand-in for the renderer's per-frame
+// work, reporting each thread's busy time against wall time.
+//
+// Usage: worldbox_bench_render_snapshot [npcs] [seconds]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "environment/sim_thread.h"
+#include "environment/world.h"
+#include "environment/world_snapshot.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Keeps otherwise unused results alive
+static volatile double sink = 0.0;
+
+// What WorldRenderer::Draw reads from a snapshot for a view of the whole map,
+// without the raylib calls
+static void RenderStandIn(const WorldSnapshot& s, std::vector<int>& visible) {
+    double acc = 0.0;
+    s.npcBuckets.Query({ 0.0f, 0.0f, (float)s.worldW, (float)s.worldH }, visible);
+    for (int i : visible) {
+        const NpcSnapshot& n = s.npcs[i];
+        acc += n.pos.x + n.pos.y + (n.attackT >= 0.0f ? n.attackT : 0.0f) + n.deathT;
+    }
+    for (const PlantSnapshot& p : s.plants) acc += p.position.x * p.growthStage;
+    for (const SettlementSnapshot& st : s.settlements) acc += st.centerPx.x;
+    sink = sink + acc;
+}
+
+int main(int argc, char** argv) {
+    int target = (argc > 1) ? atoi(argv[1]) : 5000;
+    double seconds = (argc > 2) ? atof(argv[2]) : 3.0;
+
+    World world;
+    world.worldW = 3200;
+    world.worldH = 2000;
+    world.worldSeed = 1337;
+    world.Init();
+
+    const float step = 12.0f;
+    for (float y = step; y < world.worldH && (int)world.npcs.size() < target; y += step) {
+        for (float x = step; x < world.worldW && (int)world.npcs.size() < target; x += step) {
+            if (!world.terrain.canBuild(x, y)) continue;
+            if (((int)(x / step) + (int)(y / step)) % 5 == 0) world.SpawnWarrior({ x, y });
+            else world.SpawnCivilian({ x, y });
+        }
+    }
+    for (int t = 0; t < 30; t++) world.Update(1.0f / 60.0f, &world.terrain);
+
+    // Tick, capture and stand-in render, one after another
+    const int frames = 120;
+    WorldSnapshotWriter writer;
+    WorldSnapshot snapshot;
+    std::vector<int> visible;
+    writer.Capture(world, snapshot);
+    double tickMs = 0.0, captureMs = 0.0, renderMs = 0.0;
+    for (int f = 0; f < frames; f++) {
+        Clock::time_point t0 = Clock::now();
+        world.Update(1.0f / 60.0f, &world.terrain);
+        tickMs += MsSince(t0);
+        Clock::time_point t1 = Clock::now();
+        writer.Capture(world, snapshot);
+        captureMs += MsSince(t1);
+        Clock::time_point t2 = Clock::now();
+        RenderStandIn(snapshot, visible);
+        renderMs += MsSince(t2);
+    }
+    printf("LARGE 3200x2000  %d npcs in snapshot  %d plants\n", (int)snapshot.npcs.size(), (int)snapshot.plants.size());
+    printf("tick               %.3f ms\n", tickMs / frames);
+    printf("capture            %.3f ms\n", captureMs / frames);
+    printf("render stand-in    %.3f ms\n", renderMs / frames);
+    printf("serial frame       %.3f ms\n", (tickMs + captureMs + renderMs) / frames);
+
+    // Simulation on its own thread at 60 Hz; this thread renders whatever is newest
+    SimulationThread sim(world, 60.0f);
+    sim.Start();
+    Clock::time_point start = Clock::now();
+    double renderBusyMs = 0.0;
+    int rendered = 0;
+    int distinct = 0;
+    uint64_t lastTick = UINT64_MAX;
+    float simBusy = 0.0f;
+    int simTicks = 0;
+    while (MsSince(start) < seconds * 1000.0) {
+        Clock::time_point t0 = Clock::now();
+        const WorldSnapshot& s = sim.Acquire();
+        RenderStandIn(s, visible);
+        renderBusyMs += MsSince(t0);
+        rendered++;
+        if (s.tick != lastTick) distinct++;
+        lastTick = s.tick;
+        if (s.simTicksPerSecond > 0) {
+            simBusy = s.simBusyMsPerSecond;
+            simTicks = s.simTicksPerSecond;
+        }
+        // A 60 fps frame limiter
+        std::this_thread::sleep_until(t0 + std::chrono::microseconds(16667));
+    }
+    double wallMs = MsSince(start);
+    sim.Stop();
+
+    printf("threaded, %.1f s wall\n", wallMs / 1000.0);
+    printf("  sim thread       %d ticks/s  busy %.1f ms/s\n", simTicks, simBusy);
+    printf("  render thread    %.0f frames/s  busy %.1f ms/s  (%d distinct snapshots)\n",
+           rendered / (wallMs / 1000.0), renderBusyMs / (wallMs / 1000.0), distinct);
+    printf("  busy sum         %.1f ms/s, overlapped instead of added per frame\n",
+           simBusy + renderBusyMs / (wallMs / 1000.0));
+    return 0;
+}
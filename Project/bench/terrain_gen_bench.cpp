@@ -0,0 +1,55 @@
+// Times Terrain::generate for each map size offered in the menu, on one
+// thread and on every hardware thread.
+//
+// Usage: worldbox_bench_terrain_gen [repeats] [seed]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "environment/world.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct MapSize {
+    const char* name;
+    int worldW;
+    int worldH;
+};
+
+// Seconds per generate() call, best of repeats
+static double TimeGenerate(int cols, int rows, unsigned int seed, int threads, int repeats) {
+    double best = 1e30;
+    for (int r = 0; r < repeats; r++) {
+        Terrain terrain(cols, rows, seed);
+        Clock::time_point start = Clock::now();
+        terrain.generate(threads);
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    int repeats = (argc > 1) ? atoi(argv[1]) : 3;
+    unsigned int seed = (argc > 2) ? (unsigned int)strtoul(argv[2], nullptr, 10) : 1337u;
+    int hw = (int)std::max(1u, std::thread::hardware_concurrency());
+
+    const MapSize sizes[] = {
+        { "SMALL",  1400,  900 },
+        { "MEDIUM", 2200, 1400 },
+        { "LARGE",  3200, 2000 },
+    };
+
+    printf("%-7s %9s %14s %14s  (%d hardware threads)\n", "map", "tiles", "1 thread t/s", "all t/s", hw);
+    for (const MapSize& size : sizes) {
+        int cols = size.worldW / CELL_SIZE;
+        int rows = size.worldH / CELL_SIZE;
+        double tiles = (double)cols * rows;
+
+        double serial = TimeGenerate(cols, rows, seed, 1, repeats);
+        double parallel = TimeGenerate(cols, rows, seed, 0, repeats);
+        printf("%-7s %9.0f %14.0f %14.0f\n", size.name, tiles, tiles / serial, tiles / parallel);
+    }
+    return 0;
+}
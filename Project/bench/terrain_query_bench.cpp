@@ -0,0 +1,81 @@
+// Times the terrain queries movement code makes (getMoveSpeedAt, canWalk),
+// then World::Update on the LARGE map, where every behavior and animal step
+// makes them.
+//
+// Usage: worldbox_bench_terrain_query [ticks] [settlements]
+
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "environment/world.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps otherwise unused results alive
+static volatile float sink = 0.0f;
+
+static double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int ticks = (argc > 1) ? atoi(argv[1]) : 600;
+    int settlementCount = (argc > 2) ? atoi(argv[2]) : 40;
+
+    World world;
+    world.worldW = 3200;
+    world.worldH = 2000;
+    world.worldSeed = 1337;
+    world.Init();
+
+    // Random positions in and slightly around the map
+    const int queries = 4000000;
+    std::vector<Vector2> points(queries);
+    Rng rng(11);
+    for (Vector2& p : points) {
+        p = { RandomFloat(rng, -50.0f, 3250.0f), RandomFloat(rng, -50.0f, 2050.0f) };
+    }
+
+    // Best of five passes each
+    float acc = 0.0f;
+    double speedNs = 1e30;
+    double walkNs = 1e30;
+    for (int r = 0; r < 5; r++) {
+        Clock::time_point start = Clock::now();
+        for (const Vector2& p : points) acc += world.terrain.getMoveSpeedAt(p.x, p.y);
+        speedNs = std::min(speedNs, MsSince(start) * 1e6 / queries);
+
+        start = Clock::now();
+        for (const Vector2& p : points) acc += world.terrain.canWalk(p.x, p.y) ? 1.0f : 0.0f;
+        walkNs = std::min(walkNs, MsSince(start) * 1e6 / queries);
+    }
+    sink = acc;
+
+    printf("getMoveSpeedAt %6.2f ns/query   canWalk %6.2f ns/query\n", speedNs, walkNs);
+
+    // Same population recipe as WorldBoxHeadless
+    std::vector<Vector2> land;
+    for (int y = 40; y < world.worldH - 40; y += 23) {
+        for (int x = 40; x < world.worldW - 40; x += 29) {
+            if (world.terrain.canBuild((float)x, (float)y)) land.push_back({(float)x, (float)y});
+        }
+    }
+    for (int k = 0; k < settlementCount && !land.empty(); k++) {
+        Vector2 p = land[((size_t)k * 7919) % land.size()];
+        for (int c = 0; c < 6; c++) world.SpawnCivilian({p.x + c * 3.0f, p.y + c * 2.0f});
+        for (int c = 0; c < 6; c++) world.SpawnWarrior({p.x + (c % 3) * 4.0f, p.y - 6.0f - (c / 3) * 4.0f});
+        world.SpawnCaptain({p.x - 6.0f, p.y});
+    }
+
+    const float dt = 1.0f / 60.0f;
+    Clock::time_point start = Clock::now();
+    for (int t = 0; t < ticks; t++) world.Update(dt, &world.terrain);
+    double tickMs = MsSince(start) / ticks;
+
+    printf("World::Update  %6.3f ms/tick over %d ticks (%zu npcs, %zu animals at end)\n",
+           tickMs, ticks, world.npcs.size(), world.animals.size());
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Pans a camera and an army across a map far beyond LARGE while the terrain
+// streams in chunks, and reports resident memory and query latency.
+// The camera reads every visible tile each frame (as a renderer bake would),
+// the army queries canWalk/getMoveSpeedAt around it and digs a few tiles,
+// and trimResident runs once per frame with a fixed chunk budget. The camera
+// pans out and back, so the return trip reloads dug chunks from disk.
+//
+// Usage: worldbox_bench_terrain_stream [tiles] [frames] [budget]
+
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "environment/random.h"
+#include "terrain/terrain.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps otherwise unused results alive
+static volatile float sink = 0.0f;
+
+static double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int tiles = (argc > 1) ? atoi(argv[1]) : 6250;
+    int frames = (argc > 2) ? atoi(argv[2]) : 2400;
+    size_t budget = (argc > 3) ? (size_t)atoll(argv[3]) : 512;
+
+    const float tilePx = 8.0f;
+    const int viewW = 160;     // 1280x720 px camera
+    const int viewH = 90;
+    const int armySize = 2000;
+    const float armySpread = 1200.0f;
+
+    Terrain terrain(tiles, tiles, 1337);
+    terrain.setResidentChunkBudget(budget);
+
+    std::vector<Vector2> offsets(armySize);
+    Rng rng(5);
+    for (Vector2& o : offsets) o = { RandomFloat(rng, -armySpread, armySpread), RandomFloat(rng, -armySpread, armySpread) };
+
+    // Diagonal pan to the far corner and back
+    const float span = (tiles - viewW) * tilePx;
+    float acc = 0.0f;
+    double frameMsTotal = 0.0;
+    double frameMsMax = 0.0;
+    double queryMs = 0.0;
+    long long queryCount = 0;
+    size_t peakBytes = 0;
+
+    Clock::time_point runStart = Clock::now();
+    for (int f = 0; f < frames; f++) {
+        float t = (float)f / (float)(frames - 1);
+        float along = (t < 0.5f) ? t * 2.0f : (1.0f - t) * 2.0f;
+        float camX = along * span;
+        float camY = along * span * 0.8f;
+
+        Clock::time_point frameStart = Clock::now();
+        terrain.trimResident();
+
+        int tx0 = (int)(camX / tilePx);
+        int ty0 = (int)(camY / tilePx);
+        for (int y = ty0; y < ty0 + viewH; y++) {
+            for (int x = tx0; x < tx0 + viewW; x++) acc += terrain.getTile(x, y).getElevation();
+        }
+
+        float cx = camX + viewW * tilePx * 0.5f;
+        float cy = camY + viewH * tilePx * 0.5f;
+        Clock::time_point queryStart = Clock::now();
+        for (const Vector2& o : offsets) {
+            float px = cx + o.x;
+            float py = cy + o.y;
+            if (terrain.canWalk(px, py)) acc += terrain.getMoveSpeedAt(px, py);
+        }
+        queryMs += MsSince(queryStart);
+        queryCount += armySize * 2;
+
+        // A few units dig where they stand
+        for (int k = 0; k < 4; k++) {
+            const Vector2& o = offsets[(f * 4 + k) % armySize];
+            int x = (int)((cx + o.x) / tilePx);
+            int y = (int)((cy + o.y) / tilePx);
+            Tile tile = terrain.getTile(x, y);
+            tile.setElevation(tile.getElevation() * 0.9f);
+            terrain.setTile(x, y, tile);
+        }
+
+        double ms = MsSince(frameStart);
+        frameMsTotal += ms;
+        frameMsMax = std::max(frameMsMax, ms);
+        peakBytes = std::max(peakBytes, terrain.getChunkStats().residentBytes);
+    }
+    double runMs = MsSince(runStart);
+    sink = acc;
+
+    Terrain::ChunkStats stats = terrain.getChunkStats();
+    double flatMiB = (double)tiles * tiles * (sizeof(Tile) + 2) / (1024.0 * 1024.0);
+    printf("map %dx%d tiles (%d px)  chunk %dx%d  budget %zu chunks\n",
+           tiles, tiles, (int)(tiles * tilePx), Terrain::CHUNK_SIZE, Terrain::CHUNK_SIZE, budget);
+    printf("frames %d  wall %.1f ms  frame avg %.3f ms  max %.3f ms\n",
+           frames, runMs, frameMsTotal / frames, frameMsMax);
+    printf("army queries %.2f ns/query\n", queryMs * 1e6 / (double)queryCount);
+    printf("resident %zu chunks  peak %.1f MiB  (whole map in memory: %.1f MiB)\n",
+           stats.resident, peakBytes / (1024.0 * 1024.0), flatMiB);
+    printf("generated %zu  evicted %zu  written to disk %zu  loaded from disk %zu\n",
+           stats.generated, stats.evicted, stats.writtenToDisk, stats.loadedFromDisk);
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Founds settlements on the LARGE map and measures territory memory, the
+// per-tick merge check, tile membership tests and random tile sampling.
+//
+// Usage: worldbox_bench_territory [settlements]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <vector>
+
+#include "environment/world.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Bytes handed out by operator new, to size container copies
+static size_t allocatedBytes = 0;
+
+void* operator new(size_t size) {
+    allocatedBytes += size;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Keeps otherwise unused results alive
+static volatile long long sink = 0;
+
+int main(int argc, char** argv) {
+    int target = (argc > 1) ? atoi(argv[1]) : 200;
+
+    World world;
+    world.worldW = 3200;
+    world.worldH = 2000;
+    world.worldSeed = 1337;
+    world.Init();
+
+    // One settlement square is 17 tiles wide; step by that so squares only touch
+    const float step = 17.0f * CELL_SIZE;
+    for (float y = step * 0.5f; y < world.worldH && (int)world.settlements.size() < target; y += step) {
+        for (float x = step * 0.5f; x < world.worldW && (int)world.settlements.size() < target; x += step) {
+            if (!world.terrain.canBuild(x, y)) continue;
+            for (int c = 0; c < 3; c++) world.SpawnCivilian({x + c, y});
+        }
+    }
+
+    size_t tileCount = 0;
+    for (const Settlement& s : world.settlements) tileCount += s.tiles.size();
+
+    // Territory memory: a copy of every tile container plus the owner grid
+    std::vector<decltype(Settlement::tiles)> copies;
+    copies.reserve(world.settlements.size());
+    size_t afterReserve = allocatedBytes;
+    for (const Settlement& s : world.settlements) copies.push_back(s.tiles);
+    size_t containerBytes = allocatedBytes - afterReserve;
+    size_t gridBytes = world.tileOwner.size() * sizeof(int);
+
+    printf("settlements %zu  tiles %zu  map %dx%d tiles\n",
+           world.settlements.size(), tileCount, world.cols, world.rows);
+    printf("territory memory: tile lists %.1f KiB  owner grid %.1f KiB  total %.1f KiB\n",
+           containerBytes / 1024.0, gridBytes / 1024.0, (containerBytes + gridBytes) / 1024.0);
+
+    const int mergeCalls = 200;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < mergeCalls; i++) world.MergeSettlementsIfNeeded();
+    printf("MergeSettlementsIfNeeded     %10.4f ms/call\n", MsSince(start) / mergeCalls);
+
+    // Full pass, as after a new settlement claims contested tiles
+    start = Clock::now();
+    for (int i = 0; i < mergeCalls; i++) {
+        world.territoryContested = true;
+        world.MergeSettlementsIfNeeded();
+    }
+    printf("  contested full pass        %10.4f ms/call\n", MsSince(start) / mergeCalls);
+
+    Rng rng(7);
+    const int probes = 1000000;
+    long long hits = 0;
+    start = Clock::now();
+    for (int i = 0; i < probes; i++) {
+        int id = RandomInt(rng, 0, (int)world.settlements.size() - 1);
+        const Settlement& s = world.settlements[id];
+        Vector2 p = { s.boundsPx.x + RandomFloat(rng, 0.0f, s.boundsPx.width),
+                      s.boundsPx.y + RandomFloat(rng, 0.0f, s.boundsPx.height) };
+        hits += world.PointInSettlementPx(id, p) ? 1 : 0;
+    }
+    printf("PointInSettlementPx          %10.4f us/call\n", MsSince(start) * 1000.0 / probes);
+
+    const int samples = 200000;
+    start = Clock::now();
+    for (int i = 0; i < samples; i++) {
+        const Settlement& s = world.settlements[RandomInt(rng, 0, (int)world.settlements.size() - 1)];
+        auto it = s.tiles.begin();
+        std::advance(it, RandomInt(rng, 0, (int)s.tiles.size() - 1));
+        hits += *it;
+    }
+    printf("random tile sample           %10.4f us/call\n", MsSince(start) * 1000.0 / samples);
+
+    sink = hits;
+    return 0;
+}
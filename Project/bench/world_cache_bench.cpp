@@ -0,0 +1,65 @@
+// Times World::Init on the LARGE map cold (generating terrain, route graph,
+// regions and nature) against warm (loading them from the generated-world
+// cache), and checks both lead to the same state.
+//
+// Usage: worldbox_bench_world_cache [runs] [seed] [cacheDir]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+#include "environment/world.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int runs = (argc > 1) ? atoi(argv[1]) : 5;
+    unsigned int seed = (argc > 2) ? (unsigned int)strtoul(argv[2], nullptr, 10) : 1337u;
+    std::string dir = (argc > 3) ? argv[3] : (std::filesystem::temp_directory_path() / "worldbox_bench_cache").string();
+
+    auto initOnce = [&](const std::string& cacheDir, bool& fromCache, uint64_t& hash) {
+        World world;
+        world.worldW = 3200;
+        world.worldH = 2000;
+        world.worldSeed = seed;
+        world.generatedCacheDir = cacheDir;
+        Clock::time_point start = Clock::now();
+        world.Init();
+        double ms = MsSince(start);
+        fromCache = world.initFromCache;
+        hash = world.ComputeStateHash();
+        return ms;
+    };
+
+    std::filesystem::remove_all(dir);
+    bool fromCache = false;
+    uint64_t coldHash = 0, warmHash = 0;
+    double coldMs = 0.0;
+    for (int r = 0; r < runs; r++) coldMs += initOnce("", fromCache, coldHash);
+
+    // Writes the file
+    double writeMs = initOnce(dir, fromCache, coldHash);
+    double warmMs = 0.0;
+    int hits = 0;
+    for (int r = 0; r < runs; r++) {
+        warmMs += initOnce(dir, fromCache, warmHash);
+        hits += fromCache ? 1 : 0;
+    }
+
+    uintmax_t bytes = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) bytes += entry.file_size();
+
+    printf("LARGE 3200x2000  seed %u  %d runs\n", seed, runs);
+    printf("cold Init          %.2f ms\n", coldMs / runs);
+    printf("cold Init + write  %.2f ms  (%.1f MiB file)\n", writeMs, bytes / (1024.0 * 1024.0));
+    printf("warm Init          %.2f ms  (%d / %d from cache, state %s)\n", warmMs / runs, hits, runs,
+           warmHash == coldHash ? "identical" : "DIFFERENT");
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -3,9 +3,12 @@
 #define PLANT_H
 
 #include "raylib.h"
+#include "random.h"
 #include "WorldObject.h"   // <-- подключаем базовый класс (лежит в той же папке)
 
 class Terrain;
+class BlobReader;
+class BlobWriter;
 
 enum class PlantType { FLOWER, TREE };
 
@@ -22,13 +25,12 @@ public:
     Color color;
     PlantType type;
 
-    static Texture2D texFlower;
-    static Texture2D texTree;
-    static bool texturesLoaded;
-
-    Plant(Vector2 pos, float treeChance = 0.5f);
+    Plant(Vector2 pos, float treeChance, Rng& rng);
     void Update(float deltaTime, const Terrain* terrain) override;
-    void Draw() const override; 
+
+    // Field by field, for the generated-world cache
+    void save(BlobWriter& out) const;
+    bool load(BlobReader& in);
 };
 
 #endif
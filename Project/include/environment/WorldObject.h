@@ -10,7 +10,6 @@ public:
 
     // Чисто виртуальные методы – обязательны к реализации в наследниках
     virtual void Update(float deltaTime, const Terrain* terrain) = 0;
-    virtual void Draw() const = 0;
 
 protected:
     WorldObject() = default; // защищённый конструктор – нельзя создать экземпляр
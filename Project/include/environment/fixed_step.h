@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cmath>
+
+// Fixed-timestep accumulator. Turns variable frame times into whole simulation
+// ticks of 1 / tickRate seconds, so World::Update always sees the same dt.
+// A frame that falls more than maxCatchUpTicks behind drops the excess time
+// instead of spiralling into ever longer frames.
+class FixedStepper {
+public:
+    explicit FixedStepper(float ticksPerSecond = 60.0f, int maxCatchUp = 5)
+        : maxCatchUpTicks(maxCatchUp) {
+        SetTickRate(ticksPerSecond);
+    }
+
+    int maxCatchUpTicks = 5;
+
+    void SetTickRate(float ticksPerSecond) {
+        tickRate = (ticksPerSecond > 0.0f) ? ticksPerSecond : 60.0f;
+        tickDt = 1.0f / tickRate;
+    }
+
+    float GetTickRate() const { return tickRate; }
+    float GetTickDt() const { return tickDt; }
+
+    // Adds one frame of wall time and returns how many ticks to run now
+    int Advance(float frameDt) {
+        if (frameDt > 0.0f) accumulator += frameDt;
+
+        int ticks = (int)std::floor(accumulator / tickDt);
+        if (ticks > maxCatchUpTicks) {
+            droppedTicks += ticks - maxCatchUpTicks;
+            ticks = maxCatchUpTicks;
+            accumulator = std::fmod(accumulator, (double)tickDt);
+        } else {
+            accumulator -= ticks * (double)tickDt;
+        }
+        return ticks;
+    }
+
+    // Fraction of a tick left in the accumulator, for render interpolation
+    float GetAlpha() const { return (float)(accumulator / tickDt); }
+
+    // Ticks skipped by the catch-up cap since construction
+    long long GetDroppedTicks() const { return droppedTicks; }
+
+    void Reset() { accumulator = 0.0; }
+
+private:
+    float tickRate = 60.0f;
+    float tickDt = 1.0f / 60.0f;
+    double accumulator = 0.0;
+    long long droppedTicks = 0;
+};
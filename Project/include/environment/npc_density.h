@@ -0,0 +1,49 @@
+#pragma once
+
+#include <raylib.h>
+#include <cstdint>
+#include <vector>
+
+#include "environment/world_snapshot.h"
+
+class WorkerPool;
+
+// Snapshot NPCs counted per square cell of a world-aligned grid, with the sum
+// of their settlement colours, for drawing a crowd too small on screen to
+// show as sprites. Raylib-free, like the snapshot it reads.
+class NpcDensityGrid {
+public:
+    struct Cell {
+        uint32_t count;
+        uint32_t r, g, b;
+    };
+
+    // Cell size in world pixels; the grid starts at cell (originX, originY)
+    int cellPx = 0;
+    int originX = 0;
+    int originY = 0;
+    int width = 0;
+    int height = 0;
+    std::vector<Cell> cells;
+
+    // Counts snapshot.npcs[i] for each i in indices into the cells covering
+    // view; NPCs outside it are skipped. With a pool, chunks of NPCs count
+    // into partial grids in parallel; counts are sums, so the result is the
+    // same for any thread count.
+    void Build(const WorldSnapshot& snapshot, const std::vector<int>& indices, Rectangle view, int cellPx,
+               WorkerPool* pool = nullptr);
+
+    const Cell& At(int x, int y) const { return cells[(size_t)y * width + x]; }
+    // World-pixel rectangle of local cell (x, y)
+    Rectangle CellRect(int x, int y) const {
+        return { (float)((originX + x) * cellPx), (float)((originY + y) * cellPx), (float)cellPx, (float)cellPx };
+    }
+
+private:
+    // NPCs per partial grid, at least; fewer would cost more to merge than to count
+    static constexpr int MIN_CHUNK = 2048;
+
+    std::vector<std::vector<Cell>> partials;
+
+    void Count(const WorldSnapshot& snapshot, const int* indices, int count, Cell* out) const;
+};
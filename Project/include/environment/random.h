@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+// PCG32 generator. Integer-only, so a seed yields the same sequence on every
+// platform and compiler; each World owns one seeded from worldSeed.
+class Rng {
+public:
+    Rng() { Seed(0); }
+    explicit Rng(uint64_t seed) { Seed(seed); }
+
+    void Seed(uint64_t seed, uint64_t stream = 0xda3e39cb94b95bdbULL) {
+        state = 0;
+        inc = (stream << 1u) | 1u;
+        NextU32();
+        state += seed;
+        NextU32();
+    }
+
+    uint32_t NextU32() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + inc;
+        uint32_t xorShifted = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+        uint32_t rot = (uint32_t)(old >> 59u);
+        return (xorShifted >> rot) | (xorShifted << ((0u - rot) & 31u));
+    }
+
+    bool operator==(const Rng& other) const { return state == other.state && inc == other.inc; }
+
+private:
+    uint64_t state = 0;
+    uint64_t inc = 1;
+};
+
+// Random integer in [min, max]
+inline int RandomInt(Rng& rng, int min, int max) {
+    if (min > max) {
+        int tmp = max;
+        max = min;
+        min = tmp;
+    }
+    uint64_t span = (uint64_t)((int64_t)max - (int64_t)min) + 1u;
+    return (int)((int64_t)min + (int64_t)(((uint64_t)rng.NextU32() * span) >> 32u));
+}
+
+// Random float in [min, max] in steps of 1/10000 of the range
+inline float RandomFloat(Rng& rng, float min, float max) {
+    return min + (float)RandomInt(rng, 0, 10000) / 10000.0f * (max - min);
+}
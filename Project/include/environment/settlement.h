@@ -1,9 +1,9 @@
 #pragma once
 
 #include "raylib.h"
+#include "random.h"
 #include <vector>
 #include <cmath>
-#include <unordered_set>
 
 struct Barracks {
     bool alive = true;
@@ -20,8 +20,8 @@ struct Settlement {
     bool alive = true;
     Color color{255, 255, 255, 255};
 
-    // Settlement territory as tile ids
-    std::unordered_set<int> tiles;
+    // Settlement territory as unique tile ids; World::tileOwner maps tiles back
+    std::vector<int> tiles;
 
     // Cached geometry in world pixels
     Vector2 centerPx{0, 0};
@@ -57,7 +57,9 @@ inline Vector2 CellToPxCenter(int cx, int cy) {
 inline bool PointInSettlementPx(const Settlement& s, Vector2 pPx) {
     if (!s.alive) return false;
 
-    return CheckCollisionPointRec(pPx, s.boundsPx);
+    const Rectangle& r = s.boundsPx;
+    return pPx.x >= r.x && pPx.x < r.x + r.width &&
+           pPx.y >= r.y && pPx.y < r.y + r.height;
 }
 
 // Safely normalizes a 2D vector
@@ -68,7 +70,7 @@ inline Vector2 SafeNormalize(Vector2 v) {
 }
 
 // Returns a random unit vector in 2D
-inline Vector2 RandomUnit2D() {
-    float a = GetRandomValue(0, 360) * DEG2RAD;
+inline Vector2 RandomUnit2D(Rng& rng) {
+    float a = RandomInt(rng, 0, 360) * DEG2RAD;
     return { cosf(a), sinf(a) };
 }
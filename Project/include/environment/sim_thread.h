@@ -0,0 +1,72 @@
+#pragma once
+
+#include <raylib.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "environment/fixed_step.h"
+#include "environment/snapshot_buffer.h"
+#include "environment/world_snapshot.h"
+
+class World;
+
+// Runs World::Update on its own thread at a fixed tick rate and publishes a
+// WorldSnapshot after each step, so the render thread draws the latest
+// snapshot while the next tick runs. Snapshots pass through a TripleBuffer;
+// only posted commands take a lock, and only between ticks.
+// While running, nothing but posted commands may touch the World.
+class SimulationThread {
+public:
+    explicit SimulationThread(World& world, float ticksPerSecond = 60.0f);
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // Publishes a first snapshot, then starts ticking
+    void Start();
+    // Waits for the current step to finish and joins the thread
+    void Stop();
+    bool IsRunning() const { return thread.joinable(); }
+
+    // Paused, the thread still runs commands and publishes snapshots
+    void SetPaused(bool paused);
+    // Runs fn on the simulation thread before its next tick
+    void Post(std::function<void(World&)> fn);
+    // World position snapshots report barracks placement for, or none
+    void SetBarracksPreview(std::optional<Vector2> pos);
+
+    // Render thread: the newest published snapshot, valid until the next call
+    const WorldSnapshot& Acquire();
+
+private:
+    World& world;
+    FixedStepper stepper;
+    WorldSnapshotWriter writer;
+    TripleBuffer<WorldSnapshot> snapshots;
+    std::thread thread;
+
+    // Guards everything below
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::function<void(World&)>> commands;
+    std::optional<Vector2> barracksPreview;
+    bool paused = false;
+    bool stopping = false;
+
+    // Busy time over the current one-second window
+    double statsWindowSec = 0.0;
+    double statsBusyMs = 0.0;
+    double statsTickMs = 0.0;
+    int statsTicks = 0;
+    float simMsPerTick = 0.0f;
+    int simTicksPerSecond = 0;
+    float simBusyMsPerSecond = 0.0f;
+
+    void Run();
+    void Publish(const std::optional<Vector2>& preview);
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free exchange of whole values between one writer and one reader
+// thread. Three slots: the writer fills its back slot and publishes it by
+// swapping it with the middle one; the reader swaps the middle slot in when
+// it holds something newer. Neither side ever waits, and the reader always
+// sees a complete value, though it may skip some the writer published.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer: the slot to fill next. It holds an older value, never one the
+    // reader is looking at.
+    T& Back() { return slots[back]; }
+
+    // Writer: makes the back slot the newest value
+    void Publish() {
+        back = middle.exchange((uint8_t)(back | FRESH), std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Reader: takes the newest published value if there is one; returns
+    // whether Front() changed
+    bool Acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    // Reader: the value taken by the last Acquire, valid until the next one
+    const T& Front() const { return slots[front]; }
+
+private:
+    static constexpr uint8_t INDEX = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    T slots[3];
+    // Slot index in the low bits, FRESH when the reader has not taken it yet
+    std::atomic<uint8_t> middle{1};
+    // Owned by the writer and reader respectively
+    uint8_t back = 0;
+    uint8_t front = 2;
+};
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include <raylib.h>
+#include "npc/npc_store.h"
+
+// Filters NPCs by role, settlement, bandit group and identity
+struct NpcQueryFilter {
+    static constexpr int ANY = INT_MIN;
+    static constexpr uint32_t ALL_ROLES = 0xFFFFFFFFu;
+
+    uint32_t roleMask = ALL_ROLES;
+    int settlementId = ANY;
+    int excludedSettlementId = ANY;
+    int banditGroupId = ANY;
+    uint32_t excludedId = 0;
+    // Bandit scans never skipped NPCs playing their death animation
+    bool includeDying = false;
+
+    static uint32_t RoleBit(NPC::HumanRole role) { return 1u << (uint32_t)role; }
+
+    NpcQueryFilter& Roles(std::initializer_list<NPC::HumanRole> roles) {
+        roleMask = 0;
+        for (NPC::HumanRole r : roles) roleMask |= RoleBit(r);
+        return *this;
+    }
+
+    NpcQueryFilter& ExceptRole(NPC::HumanRole role) {
+        roleMask &= ~RoleBit(role);
+        return *this;
+    }
+
+    NpcQueryFilter& InSettlement(int id) { settlementId = id; return *this; }
+    NpcQueryFilter& NotInSettlement(int id) { excludedSettlementId = id; return *this; }
+    NpcQueryFilter& InBanditGroup(int id) { banditGroupId = id; return *this; }
+    NpcQueryFilter& ExcludeId(uint32_t id) { excludedId = id; return *this; }
+    NpcQueryFilter& IncludeDying() { includeDying = true; return *this; }
+
+    // Dead NPCs never match; dying ones only with IncludeDying
+    bool Accepts(const NpcStore& npcs, int i) const {
+        if (!npcs.IsAlive(i) || (!includeDying && npcs.IsDying(i))) return false;
+        if ((roleMask & RoleBit(npcs.Role(i))) == 0) return false;
+        if (settlementId != ANY && npcs.SettlementId(i) != settlementId) return false;
+        if (excludedSettlementId != ANY && npcs.SettlementId(i) == excludedSettlementId) return false;
+        if (banditGroupId != ANY && npcs.BanditGroupId(i) != banditGroupId) return false;
+        if (excludedId != 0 && npcs.Id(i) == excludedId) return false;
+        return true;
+    }
+
+    // Same test against an NPC record or handle
+    template <typename N>
+    bool Accepts(const N& n) const {
+        if (!n.alive || (!includeDying && n.isDying)) return false;
+        if ((roleMask & RoleBit(n.humanRole)) == 0) return false;
+        if (settlementId != ANY && n.settlementId != settlementId) return false;
+        if (excludedSettlementId != ANY && n.settlementId == excludedSettlementId) return false;
+        if (banditGroupId != ANY && n.banditGroupId != banditGroupId) return false;
+        if (excludedId != 0 && n.id == excludedId) return false;
+        return true;
+    }
+};
+
+// Uniform bucket grid over NPC positions, rebuilt once per World::Update.
+// Buckets store indices into World::npcs split by role, so role-filtered
+// queries never touch other roles. NPCs appended after the last rebuild
+// are scanned linearly until the next rebuild. Query results are returned in
+// ascending index order so callers keep the same tie-breaking as a full scan.
+// Anything other than push_back on the indexed vector requires Clear() or Rebuild().
+class NpcSpatialGrid {
+public:
+    // Bucket edge in CELL_SIZE tiles
+    static constexpr int BUCKET_TILES = 4;
+    static constexpr int ROLE_COUNT = (int)NPC::HumanRole::CAPTAIN + 1;
+
+    void Rebuild(const NpcStore& npcs, int worldW, int worldH, float cellSizePx);
+    void Clear();
+
+    int GetBucketCount() const { return bucketsX * bucketsY; }
+    float GetBucketSizePx() const { return bucketPx; }
+
+    // Collects matching NPC indices within radius (ascending)
+    void QueryRadius(const NpcStore& npcs, Vector2 center, float radius,
+                     const NpcQueryFilter& filter, std::vector<int>& out) const {
+        QueryRadiusIf(npcs, center, radius, filter, [](ConstNpcRef) { return true; }, out);
+    }
+
+    // Collects matching NPC indices inside a rectangle (ascending)
+    void QueryRect(const NpcStore& npcs, Rectangle rect, const NpcQueryFilter& filter,
+                   std::vector<int>& out) const;
+
+    // Collects every NPC index inside a rectangle, dying and dead ones included
+    // (ascending); for drawing, which still shows dying NPCs
+    void QueryRectAll(const NpcStore& npcs, Rectangle rect, std::vector<int>& out) const;
+
+    // Collects matching members of a settlement (ascending). Membership comes from the
+    // last Rebuild; an NPC whose settlementId changed since is only found if it moved
+    // out of the queried settlement. Negative ids fall back to a full scan.
+    void QuerySettlement(const NpcStore& npcs, int settlementId, const NpcQueryFilter& filter,
+                         std::vector<int>& out) const;
+
+    int CountInRadius(const NpcStore& npcs, Vector2 center, float radius,
+                      const NpcQueryFilter& filter) const;
+    bool AnyInRadius(const NpcStore& npcs, Vector2 center, float radius,
+                     const NpcQueryFilter& filter) const;
+
+    // Nearest match within radius; FLT_MAX searches the whole world. Ties keep the lowest index.
+    int FindNearest(const NpcStore& npcs, Vector2 center, float radius,
+                    const NpcQueryFilter& filter) const {
+        std::vector<int>& scratch = Scratch();
+        FindKNearestIf(npcs, center, 1, radius, filter, [](ConstNpcRef) { return true; }, scratch);
+        return scratch.empty() ? -1 : scratch[0];
+    }
+
+    // Up to k nearest matches ordered by distance, then index
+    void FindKNearest(const NpcStore& npcs, Vector2 center, int k, float radius,
+                      const NpcQueryFilter& filter, std::vector<int>& out) const {
+        FindKNearestIf(npcs, center, k, radius, filter, [](ConstNpcRef) { return true; }, out);
+    }
+
+    // Picks the first role in priority order, then the nearest within that role.
+    // Replays the legacy scan over ascending candidates so results match it exactly.
+    int FindByRolePriority(const NpcStore& npcs, Vector2 center, float radius,
+                           NpcQueryFilter filter,
+                           std::initializer_list<NPC::HumanRole> priority) const;
+
+    template <typename Pred>
+    void QueryRadiusIf(const NpcStore& npcs, Vector2 center, float radius,
+                       const NpcQueryFilter& filter, Pred&& pred, std::vector<int>& out) const {
+        out.clear();
+        const float r2 = radius * radius;
+
+        ForEachCandidate((int)npcs.size(), filter.roleMask, center.x - radius, center.y - radius,
+                         center.x + radius, center.y + radius,
+                         [&](int i) {
+            if (!filter.Accepts(npcs, i)) return;
+            Vector2 p = npcs.Pos(i);
+            float dx = p.x - center.x;
+            float dy = p.y - center.y;
+            if (dx * dx + dy * dy > r2) return;
+            if (!pred(npcs[i])) return;
+            out.push_back(i);
+        });
+
+        std::sort(out.begin(), out.end());
+    }
+
+    template <typename Pred>
+    bool AnyInRadiusIf(const NpcStore& npcs, Vector2 center, float radius,
+                       const NpcQueryFilter& filter, Pred&& pred) const {
+        const float r2 = radius * radius;
+        bool found = false;
+
+        ForEachCandidate((int)npcs.size(), filter.roleMask, center.x - radius, center.y - radius,
+                         center.x + radius, center.y + radius,
+                         [&](int i) {
+            if (found) return;
+            if (!filter.Accepts(npcs, i)) return;
+            Vector2 p = npcs.Pos(i);
+            float dx = p.x - center.x;
+            float dy = p.y - center.y;
+            if (dx * dx + dy * dy > r2) return;
+            if (pred(npcs[i])) found = true;
+        });
+
+        return found;
+    }
+
+    template <typename Pred>
+    void FindKNearestIf(const NpcStore& npcs, Vector2 center, int k, float radius,
+                        const NpcQueryFilter& filter, Pred&& pred, std::vector<int>& out) const {
+        out.clear();
+        if (k <= 0) return;
+
+        // Grow the search ring until it holds k matches or covers the whole request.
+        // Once the ring spans the grid the full radius is used, so NPCs outside the
+        // world bounds are still found.
+        const float gridSpan = (float)(bucketsX + bucketsY) * bucketPx;
+        float r = (bucketPx > 0.0f && bucketPx < radius) ? bucketPx : radius;
+
+        for (;;) {
+            QueryRadiusIf(npcs, center, r, filter, pred, out);
+            if ((int)out.size() >= k || r >= radius) break;
+            r *= 2.0f;
+            if (r > radius || r >= gridSpan) r = radius;
+        }
+
+        auto closer = [&](int a, int b) {
+            float da = Dist2(npcs.Pos(a), center);
+            float db = Dist2(npcs.Pos(b), center);
+            if (da != db) return da < db;
+            return a < b;
+        };
+
+        if ((int)out.size() > k) {
+            std::partial_sort(out.begin(), out.begin() + k, out.end(), closer);
+            out.resize(k);
+        } else {
+            std::sort(out.begin(), out.end(), closer);
+        }
+    }
+
+private:
+    int bucketsX = 0;
+    int bucketsY = 0;
+    float bucketPx = 0.0f;
+
+    // NPCs move between rebuilds, so every query is padded by this distance
+    float slackPx = 0.0f;
+
+    int indexedCount = 0;
+
+    // Entries of bucket b and role r live in [bucketStart[k], bucketStart[k + 1]), k = b * ROLE_COUNT + r
+    std::vector<int> bucketStart;
+    std::vector<int> entries;
+
+    // Indexed NPCs grouped by role only, for boxes that cover more buckets than matches
+    int roleStart[ROLE_COUNT + 1] = {};
+    std::vector<int> roleEntries;
+
+    // Indexed NPCs grouped by settlementId >= 0 and role, same layout as the buckets
+    std::vector<int> settlementStart;
+    std::vector<int> settlementEntries;
+
+    // Bucket keys and fill positions reused between rebuilds
+    std::vector<int> keyOf;
+    std::vector<int> cursor;
+
+    static float Dist2(Vector2 a, Vector2 b) {
+        float dx = a.x - b.x;
+        float dy = a.y - b.y;
+        return dx * dx + dy * dy;
+    }
+
+    // Per-thread result buffer for FindNearest and FindByRolePriority
+    static std::vector<int>& Scratch();
+
+    int BucketCoord(float v, int count) const {
+        float c = v / bucketPx;
+        if (c <= 0.0f) return 0;
+        if (c >= (float)(count - 1)) return count - 1;
+        return (int)c;
+    }
+
+    static int RoleSlot(NPC::HumanRole role) {
+        int r = (int)role;
+        return (r >= 0 && r < ROLE_COUNT) ? r : 0;
+    }
+
+    // Visits every indexed NPC of the masked roles whose bucket overlaps the box,
+    // then the unindexed tail
+    template <typename Fn>
+    void ForEachCandidate(int total, uint32_t roleMask, float minX, float minY, float maxX, float maxY,
+                          Fn&& fn) const {
+        if (indexedCount > 0 && bucketsX > 0 && bucketsY > 0) {
+            int bx0 = BucketCoord(minX - slackPx, bucketsX);
+            int by0 = BucketCoord(minY - slackPx, bucketsY);
+            int bx1 = BucketCoord(maxX + slackPx, bucketsX);
+            int by1 = BucketCoord(maxY + slackPx, bucketsY);
+
+            int roleMatches = 0;
+            for (int r = 0; r < ROLE_COUNT; r++) {
+                if (roleMask & (1u << r)) roleMatches += roleStart[r + 1] - roleStart[r];
+            }
+
+            // Sparse roles over a wide box: walking the role list is cheaper than the buckets
+            if (roleMatches < (bx1 - bx0 + 1) * (by1 - by0 + 1)) {
+                for (int r = 0; r < ROLE_COUNT; r++) {
+                    if ((roleMask & (1u << r)) == 0) continue;
+                    for (int e = roleStart[r]; e < roleStart[r + 1]; e++) {
+                        int i = roleEntries[e];
+                        if (i < total) fn(i);
+                    }
+                }
+            } else {
+                for (int by = by0; by <= by1; by++) {
+                    const int row = by * bucketsX;
+                    for (int bx = bx0; bx <= bx1; bx++) {
+                        const int b = (row + bx) * ROLE_COUNT;
+                        for (int r = 0; r < ROLE_COUNT; r++) {
+                            if ((roleMask & (1u << r)) == 0) continue;
+                            for (int e = bucketStart[b + r]; e < bucketStart[b + r + 1]; e++) {
+                                int i = entries[e];
+                                if (i < total) fn(i);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        for (int i = std::min(indexedCount, total); i < total; i++) {
+            fn(i);
+        }
+    }
+};
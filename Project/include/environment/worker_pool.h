@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops. The calling thread
+// joins in, so a pool of 1 runs everything inline with no threads at all.
+class WorkerPool {
+public:
+    // 0 picks std::thread::hardware_concurrency()
+    explicit WorkerPool(int threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int GetThreadCount() const { return (int)workers.size() + 1; }
+
+    // Calls fn(chunkIndex, begin, end) for every chunk of [0, count) and waits.
+    // Chunk boundaries depend only on count and chunkSize, never on thread count.
+    void ParallelFor(int count, int chunkSize, const std::function<void(int, int, int)>& fn);
+
+private:
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    // Current job, guarded by mutex except for the atomic chunk cursor
+    const std::function<void(int, int, int)>* job = nullptr;
+    int jobCount = 0;
+    int jobChunkSize = 1;
+    int jobChunks = 0;
+    std::atomic<int> nextChunk{0};
+    int busyWorkers = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    void WorkerLoop();
+    void RunChunks();
+};
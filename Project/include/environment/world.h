@@ -1,11 +1,21 @@
 #pragma once
 #include <algorithm>
+#include <atomic>
 #include <vector>
 #include <memory>
+#include <optional>
+#include <string>
 #include <raylib.h>
 #include "raymath.h"
-#include "npc/npc.h"
+#include "npc/behavior_context.h"
+#include "npc/npc_store.h"
+#include "random.h"
 #include "settlement.h"
+#include "spatial_grid.h"
+#include "worker_pool.h"
+#include "terrain/flow_field.h"
+#include "terrain/hpa_pathfinder.h"
+#include "terrain/land_regions.h"
 #include "terrain/terrain.h"
 
 #include "npc/Animal.h"
@@ -24,78 +34,131 @@ public:
     Terrain terrain;
     unsigned int worldSeed = 0;
 
+    // Maps up to this many tiles are generated whole by Init; larger ones
+    // stream in chunk by chunk and keep at most TERRAIN_CHUNK_BUDGET resident
+    static constexpr size_t EAGER_TERRAIN_TILES = 4096 * 4096;
+    static constexpr size_t TERRAIN_CHUNK_BUDGET = 2048;
+
+    // Route graph over terrain; Init builds it for eagerly generated maps and
+    // meteor impacts rebuild the clusters they hit
+    HpaPathfinder pathfinder;
+    // Flow fields toward settlements under attack, keyed by settlement id and
+    // holding one reference per war aimed at it; only on maps with a route graph
+    FlowFieldCache warFlowFields;
+    std::vector<int> warFlowRefs; // references held, per settlement
+    // Point to steer npc toward on its way to goal: the next step of the
+    // target settlement's flow field when goal is its centre, else the next
+    // waypoint of a cached route, re-planned when reached or when goal moves.
+    // Falls back to goal itself when no route is known.
+    Vector2 MarchWaypoint(NpcRef npc, Vector2 goal) const;
+    // Walkable regions, kept alongside the route graph so targets across
+    // water or mountains are turned down before anyone marches
+    LandRegions landRegions;
+    // Whether a walk from one point to the other exists; endpoints on
+    // blocked tiles snap to nearby land. Always true without region labels.
+    bool Reachable(Vector2 from, Vector2 to) const;
+
+    // Every simulation random draw comes from here; Init seeds it from worldSeed
+    Rng rng;
+
+    // Update calls since Init
+    uint64_t tickCount = 0;
+
     std::vector<Settlement> settlements;
-    std::vector<NPC> npcs;
+    NpcStore npcs;
+
+    // Territory owner per tile (cols * rows), -1 when unclaimed. A tile listed by
+    // several alive settlements belongs to the lowest id until they merge, and
+    // territoryContested stays set while any such tile exists.
+    std::vector<int> tileOwner;
+    bool territoryContested = false;
+
+    int GetTileOwner(int tileId) const;
+    bool SettlementHasTile(int settlementId, int tileId) const;
+    // Claims the settlement's free tiles; call after adding tiles to it
+    void ClaimSettlementTerritory(int settlementId);
+    // Recomputes tileOwner and territoryContested from the alive settlements
+    void RebuildTerritoryOwners();
+
+    // Tile regions whose drawn territory (a tile's owner, or whether that
+    // owner is alive) changed since a snapshot last consumed them. Init marks
+    // the whole map; claims, merges and settlement deaths mark what they touch.
+    std::vector<TileRect> territoryDirty;
+    // Queues rect like MarkTerrainDirty
+    void MarkTerritoryDirty(TileRect rect);
+
+    // How Update runs NPC behaviors. SERIAL updates NPCs in place in index order.
+    // PARALLEL runs them on worker threads against the NPC state at the start of
+    // the behavior pass, then applies their intents (damage, deaths, squad
+    // changes) in index order; its results are the same for any worker count.
+    enum class UpdateMode { SERIAL, PARALLEL };
+    UpdateMode updateMode = UpdateMode::SERIAL;
+
+    // Worker threads for PARALLEL mode, 0 uses every hardware thread
+    void SetWorkerCount(int count);
+    int GetWorkerCount() const { return workerCount; }
 
     // --- ДОБАВЛЕНО: Списки для хранения растений и животных ---
     std::vector<std::unique_ptr<Animal>> animals;
     std::vector<Plant> plants;
+    // Bumped whenever plants are added, removed or replaced, so views of
+    // them (the renderer's buckets) know to rebuild
+    uint64_t plantsRevision = 0;
     std::vector<Meteor> meteors;
 
-    static constexpr int NPC_VARIANTS = 3;
-
-    Texture2D npcTexCivilian[NPC_VARIANTS]{};
-    bool npcTexCivilianLoaded[NPC_VARIANTS]{};
-
-    Texture2D npcTexWarrior[NPC_VARIANTS]{};
-    bool npcTexWarriorLoaded[NPC_VARIANTS]{};
-
-    Texture2D npcTexBandit[NPC_VARIANTS]{};
-    bool npcTexBanditLoaded[NPC_VARIANTS]{};
+    // Tile regions whose terrain changed since a snapshot last consumed them.
+    // Init marks the whole map; WorldSnapshotWriter clears the list after re-baking.
+    std::vector<TileRect> terrainDirty;
+    // Queues rect (clipped to the map); a long backlog folds into one bounding rect
+    void MarkTerrainDirty(TileRect rect);
 
-    Texture2D npcTexCaptain[NPC_VARIANTS]{};
-    bool npcTexCaptainLoaded[NPC_VARIANTS]{};
-
-    bool npcSpritesLoaded = false;
-
-    // NPC sprite resources
-    void LoadNpcSprites();
-    void UnloadNpcSprites();
+    // Sprite variants per role, picked by NPC::skinId
+    static constexpr int NPC_VARIANTS = 3;
 
     // Bandit spawning state
     float banditSpawnTimer = 0.0f;
     int nextBanditGroupId = 1;
 
-    // Captain resources and spawning
+    // Captain spawning
     void SpawnCaptain(Vector2 pos);
-    Texture2D captainTex{};
-    bool captainTexLoaded = false;
-
-    // Campfire resources
-    static constexpr int FIRE_FRAMES = 4;
-    Texture2D fireTex[FIRE_FRAMES]{};
-    bool fireLoaded[FIRE_FRAMES]{false};
-    int fireFrame = 0;
-    float fireAnimT = 0.0f;
-    float fireAnimSpeed = 0.10f;
-
-    // Barracks resources
-    Texture2D barracksTex{};
-    bool barracksTexLoaded = false;
-
-    // NPC ids and captain selection
-    uint32_t nextNpcId = 1;
+
+    // Captain selection; NPC ids come from npcs.AllocateId()
     uint32_t selectedCaptainId = 0;
     int selectedCaptainIndex = -1;
 
-    NPC* FindNpcById(uint32_t id);
-    const NPC* FindNpcById(uint32_t id) const;
+    // O(1) through the store's id slots; stale ids of removed NPCs give nullopt
+    std::optional<NpcRef> FindNpcById(uint32_t id);
+    std::optional<ConstNpcRef> FindNpcById(uint32_t id) const;
+
+    // Spatial index over npcs, rebuilt once per Update after removals and merges
+    NpcSpatialGrid npcGrid;
+
+    // Neighbor queries backed by npcGrid; all return an index into npcs or -1
+    // Dying bandits count, as they did for the linear scans this replaced
+    int FindNearestBandit(Vector2 from, float rangePx, int groupId = NpcQueryFilter::ANY) const;
+    int FindNearestEnemyCombatNear(ConstNpcRef npc, float radiusPx) const;
+    int FindNearestEnemyForSettlementWar(ConstNpcRef attacker, int enemySettlementId, float maxDistPx) const;
+    int FindNearestHostileTroopNear(int homeSettlementId, Vector2 homePos, float maxDistPx) const;
+    int CountEnemyCombatUnitsNear(ConstNpcRef npc, float radiusPx) const;
+    bool IsEnemyWarTroopNear(int settlementId, Vector2 center, float radiusPx) const;
+
+    // Whether a barracks fits at worldPos, and in which settlement
+    bool CanBuildBarracksAt(Vector2 worldPos, int* settlementId = nullptr) const;
     bool TryBuildBarracksAt(Vector2 worldPos);
     void StartSettlementWar(int attackerSettlementId, int targetSettlementId);
     void StopSettlementWar(int settlementId);
     bool IsSettlementAliveAndValid(int settlementId) const;
-    void BeginNpcDeath(NPC& npc);
-    void BeginNpcAttack(NPC& npc, Vector2 targetPos);
+    void BeginNpcDeath(NpcRef npc);
+    void BeginNpcAttack(NpcRef npc, Vector2 targetPos);
     bool SettlementHasLivingCombatUnits(int settlementId) const;
     void DamageSettlementBarracks(int settlementId, int barracksIndex, float damage);
+    void ApplyNpcIntent(const NpcIntent& intent);
 
-    void IssueCaptainMoveOrder(uint32_t captainId, Vector2 targetPx);
+    // False, leaving the captain's orders as they were, when the target
+    // cannot be walked to
+    bool IssueCaptainMoveOrder(uint32_t captainId, Vector2 targetPx);
 
-    void LoadFireSprites();
-    void UnloadFireSprites();
     void UpdateCampfires();
-    void LoadBarracksSprite();
-    void UnloadBarracksSprite();
     void UpdateBarracks();
     void UpdateBarracksProduction(float dt);
     void UpdateSettlementWars(float dt);
@@ -103,13 +166,41 @@ public:
     void UpdateSettlementWarPreparation(float dt);
     void UpdateSettlementDefense(float dt);
     void RefreshSettlementWarSquads();
+    // Matches warFlowFields references to the active wars and rebuilds stale fields
+    void SyncWarFlowFields();
 
 
     void Init();
     void Update(float dt, const Terrain* terrain);
-    void Draw() const;
 
-    bool PointInSettlementPx(const Settlement& s, Vector2 pos) const;
+    // Init's stages: terrain, route graph, land regions, nature
+    static constexpr int INIT_STAGES = 4;
+    // Stages the running Init has finished, so another thread can show
+    // progress while Init runs on its own
+    std::atomic<int> initStagesDone{0};
+
+    // Directory of the generated-world cache, empty to disable it. Init
+    // loads eagerly generated maps (terrain, route graph, regions, nature
+    // and the RNG state after them) from the file for (seed, size,
+    // GENERATOR_VERSION), and writes that file after generating a new one.
+    std::string generatedCacheDir;
+    // Most world files the cache keeps; a save beyond it deletes the least
+    // recently saved or loaded ones
+    size_t generatedCacheLimit = 4;
+    // Bump whenever generation output or a cached layout changes
+    static constexpr uint32_t GENERATOR_VERSION = 1;
+    // Whether the last Init came from the cache
+    bool initFromCache = false;
+    std::string GeneratedCachePath() const;
+    bool SaveGeneratedWorld(const std::string& path) const;
+    // All or nothing: on false the world is left for Init to regenerate
+    bool LoadGeneratedWorld(const std::string& path);
+
+    // FNV-1a over NPC, settlement, nature and RNG state; equal hashes mean equal runs
+    uint64_t ComputeStateHash() const;
+
+    // Whether pos lies on a tile of settlements[settlementId]
+    bool PointInSettlementPx(int settlementId, Vector2 pos) const;
     Vector2 ComputeSettlementCenterPx(const Settlement& s);
     Rectangle ComputeSettlementBoundsPx(const Settlement& s);
 
@@ -125,7 +216,6 @@ public:
     // --- Meteor system ---
     void SpawnMeteor(Vector2 targetPos);
     void UpdateMeteors(float dt);
-    void DrawMeteors() const;
 
     // --- Armageddon mode ---
     bool armageddonMode = false;
@@ -135,9 +225,23 @@ public:
     void StopArmageddon();
     void UpdateArmageddon(float dt);
 
-    void Shutdown();
-};
+private:
+    // NPCs per parallel work item; fixed so intent order never depends on threads
+    static constexpr int NPC_CHUNK = 256;
 
-inline float RandomFloat(float min, float max) {
-    return min + (float)GetRandomValue(0, 10000) / 10000.0f * (max - min);
-}
+    int workerCount = 0;
+    std::unique_ptr<WorkerPool> workers;
+
+    // During the parallel behavior pass, the live store (npcs holds the read
+    // view meanwhile); afterwards, the read view kept for its capacity
+    NpcStore npcsNext;
+    std::vector<std::vector<NpcIntent>> chunkIntents;
+
+    // Per-tile stamps for set tests during merges, epoch bumped per use
+    std::vector<uint32_t> tileMark;
+    uint32_t tileMarkEpoch = 0;
+    uint32_t NextTileMark();
+
+    void UpdateNpcsSerial(float dt);
+    void UpdateNpcsParallel(float dt);
+};
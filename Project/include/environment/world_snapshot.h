@@ -0,0 +1,191 @@
+#pragma once
+
+#include <raylib.h>
+#include <cstdint>
+#include <vector>
+
+#include "terrain/terrain.h"
+
+class World;
+
+// Plain-data copy of everything a frame draws, captured by the simulation
+// after a tick so a renderer on another thread never touches World. Every
+// element type is trivially copyable; vectors keep their capacity between
+// captures, so steady-state captures do not allocate.
+
+struct NpcSnapshot {
+    Vector2 pos;
+    // Lunge direction while attacking
+    Vector2 attackDir;
+    uint32_t id;
+    int32_t settlementId;
+    // Death animation progress in [0, 1], used while dying
+    float deathT;
+    // Attack animation progress in [0, 1], negative when not attacking
+    float attackT;
+    uint8_t role;
+    uint8_t variant;
+    uint8_t dying;
+};
+
+struct PlantSnapshot {
+    Vector2 position;
+    float growthStage;
+    Color color;
+    uint8_t type;
+};
+
+struct AnimalSnapshot {
+    Vector2 position;
+    uint8_t facingLeft;
+};
+
+struct BarracksSnapshot {
+    Vector2 posPx;
+    // hp / maxHp, negative when the barracks has no hit points to show
+    float hpRatio;
+};
+
+struct SettlementSnapshot {
+    Rectangle boundsPx;
+    Vector2 centerPx;
+    Vector2 campfirePosPx;
+    Color color;
+    int32_t warTargetSettlementId;
+    // Alive barracks, as a range of WorldSnapshot::barracks
+    int32_t firstBarracks;
+    int32_t barracksCount;
+    uint8_t alive;
+    uint8_t warActive;
+    uint8_t offensiveWaveReady;
+    uint8_t defensiveMobilization;
+};
+
+struct MeteorSnapshot {
+    Vector2 pos;
+    Vector2 targetPos;
+    float radius;
+    // Explosion progress in [0, 1] while exploding
+    float pulse;
+    uint8_t state;
+};
+
+// Point indices bucketed by position, in index order within each bucket,
+// so a view query touches only the buckets it overlaps
+struct PointBuckets {
+    float bucketPx = 64.0f;
+    int bucketsX = 0;
+    int bucketsY = 0;
+    std::vector<int> start;
+    std::vector<int> items;
+
+    // positionOf(i) gives point i's position; points off the area clamp to its edge
+    template <typename PositionOf>
+    void Build(int count, float areaW, float areaH, PositionOf positionOf);
+    // Indices of points in buckets overlapping rect, sorted
+    void Query(Rectangle rect, std::vector<int>& out) const;
+
+private:
+    std::vector<int> fill;
+    int BucketOf(Vector2 p) const;
+};
+
+// One colour per tile, for a layer the renderer keeps as a texture.
+// revision counts changes; changes lists the newest ones, so a consumer a
+// few revisions behind re-uploads only their rects.
+struct TileLayerSnapshot {
+    static constexpr size_t MAX_CHANGES = 64;
+
+    struct Change {
+        uint64_t revision;
+        TileRect rect;
+    };
+
+    int width = 0;
+    int height = 0;
+    uint64_t revision = 0;
+    std::vector<Color> pixels;
+    std::vector<Change> changes;
+
+    // Rects changed after revision have; false when the log no longer
+    // reaches back that far and everything must be re-uploaded
+    bool ChangesSince(uint64_t have, std::vector<TileRect>& out) const;
+    // Brings this copy up to source's revision, copying only changed rects
+    // when its own revision is still in source's log
+    void CopyFrom(const TileLayerSnapshot& source);
+};
+
+struct WorldSnapshot {
+    enum class CaptainMode : uint8_t { AUTO, MANUAL_IDLE, MANUAL_MOVE, MANUAL_ATTACK };
+
+    // World::tickCount at capture
+    uint64_t tick = 0;
+    int worldW = 0;
+    int worldH = 0;
+
+    std::vector<NpcSnapshot> npcs;
+    PointBuckets npcBuckets;
+    std::vector<PlantSnapshot> plants;
+    uint64_t plantsRevision = 0;
+    std::vector<AnimalSnapshot> animals;
+    std::vector<SettlementSnapshot> settlements;
+    std::vector<BarracksSnapshot> barracks;
+    std::vector<MeteorSnapshot> meteors;
+
+    TileLayerSnapshot terrain;
+    TileLayerSnapshot territory;
+
+    // HUD state; selectedCaptainId is 0 when the selected captain is gone
+    uint32_t selectedCaptainId = 0;
+    CaptainMode selectedCaptainMode = CaptainMode::AUTO;
+    int selectedCaptainSquad = 0;
+    bool armageddonMode = false;
+    // Whether barracks could be built at the position the capture was asked about
+    bool barracksPreviewOk = false;
+
+    // Time the simulation thread spent per tick, and its ticks and busy
+    // milliseconds over the last whole second
+    float simMsPerTick = 0.0f;
+    int simTicksPerSecond = 0;
+    float simBusyMsPerSecond = 0.0f;
+};
+
+// Fills WorldSnapshots from a World. Owns the master copies of the tile
+// layers: captures drain World::terrainDirty and territoryDirty into them,
+// baking only the dirty rects, and copy only what changed into each snapshot.
+// Terrain is baked one resident chunk at a time, so a capture never loads
+// chunks; a streamed map's layer stays blank where no chunk has loaded yet.
+class WorldSnapshotWriter {
+public:
+    // previewPos: where to test barracks placement, when non-null
+    void Capture(World& world, WorldSnapshot& out, const Vector2* previewPos = nullptr);
+
+private:
+    TileLayerSnapshot terrain;
+    TileLayerSnapshot territory;
+    std::vector<Color> scratch;
+    // Per terrain chunk, whether terrain holds its colours
+    std::vector<uint8_t> terrainBaked;
+
+    void SyncTerrain(World& world);
+    void SyncTerritory(World& world);
+};
+
+// Overlay colour per tile of rect, row by row: the owner's colour at 25%
+// when the owner is alive, else transparent
+void BakeTerritoryColors(const World& world, TileRect rect, Color* out);
+
+template <typename PositionOf>
+void PointBuckets::Build(int count, float areaW, float areaH, PositionOf positionOf) {
+    bucketsX = areaW > 0.0f ? (int)(areaW / bucketPx) + 1 : 1;
+    bucketsY = areaH > 0.0f ? (int)(areaH / bucketPx) + 1 : 1;
+    const int bucketCount = bucketsX * bucketsY;
+
+    // Counting sort keeps each bucket in index order
+    start.assign(bucketCount + 1, 0);
+    for (int i = 0; i < count; i++) start[BucketOf(positionOf(i)) + 1]++;
+    for (int b = 0; b < bucketCount; b++) start[b + 1] += start[b];
+    items.resize(count);
+    fill.assign(start.begin(), start.end() - 1);
+    for (int i = 0; i < count; i++) items[fill[BucketOf(positionOf(i))]++] = i;
+}
@@ -4,9 +4,12 @@
 
 #include "raylib.h"
 #include "environment/WorldObject.h"
+#include "environment/random.h"
 
 
 class Terrain;
+class BlobReader;
+class BlobWriter;
 
 class Animal : public WorldObject {
 public:
@@ -21,14 +24,18 @@ public:
     float health = 100.0f;
     bool alive = true;
 
-    Animal(Vector2 pos);
+    // Draws its own random stream from spawnRng so Update needs no world access
+    Animal(Vector2 pos, Rng& spawnRng);
 
     void Update(float deltaTime, const Terrain* terrain) override;
-    void Draw() const override;
-    static Texture2D texture;
-    static bool textureLoaded;
+
+    // Field by field, for the generated-world cache
+    void save(BlobWriter& out) const;
+    bool load(BlobReader& in);
 
 private:
+    Rng rng;
+
     void Wander(float deltaTime, const Terrain* terrain);
 };
 
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "environment/random.h"
+#include "npc_store.h"
+
+struct World; // forward
+
+// Side effect of one NPC's behavior on other NPCs or settlements
+struct NpcIntent {
+    enum class Kind { DAMAGE_NPC, DAMAGE_BARRACKS, JOIN_SQUAD, LEAVE_SQUAD };
+
+    Kind kind = Kind::DAMAGE_NPC;
+    int target = -1;          // NPC index, or settlement id for barracks
+    int barracksIndex = -1;
+    int formationSlot = -1;
+    uint32_t captainId = 0;
+    float amount = 0.0f;
+};
+
+// What a behavior may touch besides its own NPC. With intents == nullptr every
+// effect is applied at once (serial mode); otherwise effects are queued and
+// World applies them in NPC order after the parallel read phase.
+struct BehaviorContext {
+    World& world;
+    Rng& rng;
+    std::vector<NpcIntent>* intents = nullptr;
+
+    // Subtracts hp and starts the death animation at zero
+    void DamageNpc(int targetIndex, float damage);
+    void DamageBarracks(int settlementId, int barracksIndex, float damage);
+
+    // Adds a warrior to the captain's squad unless another captain leads it
+    void JoinSquad(int warriorIndex, uint32_t captainId, int formationSlot);
+    // Detaches a warrior if it still follows this captain
+    void LeaveSquad(int warriorIndex, uint32_t captainId);
+};
@@ -1,13 +1,13 @@
 #pragma once
-#include "npc.h"
+#include "behavior_context.h"
 
 struct World;
 
 namespace CaptainFormation {
-    Vector2 GetCaptainFacing(const NPC& captain);
+    Vector2 GetCaptainFacing(ConstNpcRef captain);
     Vector2 GetSlotOffset(int slot, bool combatMode);
 }
 
 struct CaptainBehavior {
-    static void Update(World& world, NPC& npc, float dt);
+    static void Update(BehaviorContext& ctx, NpcRef npc, float dt);
 };
\ No newline at end of file
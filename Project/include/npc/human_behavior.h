@@ -1,8 +1,8 @@
 #pragma once
-#include "npc.h"
+#include "behavior_context.h"
 
 struct World; // forward
 
 struct HumanBehavior {
-    static void Update(World& world, NPC& npc, float dt);
+    static void Update(BehaviorContext& ctx, NpcRef npc, float dt);
 };
\ No newline at end of file
@@ -2,109 +2,135 @@
 #include <raylib.h>
 #include <cstdint>
 
+// Full NPC record. Used to build NPCs before NpcStore::push_back and for
+// snapshots; live NPCs are reached through NpcRef, which has the same members.
+// Top-level fields are hot and stored as contiguous columns; role-specific
+// state lives in the nested cold groups, each kept in its own side table.
 struct NPC {
-    // Transform state
-    Vector2 pos{0, 0};
-    Vector2 vel{0, 0};
-
-    // Identity
-    enum class Type { HUMAN, ANIMAL } type = Type::HUMAN;
+    enum class Type { HUMAN, ANIMAL };
 
-    enum class HumanRole { NONE, CIVILIAN, WARRIOR, BANDIT, CAPTAIN }
-            humanRole = HumanRole::CIVILIAN;
+    enum class HumanRole { NONE, CIVILIAN, WARRIOR, BANDIT, CAPTAIN };
 
     enum class WarriorRank { WARRIOR, CAPTAIN };
-    WarriorRank warriorRank = WarriorRank::WARRIOR;
-    bool isCaptain = false;
-
-    int settlementId = -1;
-    bool alive = true;
-
-    uint16_t skinId = 0;
 
-    // Shared formation helpers
-    bool hasFormationOffset = false;
-    Vector2 formationOffset{0, 0};
-    bool formationAssigned = false;
+    // Shared identity, stats, movement, animation and death state
+    struct Cold {
+        Type type = Type::HUMAN;
+        WarriorRank warriorRank = WarriorRank::WARRIOR;
+        bool isCaptain = false;
+
+        uint16_t skinId = 0;
+
+        // Stats
+        float speed  = 15.0f;
+        float damage = 10.0f;
+
+        // Generic movement
+        Vector2 wanderDir = {0.0f, 0.0f};
+        float wanderTimer = 0.0f;
+        Vector2 wanderTarget{0, 0};
+        int homeTile = -1;
+
+        bool isIdle = false;
+        float idleTimer = 0.0f;
+        float moveTimer = 0.0f;
+
+        // Shared roaming target
+        Vector2 roamTarget = {0.0f, 0.0f};
+        bool hasRoamTarget = false;
+        float restTimer = 0.0f;
+
+        // Combat
+        float attackCooldown = 0.0f;
+
+        // Melee attack animation
+        bool isAttacking = false;
+        float attackAnimTimer = 0.0f;
+        float attackAnimDuration = 0.16f;
+        Vector2 attackAnimDir{0.0f, 1.0f};
+
+        // Death animation state
+        float deathTimer = 0.0f;
+        float deathDuration = 0.65f;
+    };
+
+    // Warrior formation state and captain squad links
+    struct Squad {
+        bool hasFormationOffset = false;
+        Vector2 formationOffset{0, 0};
+        bool formationAssigned = false;
+
+        bool inCombat = false;
+        Vector2 combatTargetPos = {0.0f, 0.0f};
+        int squadId = -1;
+
+        uint32_t leaderCaptainId = 0;
+        int formationSlot = -1;
+    };
+
+    // Captain player commands and orders
+    struct Captain {
+        bool manualControl = false;
+        bool hasMoveTarget = false;
+        Vector2 moveTargetPx{0, 0};
+
+        // Control state
+        bool captainAutoMode = true;
+        bool captainHasMoveOrder = false;
+        Vector2 captainMoveTarget{0, 0};
+
+        // Attack order state
+        bool captainHasAttackOrder = false;
+        int captainAttackGroupId = -1;
+        uint32_t captainAttackTargetId = 0;
+    };
 
-    // Stats
-    float speed  = 15.0f;
-    float hp     = 100.0f;
-    float damage = 10.0f;
-
-    // Generic movement
-    Vector2 wanderDir = {0.0f, 0.0f};
-    float wanderTimer = 0.0f;
-    Vector2 wanderTarget{0, 0};
-    int homeTile = -1;
+    // Bandit group state
+    struct Bandit {
+        Vector2 banditGroupDir = {0.0f, 0.0f};
+        float banditLifeTime = 0.0f;
+    };
 
-    bool isIdle = false;
-    float idleTimer = 0.0f;
-    float moveTimer = 0.0f;
+    // Settlement war state
+    struct War {
+        bool warAssigned = false;
+        int warFromSettlementId = -1;
+        int warTargetSettlementId = -1;
+        bool warMarching = false;
+        Vector2 warTargetPos{0.0f, 0.0f};
+
+        // Next stop on the terrain route to warRouteGoal, see World::MarchWaypoint
+        bool warHasRoute = false;
+        Vector2 warRouteGoal{0.0f, 0.0f};
+        Vector2 warWaypoint{0.0f, 0.0f};
+
+        // Squad formation links during settlement war
+        uint32_t warCaptainId = 0;
+        int warSquadIndex = -1;
+        bool warIsDefender = false;
+        bool warReady = false;
+        bool warInBattle = false;
+        float warBattleLockTimer = 0.0f;
+    };
 
-    // Combat
-    float attackCooldown = 0.0f;
+    // Transform state
+    Vector2 pos{0, 0};
+    Vector2 vel{0, 0};
 
-    // Melee attack animation
-    bool isAttacking = false;
-    float attackAnimTimer = 0.0f;
-    float attackAnimDuration = 0.16f;
-    Vector2 attackAnimDir{0.0f, 1.0f};
+    HumanRole humanRole = HumanRole::CIVILIAN;
+    int settlementId = -1;
+    int banditGroupId = -1;
 
-    // Warrior formation state
-    bool inCombat = false;
-    Vector2 combatTargetPos = {0.0f, 0.0f};
-    int squadId = -1;
+    bool alive = true;
+    bool isDying = false;
+    float hp = 100.0f;
 
     // Stable identity for squads and selection
     uint32_t id = 0;
 
-    // Captain squad links for warrior followers
-    uint32_t leaderCaptainId = 0;
-    int formationSlot = -1;
-
-    // Captain player commands
-    bool manualControl = false;
-    bool hasMoveTarget = false;
-    Vector2 moveTargetPx{0, 0};
-
-    // Bandit group state
-    int banditGroupId = -1;
-    Vector2 banditGroupDir = {0.0f, 0.0f};
-    float banditLifeTime = 0.0f;
-
-    // Shared roaming target
-    Vector2 roamTarget = {0.0f, 0.0f};
-    bool hasRoamTarget = false;
-    float restTimer = 0.0f;
-
-    // Captain control state
-    bool captainAutoMode = true;
-    bool captainHasMoveOrder = false;
-    Vector2 captainMoveTarget{0, 0};
-
-    // Captain attack order state
-    bool captainHasAttackOrder = false;
-    int captainAttackGroupId = -1;
-    uint32_t captainAttackTargetId = 0;
-
-    // Death animation state
-    bool isDying = false;
-    float deathTimer = 0.0f;
-    float deathDuration = 0.65f;
-
-    // Settlement war state
-    bool warAssigned = false;
-    int warFromSettlementId = -1;
-    int warTargetSettlementId = -1;
-    bool warMarching = false;
-    Vector2 warTargetPos{0.0f, 0.0f};
-
-    // Squad formation links during settlement war
-    uint32_t warCaptainId = 0;
-    int warSquadIndex = -1;
-    bool warIsDefender = false;
-    bool warReady = false;
-    bool warInBattle = false;
-    float warBattleLockTimer = 0.0f;
+    Cold cold;
+    Squad squad;
+    Captain captain;
+    Bandit bandit;
+    War war;
 };
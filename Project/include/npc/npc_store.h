@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <type_traits>
+#include <vector>
+
+#include "npc.h"
+
+class NpcStore;
+
+// Handle to one NPC inside an NpcStore. Members are references into the
+// store's columns and side tables, named like the fields of NPC, so code
+// reads the same against a record or a stored NPC. Invalidated by any
+// push_back, RemoveIf or clear on the store.
+template <bool Const>
+class BasicNpcRef {
+    template <typename T>
+    using Ref = std::conditional_t<Const, const T&, T&>;
+    using StoreRef = std::conditional_t<Const, const NpcStore&, NpcStore&>;
+
+public:
+    BasicNpcRef(StoreRef store, int i);
+
+    // Mutable handles convert to read-only ones
+    template <bool C = Const, typename = std::enable_if_t<C>>
+    BasicNpcRef(const BasicNpcRef<false>& other);
+
+    Ref<Vector2> pos;
+    Ref<Vector2> vel;
+    Ref<NPC::HumanRole> humanRole;
+    Ref<int> settlementId;
+    Ref<int> banditGroupId;
+    Ref<bool> alive;
+    Ref<bool> isDying;
+    Ref<float> hp;
+    Ref<uint32_t> id;
+
+    Ref<NPC::Cold> cold;
+    Ref<NPC::Squad> squad;
+    Ref<NPC::Captain> captain;
+    Ref<NPC::Bandit> bandit;
+    Ref<NPC::War> war;
+
+    // Position in the store, valid until the next compaction
+    int index;
+
+    // Copies the NPC out as a full record
+    NPC Get() const;
+};
+
+using NpcRef = BasicNpcRef<false>;
+using ConstNpcRef = BasicNpcRef<true>;
+
+// Structure-of-arrays NPC storage. Fields read by every per-tick pass
+// (position, velocity, role, flags, settlement, hp, ids) sit in contiguous
+// columns; role-specific state sits in side tables indexed the same way.
+// Order is insertion order, and RemoveIf keeps it stable.
+//
+// Ids come from AllocateId and are generational handles: the low ID_SLOT_BITS
+// hold a slot number + 1, the high bits the slot's generation. The slot maps
+// to the NPC's current index and follows it through compaction; removing the
+// NPC bumps the generation, so an old id never matches a recycled slot.
+// Freed slots are reused oldest first, and a slot whose generation reaches
+// MAX_GENERATION is retired rather than wrapped. The limit of MAX_ID_SLOTS
+// applies to ids outstanding plus retired slots, not to NPCs ever spawned.
+class NpcStore {
+public:
+    static constexpr uint32_t ID_SLOT_BITS = 20;
+    static constexpr uint32_t ID_SLOT_MASK = (1u << ID_SLOT_BITS) - 1u;
+    // Slot numbers are stored + 1 so that no id is 0
+    static constexpr uint32_t MAX_ID_SLOTS = ID_SLOT_MASK;
+    static constexpr uint32_t MAX_GENERATION = 0xFFFFFFFFu >> ID_SLOT_BITS;
+
+    template <bool Const>
+    class Iterator {
+        using StorePtr = std::conditional_t<Const, const NpcStore*, NpcStore*>;
+
+    public:
+        Iterator(StorePtr s, int i) : store(s), index(i) {}
+        BasicNpcRef<Const> operator*() const { return BasicNpcRef<Const>(*store, index); }
+        Iterator& operator++() { index++; return *this; }
+        bool operator==(const Iterator& o) const { return index == o.index; }
+        bool operator!=(const Iterator& o) const { return index != o.index; }
+
+    private:
+        StorePtr store;
+        int index;
+    };
+
+    size_t size() const { return posCol.size(); }
+    bool empty() const { return posCol.empty(); }
+
+    void clear();
+    void reserve(size_t n);
+    void push_back(const NPC& npc);
+
+    // Makes this store a read view of `from` for a pass where NPCs only
+    // read each other: hot columns, ids, squad, captain and war tables are
+    // copied; cold and bandit tables, which only their own NPC reads, are
+    // sized to match but left stale. Reuses this store's capacity.
+    void CopySharedFrom(const NpcStore& from);
+
+    NpcRef operator[](int i) { return NpcRef(*this, i); }
+    ConstNpcRef operator[](int i) const { return ConstNpcRef(*this, i); }
+    NpcRef back() { return (*this)[(int)size() - 1]; }
+
+    Iterator<false> begin() { return { this, 0 }; }
+    Iterator<false> end() { return { this, (int)size() }; }
+    Iterator<true> begin() const { return { this, 0 }; }
+    Iterator<true> end() const { return { this, (int)size() }; }
+
+    NPC Get(int i) const;
+
+    // Hot column reads for scans that need no handle
+    Vector2 Pos(int i) const { return posCol[i]; }
+    NPC::HumanRole Role(int i) const { return roleCol[i]; }
+    int SettlementId(int i) const { return settlementCol[i]; }
+    int BanditGroupId(int i) const { return banditGroupCol[i]; }
+    uint32_t Id(int i) const { return idCol[i]; }
+    bool IsAlive(int i) const { return flagCol[i].alive; }
+    bool IsDying(int i) const { return flagCol[i].isDying; }
+    // Alive and not playing its death animation
+    bool IsActive(int i) const { return flagCol[i].alive && !flagCol[i].isDying; }
+    const NPC::Squad& Squad(int i) const { return squadTable[i]; }
+
+    // Reserves a fresh id for an NPC that is about to be pushed. Never 0.
+    // Throws std::length_error when all MAX_ID_SLOTS slots are in use.
+    uint32_t AllocateId();
+
+    // Current index of the NPC with this id, -1 for 0, unknown or stale ids
+    int IndexOf(uint32_t id) const {
+        uint32_t slot = (id & ID_SLOT_MASK) - 1u;
+        if ((id & ID_SLOT_MASK) == 0 || slot >= idSlots.size()) return -1;
+        const IdSlot& s = idSlots[slot];
+        return (s.generation == (id >> ID_SLOT_BITS)) ? s.index : -1;
+    }
+
+    // Removes every NPC the predicate accepts, keeping the order of the rest
+    template <typename Pred>
+    void RemoveIf(Pred&& pred);
+
+private:
+    template <bool> friend class BasicNpcRef;
+
+    struct Flags {
+        bool alive = true;
+        bool isDying = false;
+    };
+
+    std::vector<Vector2> posCol;
+    std::vector<Vector2> velCol;
+    std::vector<NPC::HumanRole> roleCol;
+    std::vector<int> settlementCol;
+    std::vector<int> banditGroupCol;
+    std::vector<Flags> flagCol;
+    std::vector<float> hpCol;
+    std::vector<uint32_t> idCol;
+
+    std::vector<NPC::Cold> coldTable;
+    std::vector<NPC::Squad> squadTable;
+    std::vector<NPC::Captain> captainTable;
+    std::vector<NPC::Bandit> banditTable;
+    std::vector<NPC::War> warTable;
+
+    struct IdSlot {
+        int index = -1;
+        uint32_t generation = 0;
+    };
+
+    // Indexed by id slot; freed slots are reused with a bumped generation,
+    // in release order so reuse spreads over every free slot
+    std::vector<IdSlot> idSlots;
+    std::deque<uint32_t> freeIdSlots;
+
+    void BindId(uint32_t id, int index);
+    void ReleaseId(int index);
+    void MoveSlot(int from, int to);
+    void Truncate(size_t n);
+};
+
+template <bool Const>
+BasicNpcRef<Const>::BasicNpcRef(StoreRef s, int i)
+    : pos(s.posCol[i]), vel(s.velCol[i]), humanRole(s.roleCol[i]),
+      settlementId(s.settlementCol[i]), banditGroupId(s.banditGroupCol[i]),
+      alive(s.flagCol[i].alive), isDying(s.flagCol[i].isDying), hp(s.hpCol[i]), id(s.idCol[i]),
+      cold(s.coldTable[i]), squad(s.squadTable[i]), captain(s.captainTable[i]),
+      bandit(s.banditTable[i]), war(s.warTable[i]), index(i) {}
+
+template <bool Const>
+template <bool C, typename>
+BasicNpcRef<Const>::BasicNpcRef(const BasicNpcRef<false>& o)
+    : pos(o.pos), vel(o.vel), humanRole(o.humanRole), settlementId(o.settlementId),
+      banditGroupId(o.banditGroupId), alive(o.alive), isDying(o.isDying), hp(o.hp), id(o.id),
+      cold(o.cold), squad(o.squad), captain(o.captain), bandit(o.bandit), war(o.war),
+      index(o.index) {}
+
+template <bool Const>
+NPC BasicNpcRef<Const>::Get() const {
+    NPC npc;
+    npc.pos = pos;
+    npc.vel = vel;
+    npc.humanRole = humanRole;
+    npc.settlementId = settlementId;
+    npc.banditGroupId = banditGroupId;
+    npc.alive = alive;
+    npc.isDying = isDying;
+    npc.hp = hp;
+    npc.id = id;
+    npc.cold = cold;
+    npc.squad = squad;
+    npc.captain = captain;
+    npc.bandit = bandit;
+    npc.war = war;
+    return npc;
+}
+
+template <typename Pred>
+void NpcStore::RemoveIf(Pred&& pred) {
+    const int n = (int)size();
+    int out = 0;
+    for (int i = 0; i < n; i++) {
+        if (pred(ConstNpcRef(*this, i))) {
+            ReleaseId(i);
+            continue;
+        }
+        if (out != i) MoveSlot(i, out);
+        out++;
+    }
+    Truncate((size_t)out);
+}
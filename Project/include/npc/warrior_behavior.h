@@ -1,8 +1,8 @@
 #pragma once
-#include "npc/npc.h"
+#include "npc/behavior_context.h"
 
 struct World; // forward declaration
 
 struct WarriorBehavior {
-    static void Update(World& world, NPC& npc, float dt);
+    static void Update(BehaviorContext& ctx, NpcRef npc, float dt);
 };
\ No newline at end of file
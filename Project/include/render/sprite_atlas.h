@@ -0,0 +1,58 @@
+#pragma once
+
+#include <raylib.h>
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Every PNG under an asset directory packed into one texture, so sprites
+// drawn back to back share raylib's batch. Sprites are named by their path
+// below the directory without the extension, e.g. "npc/civilian/civilian_0";
+// callers look names up once and keep the ids.
+// Loading is two steps: Decode does the file reads, PNG decoding and packing
+// on any thread, and Upload hands the result to the GPU on the window's thread.
+class WorkerPool;
+
+class SpriteAtlas {
+public:
+    static constexpr int MAX_SIZE = 4096;
+    // Empty texels around each sprite, filled with copies of its edge so
+    // point sampling at a rounded edge never reads a neighbour
+    static constexpr int PADDING = 1;
+
+    Texture2D texture{};
+
+    // Decodes and packs every PNG under directory into memory, one file per
+    // pool task when a pool is given. Needs no window. False when nothing fits.
+    bool Decode(const std::string& directory, WorkerPool* pool = nullptr);
+    // Uploads what Decode packed and frees it; requires an open window
+    bool Upload();
+    // Decode then Upload
+    bool Load(const std::string& directory);
+    void Unload();
+    bool IsLoaded() const { return texture.id != 0; }
+
+    // Files decoded out of those found, updated while Decode runs so another
+    // thread can show progress
+    std::atomic<int> filesDecoded{0};
+    std::atomic<int> filesFound{0};
+
+    // Sprite id for name, -1 when no such file was packed
+    int Find(const std::string& name) const;
+    // Source rectangle of sprite id in the atlas texture
+    Rectangle Rect(int id) const { return rects[id]; }
+    int SpriteCount() const { return (int)rects.size(); }
+    // A white texel region for SetShapesTexture, so shapes batch with sprites
+    Rectangle WhiteRect() const { return white; }
+
+private:
+    // Decode's output until Upload
+    std::vector<Color> packed;
+    int packedW = 0;
+    int packedH = 0;
+
+    std::vector<Rectangle> rects;
+    std::unordered_map<std::string, int> ids;
+    Rectangle white{};
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <raylib.h>
+#include "environment/world_snapshot.h"
+
+// A TileLayerSnapshot kept as a texture with one texel per tile, drawn scaled
+// up in a single call. Used for both terrain and settlement territory.
+// Only the rects changed since the uploaded revision are re-uploaded.
+class TileLayerRenderer {
+public:
+    // Brings the texture up to layer's revision; a size change, or a revision
+    // older than the layer's change log, re-uploads all. Requires an open window.
+    void Sync(const TileLayerSnapshot& layer);
+    // Draws the part of the layer inside view (world pixels)
+    void Draw(Rectangle view, float tilePx) const;
+    void Unload();
+    unsigned int TextureId() const { return texture.id; }
+
+private:
+    Texture2D texture{};
+    bool loaded = false;
+    uint64_t revision = 0;
+    // Scratch for changed rects, and one rect's colours
+    std::vector<TileRect> rects;
+    std::vector<Color> pixels;
+};
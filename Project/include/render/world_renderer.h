@@ -0,0 +1,158 @@
+#pragma once
+
+#include <raylib.h>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "environment/npc_density.h"
+#include "environment/worker_pool.h"
+#include "environment/world.h"
+#include "environment/world_snapshot.h"
+#include "render/sprite_atlas.h"
+#include "render/tile_layer_renderer.h"
+
+// World-pixel rectangle a 2D camera shows on a screenW x screenH screen
+Rectangle CameraViewRect(const Camera2D& camera, int screenW, int screenH);
+
+// Draws WorldSnapshots through raylib and owns the sprite atlas.
+// It never reads World, so the simulation can tick on another thread
+// while a frame is drawn, and World runs without a window.
+class WorldRenderer {
+public:
+    static constexpr int NPC_VARIANTS = World::NPC_VARIANTS;
+    static constexpr int ROLE_COUNT = (int)NPC::HumanRole::CAPTAIN + 1;
+
+    // Every sprite in one texture
+    SpriteAtlas atlas;
+
+    // Atlas ids resolved once at load, -1 where the file is missing
+    int npcSprite[ROLE_COUNT][NPC_VARIANTS]{};
+    int animalSprite = -1;
+    int flowerSprite = -1;
+    int treeSprite = -1;
+
+    // Campfire resources
+    static constexpr int FIRE_FRAMES = 4;
+    int fireSprite[FIRE_FRAMES]{};
+    int fireFrame = 0;
+    float fireAnimT = 0.0f;
+    float fireAnimSpeed = 0.10f;
+
+    // Barracks resources
+    int barracksSprite = -1;
+
+    TileLayerRenderer terrain;
+    TileLayerRenderer territory;
+
+    // Decodes and packs all sprites on a pool of workers; needs no window,
+    // so it can run on another thread while the world generates
+    void DecodeAssets();
+    // Fraction of sprite files DecodeAssets has decoded so far
+    float DecodeProgress() const;
+    // Uploads the decoded atlas and resolves sprite ids; requires an open
+    // window. Throws when a sprite the renderer cannot do without is missing.
+    void FinishLoad();
+    // DecodeAssets then FinishLoad
+    void Load();
+    void Unload();
+
+    // Atlas id of an NPC sprite, -1 when missing
+    int NpcSprite(NPC::HumanRole role, int variant) const {
+        int r = (int)role;
+        return r >= 0 && r < ROLE_COUNT ? npcSprite[r][variant % NPC_VARIANTS] : -1;
+    }
+
+    // NPC detail by size on screen: animated sprites up close, flat quads
+    // further out, and per-cell density splats once a sprite would be a few
+    // pixels wide
+    enum class NpcLod { SPRITES, QUADS, DENSITY };
+    // On-screen NPC sprite width, in pixels, at which each tier starts
+    static constexpr float SPRITES_MIN_SCREEN_PX = 10.0f;
+    static constexpr float QUADS_MIN_SCREEN_PX = 5.0f;
+    // Density cells are at least this many pixels wide on screen
+    static constexpr float DENSITY_CELL_SCREEN_PX = 4.0f;
+    static NpcLod LodForZoom(float zoom);
+    // Forces a tier regardless of zoom, for comparing them
+    std::optional<NpcLod> npcLodOverride;
+
+    // Advances sprite animations by one rendered frame
+    void Update(float dt);
+
+    // Uploads the terrain and territory rects that changed since the last
+    // synced snapshot; call before Draw
+    void Sync(const WorldSnapshot& snapshot);
+
+    // Draws what overlaps view, a rectangle in world pixels (see
+    // CameraViewRect), at zoom screen pixels per world pixel. Plants and NPCs
+    // are found through spatial indexes, so the cost follows what is on screen.
+    void Draw(const WorldSnapshot& snapshot, Rectangle view, float zoom);
+
+    // Objects handed to raylib versus skipped as off screen by the last Draw
+    struct DrawCounts {
+        int submitted = 0;
+        int culled = 0;
+    };
+    struct DrawStats {
+        DrawCounts plants;
+        DrawCounts animals;
+        DrawCounts barracks;
+        DrawCounts npcs;
+        // Draw calls raylib issues for the world, as modelled by BatchModel
+        int drawCalls = 0;
+        // NPC tier used, the time its pass took, and its splats when DENSITY
+        NpcLod npcLod = NpcLod::SPRITES;
+        double npcMs = 0.0;
+        int densitySplats = 0;
+
+        DrawCounts Total() const {
+            DrawCounts t;
+            for (const DrawCounts* c : { &plants, &animals, &barracks, &npcs }) {
+                t.submitted += c->submitted;
+                t.culled += c->culled;
+            }
+            return t;
+        }
+    };
+    DrawStats lastDrawStats;
+
+private:
+    // Plant indices bucketed by position; plants never move, so this is
+    // rebuilt only when the snapshot's plantsRevision changes
+    PointBuckets plantBuckets;
+    uint64_t plantBucketsRevision = UINT64_MAX;
+    // Scratch for visible plant and NPC indices
+    std::vector<int> visible;
+
+    // DENSITY tier histogram, counted on its own pool; created on first use
+    NpcDensityGrid density;
+    std::unique_ptr<WorkerPool> densityPool;
+
+    // Mirrors raylib's batching to count draw calls: a new one starts when
+    // the texture or primitive changes, or when the vertex buffer fills
+    struct BatchModel {
+        static constexpr int BUFFER_VERTICES = 8192 * 4;
+        uint64_t key = 0;
+        int used = 0;
+        int drawCalls = 0;
+
+        void Submit(unsigned int textureId, bool lines, int vertices);
+    };
+    BatchModel batch;
+
+    // Draws sprite id from the atlas into dst
+    void DrawSprite(int id, Rectangle dst, Vector2 origin, Color tint, bool flipX = false);
+    // Counts shapes, which use the atlas white texel once it is loaded
+    void CountShapes(int quads);
+    void CountLines(int lines);
+
+    void DrawPlant(const PlantSnapshot& plant);
+    void DrawAnimal(const AnimalSnapshot& animal);
+    void DrawMeteors(const WorldSnapshot& snapshot);
+
+    // The NPC tiers, over the visible indices
+    void DrawNpcSprites(const WorldSnapshot& snapshot);
+    void DrawNpcQuads(const WorldSnapshot& snapshot);
+    void DrawNpcDensity(const WorldSnapshot& snapshot, Rectangle view, float zoom);
+    void DrawSelectedCaptainRing(const WorldSnapshot& snapshot);
+};
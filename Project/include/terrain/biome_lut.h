@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+struct Biome;
+
+// Elevation -> biome index table compiled from a biome list. lookup returns
+// exactly what a scan for the first biome with minElevation <= e <=
+// maxElevation returns (0 when none does), in O(1) for any catalogue size.
+//
+// The answer only changes at biome edges, so the table keeps the sorted
+// edges with the answer on each edge and in each gap, plus fixed-width bins
+// that jump straight to the first edge a value can reach.
+class BiomeLut {
+public:
+    void build(const std::vector<Biome>& biomes);
+
+    int lookup(float elevation) const {
+        if (elevation != elevation) return 0; // NaN matches no biome
+
+        float f = elevation * (float)BINS;
+        int bin = (f <= 0.0f) ? 0 : (f >= (float)(BINS - 1)) ? BINS - 1 : (int)f;
+
+        int k = binStart[bin];
+        while (k < (int)edges.size() && edges[k] < elevation) k++;
+        if (k < (int)edges.size() && edges[k] == elevation) return onEdge[k];
+        return belowEdge[k];
+    }
+
+private:
+    static constexpr int BINS = 1024;
+
+    std::vector<float> edges;   // sorted, unique
+    std::vector<int> onEdge;    // answer at edges[k]
+    std::vector<int> belowEdge; // answer between edges[k-1] and edges[k]; last entry is above every edge
+    std::vector<int> binStart;  // first edge a value in the bin can land on
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Flat host-byte-order image of plain values and vectors of them, for
+// the generated-world cache. Only trivially copyable types go in raw; the
+// classes that own richer state write it field by field.
+class BlobWriter {
+public:
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        append(&value, sizeof(T));
+    }
+    template <typename T>
+    void putVector(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        put((uint64_t)values.size());
+        append(values.data(), values.size() * sizeof(T));
+    }
+    void append(const void* data, size_t size) {
+        if (size == 0) return;
+        const size_t old = bytes.size();
+        bytes.resize(old + size);
+        std::memcpy(bytes.data() + old, data, size);
+    }
+
+    const std::vector<uint8_t>& data() const { return bytes; }
+
+private:
+    std::vector<uint8_t> bytes;
+};
+
+// Reads a BlobWriter image back. Every read checks the remaining length;
+// after the first short read ok() is false and all later reads fail.
+class BlobReader {
+public:
+    BlobReader(const void* data, size_t size) : pos((const uint8_t*)data), end(pos + size) {}
+
+    template <typename T>
+    bool get(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return read(&value, sizeof(T));
+    }
+    template <typename T>
+    bool getVector(std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        uint64_t count = 0;
+        if (!get(count) || count > remaining() / sizeof(T)) return fail();
+        values.resize((size_t)count);
+        return read(values.data(), (size_t)count * sizeof(T));
+    }
+    bool read(void* out, size_t size) {
+        if (!good || size > remaining()) return fail();
+        std::memcpy(out, pos, size);
+        pos += size;
+        return true;
+    }
+    // Points at the next size bytes without copying them; nullptr if short
+    const uint8_t* view(size_t size) {
+        if (!good || size > remaining()) {
+            fail();
+            return nullptr;
+        }
+        const uint8_t* p = pos;
+        pos += size;
+        return p;
+    }
+
+    bool ok() const { return good; }
+    size_t remaining() const { return (size_t)(end - pos); }
+
+private:
+    const uint8_t* pos;
+    const uint8_t* end;
+    bool good = true;
+
+    bool fail() {
+        good = false;
+        return false;
+    }
+};
+
+// Read-only view of a whole file: memory-mapped where the platform allows,
+// else read into memory
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const std::string& path);
+    void close();
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t* bytes = nullptr;
+    size_t length = 0;
+    bool mapped = false;
+    std::vector<uint8_t> fallback;
+};
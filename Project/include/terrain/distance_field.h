@@ -0,0 +1,61 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "terrain/blob.h"
+#include "terrain/terrain.h"
+
+// Per tile: the nearest walkable tile and the distance to water, both within
+// RADIUS tiles (Chebyshev), from two raster sweeps that pass each tile its
+// neighbours' nearest seed. Ties go to the smaller row, then column, which
+// is the tile Terrain's ring search meets first, so lookups return exactly
+// what that search would.
+class DistanceField {
+public:
+    static constexpr int RADIUS = 32;
+
+    void build(const Terrain& terrain);
+    // Refreshes every tile within RADIUS of rect after rect's tiles changed
+    void update(const Terrain& terrain, TileRect rect);
+    bool isBuilt() const { return width > 0; }
+    void save(BlobWriter& out) const;
+    // Rejects a field for another map size or with seeds off the map
+    bool load(BlobReader& in, const Terrain& terrain);
+
+    // Nearest walkable tile to (x, y) other than itself at most maxRadius
+    // away. Only valid for blocked in-map tiles and maxRadius <= RADIUS.
+    bool nearestPassable(int x, int y, int& outX, int& outY, int maxRadius) const {
+        const Seed& s = passable[(size_t)y * width + x];
+        if (s.dx == NO_SEED || std::max(std::abs(s.dx), std::abs(s.dy)) > maxRadius) return false;
+        outX = x + s.dx;
+        outY = y + s.dy;
+        return true;
+    }
+    // Tiles from (x, y) to the nearest water tile: 0 on water, RADIUS + 1
+    // when none is within RADIUS
+    int waterDistance(int x, int y) const { return water[(size_t)y * width + x]; }
+
+private:
+    static constexpr int8_t NO_SEED = INT8_MIN;
+
+    // Offset from a tile to its nearest seed; dx == NO_SEED when none
+    struct Seed {
+        int8_t dx = NO_SEED;
+        int8_t dy = 0;
+    };
+
+    int width = 0;
+    int height = 0;
+    std::vector<Seed> passable;
+    std::vector<uint8_t> water;
+    std::vector<Seed> scratch;
+
+    // Runs the sweeps over the tiles of window and stores the results for
+    // the tiles of keep, which must lie inside window at least RADIUS from
+    // its edges wherever those are not the map's
+    void sweep(const Terrain& terrain, TileRect window, TileRect keep);
+    static void propagate(std::vector<Seed>& seeds, int w, int h);
+};
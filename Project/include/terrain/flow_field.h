@@ -0,0 +1,71 @@
+#pragma once
+
+#include <raylib.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "terrain/terrain.h"
+
+// Every tile's cheapest walk to one goal tile, from a single Dijkstra pass
+// over the map (8-way, no corner cutting, same step costs as
+// HpaPathfinder). Units heading to the goal sample their next step in O(1)
+// instead of planning a route each.
+class FlowField {
+public:
+    // Builds toward the tile under goalPx, or the nearest walkable tile if
+    // that one is blocked. False when no walkable goal was found.
+    bool build(const Terrain& terrain, Vector2 goalPx);
+
+    Vector2 getGoalPx() const { return goalPx; }
+    // Walk cost from the tile under posPx to the goal; infinite off the map
+    // or where the goal cannot be reached
+    float costAt(Vector2 posPx) const;
+    // Centre of the next tile toward the goal. False on the goal tile and
+    // where the goal cannot be reached.
+    bool nextStep(Vector2 posPx, Vector2& outPx) const;
+
+private:
+    static constexpr uint8_t NO_STEP = 255;
+
+    int width = 0;
+    int height = 0;
+    Vector2 goalPx{0.0f, 0.0f};
+    // Per tile: integrated cost to the goal and the neighbour (0-7) to step to
+    std::vector<float> cost;
+    std::vector<uint8_t> step;
+
+    int tileIndex(Vector2 posPx) const;
+};
+
+// Flow fields shared by everyone marching to the same place, keyed by the
+// caller (World keys them by target settlement). Each key is reference
+// counted; the field is built on first acquire and freed on last release.
+class FlowFieldCache {
+public:
+    // Adds a user of key's field toward goalPx, building it if needed
+    void acquire(const Terrain& terrain, int key, Vector2 goalPx);
+    void release(int key);
+    // Rebuilds key's field if its goal moved by more than a tile
+    void retarget(const Terrain& terrain, int key, Vector2 goalPx);
+    // nullptr when nobody holds key
+    const FlowField* find(int key) const;
+    int refCount(int key) const;
+    size_t size() const { return entries.size(); }
+
+    // Marks every field stale after a terrain edit, since any cost change
+    // can reroute the whole field; refresh rebuilds them
+    void invalidate();
+    void refresh(const Terrain& terrain);
+
+private:
+    struct Entry {
+        int key = 0;
+        int refs = 0;
+        bool stale = false;
+        std::unique_ptr<FlowField> field;
+    };
+    std::vector<Entry> entries;
+
+    Entry* findEntry(int key);
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <raylib.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "terrain/blob.h"
+#include "terrain/terrain.h"
+
+// Hierarchical A* over Terrain tiles. The map is cut into CLUSTER x CLUSTER
+// tile clusters; walkable openings on each shared cluster border become a
+// pair of nodes, one per side, and nodes of one cluster are linked by their
+// cheapest path inside it. A query searches that small graph, refines every
+// hop with a search inside one cluster, then drops waypoints a straight
+// walkable line can skip.
+//
+// Steps move 8-way without cutting corners and cost distance divided by
+// tile move speed, averaged over both tiles. Queries only read the graph
+// and may run in parallel; build and invalidate must not overlap them.
+class HpaPathfinder {
+public:
+    static constexpr int CLUSTER = 16;
+
+    void build(const Terrain& terrain);
+    // Rebuilds the clusters rect touches, and the entrances they share with
+    // their neighbours, after those tiles changed
+    void invalidate(const Terrain& terrain, TileRect rect);
+    bool isBuilt() const { return clustersX > 0; }
+    // The whole graph, for the generated-world cache. load rejects a graph
+    // for another map size or with any index out of range.
+    void save(BlobWriter& out) const;
+    bool load(BlobReader& in, const Terrain& terrain);
+
+    // Waypoints in world pixels: fromPx first, then the route, then toPx.
+    // Endpoints on blocked tiles move to the nearest walkable tile. Returns
+    // false when no route exists or the graph was never built.
+    bool findPath(const Terrain& terrain, Vector2 fromPx, Vector2 toPx, std::vector<Vector2>& out) const;
+
+    size_t nodeCount() const { return nodes.size() - freeNodes.size(); }
+    size_t edgeCount() const;
+
+private:
+    struct Edge {
+        int to;
+        float cost;
+        // Tiles after this node up to and including `to`, as cluster-local
+        // indices in clusterPaths of this node's cluster
+        uint32_t path;
+        uint32_t pathLen;
+    };
+
+    struct Node {
+        int tx = 0;
+        int ty = 0;
+        int cluster = -1;
+        // Node across the border and the cost of the step to it
+        int partner = -1;
+        float partnerCost = 0.0f;
+        std::vector<Edge> intra;
+    };
+
+    int width = 0;
+    int height = 0;
+    int clustersX = 0;
+    int clustersY = 0;
+    // Cheapest cost of one straight step, for an admissible heuristic
+    float minStepCost = 1.0f;
+
+    // Step cost factor per tile (1 / move speed), negative when blocked;
+    // refreshed by build and invalidate
+    std::vector<float> tileCost;
+
+    std::vector<Node> nodes;
+    std::vector<int> freeNodes;
+    std::vector<std::vector<int>> clusterNodes;
+    std::vector<std::vector<uint8_t>> clusterPaths;
+    // Per cluster: nodes on its right border, then (offset by the cluster
+    // count) on its bottom border
+    std::vector<std::vector<int>> borderNodes;
+
+    int clusterOf(int tx, int ty) const { return (ty / CLUSTER) * clustersX + tx / CLUSTER; }
+    float costAt(int tx, int ty) const {
+        if (tx < 0 || tx >= width || ty < 0 || ty >= height) return -1.0f;
+        return tileCost[(size_t)ty * width + tx];
+    }
+    void refreshCosts(const Terrain& terrain, int x0, int y0, int x1, int y1);
+    bool lineWalkable(int ax, int ay, int bx, int by) const;
+    void rebuildBorder(int border);
+    void linkCluster(int cluster);
+    int addNode(int tx, int ty);
+    bool loadedGraphValid() const;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <raylib.h>
+#include <cstdint>
+#include <vector>
+
+#include "terrain/blob.h"
+#include "terrain/terrain.h"
+
+// Connected regions of walkable tiles, using the same 8-way moves without
+// corner cutting as HpaPathfinder, so two tiles share a region exactly when
+// a walk between them exists. Labels are per tile; update relabels only the
+// regions an edit touched.
+class LandRegions {
+public:
+    static constexpr int NONE = -1;
+
+    void build(const Terrain& terrain);
+    // Relabels after rect's tiles changed. Cost is the size of the regions
+    // touching rect, falling back to a full build when they cover most of
+    // the map.
+    void update(const Terrain& terrain, TileRect rect);
+    bool isBuilt() const { return width > 0; }
+    void save(BlobWriter& out) const;
+    // Rejects labels for another map size or naming a region not stored
+    bool load(BlobReader& in, const Terrain& terrain);
+
+    // Region of tile (tx, ty), NONE when blocked or off the map
+    int regionAt(int tx, int ty) const {
+        if (tx < 0 || tx >= width || ty < 0 || ty >= height) return NONE;
+        return labels[(size_t)ty * width + tx];
+    }
+    int regionAtPx(Vector2 px) const {
+        return regionAt((int)(px.x / Terrain::TILE_PX), (int)(px.y / Terrain::TILE_PX));
+    }
+    // Whether a walk from a to b exists; false if either is blocked
+    bool sameRegion(Vector2 a, Vector2 b) const {
+        int r = regionAtPx(a);
+        return r != NONE && r == regionAtPx(b);
+    }
+
+    size_t regionCount() const { return liveRegions; }
+    // Tiles in region, 0 for labels no longer in use
+    int regionSize(int region) const { return region >= 0 && region < (int)sizes.size() ? sizes[region] : 0; }
+
+private:
+    int width = 0;
+    int height = 0;
+    std::vector<int32_t> labels;
+    // Tile count per label; labels are never reused, so retired ones stay 0
+    std::vector<int> sizes;
+    size_t liveRegions = 0;
+    std::vector<int> stack;
+
+    // Labels every walkable unlabelled tile reachable from (x, y)
+    void fill(const Terrain& terrain, int x, int y, int label);
+};
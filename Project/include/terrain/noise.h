@@ -0,0 +1,23 @@
+#pragma once
+
+// 2D Perlin noise and fBm over a 512-entry permutation table (see
+// Terrain::buildPermutation). FbmBatch runs several points per instruction
+// with SSE2 or AVX2 when the CPU has them; every kernel performs the same
+// float operations in the same order as the scalar reference.
+
+enum class NoiseKernel { SCALAR, SSE2, AVX2 };
+
+// Scalar reference
+float PerlinNoise(const int* perm, float x, float y);
+float Fbm(const int* perm, float x, float y, int octaves);
+
+// out[i] = Fbm(perm, xs[i], ys[i], octaves) for i < count
+void FbmBatch(const int* perm, const float* xs, const float* ys, int count, int octaves, float* out);
+
+// Best kernel this CPU supports
+NoiseKernel DetectNoiseKernel();
+// Kernel FbmBatch uses; defaults to DetectNoiseKernel(). Set clamps to what
+// the CPU supports and is meant for tests and benchmarks.
+NoiseKernel GetNoiseKernel();
+void SetNoiseKernel(NoiseKernel kernel);
+const char* NoiseKernelName(NoiseKernel kernel);
@@ -1,9 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include <raylib.h>
+#include "terrain/biome_lut.h"
 
 enum class TileType {
     None,
@@ -46,18 +51,24 @@ enum class TerrainFeature {
     Oasis,
 };
 
+// Resource names, indexed by the enum instead of stored per tile
+const char* VegetationYieldName(VegetationType type);
+const char* OreYieldName(OreType type);
+
 struct VegetationData {
     VegetationType type = VegetationType::None;
     bool isHarvestable = true;
     int yieldAmount = 1;
-    std::string yieldName = "wood";
+
+    const char* yieldName() const { return VegetationYieldName(type); }
 };
 
 struct OreData {
     OreType type = OreType::None;
     int amount = 0;
     bool isHarvestable = true;
-    std::string yieldName = "ore";
+
+    const char* yieldName() const { return OreYieldName(type); }
 };
 
 struct TileProperties {
@@ -99,68 +110,270 @@ struct Biome {
     TileProperties props;
 };
 
+// Packed to 10 bytes. Elevation is stored in 1/65535 steps and moisture and
+// temperature in 1/255 steps, each clamped to [0,1]; vegetation yield is
+// capped at 255 and ore amount at 65535.
 struct Tile {
-    TileType type = TileType::None;
-    int biomeIndex = -1;
-    float elevation = 0.0f;
-    float moisture = 0.0f;
-    float temperature = 0.0f;
-    
-    VegetationData vegetation;
-    OreData ore;
-    TerrainFeature feature = TerrainFeature::None;
+    int8_t biomeIndex = -1;
+
+    float getElevation() const { return elevationQ * (1.0f / 65535.0f); }
+    float getMoisture() const { return moistureQ * (1.0f / 255.0f); }
+    float getTemperature() const { return temperatureQ * (1.0f / 255.0f); }
+    void setElevation(float value);
+    void setMoisture(float value);
+    void setTemperature(float value);
+
+    TileType getType() const { return (TileType)type; }
+    void setType(TileType value) { type = (uint8_t)value; }
+    TerrainFeature getFeature() const { return (TerrainFeature)feature; }
+    void setFeature(TerrainFeature value) { feature = (uint8_t)value; }
+
+    VegetationData getVegetation() const;
+    void setVegetation(const VegetationData& value);
+    OreData getOre() const;
+    void setOre(const OreData& value);
+
+private:
+    uint8_t moistureQ = 0;
+    uint16_t elevationQ = 0;
+    uint8_t temperatureQ = 0;
+
+    uint8_t type : 3 = (uint8_t)TileType::None;
+    uint8_t feature : 3 = (uint8_t)TerrainFeature::None;
+    uint8_t vegetationHarvestable : 1 = 1;
+    uint8_t oreHarvestable : 1 = 1;
+
+    uint8_t vegetationType : 3 = (uint8_t)VegetationType::None;
+    uint8_t oreType : 3 = (uint8_t)OreType::None;
+
+    uint8_t vegetationYield = 1;
+    uint16_t oreAmount = 0;
 };
 
+// Axis-aligned block of tiles, in tile coordinates
+struct TileRect {
+    int x = 0;
+    int y = 0;
+    int w = 0;
+    int h = 0;
+};
+
+class BlobReader;
+class BlobWriter;
+class DistanceField;
+
 class Terrain {
 public:
-    Terrain() = default;
+    // World pixels per tile side
+    static constexpr float TILE_PX = 8.0f;
+
+    Terrain();
     Terrain(int width, int height, unsigned int seed);
-    ~Terrain() = default;
+    Terrain(Terrain&&) noexcept;
+    Terrain& operator=(Terrain&&) noexcept;
+    ~Terrain();
 
     void setTile(int x, int y, const Tile& tile);
-    void generate();
+    // Generates every chunk now. Chunk blocks run on threadCount threads
+    // (0 = every hardware thread); the result does not depend on the count.
+    // Without this call chunks are generated one by one on first access,
+    // with identical contents.
+    void generate(int threadCount = 0);
     void generateActualPlayMap();
     void addArchipelago(float cx, float cy, float sizeX, float sizeY, int islandCount, int seed);
+    // Every tile plus the distance field, for the generated-world cache.
+    // load expects a Terrain constructed with the same size and seed, and
+    // leaves it as generate() would.
+    void save(BlobWriter& out) const;
+    bool load(BlobReader& in);
+    // Out-of-map coordinates return a blank scratch tile
     Tile& getTile(int x, int y);
     const Tile& getTile(int x, int y) const;
     
     const Tile* getTileAt(float worldX, float worldY) const;
     const TileProperties* getTilePropertiesAt(float worldX, float worldY) const;
     const Biome* getBiomeAt(float worldX, float worldY) const;
-    bool canWalk(float worldX, float worldY) const;
-    bool canBuild(float worldX, float worldY) const;
-    float getDamageAt(float worldX, float worldY) const;
-    float getMoveSpeedAt(float worldX, float worldY) const;
+
+    // ── Chunks ──
+    // Tiles live in CHUNK_SIZE x CHUNK_SIZE chunks, generated from the seed
+    // the first time any query touches them; concurrent queries are safe.
+    // trimResident evicts the least recently used chunks beyond the budget.
+    // Chunks changed since generation go to an on-disk cache and are read
+    // back on the next access; unchanged ones are regenerated. A failed read
+    // throws std::runtime_error rather than regenerating over the edits.
+    static constexpr int CHUNK_SHIFT = 6;
+    static constexpr int CHUNK_SIZE = 1 << CHUNK_SHIFT;
+    static constexpr int CHUNK_MASK = CHUNK_SIZE - 1;
+    static constexpr int CHUNK_TILES = CHUNK_SIZE * CHUNK_SIZE;
+
+    struct ChunkStats {
+        size_t resident = 0;
+        size_t residentBytes = 0;
+        size_t generated = 0;
+        size_t loadedFromDisk = 0;
+        size_t writtenToDisk = 0;
+        size_t evicted = 0;
+    };
+    ChunkStats getChunkStats() const;
+
+    // Whether chunk (cx, cy) is in memory; unlike the tile queries, never loads it
+    bool isChunkResident(int cx, int cy) const {
+        return chunkTable && chunkTable[cy * chunksX + cx].load(std::memory_order_acquire) != nullptr;
+    }
+
+    // Chunks trimResident keeps; 0 keeps every chunk
+    void setResidentChunkBudget(size_t chunks);
+    // Evicts down to the budget. Invalidates tile pointers and references
+    // handed out earlier; never call it while other threads use the terrain.
+    void trimResident();
+
+    // ── Derived grids ──
+    // One flag byte and one biome byte per tile, kept in step with the tiles
+    // by generation, setTile and refreshDerived. The queries below read only
+    // these and the small per-biome tables.
+    enum TileFlag : uint8_t {
+        TILE_WALKABLE  = 1 << 0,
+        TILE_BUILDABLE = 1 << 1,
+        TILE_WATER     = 1 << 2,
+        TILE_SWIMMABLE = 1 << 3,
+        TILE_DAMAGING  = 1 << 4,
+    };
+
+    // Flags of tile (x, y), 0 off the map
+    uint8_t getTileFlags(int x, int y) const {
+        if (x < 0 || x >= width || y < 0 || y >= height) return 0;
+        return chunkAt(x, y).flags[localIndex(x, y)];
+    }
+    // Flags of the tile under a world position, 0 off the map
+    uint8_t getTileFlagsAt(float worldX, float worldY) const {
+        return getTileFlags((int)(worldX / TILE_PX), (int)(worldY / TILE_PX));
+    }
+
+    bool canWalk(float worldX, float worldY) const { return (getTileFlagsAt(worldX, worldY) & TILE_WALKABLE) != 0; }
+    bool canBuild(float worldX, float worldY) const { return (getTileFlagsAt(worldX, worldY) & TILE_BUILDABLE) != 0; }
+    bool isWaterAt(float worldX, float worldY) const { return (getTileFlagsAt(worldX, worldY) & TILE_WATER) != 0; }
+    float getDamageAt(float worldX, float worldY) const {
+        int tx = (int)(worldX / TILE_PX);
+        int ty = (int)(worldY / TILE_PX);
+        if (tx < 0 || tx >= width || ty < 0 || ty >= height) return 0.0f;
+        return biomeDamage[chunkAt(tx, ty).biomes[localIndex(tx, ty)]];
+    }
+    float getMoveSpeedAt(float worldX, float worldY) const {
+        int tx = (int)(worldX / TILE_PX);
+        int ty = (int)(worldY / TILE_PX);
+        if (tx < 0 || tx >= width || ty < 0 || ty >= height) return 1.0f;
+        return biomeMoveSpeed[chunkAt(tx, ty).biomes[localIndex(tx, ty)]];
+    }
+
+    // Re-derives the grids for rect and marks its chunks changed; call after
+    // editing tiles through getTile
+    void refreshDerived(TileRect rect);
     
     const TileProperties& getTileProperties(int x, int y) const;
     
-    const VegetationData* getVegetationAt(float worldX, float worldY) const;
-    const OreData* getOreAt(float worldX, float worldY) const;
-    
-    void draw() const;
+    std::optional<VegetationData> getVegetationAt(float worldX, float worldY) const;
+    std::optional<OreData> getOreAt(float worldX, float worldY) const;
 
     int getWidth() const { return width; }
     int getHeight() const { return height; }
 
     bool isPassable(int x, int y) const;
+    // Move speed of tile (x, y), 1 off the map like getMoveSpeedAt
+    float getTileMoveSpeed(int x, int y) const {
+        if (x < 0 || x >= width || y < 0 || y >= height) return 1.0f;
+        return biomeMoveSpeed[chunkAt(x, y).biomes[localIndex(x, y)]];
+    }
+    // Cost per unit of distance of walking across tile (x, y), i.e. the
+    // inverse move speed; negative when the tile cannot be walked
+    float getWalkCost(int x, int y) const {
+        if (!isPassable(x, y)) return -1.0f;
+        float speed = getTileMoveSpeed(x, y);
+        return speed > 0.0f ? 1.0f / speed : -1.0f;
+    }
+    // Nearest passable tile other than the target, searched ring by ring
+    // and row by row within each ring. Maps built by generate() keep a
+    // DistanceField that answers blocked in-map targets in O(1).
     bool findNearestPassable(int targetX, int targetY, int& outX, int& outY, int maxRadius = 10) const;
+    // Tiles (Chebyshev) from (x, y) to the nearest water tile: 0 on water,
+    // capped at DistanceField::RADIUS + 1
+    int getWaterDistance(int x, int y) const;
 
     const std::vector<Biome>& getBiomes() const { return biomes; }
     int getBiomeCount() const { return (int)biomes.size(); }
-    int getBiomeIndex(float elevation, float moisture, float temperature) const;
+    // Tile::biomeIndex is an int8_t, so a catalogue holds at most 128 biomes
+    static constexpr int MAX_BIOMES = INT8_MAX + 1;
+    // Replaces the catalogue and recompiles everything derived from it.
+    // Tiles keep their biome indices. Throws std::length_error past
+    // MAX_BIOMES, leaving the old catalogue in place.
+    void setBiomes(std::vector<Biome> newBiomes);
+    // First biome whose elevation band holds elevation, else 0. Moisture and
+    // temperature are not part of the classification yet.
+    int getBiomeIndex(float elevation, float moisture, float temperature) const {
+        (void)moisture;
+        (void)temperature;
+        return biomeLut.lookup(elevation);
+    }
 
 private:
-    int width;
-    int height;
-    unsigned int seed;
-    std::vector<Tile> tiles;
+    // Chunk::biomes value for tiles with no biome
+    static constexpr uint8_t NO_BIOME = 255;
+
+    struct Chunk {
+        Tile tiles[CHUNK_TILES];
+        uint8_t flags[CHUNK_TILES];
+        uint8_t biomes[CHUNK_TILES];
+        // trimResident epoch of the last access
+        std::atomic<uint32_t> lastUsed{0};
+        // Tiles differ from the seed's output and from any cached copy
+        bool modified = false;
+    };
+    // Chunk table, disk cache and counters; defined in terrain.cpp
+    struct ChunkStore;
+
+    int width = 0;
+    int height = 0;
+    unsigned int seed = 0;
     std::vector<Biome> biomes;
 
-    float fade(float t) const;
-    float lerp(float a, float b, float t) const;
-    float grad(int hash, float x, float y) const;
-    float perlinNoise(float x, float y) const;
-    float fbm(float x, float y, int octaves) const;
+    int chunksX = 0;
+    int chunksY = 0;
+    std::unique_ptr<ChunkStore> store;
+    // Nearest-passable and water-distance transform; generate() builds it,
+    // setTile and refreshDerived keep it current
+    std::unique_ptr<DistanceField> distances;
+    // store's table, kept here so the inline queries avoid a second hop
+    std::atomic<Chunk*>* chunkTable = nullptr;
+    uint32_t useEpoch = 1;
+
+    // Indexed by Chunk::biomes; NO_BIOME keeps the off-biome defaults
+    float biomeMoveSpeed[256] = {};
+    float biomeDamage[256] = {};
+    uint8_t biomeFlags[256] = {};
+    BiomeLut biomeLut;
+
+    static int localIndex(int tx, int ty) { return (ty & CHUNK_MASK) * CHUNK_SIZE + (tx & CHUNK_MASK); }
+
+    // Resident chunk holding tile (tx, ty), loading it first if needed
+    Chunk& chunkAt(int tx, int ty) const {
+        int ci = (ty >> CHUNK_SHIFT) * chunksX + (tx >> CHUNK_SHIFT);
+        Chunk* c = chunkTable[ci].load(std::memory_order_acquire);
+        if (!c) c = loadChunk(ci);
+        if (c->lastUsed.load(std::memory_order_relaxed) != useEpoch) {
+            c->lastUsed.store(useEpoch, std::memory_order_relaxed);
+        }
+        return *c;
+    }
+    Chunk* loadChunk(int ci) const;
+    void generateChunk(Chunk& chunk, int cx, int cy) const;
+    void dropAllChunks();
+
+    void buildBiomeTables();
+    void refreshTile(Chunk& chunk, int local) const;
+
+    // Seed-shifted Perlin permutation, built once by the constructor
+    int perm[512] = {};
+
+    void buildPermutation();
 
     float distToRegion(int px, int py, int rx1, int ry1, int rx2, int ry2) const;
     void carveRegion(int x1, int y1, int x2, int y2, float edgeFade, int biomeIdx);
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <raylib.h>
+#include "terrain/terrain.h"
+
+// Final on-screen colour of one tile: biome colour with depth/elevation
+// shading, per-tile jitter and snow whitening. Needs no window.
+Color ShadeTerrainTile(const Terrain& terrain, int x, int y);
+
+// Writes ShadeTerrainTile for every tile of rect into out, row by row with
+// rect.w colours per row
+void BakeTerrainColors(const Terrain& terrain, TileRect rect, Color* out);
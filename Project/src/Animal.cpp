@@ -1,18 +1,20 @@
 // src/Animal.cpp
 #include "npc/Animal.h"
 #include "terrain/terrain.h"
+#include "terrain/blob.h"
 #include <cmath>
 #include "raymath.h"
 
-Animal::Animal(Vector2 pos) : position(pos), speed(DEFAULT_SPEED), hunger(100.0f) {
-    velocity = { (float)GetRandomValue(-10, 10) / 10.0f, (float)GetRandomValue(-10, 10) / 10.0f };
+Animal::Animal(Vector2 pos, Rng& spawnRng)
+    : position(pos), speed(DEFAULT_SPEED), hunger(100.0f), rng(spawnRng.NextU32()) {
+    velocity = { (float)RandomInt(rng, -10, 10) / 10.0f, (float)RandomInt(rng, -10, 10) / 10.0f };
 }
 
 void Animal::Wander(float deltaTime, const Terrain* terrain) {
     Vector2 newPos = position;
-    if (GetRandomValue(0, 100) < 2) {
-        velocity.x += (float)GetRandomValue(-5, 5) / 10.0f;
-        velocity.y += (float)GetRandomValue(-5, 5) / 10.0f;
+    if (RandomInt(rng, 0, 100) < 2) {
+        velocity.x += (float)RandomInt(rng, -5, 5) / 10.0f;
+        velocity.y += (float)RandomInt(rng, -5, 5) / 10.0f;
 
         if (Vector2Length(velocity) > 0) {
             velocity = Vector2Normalize(velocity);
@@ -49,20 +51,17 @@ void Animal::Update(float deltaTime, const Terrain* terrain) {
     hunger -= HUNGER_DECAY_RATE * deltaTime;
 }
 
-void Animal::Draw() const {
-    // ... без изменений (как было)
-    if (textureLoaded) {
-        float desiredWidth = 32.0f;
-        float desiredHeight = 32.0f;
-        float flip = (velocity.x < 0) ? -1.0f : 1.0f;
-        Rectangle src = { 0.0f, 0.0f, (float)texture.width * flip, (float)texture.height };
-        Rectangle dst = { position.x, position.y, desiredWidth, desiredHeight };
-        Vector2 origin = { desiredWidth / 2.0f, desiredHeight };
-        DrawTexturePro(texture, src, dst, origin, 0.0f, WHITE);
-    } else {
-        DrawRectangleV({position.x - 5, position.y - 5}, {10, 10}, GOLD);
-    }
+void Animal::save(BlobWriter& out) const {
+    out.put(position);
+    out.put(velocity);
+    out.put(speed);
+    out.put(hunger);
+    out.put(health);
+    out.put(alive);
+    out.put(rng);
 }
 
-Texture2D Animal::texture = { 0 };
-bool Animal::textureLoaded = false;
\ No newline at end of file
+bool Animal::load(BlobReader& in) {
+    return in.get(position) && in.get(velocity) && in.get(speed) && in.get(hunger) &&
+           in.get(health) && in.get(alive) && in.get(rng);
+}
@@ -3,16 +3,17 @@
 #include "npc/civilian_behavior.h"
 
 // Updates bandit movement and combat behavior
-void BanditBehavior::Update(World& world, NPC& npc, float dt) {
-    npc.attackCooldown -= dt;
-    if (npc.attackCooldown < 0.0f) npc.attackCooldown = 0.0f;
+void BanditBehavior::Update(BehaviorContext& ctx, NpcRef npc, float dt) {
+    World& world = ctx.world;
 
-    npc.banditLifeTime += dt;
+    npc.cold.attackCooldown -= dt;
+    if (npc.cold.attackCooldown < 0.0f) npc.cold.attackCooldown = 0.0f;
+
+    npc.bandit.banditLifeTime += dt;
 
     const float AGGRO_RADIUS = 140.0f;
 
     const Settlement* targetSettlement = nullptr;
-    NPC* victim = nullptr;
     float bestDist2 = 1e9f;
     for (const auto& s : world.settlements) {
         if (PointInSettlementPx(s, npc.pos)) {
@@ -22,7 +23,7 @@ void BanditBehavior::Update(World& world, NPC& npc, float dt) {
     }
 
     // Despawn bandits that never find a settlement
-    if (!targetSettlement && npc.banditLifeTime > 90.0f) {
+    if (!targetSettlement && npc.bandit.banditLifeTime > 90.0f) {
         npc.pos = { -1000.0f, -1000.0f };
         return;
     }
@@ -30,13 +31,18 @@ void BanditBehavior::Update(World& world, NPC& npc, float dt) {
     float terrainSpeed = world.terrain.getMoveSpeedAt(npc.pos.x, npc.pos.y);
     float swimSpeed = 0.3f;
     float effectiveSpeed = (terrainSpeed > 0.0f) ? terrainSpeed : swimSpeed;
-    float baseSpeed = npc.speed * 0.55f * effectiveSpeed;
+    float baseSpeed = npc.cold.speed * 0.55f * effectiveSpeed;
     Vector2 desiredDir;
-    NPC* targetWarrior = nullptr;
+    std::optional<ConstNpcRef> targetWarrior;
 
-    for (auto& other : world.npcs) {
-        if (!other.alive) continue;
-        if (other.humanRole != NPC::HumanRole::WARRIOR) continue;
+    NpcQueryFilter warriorFilter;
+    warriorFilter.Roles({NPC::HumanRole::WARRIOR}).IncludeDying();
+
+    std::vector<int> nearby;
+    world.npcGrid.QueryRadius(world.npcs, npc.pos, AGGRO_RADIUS, warriorFilter, nearby);
+
+    for (int i : nearby) {
+        ConstNpcRef other = world.npcs[i];
 
         float dx = other.pos.x - npc.pos.x;
         float dy = other.pos.y - npc.pos.y;
@@ -44,22 +50,22 @@ void BanditBehavior::Update(World& world, NPC& npc, float dt) {
 
         if (d2 < AGGRO_RADIUS * AGGRO_RADIUS && d2 < bestDist2) {
             bestDist2 = d2;
-            targetWarrior = &other;
+            targetWarrior.emplace(other);
         }
     }
 
     if (targetSettlement) {
             Vector2 noise = {
-                    RandomFloat(-1.0f, 1.0f),
-                    RandomFloat(-1.0f, 1.0f)
+                    RandomFloat(ctx.rng, -1.0f, 1.0f),
+                    RandomFloat(ctx.rng, -1.0f, 1.0f)
             };
             noise = SafeNormalize(noise);
 
-            npc.banditGroupDir.x = npc.banditGroupDir.x * 0.8f + noise.x * 0.2f;
-            npc.banditGroupDir.y = npc.banditGroupDir.y * 0.8f + noise.y * 0.2f;
-            npc.banditGroupDir = SafeNormalize(npc.banditGroupDir);
+            npc.bandit.banditGroupDir.x = npc.bandit.banditGroupDir.x * 0.8f + noise.x * 0.2f;
+            npc.bandit.banditGroupDir.y = npc.bandit.banditGroupDir.y * 0.8f + noise.y * 0.2f;
+            npc.bandit.banditGroupDir = SafeNormalize(npc.bandit.banditGroupDir);
 
-            desiredDir = npc.banditGroupDir;
+            desiredDir = npc.bandit.banditGroupDir;
         baseSpeed *= 0.5f;
     } else {
         if (targetWarrior) {
@@ -69,16 +75,16 @@ void BanditBehavior::Update(World& world, NPC& npc, float dt) {
             };
             desiredDir = SafeNormalize(toEnemy);
 
-            npc.banditGroupDir = desiredDir;
+            npc.bandit.banditGroupDir = desiredDir;
         } else {
-            desiredDir = npc.banditGroupDir;
+            desiredDir = npc.bandit.banditGroupDir;
         };
     }
 
     float noiseStrength = targetWarrior ? 0.2f : 0.6f;
     Vector2 noise = {
-            RandomFloat(-1.0f, 1.0f),
-            RandomFloat(-1.0f, 1.0f)
+            RandomFloat(ctx.rng, -1.0f, 1.0f),
+            RandomFloat(ctx.rng, -1.0f, 1.0f)
     };
     noise = SafeNormalize(noise);
 
@@ -97,24 +103,22 @@ void BanditBehavior::Update(World& world, NPC& npc, float dt) {
 
     npc.pos.x = Clamp(npc.pos.x, margin, world.worldW - margin);
     npc.pos.y = Clamp(npc.pos.y, margin, world.worldH - margin);
-    for (auto& other : world.npcs) {
+    NpcQueryFilter preyFilter;
+    preyFilter.ExceptRole(NPC::HumanRole::BANDIT).NotInSettlement(npc.settlementId).IncludeDying();
+    world.npcGrid.QueryRadius(world.npcs, npc.pos, 16.0f, preyFilter, nearby);
+
+    for (int i : nearby) {
+        ConstNpcRef other = world.npcs[i];
         if (!other.alive) continue;
-        if (other.settlementId == npc.settlementId) continue;
-        if (other.humanRole == NPC::HumanRole::BANDIT) continue;
 
         float dx = other.pos.x - npc.pos.x;
         float dy = other.pos.y - npc.pos.y;
 
         if (dx*dx + dy*dy < 16.0f * 16.0f) {
-            if (npc.attackCooldown <= 0.0f) {
+            if (npc.cold.attackCooldown <= 0.0f) {
                 world.BeginNpcAttack(npc, other.pos);
-                other.hp -= npc.damage;
-                npc.attackCooldown = 1.00f;
-
-                if (other.hp <= 0.0f) {
-                    other.hp = 0.0f;
-                    world.BeginNpcDeath(other);
-                }
+                ctx.DamageNpc(i, npc.cold.damage);
+                npc.cold.attackCooldown = 1.00f;
             }
         }
     }
@@ -43,9 +43,9 @@ static Vector2 RotateFromBaseY(Vector2 local, Vector2 forward) {
 
 namespace CaptainFormation {
     // Returns the captain-facing vector used by formation slots
-    Vector2 GetCaptainFacing(const NPC& captain) {
-        if (captain.captainHasMoveOrder) {
-            Vector2 toTarget = Vector2Subtract(captain.captainMoveTarget, captain.pos);
+    Vector2 GetCaptainFacing(ConstNpcRef captain) {
+        if (captain.captain.captainHasMoveOrder) {
+            Vector2 toTarget = Vector2Subtract(captain.captain.captainMoveTarget, captain.pos);
             if (Vector2Length(toTarget) > 0.1f) return SafeNormalizeEx(toTarget);
         }
 
@@ -87,7 +87,7 @@ namespace CaptainFormation {
 
 } // namespace CaptainFormation
 
-static void MoveTowards(World& world, NPC& npc, Vector2 target, float dt, float speedMul = 1.0f) {
+static void MoveTowards(World& world, NpcRef npc, Vector2 target, float dt, float speedMul = 1.0f) {
     float terrainSpeed = world.terrain.getMoveSpeedAt(npc.pos.x, npc.pos.y);
     if (terrainSpeed <= 0.0f) {
         npc.vel = {0, 0};
@@ -100,60 +100,24 @@ static void MoveTowards(World& world, NPC& npc, Vector2 target, float dt, float
     }
 
     Vector2 dir = SafeNormalizeEx(to);
-    npc.vel = Vector2Scale(dir, npc.speed * speedMul * terrainSpeed);
+    npc.vel = Vector2Scale(dir, npc.cold.speed * speedMul * terrainSpeed);
     npc.pos = Vector2Add(npc.pos, Vector2Scale(npc.vel, dt));
 }
 
-static int FindNearestBanditInRange(World& world, Vector2 from, float rangePx) {
-    const float r2 = rangePx * rangePx;
-    int best = -1;
-    float bestD2 = FLT_MAX;
-
-    for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const auto& o = world.npcs[i];
-        if (!o.alive) continue;
-        if (o.humanRole != NPC::HumanRole::BANDIT) continue;
-
-        float d2 = Dist2(o.pos, from);
-        if (d2 <= r2 && d2 < bestD2) {
-            bestD2 = d2;
-            best = i;
-        }
-    }
-
-    return best;
-}
-
-static int FindNearestBanditInGroup(World& world, Vector2 from, int groupId) {
-    int best = -1;
-    float bestD2 = FLT_MAX;
-
-    for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const auto& o = world.npcs[i];
-        if (!o.alive) continue;
-        if (o.humanRole != NPC::HumanRole::BANDIT) continue;
-        if (o.banditGroupId != groupId) continue;
-
-        float d2 = Dist2(o.pos, from);
-        if (d2 < bestD2) {
-            bestD2 = d2;
-            best = i;
-        }
-    }
-
-    return best;
-}
-
 static int FindThreatBanditNearSettlement(World& world, const Settlement& s, Vector2 from) {
     Rectangle threatRect = ExpandRect(s.boundsPx, 80.0f);
 
+    NpcQueryFilter filter;
+    filter.Roles({NPC::HumanRole::BANDIT}).IncludeDying();
+
+    std::vector<int> candidates;
+    world.npcGrid.QueryRect(world.npcs, threatRect, filter, candidates);
+
     int best = -1;
     float bestD2 = FLT_MAX;
 
-    for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const auto& o = world.npcs[i];
-        if (!o.alive) continue;
-        if (o.humanRole != NPC::HumanRole::BANDIT) continue;
+    for (int i : candidates) {
+        ConstNpcRef o = world.npcs[i];
         if (!PointInRectPx(threatRect, o.pos)) continue;
 
         float d2 = Dist2(o.pos, from);
@@ -166,69 +130,6 @@ static int FindThreatBanditNearSettlement(World& world, const Settlement& s, Vec
     return best;
 }
 
-static int FindNearestEnemyNpcForSettlementWar(World& world, const NPC& attacker, int enemySettlementId, float maxDistPx) {
-    float bestD2 = maxDistPx * maxDistPx;
-    int bestIndex = -1;
-    int bestPriority = 999;
-
-    for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const NPC& other = world.npcs[i];
-        if (!other.alive || other.isDying) continue;
-        if (other.settlementId != enemySettlementId) continue;
-        if (other.id == attacker.id) continue;
-
-        int priority = 999;
-        if (other.humanRole == NPC::HumanRole::WARRIOR) priority = 0;
-        else if (other.humanRole == NPC::HumanRole::CAPTAIN) priority = 1;
-        else if (other.humanRole == NPC::HumanRole::CIVILIAN) priority = 2;
-        else continue;
-
-        float dx = other.pos.x - attacker.pos.x;
-        float dy = other.pos.y - attacker.pos.y;
-        float d2 = dx*dx + dy*dy;
-
-        if (d2 > bestD2) continue;
-
-        if (priority < bestPriority || (priority == bestPriority && d2 < bestD2)) {
-            bestPriority = priority;
-            bestD2 = d2;
-            bestIndex = i;
-        }
-    }
-
-    return bestIndex;
-}
-
-static int FindNearestEnemyCombatNearNpc(World& world, const NPC& npc, float radiusPx) {
-    float bestD2 = radiusPx * radiusPx;
-    int bestIndex = -1;
-    int bestPriority = 999;
-
-    for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const NPC& other = world.npcs[i];
-        if (!other.alive || other.isDying) continue;
-        if (other.settlementId == npc.settlementId) continue;
-
-        int priority = 999;
-        if (other.humanRole == NPC::HumanRole::WARRIOR) priority = 0;
-        else if (other.humanRole == NPC::HumanRole::CAPTAIN) priority = 1;
-        else continue;
-
-        float dx = other.pos.x - npc.pos.x;
-        float dy = other.pos.y - npc.pos.y;
-        float d2 = dx*dx + dy*dy;
-        if (d2 > bestD2) continue;
-
-        if (priority < bestPriority || (priority == bestPriority && d2 < bestD2)) {
-            bestPriority = priority;
-            bestD2 = d2;
-            bestIndex = i;
-        }
-    }
-
-    return bestIndex;
-}
-
 static int FindNearestAliveBarracksIndex(const Settlement& s, Vector2 fromPos)
 {
     float bestD2 = 1e30f;
@@ -252,72 +153,44 @@ static int FindNearestAliveBarracksIndex(const Settlement& s, Vector2 fromPos)
     return bestIndex;
 }
 
-static int FindNearestHostileTroopNearSettlement(World& world, int homeSettlementId, Vector2 homePos, float maxDistPx) {
-    float bestD2 = maxDistPx * maxDistPx;
-    int bestIndex = -1;
-    int bestPriority = 999;
-
-    for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const NPC& other = world.npcs[i];
-        if (!other.alive || other.isDying) continue;
-        if (other.settlementId == homeSettlementId) continue;
-
-        int priority = 999;
-        if (other.humanRole == NPC::HumanRole::WARRIOR) priority = 0;
-        else if (other.humanRole == NPC::HumanRole::CAPTAIN) priority = 1;
-        else if (other.humanRole == NPC::HumanRole::CIVILIAN) priority = 2;
-        else continue;
-
-        float dx = other.pos.x - homePos.x;
-        float dy = other.pos.y - homePos.y;
-        float d2 = dx*dx + dy*dy;
-        if (d2 > bestD2) continue;
-
-        if (priority < bestPriority || (priority == bestPriority && d2 < bestD2)) {
-            bestPriority = priority;
-            bestD2 = d2;
-            bestIndex = i;
-        }
-    }
+static void TryMeleeAttack(BehaviorContext& ctx, NpcRef attacker, int targetIndex, float dt, float cooldownSeconds) {
+    attacker.cold.attackCooldown -= dt;
+    if (attacker.cold.attackCooldown > 0.0f) return;
 
-    return bestIndex;
+    ctx.world.BeginNpcAttack(attacker, ctx.world.npcs.Pos(targetIndex));
+    ctx.DamageNpc(targetIndex, attacker.cold.damage);
+    attacker.cold.attackCooldown = cooldownSeconds;
 }
 
-static void TryMeleeAttack(World& world, NPC& attacker, NPC& target, float dt, float cooldownSeconds) {
-    attacker.attackCooldown -= dt;
-    if (attacker.attackCooldown > 0.0f) return;
-
-    world.BeginNpcAttack(attacker, target.pos);
-    target.hp -= attacker.damage;
-    attacker.attackCooldown = cooldownSeconds;
-
-    if (target.hp <= 0.0f) {
-        target.hp = 0.0f;
-        world.BeginNpcDeath(target);
-    }
-}
+static void RefreshCaptainSquad(BehaviorContext& ctx, NpcRef captain) {
+    World& world = ctx.world;
 
-static void RefreshCaptainSquad(World& world, NPC& captain) {
     if (captain.settlementId < 0 || captain.settlementId >= (int)world.settlements.size()) return;
     if (!world.settlements[captain.settlementId].alive) return;
 
     struct Candidate {
         float d2;
         uint32_t id;
+        int index;
     };
 
-    std::vector<Candidate> candidates;
-    candidates.reserve(64);
+    NpcQueryFilter filter;
+    filter.Roles({NPC::HumanRole::WARRIOR}).IncludeDying();
 
-    for (auto& n : world.npcs) {
-        if (!n.alive) continue;
-        if (n.humanRole != NPC::HumanRole::WARRIOR) continue;
-        if (n.settlementId != captain.settlementId) continue;
+    // A merged settlement holds thousands of warriors; keep the buffers and
+    // read columns rather than building a handle per member
+    thread_local std::vector<int> members;
+    thread_local std::vector<Candidate> candidates;
+    const NpcStore& npcs = world.npcs;
+    world.npcGrid.QuerySettlement(npcs, captain.settlementId, filter, members);
+    candidates.clear();
 
+    for (int i : members) {
         // Keep warriors attached to their current captain
-        if (n.leaderCaptainId != 0 && n.leaderCaptainId != captain.id) continue;
+        uint32_t leader = npcs.Squad(i).leaderCaptainId;
+        if (leader != 0 && leader != captain.id) continue;
 
-        candidates.push_back({ Dist2(n.pos, captain.pos), n.id });
+        candidates.push_back({ Dist2(npcs.Pos(i), captain.pos), npcs.Id(i), i });
     }
 
     std::sort(candidates.begin(), candidates.end(),
@@ -330,39 +203,38 @@ static void RefreshCaptainSquad(World& world, NPC& captain) {
         chosen.push_back(candidates[i].id);
     }
 
-    for (auto& n : world.npcs) {
-        if (!n.alive) continue;
-        if (n.humanRole != NPC::HumanRole::WARRIOR) continue;
-        if (n.leaderCaptainId != captain.id) continue;
+    // A follower may have changed settlement since it joined, so release
+    // links from every warrior rather than only this settlement's
+    for (int i = 0; i < (int)npcs.size(); i++) {
+        if (npcs.Squad(i).leaderCaptainId != captain.id) continue;
+        if (!npcs.IsAlive(i) || npcs.Role(i) != NPC::HumanRole::WARRIOR) continue;
 
         bool stillChosen = false;
         for (uint32_t cid : chosen) {
-            if (cid == n.id) {
+            if (cid == npcs.Id(i)) {
                 stillChosen = true;
                 break;
             }
         }
 
         if (!stillChosen) {
-            n.leaderCaptainId = 0;
-            n.formationSlot = -1;
+            ctx.LeaveSquad(i, captain.id);
         }
     }
 
     for (int slot = 0; slot < (int)chosen.size(); slot++) {
-        NPC* w = world.FindNpcById(chosen[slot]);
-        if (!w) continue;
-        w->leaderCaptainId = captain.id;
-        w->formationSlot = slot;
+        ctx.JoinSquad(candidates[slot].index, captain.id, slot);
     }
 }
 
-static bool ExecuteAttackOrder(World& world, NPC& captain, float dt, int groupId) {
-    int bi = FindNearestBanditInGroup(world, captain.pos, groupId);
+static bool ExecuteAttackOrder(BehaviorContext& ctx, NpcRef captain, float dt, int groupId) {
+    World& world = ctx.world;
+
+    int bi = world.FindNearestBandit(captain.pos, FLT_MAX, groupId);
     if (bi == -1) return false;
 
-    NPC& b = world.npcs[bi];
-    captain.captainAttackTargetId = b.id;
+    ConstNpcRef b = world.npcs[bi];
+    captain.captain.captainAttackTargetId = b.id;
 
     const float meleeRange = 28.0f;
     float d2 = Dist2(captain.pos, b.pos);
@@ -371,74 +243,76 @@ static bool ExecuteAttackOrder(World& world, NPC& captain, float dt, int groupId
         MoveTowards(world, captain, b.pos, dt, 1.0f);
     } else {
         captain.vel = {0, 0};
-        TryMeleeAttack(world, captain, b, dt, 0.75f);
+        TryMeleeAttack(ctx, captain, bi, dt, 0.75f);
     }
 
     return true;
 }
 
 // Updates captain behavior
-void CaptainBehavior::Update(World& world, NPC& npc, float dt) {
+void CaptainBehavior::Update(BehaviorContext& ctx, NpcRef npc, float dt) {
+    World& world = ctx.world;
+
     if (npc.humanRole != NPC::HumanRole::CAPTAIN) return;
 
     if (npc.settlementId < 0 || npc.settlementId >= (int)world.settlements.size() ||
         !world.settlements[npc.settlementId].alive) {
 
-        npc.wanderTimer -= dt;
-        if (npc.wanderTimer <= 0.0f) {
-            npc.wanderTimer = RandomFloat(1.0f, 2.5f);
-            npc.wanderDir = SafeNormalizeEx(RandomUnit2D());
+        npc.cold.wanderTimer -= dt;
+        if (npc.cold.wanderTimer <= 0.0f) {
+            npc.cold.wanderTimer = RandomFloat(ctx.rng, 1.0f, 2.5f);
+            npc.cold.wanderDir = SafeNormalizeEx(RandomUnit2D(ctx.rng));
         }
 
-        npc.vel = Vector2Scale(npc.wanderDir, npc.speed);
+        npc.vel = Vector2Scale(npc.cold.wanderDir, npc.cold.speed);
         npc.pos = Vector2Add(npc.pos, Vector2Scale(npc.vel, dt));
         return;
     }
 
     const Settlement& s = world.settlements[npc.settlementId];
 
-    RefreshCaptainSquad(world, npc);
+    RefreshCaptainSquad(ctx, npc);
 
     // Handle player-issued attack orders
-    if (npc.captainHasAttackOrder && npc.captainAttackGroupId != -1) {
-        if (ExecuteAttackOrder(world, npc, dt, npc.captainAttackGroupId)) {
+    if (npc.captain.captainHasAttackOrder && npc.captain.captainAttackGroupId != -1) {
+        if (ExecuteAttackOrder(ctx, npc, dt, npc.captain.captainAttackGroupId)) {
             return;
         }
 
-        npc.captainHasAttackOrder = false;
-        npc.captainAttackGroupId = -1;
-        npc.captainAttackTargetId = 0;
+        npc.captain.captainHasAttackOrder = false;
+        npc.captain.captainAttackGroupId = -1;
+        npc.captain.captainAttackTargetId = 0;
     }
 
     // Handle settlement war and defense behavior
-    if (npc.warAssigned &&
-        npc.warTargetSettlementId >= 0 &&
-        world.IsSettlementAliveAndValid(npc.warTargetSettlementId) &&
-        !npc.captainHasMoveOrder &&
-        !npc.captainHasAttackOrder)
+    if (npc.war.warAssigned &&
+        npc.war.warTargetSettlementId >= 0 &&
+        world.IsSettlementAliveAndValid(npc.war.warTargetSettlementId) &&
+        !npc.captain.captainHasMoveOrder &&
+        !npc.captain.captainHasAttackOrder)
     {
-        if (npc.warIsDefender &&
+        if (npc.war.warIsDefender &&
             npc.settlementId >= 0 &&
             npc.settlementId < (int)world.settlements.size())
         {
-            npc.warTargetPos = world.settlements[npc.settlementId].centerPx;
+            npc.war.warTargetPos = world.settlements[npc.settlementId].centerPx;
         }
         else {
-            npc.warTargetPos = world.settlements[npc.warTargetSettlementId].centerPx;
+            npc.war.warTargetPos = world.settlements[npc.war.warTargetSettlementId].centerPx;
         }
 
         // Captain stops holding formation and just fights nearby enemy combat units
-        if (npc.warInBattle) {
-            int localEnemyIndex = FindNearestEnemyCombatNearNpc(world, npc, CELL_SIZE * 9.0f);
+        if (npc.war.warInBattle) {
+            int localEnemyIndex = world.FindNearestEnemyCombatNear(npc, CELL_SIZE * 9.0f);
             if (localEnemyIndex != -1) {
-                NPC& enemy = world.npcs[localEnemyIndex];
+                ConstNpcRef enemy = world.npcs[localEnemyIndex];
 
                 float dx = enemy.pos.x - npc.pos.x;
                 float dy = enemy.pos.y - npc.pos.y;
                 float d2 = dx*dx + dy*dy;
 
                 if (d2 <= 18.0f * 18.0f) {
-                    TryMeleeAttack(world, npc, enemy, dt, 0.85f);
+                    TryMeleeAttack(ctx, npc, localEnemyIndex, dt, 0.85f);
                 } else {
                     MoveTowards(world, npc, enemy.pos, dt);
                 }
@@ -454,16 +328,16 @@ void CaptainBehavior::Update(World& world, NPC& npc, float dt) {
         }
 
         // Approach / regroup mode
-        int enemyIndex = FindNearestEnemyNpcForSettlementWar(world, npc, npc.warTargetSettlementId, CELL_SIZE * 26.0f);
+        int enemyIndex = world.FindNearestEnemyForSettlementWar(npc, npc.war.warTargetSettlementId, CELL_SIZE * 26.0f);
         if (enemyIndex != -1) {
-            NPC& enemy = world.npcs[enemyIndex];
+            ConstNpcRef enemy = world.npcs[enemyIndex];
 
             float dx = enemy.pos.x - npc.pos.x;
             float dy = enemy.pos.y - npc.pos.y;
             float d2 = dx*dx + dy*dy;
 
             if (d2 <= 18.0f * 18.0f) {
-                TryMeleeAttack(world, npc, enemy, dt, 0.85f);
+                TryMeleeAttack(ctx, npc, enemyIndex, dt, 0.85f);
             } else {
                 MoveTowards(world, npc, enemy.pos, dt);
             }
@@ -472,8 +346,8 @@ void CaptainBehavior::Update(World& world, NPC& npc, float dt) {
         }
 
         // If no enemy combat troops remain, attack the barracks
-        if (!world.SettlementHasLivingCombatUnits(npc.warTargetSettlementId)) {
-            const Settlement& targetSettlement = world.settlements[npc.warTargetSettlementId];
+        if (!world.SettlementHasLivingCombatUnits(npc.war.warTargetSettlementId)) {
+            const Settlement& targetSettlement = world.settlements[npc.war.warTargetSettlementId];
             int barracksIndex = FindNearestAliveBarracksIndex(targetSettlement, npc.pos);
             if (barracksIndex != -1) {
                 const Barracks& targetBarracks = targetSettlement.barracksList[barracksIndex];
@@ -483,11 +357,11 @@ void CaptainBehavior::Update(World& world, NPC& npc, float dt) {
                 float d2 = dx*dx + dy*dy;
 
                 if (d2 <= 22.0f * 22.0f) {
-                    npc.attackCooldown -= dt;
-                    if (npc.attackCooldown <= 0.0f) {
+                    npc.cold.attackCooldown -= dt;
+                    if (npc.cold.attackCooldown <= 0.0f) {
                         world.BeginNpcAttack(npc, targetBarracks.posPx);
-                        world.DamageSettlementBarracks(npc.warTargetSettlementId, barracksIndex, npc.damage);
-                        npc.attackCooldown = 0.85f;
+                        ctx.DamageBarracks(npc.war.warTargetSettlementId, barracksIndex, npc.cold.damage);
+                        npc.cold.attackCooldown = 0.85f;
                     }
                 } else {
                     MoveTowards(world, npc, targetBarracks.posPx, dt);
@@ -497,16 +371,16 @@ void CaptainBehavior::Update(World& world, NPC& npc, float dt) {
         }
 
         // Continue advancing toward the war target
-        float dx = npc.warTargetPos.x - npc.pos.x;
-        float dy = npc.warTargetPos.y - npc.pos.y;
+        float dx = npc.war.warTargetPos.x - npc.pos.x;
+        float dy = npc.war.warTargetPos.y - npc.pos.y;
         float dist2 = dx*dx + dy*dy;
 
         if (dist2 > CELL_SIZE * CELL_SIZE * 1.5f) {
-            MoveTowards(world, npc, npc.warTargetPos, dt);
+            MoveTowards(world, npc, world.MarchWaypoint(npc, npc.war.warTargetPos), dt);
         } else {
             Vector2 pressurePos = {
-                npc.warTargetPos.x + CELL_SIZE * 0.5f,
-                npc.warTargetPos.y - CELL_SIZE * 0.5f
+                npc.war.warTargetPos.x + CELL_SIZE * 0.5f,
+                npc.war.warTargetPos.y - CELL_SIZE * 0.5f
             };
             MoveTowards(world, npc, pressurePos, dt);
         }
@@ -515,26 +389,26 @@ void CaptainBehavior::Update(World& world, NPC& npc, float dt) {
     }
 
     // Handle direct manual control
-    if (!npc.captainAutoMode) {
-        if (npc.captainHasMoveOrder) {
-            float d2 = Dist2(npc.pos, npc.captainMoveTarget);
+    if (!npc.captain.captainAutoMode) {
+        if (npc.captain.captainHasMoveOrder) {
+            float d2 = Dist2(npc.pos, npc.captain.captainMoveTarget);
             if (d2 < 10.0f * 10.0f) {
-                npc.captainHasMoveOrder = false;
-                npc.manualControl = false;
-                npc.hasMoveTarget = false;
+                npc.captain.captainHasMoveOrder = false;
+                npc.captain.manualControl = false;
+                npc.captain.hasMoveTarget = false;
                 npc.vel = {0, 0};
             } else {
-                MoveTowards(world, npc, npc.captainMoveTarget, dt, 1.0f);
+                MoveTowards(world, npc, npc.captain.captainMoveTarget, dt, 1.0f);
             }
         } else {
-            npc.manualControl = false;
-            npc.hasMoveTarget = false;
+            npc.captain.manualControl = false;
+            npc.captain.hasMoveTarget = false;
             npc.vel = {0, 0};
         }
 
-        int nearBandit = FindNearestBanditInRange(world, npc.pos, 24.0f);
+        int nearBandit = world.FindNearestBandit(npc.pos, 24.0f);
         if (nearBandit != -1) {
-            TryMeleeAttack(world, npc, world.npcs[nearBandit], dt, 0.75f);
+            TryMeleeAttack(ctx, npc, nearBandit, dt, 0.75f);
         }
 
         return;
@@ -543,11 +417,11 @@ void CaptainBehavior::Update(World& world, NPC& npc, float dt) {
     // Handle automatic threat response
     int threatBandit = FindThreatBanditNearSettlement(world, s, npc.pos);
     if (threatBandit != -1) {
-        npc.captainHasAttackOrder = true;
-        npc.captainAttackGroupId = world.npcs[threatBandit].banditGroupId;
-        npc.captainAttackTargetId = world.npcs[threatBandit].id;
+        npc.captain.captainHasAttackOrder = true;
+        npc.captain.captainAttackGroupId = world.npcs[threatBandit].banditGroupId;
+        npc.captain.captainAttackTargetId = world.npcs[threatBandit].id;
 
-        ExecuteAttackOrder(world, npc, dt, npc.captainAttackGroupId);
+        ExecuteAttackOrder(ctx, npc, dt, npc.captain.captainAttackGroupId);
         return;
     }
 
@@ -8,19 +8,16 @@ static float Length(Vector2 v) {
 }
 
 // Picks a random tile center inside a settlement
-static Vector2 RandomPointInSettlement(const World& world, const Settlement& s) {
+static Vector2 RandomPointInSettlement(World& world, Rng& rng, const Settlement& s) {
     if (s.tiles.empty()) {
         return {
-                RandomFloat(0, world.worldW),
-                RandomFloat(0, world.worldH)
+                RandomFloat(rng, 0, world.worldW),
+                RandomFloat(rng, 0, world.worldH)
         };
     }
 
-    int index = GetRandomValue(0, (int)s.tiles.size() - 1);
-    auto it = s.tiles.begin();
-    std::advance(it, index);
-
-    int tile = *it;
+    int index = RandomInt(rng, 0, (int)s.tiles.size() - 1);
+    int tile = s.tiles[index];
     int cx = tile % world.cols;
     int cy = tile / world.cols;
 
@@ -31,8 +28,10 @@ static Vector2 RandomPointInSettlement(const World& world, const Settlement& s)
 }
 
 // Updates civilian wandering behavior
-void CivilianBehavior::Update(World& world, NPC& npc, float dt)
+void CivilianBehavior::Update(BehaviorContext& ctx, NpcRef npc, float dt)
 {
+    World& world = ctx.world;
+
     if (dt <= 0.0f) return;
 
     float terrainSpeed = world.terrain.getMoveSpeedAt(npc.pos.x, npc.pos.y);
@@ -41,7 +40,7 @@ void CivilianBehavior::Update(World& world, NPC& npc, float dt)
         return;
     }
 
-    const float MAX_SPEED = npc.speed * 1.4f * terrainSpeed;
+    const float MAX_SPEED = npc.cold.speed * 1.4f * terrainSpeed;
     const float SLOW_RADIUS = 25.0f;
     const float STOP_RADIUS = 6.0f;
 
@@ -51,7 +50,7 @@ void CivilianBehavior::Update(World& world, NPC& npc, float dt)
             !world.settlements[npc.settlementId].alive)
         {
             npc.settlementId = -1;
-            npc.hasRoamTarget = false;
+            npc.cold.hasRoamTarget = false;
         }
     }
 
@@ -60,47 +59,52 @@ void CivilianBehavior::Update(World& world, NPC& npc, float dt)
             if (!world.settlements[i].alive) continue;
             if (PointInSettlementPx(world.settlements[i], npc.pos)) {
                 npc.settlementId = i;
-                npc.hasRoamTarget = false;
+                npc.cold.hasRoamTarget = false;
                 break;
             }
         }
     }
 
     // Stay idle briefly after reaching a target
-    if (npc.restTimer > 0.0f) {
-        npc.restTimer -= dt;
+    if (npc.cold.restTimer > 0.0f) {
+        npc.cold.restTimer -= dt;
         npc.vel.x *= 0.85f;
         npc.vel.y *= 0.85f;
         return;
     }
 
     // Pick a new roam target when needed
-    if (!npc.hasRoamTarget) {
+    if (!npc.cold.hasRoamTarget) {
         if (npc.settlementId == -1) {
-            npc.roamTarget = {
-                    RandomFloat(0, world.worldW),
-                    RandomFloat(0, world.worldH)
+            npc.cold.roamTarget = {
+                    RandomFloat(ctx.rng, 0, world.worldW),
+                    RandomFloat(ctx.rng, 0, world.worldH)
             };
+            // Try again shortly instead of walking into the coast
+            if (!world.Reachable(npc.pos, npc.cold.roamTarget)) {
+                npc.cold.restTimer = RandomFloat(ctx.rng, 0.2f, 0.6f);
+                return;
+            }
         } else {
-            npc.roamTarget =
-                    RandomPointInSettlement(world,
+            npc.cold.roamTarget =
+                    RandomPointInSettlement(world, ctx.rng,
                                             world.settlements[npc.settlementId]);
         }
 
-        npc.hasRoamTarget = true;
+        npc.cold.hasRoamTarget = true;
     }
 
     // Move toward the current roam target
     Vector2 toTarget = {
-            npc.roamTarget.x - npc.pos.x,
-            npc.roamTarget.y - npc.pos.y
+            npc.cold.roamTarget.x - npc.pos.x,
+            npc.cold.roamTarget.y - npc.pos.y
     };
 
     float dist = Length(toTarget);
 
     if (dist < STOP_RADIUS) {
-        npc.hasRoamTarget = false;
-        npc.restTimer = RandomFloat(0.2f, 0.6f);
+        npc.cold.hasRoamTarget = false;
+        npc.cold.restTimer = RandomFloat(ctx.rng, 0.2f, 0.6f);
         return;
     }
 
@@ -5,22 +5,65 @@
 #include "npc/bandit_behavior.h"
 #include "npc/captain_behavior.h"
 
-void HumanBehavior::Update(World& world, NPC& npc, float dt) {
+// Applies the intent now in serial mode, otherwise queues it for the commit phase
+static void Emit(BehaviorContext& ctx, const NpcIntent& intent) {
+    if (ctx.intents) {
+        ctx.intents->push_back(intent);
+    } else {
+        ctx.world.ApplyNpcIntent(intent);
+    }
+}
+
+void BehaviorContext::DamageNpc(int targetIndex, float damage) {
+    NpcIntent intent;
+    intent.kind = NpcIntent::Kind::DAMAGE_NPC;
+    intent.target = targetIndex;
+    intent.amount = damage;
+    Emit(*this, intent);
+}
+
+void BehaviorContext::DamageBarracks(int settlementId, int barracksIndex, float damage) {
+    NpcIntent intent;
+    intent.kind = NpcIntent::Kind::DAMAGE_BARRACKS;
+    intent.target = settlementId;
+    intent.barracksIndex = barracksIndex;
+    intent.amount = damage;
+    Emit(*this, intent);
+}
+
+void BehaviorContext::JoinSquad(int warriorIndex, uint32_t captainId, int formationSlot) {
+    NpcIntent intent;
+    intent.kind = NpcIntent::Kind::JOIN_SQUAD;
+    intent.target = warriorIndex;
+    intent.captainId = captainId;
+    intent.formationSlot = formationSlot;
+    Emit(*this, intent);
+}
+
+void BehaviorContext::LeaveSquad(int warriorIndex, uint32_t captainId) {
+    NpcIntent intent;
+    intent.kind = NpcIntent::Kind::LEAVE_SQUAD;
+    intent.target = warriorIndex;
+    intent.captainId = captainId;
+    Emit(*this, intent);
+}
+
+void HumanBehavior::Update(BehaviorContext& ctx, NpcRef npc, float dt) {
     switch (npc.humanRole) {
         case NPC::HumanRole::CIVILIAN:
-            CivilianBehavior::Update(world, npc, dt);
+            CivilianBehavior::Update(ctx, npc, dt);
             break;
 
         case NPC::HumanRole::WARRIOR:
-            WarriorBehavior::Update(world, npc, dt);
+            WarriorBehavior::Update(ctx, npc, dt);
             break;
 
         case NPC::HumanRole::CAPTAIN:
-            CaptainBehavior::Update(world, npc, dt);
+            CaptainBehavior::Update(ctx, npc, dt);
             break;
 
         case NPC::HumanRole::BANDIT:
-            BanditBehavior::Update(world, npc, dt);
+            BanditBehavior::Update(ctx, npc, dt);
             break;
 
 
@@ -0,0 +1,70 @@
+#include "environment/npc_density.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "environment/worker_pool.h"
+
+void NpcDensityGrid::Count(const WorldSnapshot& snapshot, const int* indices, int count, Cell* out) const {
+    const int settlementCount = (int)snapshot.settlements.size();
+    for (int k = 0; k < count; k++) {
+        const NpcSnapshot& npc = snapshot.npcs[indices[k]];
+        int cx = (int)std::floor(npc.pos.x / cellPx) - originX;
+        int cy = (int)std::floor(npc.pos.y / cellPx) - originY;
+        if (cx < 0 || cx >= width || cy < 0 || cy >= height) continue;
+
+        // Settlement colour, or the renderer's light grey for the unsettled
+        Color c = { 220, 220, 220, 255 };
+        int sid = npc.settlementId;
+        if (sid >= 0 && sid < settlementCount && snapshot.settlements[sid].alive) c = snapshot.settlements[sid].color;
+
+        Cell& cell = out[(size_t)cy * width + cx];
+        cell.count++;
+        cell.r += c.r;
+        cell.g += c.g;
+        cell.b += c.b;
+    }
+}
+
+void NpcDensityGrid::Build(const WorldSnapshot& snapshot, const std::vector<int>& indices, Rectangle view,
+                           int cell, WorkerPool* pool) {
+    cellPx = std::max(cell, 1);
+    originX = (int)std::floor(view.x / cellPx);
+    originY = (int)std::floor(view.y / cellPx);
+    width = std::max((int)std::floor((view.x + view.width) / cellPx) - originX + 1, 0);
+    height = std::max((int)std::floor((view.y + view.height) / cellPx) - originY + 1, 0);
+    const int cellCount = width * height;
+    cells.assign(cellCount, Cell{});
+
+    // A partial grid costs about as much to clear and merge as counting one
+    // NPC per cell, so sparse crowds are counted in fewer chunks, or one
+    const int count = (int)indices.size();
+    const int threads = pool ? std::min(pool->GetThreadCount(), count / std::max(cellCount, 1)) : 1;
+    const int chunkSize = std::max(MIN_CHUNK, (count + threads - 1) / std::max(threads, 1));
+    const int chunks = threads > 1 ? (count + chunkSize - 1) / chunkSize : 1;
+    if (chunks <= 1) {
+        Count(snapshot, indices.data(), count, cells.data());
+        return;
+    }
+
+    // One pass over the NPCs, each chunk into its own partial grid
+    if ((int)partials.size() < chunks) partials.resize(chunks);
+    pool->ParallelFor(count, chunkSize, [&](int chunk, int begin, int end) {
+        std::vector<Cell>& partial = partials[chunk];
+        partial.assign(cellCount, Cell{});
+        Count(snapshot, indices.data() + begin, end - begin, partial.data());
+    });
+
+    // Then the partials summed cell by cell
+    pool->ParallelFor(cellCount, 4096, [&](int, int begin, int end) {
+        for (int c = 0; c < chunks; c++) {
+            const Cell* partial = partials[c].data();
+            for (int i = begin; i < end; i++) {
+                cells[i].count += partial[i].count;
+                cells[i].r += partial[i].r;
+                cells[i].g += partial[i].g;
+                cells[i].b += partial[i].b;
+            }
+        }
+    });
+}
@@ -0,0 +1,144 @@
+#include "npc/npc_store.h"
+
+#include <stdexcept>
+#include <utility>
+
+void NpcStore::clear() {
+    Truncate(0);
+    idSlots.clear();
+    freeIdSlots.clear();
+}
+
+void NpcStore::reserve(size_t n) {
+    posCol.reserve(n);
+    velCol.reserve(n);
+    roleCol.reserve(n);
+    settlementCol.reserve(n);
+    banditGroupCol.reserve(n);
+    flagCol.reserve(n);
+    hpCol.reserve(n);
+    idCol.reserve(n);
+
+    coldTable.reserve(n);
+    squadTable.reserve(n);
+    captainTable.reserve(n);
+    banditTable.reserve(n);
+    warTable.reserve(n);
+}
+
+void NpcStore::CopySharedFrom(const NpcStore& from) {
+    posCol = from.posCol;
+    velCol = from.velCol;
+    roleCol = from.roleCol;
+    settlementCol = from.settlementCol;
+    banditGroupCol = from.banditGroupCol;
+    flagCol = from.flagCol;
+    hpCol = from.hpCol;
+    idCol = from.idCol;
+
+    coldTable.resize(from.size());
+    squadTable = from.squadTable;
+    captainTable = from.captainTable;
+    banditTable.resize(from.size());
+    warTable = from.warTable;
+
+    idSlots = from.idSlots;
+    freeIdSlots.clear();
+}
+
+void NpcStore::push_back(const NPC& npc) {
+    posCol.push_back(npc.pos);
+    velCol.push_back(npc.vel);
+    roleCol.push_back(npc.humanRole);
+    settlementCol.push_back(npc.settlementId);
+    banditGroupCol.push_back(npc.banditGroupId);
+    flagCol.push_back(Flags{ npc.alive, npc.isDying });
+    hpCol.push_back(npc.hp);
+    idCol.push_back(npc.id);
+
+    coldTable.push_back(npc.cold);
+    squadTable.push_back(npc.squad);
+    captainTable.push_back(npc.captain);
+    banditTable.push_back(npc.bandit);
+    warTable.push_back(npc.war);
+
+    BindId(npc.id, (int)size() - 1);
+}
+
+uint32_t NpcStore::AllocateId() {
+    uint32_t slot;
+    if (!freeIdSlots.empty()) {
+        slot = freeIdSlots.front();
+        freeIdSlots.pop_front();
+    } else {
+        // slot + 1 must fit the id's slot bits, or it would run into the generation
+        if (idSlots.size() >= MAX_ID_SLOTS) throw std::length_error("NpcStore: out of NPC id slots");
+        slot = (uint32_t)idSlots.size();
+        idSlots.push_back({});
+    }
+    idSlots[slot].index = -1;
+    return (idSlots[slot].generation << ID_SLOT_BITS) | (slot + 1u);
+}
+
+void NpcStore::BindId(uint32_t id, int index) {
+    if ((id & ID_SLOT_MASK) == 0) return;
+    uint32_t slot = (id & ID_SLOT_MASK) - 1u;
+
+    // Ids not handed out by AllocateId (tests, restored records) claim their slot as is
+    if (slot >= idSlots.size()) idSlots.resize(slot + 1);
+    if (idSlots[slot].generation != (id >> ID_SLOT_BITS)) return;
+    idSlots[slot].index = index;
+}
+
+void NpcStore::ReleaseId(int index) {
+    uint32_t id = idCol[index];
+    if ((id & ID_SLOT_MASK) == 0) return;
+    uint32_t slot = (id & ID_SLOT_MASK) - 1u;
+    if (slot >= idSlots.size() || idSlots[slot].index != index) return;
+
+    IdSlot& s = idSlots[slot];
+    s.index = -1;
+    // Wrapping would let an id from 4096 releases ago match again
+    if (s.generation == MAX_GENERATION) return;
+    s.generation++;
+    freeIdSlots.push_back(slot);
+}
+
+NPC NpcStore::Get(int i) const {
+    return (*this)[i].Get();
+}
+
+void NpcStore::MoveSlot(int from, int to) {
+    posCol[to] = posCol[from];
+    velCol[to] = velCol[from];
+    roleCol[to] = roleCol[from];
+    settlementCol[to] = settlementCol[from];
+    banditGroupCol[to] = banditGroupCol[from];
+    flagCol[to] = flagCol[from];
+    hpCol[to] = hpCol[from];
+    idCol[to] = idCol[from];
+    if (IndexOf(idCol[to]) == from) idSlots[(idCol[to] & ID_SLOT_MASK) - 1u].index = to;
+
+    coldTable[to] = std::move(coldTable[from]);
+    squadTable[to] = std::move(squadTable[from]);
+    captainTable[to] = std::move(captainTable[from]);
+    banditTable[to] = std::move(banditTable[from]);
+    warTable[to] = std::move(warTable[from]);
+}
+
+void NpcStore::Truncate(size_t n) {
+    posCol.resize(n);
+    velCol.resize(n);
+    roleCol.resize(n);
+    settlementCol.resize(n);
+    banditGroupCol.resize(n);
+    flagCol.resize(n);
+    hpCol.resize(n);
+    idCol.resize(n);
+
+    coldTable.resize(n);
+    squadTable.resize(n);
+    captainTable.resize(n);
+    banditTable.resize(n);
+    warTable.resize(n);
+}
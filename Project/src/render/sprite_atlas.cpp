@@ -0,0 +1,178 @@
+#include "render/sprite_atlas.h"
+
+#include <algorithm>
+
+#include "environment/worker_pool.h"
+
+namespace {
+
+struct Source {
+    std::string name;
+    Image image{};
+};
+
+std::string NormalizePath(std::string path) {
+    std::replace(path.begin(), path.end(), '\\', '/');
+    return path;
+}
+
+// Shelf packing in the given order: left to right, a new shelf when the row
+// is full. Returns the height used, or -1 when a sprite is wider than width.
+int PackShelves(const std::vector<Source>& sources, const std::vector<int>& order, int width,
+                std::vector<Rectangle>& out) {
+    const int pad = SpriteAtlas::PADDING;
+    int x = 0;
+    int y = 0;
+    int shelfH = 0;
+    for (int i : order) {
+        int w = sources[i].image.width + 2 * pad;
+        int h = sources[i].image.height + 2 * pad;
+        if (w > width) return -1;
+        if (x + w > width) {
+            x = 0;
+            y += shelfH;
+            shelfH = 0;
+        }
+        out[i] = { (float)(x + pad), (float)(y + pad), (float)sources[i].image.width, (float)sources[i].image.height };
+        x += w;
+        shelfH = std::max(shelfH, h);
+    }
+    return y + shelfH;
+}
+
+// Copies src into the atlas at rect, repeating its edge texels into the padding
+void Blit(std::vector<Color>& atlas, int atlasW, const Image& src, Rectangle rect) {
+    const Color* pixels = (const Color*)src.data;
+    const int pad = SpriteAtlas::PADDING;
+    for (int y = -pad; y < src.height + pad; y++) {
+        int sy = std::clamp(y, 0, src.height - 1);
+        for (int x = -pad; x < src.width + pad; x++) {
+            int sx = std::clamp(x, 0, src.width - 1);
+            atlas[(size_t)((int)rect.y + y) * atlasW + (int)rect.x + x] = pixels[(size_t)sy * src.width + sx];
+        }
+    }
+}
+
+} // namespace
+
+bool SpriteAtlas::Decode(const std::string& directory, WorkerPool* pool) {
+    Unload();
+    const std::string root = NormalizePath(directory) + "/";
+
+    std::vector<std::string> paths;
+    FilePathList files = LoadDirectoryFilesEx(directory.c_str(), ".png", true);
+    for (unsigned int i = 0; i < files.count; i++) {
+        std::string path = NormalizePath(files.paths[i]);
+        if (path.compare(0, root.size(), root) == 0) paths.push_back(files.paths[i]);
+    }
+    UnloadDirectoryFiles(files);
+    filesFound = (int)paths.size();
+
+    // Each file reads and decodes on its own; failures leave an empty slot
+    std::vector<Source> decoded(paths.size());
+    auto decode = [&](int, int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            Image image = LoadImage(paths[i].c_str());
+            if (image.data == nullptr || image.width <= 0 || image.height <= 0) {
+                TraceLog(LOG_ERROR, "ATLAS: failed to load %s", paths[i].c_str());
+                UnloadImage(image);
+            } else {
+                ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+                std::string path = NormalizePath(paths[i]);
+                decoded[i] = { path.substr(root.size(), path.size() - root.size() - 4), image };
+            }
+            filesDecoded++;
+        }
+    };
+    if (pool) pool->ParallelFor((int)paths.size(), 1, decode);
+    else decode(0, 0, (int)paths.size());
+
+    std::vector<Source> sources;
+    for (Source& d : decoded) {
+        if (d.image.data != nullptr) sources.push_back(std::move(d));
+    }
+
+    // A white texel for shapes, packed like any sprite
+    Image whiteTexel = GenImageColor(1, 1, WHITE);
+    sources.push_back({ "", whiteTexel });
+
+    // Tallest first keeps shelves tight; names break ties so the layout is
+    // the same on every platform
+    std::vector<int> order(sources.size());
+    for (int i = 0; i < (int)order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        if (sources[a].image.height != sources[b].image.height) return sources[a].image.height > sources[b].image.height;
+        if (sources[a].image.width != sources[b].image.width) return sources[a].image.width > sources[b].image.width;
+        return sources[a].name < sources[b].name;
+    });
+
+    // Narrowest power of two wide enough that the atlas is no taller than wide
+    std::vector<Rectangle> placed(sources.size());
+    int width = 64;
+    int height = -1;
+    for (; width <= MAX_SIZE; width *= 2) {
+        height = PackShelves(sources, order, width, placed);
+        if (height >= 0 && height <= width) break;
+    }
+    if (width > MAX_SIZE) {
+        TraceLog(LOG_ERROR, "ATLAS: %d sprites do not fit in %dx%d", (int)sources.size(), MAX_SIZE, MAX_SIZE);
+        for (Source& s : sources) UnloadImage(s.image);
+        return false;
+    }
+    int pow2H = 1;
+    while (pow2H < height) pow2H *= 2;
+
+    packed.assign((size_t)width * pow2H, BLANK);
+    packedW = width;
+    packedH = pow2H;
+    for (size_t i = 0; i < sources.size(); i++) {
+        Blit(packed, width, sources[i].image, placed[i]);
+        UnloadImage(sources[i].image);
+    }
+
+    white = placed.back();
+    placed.pop_back();
+    sources.pop_back();
+    rects = std::move(placed);
+    for (int i = 0; i < (int)sources.size(); i++) ids[sources[i].name] = i;
+    return true;
+}
+
+bool SpriteAtlas::Upload() {
+    if (packed.empty()) return false;
+
+    Image image{ packed.data(), packedW, packedH, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    texture = LoadTextureFromImage(image);
+    if (texture.id == 0) {
+        TraceLog(LOG_ERROR, "ATLAS: failed to upload %dx%d texture", packedW, packedH);
+        Unload();
+        return false;
+    }
+    SetTextureFilter(texture, TEXTURE_FILTER_POINT);
+    SetTextureWrap(texture, TEXTURE_WRAP_CLAMP);
+
+    TraceLog(LOG_INFO, "ATLAS: packed %d sprites into %dx%d", (int)rects.size(), packedW, packedH);
+    packed = std::vector<Color>();
+    return true;
+}
+
+bool SpriteAtlas::Load(const std::string& directory) {
+    return Decode(directory) && Upload();
+}
+
+void SpriteAtlas::Unload() {
+    if (texture.id != 0) UnloadTexture(texture);
+    texture = Texture2D{};
+    packed = std::vector<Color>();
+    packedW = packedH = 0;
+    rects.clear();
+    ids.clear();
+    white = Rectangle{};
+    filesDecoded = 0;
+    filesFound = 0;
+}
+
+int SpriteAtlas::Find(const std::string& name) const {
+    auto it = ids.find(name);
+    return it == ids.end() ? -1 : it->second;
+}
@@ -0,0 +1,62 @@
+#include "render/tile_layer_renderer.h"
+
+#include <algorithm>
+#include <cmath>
+
+void TileLayerRenderer::Sync(const TileLayerSnapshot& layer) {
+    if (loaded && (texture.width != layer.width || texture.height != layer.height)) Unload();
+
+    if (!loaded) {
+        if (layer.width <= 0 || layer.height <= 0) return;
+
+        Image image{};
+        image.data = (void*)layer.pixels.data();
+        image.width = layer.width;
+        image.height = layer.height;
+        image.mipmaps = 1;
+        image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+        texture = LoadTextureFromImage(image);
+        SetTextureFilter(texture, TEXTURE_FILTER_POINT);
+        loaded = true;
+        revision = layer.revision;
+        return;
+    }
+
+    if (!layer.ChangesSince(revision, rects)) {
+        UpdateTexture(texture, layer.pixels.data());
+        revision = layer.revision;
+        return;
+    }
+
+    for (const TileRect& r : rects) {
+        pixels.resize((size_t)r.w * r.h);
+        for (int y = 0; y < r.h; y++) {
+            const Color* row = &layer.pixels[(size_t)(r.y + y) * layer.width + r.x];
+            std::copy(row, row + r.w, &pixels[(size_t)y * r.w]);
+        }
+        UpdateTextureRec(texture, { (float)r.x, (float)r.y, (float)r.w, (float)r.h }, pixels.data());
+    }
+    revision = layer.revision;
+}
+
+void TileLayerRenderer::Draw(Rectangle view, float tilePx) const {
+    if (!loaded) return;
+
+    int x0 = std::max((int)std::floor(view.x / tilePx), 0);
+    int y0 = std::max((int)std::floor(view.y / tilePx), 0);
+    int x1 = std::min((int)std::ceil((view.x + view.width) / tilePx), texture.width);
+    int y1 = std::min((int)std::ceil((view.y + view.height) / tilePx), texture.height);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    Rectangle src = { (float)x0, (float)y0, (float)(x1 - x0), (float)(y1 - y0) };
+    Rectangle dst = { x0 * tilePx, y0 * tilePx, src.width * tilePx, src.height * tilePx };
+    DrawTexturePro(texture, src, dst, { 0.0f, 0.0f }, 0.0f, WHITE);
+}
+
+void TileLayerRenderer::Unload() {
+    if (!loaded) return;
+    UnloadTexture(texture);
+    texture = Texture2D{};
+    loaded = false;
+    revision = 0;
+}
@@ -0,0 +1,618 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "render/world_renderer.h"
+// ------------------------------------------------------------
+
+static std::string PathJoin(const char* a, const char* b) {
+    std::string s = a;
+    if (!s.empty() && s.back() != '/') s += "/";
+    s += b;
+    return s;
+}
+
+// Resolves an asset directory relative to the working directory
+static std::string FindAssetDir(const char* relativePath)
+{
+    const char* wd = GetWorkingDirectory();
+
+    const char* candidates[] = {
+            "",
+            "../",
+            "../../",
+            "../../../"
+    };
+
+    for (const char* base : candidates) {
+        std::string full = PathJoin(wd, (std::string(base) + relativePath).c_str());
+        if (DirectoryExists(full.c_str())) return full;
+    }
+
+    return "";
+}
+
+void WorldRenderer::DecodeAssets()
+{
+    std::string dir = FindAssetDir("assets");
+    if (dir.empty()) {
+        TraceLog(LOG_ERROR, "ASSETS missing (WD=%s)", GetWorkingDirectory());
+        return;
+    }
+    WorkerPool pool;
+    atlas.Decode(dir, &pool);
+}
+
+float WorldRenderer::DecodeProgress() const
+{
+    int found = atlas.filesFound;
+    return found > 0 ? (float)atlas.filesDecoded / (float)found : 0.0f;
+}
+
+void WorldRenderer::Load()
+{
+    DecodeAssets();
+    FinishLoad();
+}
+
+void WorldRenderer::FinishLoad()
+{
+    if (atlas.Upload()) {
+        // Shapes sample the atlas's white texel, so they batch with sprites
+        SetShapesTexture(atlas.texture, atlas.WhiteRect());
+    }
+
+    auto find = [&](const std::string& name, const char* kind) {
+        int id = atlas.Find(name);
+        if (id < 0) TraceLog(LOG_ERROR, "%s missing: assets/%s.png", kind, name.c_str());
+        return id;
+    };
+
+    const char* roleDirs[ROLE_COUNT] = { nullptr, "civilian", "warrior", "bandit", "captain" };
+    for (int r = 0; r < ROLE_COUNT; r++) {
+        for (int i = 0; i < NPC_VARIANTS; i++) {
+            npcSprite[r][i] = roleDirs[r]
+                    ? find(std::string("npc/") + roleDirs[r] + "/" + roleDirs[r] + "_" + std::to_string(i), "NPC SPRITE")
+                    : -1;
+        }
+    }
+
+    for (int i = 0; i < FIRE_FRAMES; i++) {
+        fireSprite[i] = find("environment/fire/fire_" + std::to_string(i), "FIRE");
+    }
+    barracksSprite = find("barracks/barracks_0", "BARRACKS");
+
+    // ТРЕБОВАНИЕ ТЗ: Использование исключений (throw)
+    animalSprite = atlas.Find("npc/animal/animal");
+    if (animalSprite < 0) throw std::runtime_error("Critical error: Horse texture path not found!");
+    flowerSprite = atlas.Find("environment/flower/flower");
+    if (flowerSprite < 0) throw std::runtime_error("Flower texture not found!");
+    treeSprite = atlas.Find("environment/tree/tree");
+    if (treeSprite < 0) throw std::runtime_error("Tree texture not found!");
+}
+
+void WorldRenderer::Unload()
+{
+    atlas.Unload();
+    terrain.Unload();
+    territory.Unload();
+}
+
+void WorldRenderer::Update(float dt)
+{
+    // Advance fire animation
+    fireAnimT += dt;
+    if (fireAnimT >= fireAnimSpeed) {
+        fireAnimT = 0.0f;
+        fireFrame = (fireFrame + 1) % FIRE_FRAMES;
+    }
+}
+
+void WorldRenderer::BatchModel::Submit(unsigned int textureId, bool lines, int vertices) {
+    uint64_t k = ((uint64_t)lines << 32) | textureId;
+    if (used + vertices > BUFFER_VERTICES) {
+        used = 0;
+        drawCalls++;
+    } else if (drawCalls == 0 || k != key) {
+        drawCalls++;
+    }
+    key = k;
+    used += vertices;
+}
+
+void WorldRenderer::DrawSprite(int id, Rectangle dst, Vector2 origin, Color tint, bool flipX) {
+    Rectangle src = atlas.Rect(id);
+    if (flipX) src.width = -src.width;
+    DrawTexturePro(atlas.texture, src, dst, origin, 0.0f, tint);
+    batch.Submit(atlas.texture.id, false, 4);
+}
+
+void WorldRenderer::CountShapes(int quads) {
+    // Without an atlas the id is 0, which stands for raylib's default texture
+    batch.Submit(atlas.texture.id, false, quads * 4);
+}
+
+void WorldRenderer::CountLines(int lines) {
+    batch.Submit(0, true, lines * 2);
+}
+
+// raylib draws a circle as 36 segments, two per quad
+static constexpr int CIRCLE_QUADS = 18;
+
+void WorldRenderer::DrawPlant(const PlantSnapshot& plant) {
+    int sprite = (plant.type == (uint8_t)PlantType::FLOWER) ? flowerSprite : treeSprite;
+    if (sprite >= 0) {
+        float baseSize = (plant.type == (uint8_t)PlantType::TREE) ? Plant::BASE_TREE_SIZE : Plant::BASE_FLOWER_SIZE;
+        float finalSize = baseSize * plant.growthStage;
+        Rectangle dst = { plant.position.x, plant.position.y, finalSize, finalSize };
+        Vector2 origin = { finalSize / 2.0f, finalSize };
+        DrawSprite(sprite, dst, origin, WHITE);
+    } else {
+        DrawCircleV(plant.position, 3.0f * plant.growthStage, plant.color);
+        CountShapes(CIRCLE_QUADS);
+    }
+}
+
+void WorldRenderer::DrawAnimal(const AnimalSnapshot& animal) {
+    if (animalSprite >= 0) {
+        float desiredWidth = 32.0f;
+        float desiredHeight = 32.0f;
+        Rectangle dst = { animal.position.x, animal.position.y, desiredWidth, desiredHeight };
+        Vector2 origin = { desiredWidth / 2.0f, desiredHeight };
+        DrawSprite(animalSprite, dst, origin, WHITE, animal.facingLeft != 0);
+    } else {
+        DrawRectangleV({animal.position.x - 5, animal.position.y - 5}, {10, 10}, GOLD);
+        CountShapes(1);
+    }
+}
+
+//специально для никитоса
+void WorldRenderer::DrawMeteors(const WorldSnapshot& snapshot) {
+    for (const MeteorSnapshot& meteor : snapshot.meteors) {
+        if (meteor.state == Meteor::FALLING) {
+            DrawCircleV(meteor.pos, 12.0f, Color{255, 80, 20, 255});
+            DrawCircleV(meteor.pos, 8.0f, Color{255, 200, 50, 255});
+            CountShapes(2 * CIRCLE_QUADS);
+        } else if (meteor.state == Meteor::EXPLODING) {
+            float pulse = meteor.pulse;
+            float radius = meteor.radius * pulse;
+            DrawCircleV(meteor.targetPos, radius, Color{255, 60, 10, (unsigned char)(100 * pulse)});
+            DrawCircleV(meteor.targetPos, radius * 0.7f, Color{255, 150, 30, (unsigned char)(150 * pulse)});
+            CountShapes(2 * CIRCLE_QUADS);
+        }
+    }
+}
+
+// Returns a fully opaque settlement color
+static Color GetSafeSettlementColor(const WorldSnapshot& w, int sid) {
+    Color c = {220, 220, 220, 255};
+
+    if (sid >= 0 && sid < (int)w.settlements.size() && w.settlements[sid].alive) {
+        c = w.settlements[sid].color;
+    }
+
+    c.a = 255;
+    return c;
+}
+
+// Draws a solid diamond marker
+static void DrawDiamondSolid(Vector2 center, int r, Color col)
+{
+    col.a = 255;
+
+    int cx = (int)center.x;
+    int cy = (int)center.y;
+
+    for (int dy = -r; dy <= 0; dy++) {
+        int half = r + dy;
+        DrawLine(cx - half, cy + dy, cx + half, cy + dy, col);
+    }
+
+    for (int dy = 1; dy <= r; dy++) {
+        int half = r - dy;
+        DrawLine(cx - half, cy + dy, cx + half, cy + dy, col);
+    }
+}
+
+// Draws a diamond outline marker
+static void DrawDiamondOutline(Vector2 center, int r, Color col)
+{
+    col.a = 255;
+    int cx = (int)center.x;
+    int cy = (int)center.y;
+
+    Vector2 top    = {(float)cx,     (float)(cy - r)};
+    Vector2 right  = {(float)(cx+r), (float)cy};
+    Vector2 bottom = {(float)cx,     (float)(cy + r)};
+    Vector2 left   = {(float)(cx-r), (float)cy};
+
+    DrawLineV(top, right, col);
+    DrawLineV(right, bottom, col);
+    DrawLineV(bottom, left, col);
+    DrawLineV(left, top, col);
+}
+
+void WorldRenderer::Sync(const WorldSnapshot& snapshot)
+{
+    terrain.Sync(snapshot.terrain);
+    territory.Sync(snapshot.territory);
+}
+
+Rectangle CameraViewRect(const Camera2D& camera, int screenW, int screenH) {
+    Vector2 a = GetScreenToWorld2D({ 0.0f, 0.0f }, camera);
+    Vector2 b = GetScreenToWorld2D({ (float)screenW, (float)screenH }, camera);
+    return { std::min(a.x, b.x), std::min(a.y, b.y), std::fabs(b.x - a.x), std::fabs(b.y - a.y) };
+}
+
+// Grows r by margin on every side, for sprites drawn around their anchor
+static Rectangle Inflate(Rectangle r, float margin) {
+    return { r.x - margin, r.y - margin, r.width + 2.0f * margin, r.height + 2.0f * margin };
+}
+
+static bool Contains(Rectangle r, Vector2 p) {
+    return p.x >= r.x && p.x <= r.x + r.width && p.y >= r.y && p.y <= r.y + r.height;
+}
+
+// NPC sprites are drawn at CELL_SIZE * 2 times this
+static float NpcSpriteScale(NPC::HumanRole role) {
+    if (role == NPC::HumanRole::CIVILIAN) return 1.15f;
+    if (role == NPC::HumanRole::BANDIT) return 1.05f;
+    if (role == NPC::HumanRole::CAPTAIN) return 1.6f;
+    return 1.0f;
+}
+
+WorldRenderer::NpcLod WorldRenderer::LodForZoom(float zoom) {
+    float spritePx = (float)CELL_SIZE * 2.0f * zoom;
+    if (spritePx >= SPRITES_MIN_SCREEN_PX) return NpcLod::SPRITES;
+    if (spritePx >= QUADS_MIN_SCREEN_PX) return NpcLod::QUADS;
+    return NpcLod::DENSITY;
+}
+
+// Draws the selected captain's ring if it is among the visible NPCs
+void WorldRenderer::DrawSelectedCaptainRing(const WorldSnapshot& snapshot) {
+    if (snapshot.selectedCaptainId == 0) return;
+    for (int index : visible) {
+        const NpcSnapshot& npc = snapshot.npcs[index];
+        if (npc.id != snapshot.selectedCaptainId) continue;
+        DrawCircleLines((int)npc.pos.x, (int)npc.pos.y, CELL_SIZE * 1.3f, YELLOW);
+        DrawCircleLines((int)npc.pos.x, (int)npc.pos.y, CELL_SIZE * 1.3f + 1.0f, BLACK);
+        CountLines(2 * 36);
+        return;
+    }
+}
+
+void WorldRenderer::DrawNpcSprites(const WorldSnapshot& snapshot) {
+    for (int index : visible) {
+        const NpcSnapshot& npc = snapshot.npcs[index];
+        const NPC::HumanRole role = (NPC::HumanRole)npc.role;
+
+        int sprite = NpcSprite(role, npc.variant);
+        float mult = NpcSpriteScale(role);
+        float w = (float)CELL_SIZE * 2.0f * mult;
+        float h = (float)CELL_SIZE * 2.0f * mult;
+
+        Rectangle dst{
+                floorf(npc.pos.x - w * 0.5f),
+                floorf(npc.pos.y - h * 0.5f),
+                w, h
+        };
+
+        if (sprite < 0) {
+            float size = CELL_SIZE * 0.4f;
+            Color c = GetSafeSettlementColor(snapshot, npc.settlementId);
+            Vector2 drawPos = npc.pos;
+
+            if (npc.dying) {
+                c.a = (unsigned char)(255.0f * (1.0f - 0.70f * npc.deathT));
+            }
+
+            if (npc.attackT >= 0.0f) {
+                float pulse = sinf(npc.attackT * PI);
+                float push = 6.0f * pulse;
+                drawPos.x += npc.attackDir.x * push;
+                drawPos.y += npc.attackDir.y * push;
+            }
+
+            switch (role) {
+                case NPC::HumanRole::CIVILIAN:
+                    DrawCircleV(drawPos, size, c);
+                    CountShapes(CIRCLE_QUADS);
+                    break;
+                case NPC::HumanRole::WARRIOR:
+                    DrawRectangle(drawPos.x-size, drawPos.y-size, size*2, size*2, c);
+                    CountShapes(1);
+                    break;
+                case NPC::HumanRole::BANDIT: {
+                    Color banditCol = Color{160,80,200,255};
+                    if (npc.dying) {
+                        banditCol.a = (unsigned char)(255.0f * (1.0f - 0.70f * npc.deathT));
+                    }
+                    DrawTriangle(
+                            {drawPos.x, drawPos.y + CELL_SIZE*0.7f},
+                            {drawPos.x + CELL_SIZE*0.7f, drawPos.y - CELL_SIZE*0.7f},
+                            {drawPos.x - CELL_SIZE*0.7f, drawPos.y - CELL_SIZE*0.7f},
+                            banditCol);
+                    CountShapes(1);
+                    break;
+                }
+                default:
+                    break;
+            }
+            continue;
+        }
+
+        Rectangle drawDst = dst;
+        Color tint = WHITE;
+
+        if (npc.dying) {
+            float t = npc.deathT;
+
+            drawDst.y += floorf(10.0f * t);
+            drawDst.x -= floorf(w * 0.06f * t);
+            drawDst.width = w * (1.0f + 0.12f * t);
+            drawDst.height = h * (1.0f - 0.55f * t);
+
+            tint.a = (unsigned char)(255.0f * (1.0f - 0.70f * t));
+        }
+
+        if (npc.attackT >= 0.0f) {
+            float pulse = sinf(npc.attackT * PI);
+
+            float push = 6.0f * pulse;
+            drawDst.x += npc.attackDir.x * push;
+            drawDst.y += npc.attackDir.y * push;
+
+            drawDst.x -= (drawDst.width * 0.04f * pulse);
+            drawDst.width *= (1.0f + 0.08f * pulse);
+            drawDst.height *= (1.0f - 0.06f * pulse);
+        }
+
+        DrawSprite(sprite, drawDst, Vector2{0,0}, tint);
+    }
+
+    // Selection rings and settlement markers are lines. Drawing them after
+    // all sprites, rather than after each one, keeps the sprites in one batch.
+    for (int index : visible) {
+        const NpcSnapshot& npc = snapshot.npcs[index];
+        const NPC::HumanRole role = (NPC::HumanRole)npc.role;
+        if (NpcSprite(role, npc.variant) < 0) continue;
+
+        if (role == NPC::HumanRole::CAPTAIN && npc.id == snapshot.selectedCaptainId) {
+            DrawCircleLines((int)npc.pos.x, (int)npc.pos.y, CELL_SIZE * 1.3f, YELLOW);
+            DrawCircleLines((int)npc.pos.x, (int)npc.pos.y, CELL_SIZE * 1.3f + 1.0f, BLACK);
+            CountLines(2 * 36);
+        }
+
+        // Draw a settlement marker above the NPC
+        if (npc.settlementId != -1) {
+            Color sc = GetSafeSettlementColor(snapshot, npc.settlementId);
+            sc.a = 255;
+
+            float h = (float)CELL_SIZE * 2.0f * NpcSpriteScale(role);
+            Vector2 c = {
+                    (float)((int)npc.pos.x),
+                    (float)((int)(npc.pos.y - h - 8.0f))
+            };
+
+            const int r = 3;
+            DrawDiamondSolid(c, r, sc);
+            DrawDiamondOutline(c, r, BLACK);
+            CountLines(2 * r + 1 + 4);
+        }
+    }
+
+}
+
+// One flat quad per NPC in its settlement colour, with no animation
+void WorldRenderer::DrawNpcQuads(const WorldSnapshot& snapshot) {
+    for (int index : visible) {
+        const NpcSnapshot& npc = snapshot.npcs[index];
+        const NPC::HumanRole role = (NPC::HumanRole)npc.role;
+        Color c = role == NPC::HumanRole::BANDIT ? Color{160, 80, 200, 255}
+                                                 : GetSafeSettlementColor(snapshot, npc.settlementId);
+        float size = (float)CELL_SIZE * NpcSpriteScale(role);
+        DrawRectangleRec({ npc.pos.x - size * 0.5f, npc.pos.y - size * 0.5f, size, size }, c);
+    }
+    CountShapes((int)visible.size());
+    DrawSelectedCaptainRing(snapshot);
+}
+
+// One splat per grid cell holding NPCs, in their average colour, more
+// opaque the more crowded it is. Cells are a power-of-two number of tiles
+// wide, so they stay put while the camera pans.
+void WorldRenderer::DrawNpcDensity(const WorldSnapshot& snapshot, Rectangle view, float zoom) {
+    int cellPx = CELL_SIZE;
+    while (cellPx * zoom < DENSITY_CELL_SCREEN_PX && cellPx < 1024) cellPx *= 2;
+
+    if (!densityPool) densityPool = std::make_unique<WorkerPool>(std::max(1u, std::thread::hardware_concurrency() / 2));
+    density.Build(snapshot, visible, view, cellPx, densityPool.get());
+
+    int splats = 0;
+    for (int y = 0; y < density.height; y++) {
+        for (int x = 0; x < density.width; x++) {
+            const NpcDensityGrid::Cell& cell = density.At(x, y);
+            if (cell.count == 0) continue;
+            Color c = {
+                (unsigned char)(cell.r / cell.count),
+                (unsigned char)(cell.g / cell.count),
+                (unsigned char)(cell.b / cell.count),
+                (unsigned char)std::min(255u, 110u + 35u * cell.count)
+            };
+            DrawRectangleRec(density.CellRect(x, y), c);
+            splats++;
+        }
+    }
+    CountShapes(splats);
+    lastDrawStats.densitySplats = splats;
+    DrawSelectedCaptainRing(snapshot);
+}
+
+void WorldRenderer::Draw(const WorldSnapshot& snapshot, Rectangle view, float zoom) {
+    lastDrawStats = DrawStats();
+    DrawStats& stats = lastDrawStats;
+    batch = BatchModel();
+
+    terrain.Draw(view, Terrain::TILE_PX);
+    if (terrain.TextureId() != 0) batch.Submit(terrain.TextureId(), false, 4);
+
+    // Plants: buckets overlapping the view, then index order as before.
+    // Plants never move, so the buckets follow plantsRevision.
+    if (plantBucketsRevision != snapshot.plantsRevision) {
+        plantBucketsRevision = snapshot.plantsRevision;
+        plantBuckets.Build((int)snapshot.plants.size(), (float)snapshot.worldW, (float)snapshot.worldH,
+                           [&](int i) { return snapshot.plants[i].position; });
+    }
+    plantBuckets.Query(Inflate(view, Plant::BASE_TREE_SIZE), visible);
+    for (int i : visible) DrawPlant(snapshot.plants[i]);
+    stats.plants.submitted = (int)visible.size();
+    stats.plants.culled = (int)snapshot.plants.size() - stats.plants.submitted;
+
+    // Animals are few and move every tick; a direct test is cheaper than an index
+    {
+        Rectangle area = Inflate(view, 32.0f);
+        for (const AnimalSnapshot& animal : snapshot.animals) {
+            if (!Contains(area, animal.position)) {
+                stats.animals.culled++;
+                continue;
+            }
+            DrawAnimal(animal);
+            stats.animals.submitted++;
+        }
+    }
+
+    // Settlement territory: the baked overlay, one quad for the whole view
+    territory.Draw(view, CELL_SIZE);
+    if (territory.TextureId() != 0) batch.Submit(territory.TextureId(), false, 4);
+
+    for (int i = 0; i < (int)snapshot.settlements.size(); i++) {
+        const SettlementSnapshot& s = snapshot.settlements[i];
+        if (!s.alive) continue;
+        if (!s.warActive) continue;
+
+        Color c = s.offensiveWaveReady ? Color{220,60,60,255} : Color{220,190,60,255};
+        if (CheckCollisionRecs(Inflate(s.boundsPx, 8.0f), view)) {
+            DrawRectangleLinesEx(s.boundsPx, 2.0f, c);
+            CountShapes(4);
+
+            if (s.defensiveMobilization) {
+                DrawCircleV(s.centerPx, 6.0f, Color{255,140,60,220});
+                CountShapes(CIRCLE_QUADS);
+            }
+        }
+
+        if (s.warTargetSettlementId >= 0 &&
+            s.warTargetSettlementId < (int)snapshot.settlements.size() &&
+            snapshot.settlements[s.warTargetSettlementId].alive) {
+            Vector2 a = s.centerPx;
+            Vector2 b = snapshot.settlements[s.warTargetSettlementId].centerPx;
+            Rectangle span{ std::min(a.x, b.x), std::min(a.y, b.y), std::fabs(b.x - a.x) + 1.0f, std::fabs(b.y - a.y) + 1.0f };
+            if (CheckCollisionRecs(span, view)) {
+                DrawLineV(a, b, Color{220, 60, 60, 180});
+                CountLines(1);
+            }
+        }
+    }
+
+    // Draw barracks of settlements whose bounds, grown by a sprite, reach the view
+    const float barracksPx = (float)CELL_SIZE * 8.0f;
+    for (const SettlementSnapshot& s : snapshot.settlements) {
+        if (!s.alive) continue;
+
+        if (!CheckCollisionRecs(Inflate(s.boundsPx, barracksPx), view)) {
+            stats.barracks.culled += s.barracksCount;
+            continue;
+        }
+
+        for (int bi = s.firstBarracks; bi < s.firstBarracks + s.barracksCount; bi++) {
+            const BarracksSnapshot& b = snapshot.barracks[bi];
+
+            float w = barracksPx;
+            float h = barracksPx;
+            if (!Contains(Inflate(view, w), b.posPx)) {
+                stats.barracks.culled++;
+                continue;
+            }
+            stats.barracks.submitted++;
+            if (barracksSprite >= 0) {
+                Rectangle dst{
+                        floorf(b.posPx.x - w * 0.5f),
+                        floorf(b.posPx.y - h * 0.92f),
+                        w,
+                        h
+                };
+                DrawSprite(barracksSprite, dst, Vector2{0,0}, WHITE);
+            } else {
+                Rectangle base{
+                        floorf(b.posPx.x - w * 0.5f),
+                        floorf(b.posPx.y - h * 0.82f),
+                        w, h
+                };
+                DrawRectangleRec(base, Color{110, 80, 45, 255});
+                DrawRectangleLinesEx(base, 1.0f, BLACK);
+                DrawRectangle((int)(base.x + w * 0.30f), (int)(base.y + h * 0.55f),
+                              (int)(w * 0.40f), (int)(h * 0.25f), Color{70, 45, 20, 255});
+                CountShapes(6);
+            }
+
+            if (b.hpRatio >= 0.0f) {
+                float hpRatio = b.hpRatio;
+
+                float barW = w * 0.8f;
+                float barH = 4.0f;
+                float barX = floorf(b.posPx.x - barW * 0.5f);
+                float barY = floorf(b.posPx.y - h * 0.95f);
+
+                DrawRectangle((int)barX, (int)barY, (int)barW, (int)barH, Color{40, 20, 20, 220});
+                CountShapes(1);
+
+                int fillW = (int)floorf(barW * hpRatio);
+                if (fillW > 0) {
+                    DrawRectangle((int)barX, (int)barY, fillW, (int)barH, Color{210, 70, 70, 255});
+                    CountShapes(1);
+                }
+            }
+        }
+    }
+
+    // Draw NPCs at a fixed world scale, from the snapshot's buckets; margin
+    // covers the largest sprite, the attack lunge and the settlement marker.
+    // How much detail depends on how large they are on screen.
+    const float npcMarginPx = (float)CELL_SIZE * 4.0f + 16.0f;
+    snapshot.npcBuckets.Query(Inflate(view, npcMarginPx), visible);
+    double npcStart = GetTime();
+    stats.npcLod = npcLodOverride ? *npcLodOverride : LodForZoom(zoom);
+    switch (stats.npcLod) {
+        case NpcLod::SPRITES: DrawNpcSprites(snapshot); break;
+        case NpcLod::QUADS: DrawNpcQuads(snapshot); break;
+        case NpcLod::DENSITY: DrawNpcDensity(snapshot, view, zoom); break;
+    }
+    stats.npcMs = (GetTime() - npcStart) * 1000.0;
+    stats.npcs.submitted = (int)visible.size();
+    stats.npcs.culled = (int)snapshot.npcs.size() - stats.npcs.submitted;
+
+    // Draw campfires
+    int f = fireFrame;
+    if (f < 0 || f >= FIRE_FRAMES) f = 0;
+
+    for (const SettlementSnapshot& s : snapshot.settlements) {
+        if (!s.alive) continue;
+        if (fireSprite[f] < 0) continue;
+
+        float w = (float)CELL_SIZE * 4.0f;
+        float h = (float)CELL_SIZE * 4.0f;
+        if (!Contains(Inflate(view, w), s.campfirePosPx)) continue;
+
+        Rectangle dst{
+                floorf(s.campfirePosPx.x - w*0.5f),
+                floorf(s.campfirePosPx.y - h*0.5f),
+                w, h
+        };
+
+
+        DrawSprite(fireSprite[f], dst, {0,0}, WHITE);
+    }
+
+    DrawMeteors(snapshot);
+    stats.drawCalls = batch.drawCalls;
+}
@@ -0,0 +1,126 @@
+#include "environment/sim_thread.h"
+
+#include <chrono>
+
+#include "environment/world.h"
+
+using SimClock = std::chrono::steady_clock;
+
+static double MsSince(SimClock::time_point t) {
+    return std::chrono::duration<double, std::milli>(SimClock::now() - t).count();
+}
+
+SimulationThread::SimulationThread(World& world, float ticksPerSecond)
+    : world(world), stepper(ticksPerSecond, 5) {}
+
+SimulationThread::~SimulationThread() {
+    Stop();
+}
+
+void SimulationThread::Start() {
+    if (IsRunning()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+        Publish(barracksPreview);
+    }
+    stepper.Reset();
+    thread = std::thread([this] { Run(); });
+}
+
+void SimulationThread::Stop() {
+    if (!IsRunning()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void SimulationThread::SetPaused(bool p) {
+    std::lock_guard<std::mutex> lock(mutex);
+    paused = p;
+}
+
+void SimulationThread::Post(std::function<void(World&)> fn) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        commands.push_back(std::move(fn));
+    }
+    wake.notify_one();
+}
+
+void SimulationThread::SetBarracksPreview(std::optional<Vector2> pos) {
+    std::lock_guard<std::mutex> lock(mutex);
+    barracksPreview = pos;
+}
+
+const WorldSnapshot& SimulationThread::Acquire() {
+    snapshots.Acquire();
+    return snapshots.Front();
+}
+
+void SimulationThread::Publish(const std::optional<Vector2>& preview) {
+    WorldSnapshot& out = snapshots.Back();
+    writer.Capture(world, out, preview ? &*preview : nullptr);
+    out.simMsPerTick = simMsPerTick;
+    out.simTicksPerSecond = simTicksPerSecond;
+    out.simBusyMsPerSecond = simBusyMsPerSecond;
+    snapshots.Publish();
+}
+
+void SimulationThread::Run() {
+    std::vector<std::function<void(World&)>> pending;
+    SimClock::time_point last = SimClock::now();
+    bool wasPaused = false;
+
+    for (;;) {
+        bool isPaused;
+        std::optional<Vector2> preview;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            // Sleep until the next tick is due or a command arrives
+            auto due = last + std::chrono::duration_cast<SimClock::duration>(
+                std::chrono::duration<double>(stepper.GetTickDt() * (1.0 - stepper.GetAlpha())));
+            wake.wait_until(lock, due, [&] { return stopping || !commands.empty(); });
+            if (stopping) return;
+            pending.swap(commands);
+            isPaused = paused;
+            preview = barracksPreview;
+        }
+
+        SimClock::time_point now = SimClock::now();
+        double frameSec = std::chrono::duration<double>(now - last).count();
+        last = now;
+        if (wasPaused && !isPaused) stepper.Reset();
+        wasPaused = isPaused;
+
+        for (auto& fn : pending) fn(world);
+        pending.clear();
+
+        int ticks = isPaused ? 0 : stepper.Advance((float)frameSec);
+        SimClock::time_point tickStart = SimClock::now();
+        for (int t = 0; t < ticks; t++) {
+            world.Update(stepper.GetTickDt(), &world.terrain);
+        }
+        double tickMs = MsSince(tickStart);
+
+        if (world.selectedCaptainId != 0 && !world.FindNpcById(world.selectedCaptainId)) {
+            world.selectedCaptainId = 0;
+        }
+        Publish(preview);
+
+        statsBusyMs += MsSince(now);
+        statsTickMs += tickMs;
+        statsTicks += ticks;
+        statsWindowSec += frameSec;
+        if (statsWindowSec >= 1.0) {
+            simMsPerTick = statsTicks > 0 ? (float)(statsTickMs / statsTicks) : 0.0f;
+            simTicksPerSecond = (int)(statsTicks / statsWindowSec + 0.5);
+            simBusyMsPerSecond = (float)(statsBusyMs / statsWindowSec);
+            statsWindowSec = statsBusyMs = statsTickMs = 0.0;
+            statsTicks = 0;
+        }
+    }
+}
@@ -0,0 +1,204 @@
+#include "environment/spatial_grid.h"
+#include <cmath>
+
+std::vector<int>& NpcSpatialGrid::Scratch() {
+    thread_local std::vector<int> scratch;
+    return scratch;
+}
+
+void NpcSpatialGrid::Clear() {
+    bucketsX = 0;
+    bucketsY = 0;
+    indexedCount = 0;
+    bucketStart.clear();
+    entries.clear();
+    settlementStart.clear();
+    settlementEntries.clear();
+    roleEntries.clear();
+    for (int r = 0; r <= ROLE_COUNT; r++) roleStart[r] = 0;
+}
+
+// Buckets every NPC by position with a two-pass counting sort
+void NpcSpatialGrid::Rebuild(const NpcStore& npcs, int worldW, int worldH, float cellSizePx) {
+    bucketPx = cellSizePx * BUCKET_TILES;
+    slackPx = cellSizePx;
+
+    if (worldW <= 0 || worldH <= 0 || bucketPx <= 0.0f) {
+        Clear();
+        return;
+    }
+
+    bucketsX = (int)std::ceil((float)worldW / bucketPx) + 1;
+    bucketsY = (int)std::ceil((float)worldH / bucketPx) + 1;
+
+    const int keyCount = bucketsX * bucketsY * ROLE_COUNT;
+    const int n = (int)npcs.size();
+
+    bucketStart.assign(keyCount + 1, 0);
+    entries.resize(n);
+
+    keyOf.resize(n);
+
+    for (int i = 0; i < n; i++) {
+        Vector2 p = npcs.Pos(i);
+        int b = BucketCoord(p.y, bucketsY) * bucketsX + BucketCoord(p.x, bucketsX);
+        int key = b * ROLE_COUNT + RoleSlot(npcs.Role(i));
+        keyOf[i] = key;
+        bucketStart[key + 1]++;
+    }
+
+    for (int k = 0; k < keyCount; k++) {
+        bucketStart[k + 1] += bucketStart[k];
+    }
+
+    // Fill in index order so each bucket stays sorted
+    cursor.assign(bucketStart.begin(), bucketStart.end() - 1);
+    for (int i = 0; i < n; i++) {
+        entries[cursor[keyOf[i]]++] = i;
+    }
+
+    // Role lists in index order
+    for (int r = 0; r <= ROLE_COUNT; r++) roleStart[r] = 0;
+    for (int i = 0; i < n; i++) roleStart[RoleSlot(npcs.Role(i)) + 1]++;
+    for (int r = 0; r < ROLE_COUNT; r++) roleStart[r + 1] += roleStart[r];
+
+    roleEntries.resize(n);
+    cursor.assign(roleStart, roleStart + ROLE_COUNT);
+    for (int i = 0; i < n; i++) {
+        roleEntries[cursor[RoleSlot(npcs.Role(i))]++] = i;
+    }
+
+    // Same counting sort keyed by settlement and role
+    int settlementCount = 0;
+    for (int i = 0; i < n; i++) {
+        if (npcs.SettlementId(i) >= settlementCount) settlementCount = npcs.SettlementId(i) + 1;
+    }
+
+    const int settlementKeys = settlementCount * ROLE_COUNT;
+    settlementStart.assign(settlementKeys + 1, 0);
+    for (int i = 0; i < n; i++) {
+        int sid = npcs.SettlementId(i);
+        keyOf[i] = (sid >= 0) ? sid * ROLE_COUNT + RoleSlot(npcs.Role(i)) : -1;
+        if (keyOf[i] >= 0) settlementStart[keyOf[i] + 1]++;
+    }
+    for (int k = 0; k < settlementKeys; k++) {
+        settlementStart[k + 1] += settlementStart[k];
+    }
+
+    settlementEntries.resize(settlementStart[settlementKeys]);
+    cursor.assign(settlementStart.begin(), settlementStart.end() - 1);
+    for (int i = 0; i < n; i++) {
+        if (keyOf[i] >= 0) settlementEntries[cursor[keyOf[i]]++] = i;
+    }
+
+    indexedCount = n;
+}
+
+void NpcSpatialGrid::QueryRect(const NpcStore& npcs, Rectangle rect,
+                               const NpcQueryFilter& filter, std::vector<int>& out) const {
+    out.clear();
+
+    ForEachCandidate((int)npcs.size(), filter.roleMask, rect.x, rect.y, rect.x + rect.width, rect.y + rect.height, [&](int i) {
+        if (!filter.Accepts(npcs, i)) return;
+        Vector2 p = npcs.Pos(i);
+        if (p.x < rect.x || p.x > rect.x + rect.width) return;
+        if (p.y < rect.y || p.y > rect.y + rect.height) return;
+        out.push_back(i);
+    });
+
+    std::sort(out.begin(), out.end());
+}
+
+void NpcSpatialGrid::QueryRectAll(const NpcStore& npcs, Rectangle rect, std::vector<int>& out) const {
+    out.clear();
+
+    ForEachCandidate((int)npcs.size(), NpcQueryFilter::ALL_ROLES, rect.x, rect.y, rect.x + rect.width, rect.y + rect.height, [&](int i) {
+        Vector2 p = npcs.Pos(i);
+        if (p.x < rect.x || p.x > rect.x + rect.width) return;
+        if (p.y < rect.y || p.y > rect.y + rect.height) return;
+        out.push_back(i);
+    });
+
+    std::sort(out.begin(), out.end());
+}
+
+void NpcSpatialGrid::QuerySettlement(const NpcStore& npcs, int settlementId,
+                                     const NpcQueryFilter& filter, std::vector<int>& out) const {
+    out.clear();
+    const int total = (int)npcs.size();
+    int tailStart = std::min(indexedCount, total);
+
+    if (settlementId < 0) {
+        tailStart = 0;
+    } else if ((settlementId + 1) * ROLE_COUNT < (int)settlementStart.size()) {
+        const int base = settlementId * ROLE_COUNT;
+        for (int r = 0; r < ROLE_COUNT; r++) {
+            if ((filter.roleMask & (1u << r)) == 0) continue;
+            const size_t merged = out.size();
+            for (int e = settlementStart[base + r]; e < settlementStart[base + r + 1]; e++) {
+                int i = settlementEntries[e];
+                if (i < total && npcs.SettlementId(i) == settlementId && filter.Accepts(npcs, i)) {
+                    out.push_back(i);
+                }
+            }
+            // Each role's entries are already ascending
+            std::inplace_merge(out.begin(), out.begin() + merged, out.end());
+        }
+    }
+
+    for (int i = tailStart; i < total; i++) {
+        if (npcs.SettlementId(i) == settlementId && filter.Accepts(npcs, i)) out.push_back(i);
+    }
+}
+
+int NpcSpatialGrid::CountInRadius(const NpcStore& npcs, Vector2 center, float radius,
+                                  const NpcQueryFilter& filter) const {
+    const float r2 = radius * radius;
+    int count = 0;
+
+    ForEachCandidate((int)npcs.size(), filter.roleMask, center.x - radius, center.y - radius,
+                     center.x + radius, center.y + radius,
+                     [&](int i) {
+        if (!filter.Accepts(npcs, i)) return;
+        if (Dist2(npcs.Pos(i), center) <= r2) count++;
+    });
+
+    return count;
+}
+
+bool NpcSpatialGrid::AnyInRadius(const NpcStore& npcs, Vector2 center, float radius,
+                                 const NpcQueryFilter& filter) const {
+    return AnyInRadiusIf(npcs, center, radius, filter, [](ConstNpcRef) { return true; });
+}
+
+int NpcSpatialGrid::FindByRolePriority(const NpcStore& npcs, Vector2 center, float radius,
+                                       NpcQueryFilter filter,
+                                       std::initializer_list<NPC::HumanRole> priority) const {
+    filter.Roles(priority);
+
+    std::vector<int>& candidates = Scratch();
+    QueryRadius(npcs, center, radius, filter, candidates);
+
+    float bestD2 = radius * radius;
+    int bestIndex = -1;
+    int bestPriority = 999;
+
+    for (int i : candidates) {
+        int rank = 0;
+        for (NPC::HumanRole r : priority) {
+            if (r == npcs.Role(i)) break;
+            rank++;
+        }
+
+        float d2 = Dist2(npcs.Pos(i), center);
+        if (d2 > bestD2) continue;
+
+        if (rank < bestPriority || (rank == bestPriority && d2 < bestD2)) {
+            bestPriority = rank;
+            bestD2 = d2;
+            bestIndex = i;
+        }
+    }
+
+    return bestIndex;
+}
@@ -0,0 +1,49 @@
+#include "terrain/biome_lut.h"
+#include "terrain/terrain.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// The classification the table reproduces
+static int ScanBiomes(const std::vector<Biome>& biomes, float elevation) {
+    for (size_t i = 0; i < biomes.size(); ++i) {
+        const Biome& b = biomes[i];
+        if (elevation >= b.minElevation && elevation <= b.maxElevation) {
+            return static_cast<int>(i);
+        }
+    }
+    return 0;
+}
+
+void BiomeLut::build(const std::vector<Biome>& biomes) {
+    edges.clear();
+    for (const Biome& b : biomes) {
+        edges.push_back(b.minElevation);
+        edges.push_back(b.maxElevation);
+    }
+    edges.erase(std::remove_if(edges.begin(), edges.end(), [](float e) { return std::isnan(e); }), edges.end());
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    const float inf = std::numeric_limits<float>::infinity();
+    const int n = (int)edges.size();
+
+    onEdge.resize(n);
+    belowEdge.resize(n + 1);
+    for (int k = 0; k < n; k++) {
+        onEdge[k] = ScanBiomes(biomes, edges[k]);
+
+        // Any value strictly inside the gap; an empty gap is never looked up
+        float lo = (k == 0) ? -inf : edges[k - 1];
+        float probe = (k == 0) ? std::nextafter(edges[0], -inf) : lo + (edges[k] - lo) * 0.5f;
+        belowEdge[k] = ScanBiomes(biomes, probe);
+    }
+    belowEdge[n] = (n > 0) ? ScanBiomes(biomes, std::nextafter(edges[n - 1], inf)) : 0;
+
+    // Start one bin early so rounding in elevation * BINS can never skip an edge
+    binStart.resize(BINS);
+    for (int b = 0; b < BINS; b++) {
+        float lo = (float)(b - 1) / (float)BINS;
+        binStart[b] = (b == 0) ? 0 : (int)(std::lower_bound(edges.begin(), edges.end(), lo) - edges.begin());
+    }
+}
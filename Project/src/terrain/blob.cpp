@@ -0,0 +1,62 @@
+#include "terrain/blob.h"
+
+#include <cstdio>
+
+#if defined(_WIN32)
+#define WORLDBOX_NO_MMAP 1
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#if !defined(WORLDBOX_NO_MMAP)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p != MAP_FAILED) {
+        bytes = (const uint8_t*)p;
+        length = (size_t)st.st_size;
+        mapped = true;
+        return true;
+    }
+#endif
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    if (size <= 0) {
+        std::fclose(f);
+        return false;
+    }
+    fallback.resize((size_t)size);
+    size_t got = std::fread(fallback.data(), 1, fallback.size(), f);
+    std::fclose(f);
+    if (got != fallback.size()) {
+        fallback.clear();
+        return false;
+    }
+    bytes = fallback.data();
+    length = fallback.size();
+    return true;
+}
+
+void MappedFile::close() {
+#if !defined(WORLDBOX_NO_MMAP)
+    if (mapped) munmap((void*)bytes, length);
+#endif
+    mapped = false;
+    bytes = nullptr;
+    length = 0;
+    fallback.clear();
+}
@@ -0,0 +1,139 @@
+#include "terrain/distance_field.h"
+
+namespace {
+
+// Raster order over (dy, dx) of two offsets to the same tile, by distance
+// first; the order Terrain::findNearestPassable visits its rings in
+bool Closer(int ax, int ay, int bx, int by) {
+    int da = std::max(std::abs(ax), std::abs(ay));
+    int db = std::max(std::abs(bx), std::abs(by));
+    if (da != db) return da < db;
+    if (ay != by) return ay < by;
+    return ax < bx;
+}
+
+TileRect Clip(TileRect r, int width, int height) {
+    int x0 = std::max(r.x, 0);
+    int y0 = std::max(r.y, 0);
+    int x1 = std::min(r.x + r.w, width);
+    int y1 = std::min(r.y + r.h, height);
+    return { x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0) };
+}
+
+} // namespace
+
+// Forward pass takes seeds from above and the left, backward pass from
+// below and the right; each row is also swept back the other way
+void DistanceField::propagate(std::vector<Seed>& seeds, int w, int h) {
+    // Offers tile (x, y) the seed of its neighbour (x + ox, y + oy)
+    auto relax = [&](int x, int y, int ox, int oy) {
+        int nx = x + ox;
+        int ny = y + oy;
+        if (nx < 0 || nx >= w || ny < 0 || ny >= h) return;
+        Seed& s = seeds[(size_t)y * w + x];
+        if (s.dx == 0 && s.dy == 0) return; // a seed itself
+        const Seed& n = seeds[(size_t)ny * w + nx];
+        if (n.dx == NO_SEED) return;
+        int dx = n.dx + ox;
+        int dy = n.dy + oy;
+        if (std::abs(dx) > RADIUS || std::abs(dy) > RADIUS) return;
+        if (s.dx == NO_SEED || Closer(dx, dy, s.dx, s.dy)) {
+            s.dx = (int8_t)dx;
+            s.dy = (int8_t)dy;
+        }
+    };
+
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            relax(x, y, -1, 0);
+            relax(x, y, -1, -1);
+            relax(x, y, 0, -1);
+            relax(x, y, 1, -1);
+        }
+        for (int x = w - 1; x >= 0; x--) relax(x, y, 1, 0);
+    }
+    for (int y = h - 1; y >= 0; y--) {
+        for (int x = w - 1; x >= 0; x--) {
+            relax(x, y, 1, 0);
+            relax(x, y, 1, 1);
+            relax(x, y, 0, 1);
+            relax(x, y, -1, 1);
+        }
+        for (int x = 0; x < w; x++) relax(x, y, -1, 0);
+    }
+}
+
+void DistanceField::build(const Terrain& terrain) {
+    width = terrain.getWidth();
+    height = terrain.getHeight();
+    passable.assign((size_t)width * height, Seed());
+    water.assign((size_t)width * height, (uint8_t)(RADIUS + 1));
+    TileRect all{ 0, 0, width, height };
+    sweep(terrain, all, all);
+}
+
+void DistanceField::save(BlobWriter& out) const {
+    out.put(width);
+    out.put(height);
+    out.putVector(passable);
+    out.putVector(water);
+}
+
+bool DistanceField::load(BlobReader& in, const Terrain& terrain) {
+    if (!in.get(width) || !in.get(height) || !in.getVector(passable) || !in.getVector(water)) return false;
+    size_t tiles = (size_t)width * height;
+    if (width != terrain.getWidth() || height != terrain.getHeight() || passable.size() != tiles ||
+        water.size() != tiles) {
+        return false;
+    }
+    // nearestPassable hands out x + dx, y + dy without checking them
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const size_t i = (size_t)y * width + x;
+            if (water[i] > RADIUS + 1) return false;
+            const Seed& s = passable[i];
+            if (s.dx == NO_SEED) continue;
+            if (std::max(std::abs(s.dx), std::abs(s.dy)) > RADIUS) return false;
+            if (x + s.dx < 0 || x + s.dx >= width || y + s.dy < 0 || y + s.dy >= height) return false;
+        }
+    }
+    return true;
+}
+
+void DistanceField::update(const Terrain& terrain, TileRect rect) {
+    if (!isBuilt()) return;
+    // Tiles within RADIUS of the edit may change; their seeds lie within
+    // another RADIUS
+    TileRect keep = Clip({ rect.x - RADIUS, rect.y - RADIUS, rect.w + 2 * RADIUS, rect.h + 2 * RADIUS }, width, height);
+    TileRect window = Clip({ rect.x - 2 * RADIUS, rect.y - 2 * RADIUS, rect.w + 4 * RADIUS, rect.h + 4 * RADIUS }, width, height);
+    if (keep.w == 0 || keep.h == 0) return;
+    sweep(terrain, window, keep);
+}
+
+void DistanceField::sweep(const Terrain& terrain, TileRect window, TileRect keep) {
+    const int w = window.w;
+    const int h = window.h;
+    for (int pass = 0; pass < 2; pass++) {
+        const uint8_t flag = pass == 0 ? Terrain::TILE_WALKABLE : Terrain::TILE_WATER;
+        scratch.assign((size_t)w * h, Seed());
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                if (terrain.getTileFlags(window.x + x, window.y + y) & flag) scratch[(size_t)y * w + x] = { 0, 0 };
+            }
+        }
+        propagate(scratch, w, h);
+
+        for (int y = keep.y; y < keep.y + keep.h; y++) {
+            for (int x = keep.x; x < keep.x + keep.w; x++) {
+                const Seed& s = scratch[(size_t)(y - window.y) * w + (x - window.x)];
+                if (pass == 0) {
+                    passable[(size_t)y * width + x] = s;
+                } else {
+                    water[(size_t)y * width + x] = s.dx == NO_SEED
+                        ? (uint8_t)(RADIUS + 1)
+                        : (uint8_t)std::max(std::abs(s.dx), std::abs(s.dy));
+                }
+            }
+        }
+    }
+}
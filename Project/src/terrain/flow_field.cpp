@@ -0,0 +1,157 @@
+#include "terrain/flow_field.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <utility>
+
+namespace {
+
+constexpr float INF = std::numeric_limits<float>::infinity();
+constexpr float DIAGONAL = 1.41421356f;
+const int DX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+const int DY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+const uint8_t OPPOSITE[8] = { 1, 0, 3, 2, 7, 6, 5, 4 };
+
+} // namespace
+
+// ─────────────────────── field ───────────────────────
+
+bool FlowField::build(const Terrain& terrain, Vector2 goal) {
+    width = terrain.getWidth();
+    height = terrain.getHeight();
+    goalPx = goal;
+    cost.assign((size_t)width * height, INF);
+    step.assign((size_t)width * height, NO_STEP);
+
+    std::vector<float> walk((size_t)width * height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) walk[(size_t)y * width + x] = terrain.getWalkCost(x, y);
+    }
+    auto open = [&](int x, int y) {
+        return x >= 0 && x < width && y >= 0 && y < height && walk[(size_t)y * width + x] >= 0.0f;
+    };
+
+    int gx = std::clamp((int)std::floor(goal.x / Terrain::TILE_PX), 0, width - 1);
+    int gy = std::clamp((int)std::floor(goal.y / Terrain::TILE_PX), 0, height - 1);
+    if (!open(gx, gy) && !(terrain.findNearestPassable(gx, gy, gx, gy) && open(gx, gy))) return false;
+
+    // Dijkstra outward from the goal; each tile steps back to the neighbour
+    // it was reached from
+    std::vector<std::pair<float, int>> heap;
+    int source = gy * width + gx;
+    cost[source] = 0.0f;
+    heap.push_back({ 0.0f, source });
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+        auto [d, i] = heap.back();
+        heap.pop_back();
+        if (d > cost[i]) continue;
+
+        int x = i % width;
+        int y = i / width;
+        for (int k = 0; k < 8; k++) {
+            int nx = x + DX[k];
+            int ny = y + DY[k];
+            if (!open(nx, ny)) continue;
+            if (k >= 4 && (!open(nx, y) || !open(x, ny))) continue;
+            int j = ny * width + nx;
+            float nd = d + (k >= 4 ? DIAGONAL : 1.0f) * (walk[i] + walk[j]) * 0.5f;
+            if (nd < cost[j]) {
+                cost[j] = nd;
+                step[j] = OPPOSITE[k];
+                heap.push_back({ nd, j });
+                std::push_heap(heap.begin(), heap.end(), std::greater<>());
+            }
+        }
+    }
+    return true;
+}
+
+int FlowField::tileIndex(Vector2 posPx) const {
+    int tx = (int)std::floor(posPx.x / Terrain::TILE_PX);
+    int ty = (int)std::floor(posPx.y / Terrain::TILE_PX);
+    if (tx < 0 || tx >= width || ty < 0 || ty >= height) return -1;
+    return ty * width + tx;
+}
+
+float FlowField::costAt(Vector2 posPx) const {
+    int i = tileIndex(posPx);
+    return i < 0 ? INF : cost[i];
+}
+
+bool FlowField::nextStep(Vector2 posPx, Vector2& outPx) const {
+    int i = tileIndex(posPx);
+    if (i < 0 || step[i] == NO_STEP) return false;
+    int k = step[i];
+    int nx = i % width + DX[k];
+    int ny = i / width + DY[k];
+    outPx = { ((float)nx + 0.5f) * Terrain::TILE_PX, ((float)ny + 0.5f) * Terrain::TILE_PX };
+    return true;
+}
+
+// ─────────────────────── cache ───────────────────────
+
+FlowFieldCache::Entry* FlowFieldCache::findEntry(int key) {
+    for (Entry& e : entries) {
+        if (e.key == key) return &e;
+    }
+    return nullptr;
+}
+
+void FlowFieldCache::acquire(const Terrain& terrain, int key, Vector2 goalPx) {
+    Entry* e = findEntry(key);
+    if (!e) {
+        entries.push_back({ key, 0, true, std::make_unique<FlowField>() });
+        e = &entries.back();
+    }
+    e->refs++;
+    retarget(terrain, key, goalPx);
+}
+
+void FlowFieldCache::retarget(const Terrain& terrain, int key, Vector2 goalPx) {
+    Entry* e = findEntry(key);
+    if (!e) return;
+    Vector2 old = e->field->getGoalPx();
+    float dx = old.x - goalPx.x;
+    float dy = old.y - goalPx.y;
+    if (e->stale || dx * dx + dy * dy > Terrain::TILE_PX * Terrain::TILE_PX) {
+        e->field->build(terrain, goalPx);
+        e->stale = false;
+    }
+}
+
+void FlowFieldCache::release(int key) {
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (entries[i].key != key) continue;
+        if (--entries[i].refs <= 0) entries.erase(entries.begin() + i);
+        return;
+    }
+}
+
+const FlowField* FlowFieldCache::find(int key) const {
+    for (const Entry& e : entries) {
+        if (e.key == key) return e.field.get();
+    }
+    return nullptr;
+}
+
+int FlowFieldCache::refCount(int key) const {
+    for (const Entry& e : entries) {
+        if (e.key == key) return e.refs;
+    }
+    return 0;
+}
+
+void FlowFieldCache::invalidate() {
+    for (Entry& e : entries) e.stale = true;
+}
+
+void FlowFieldCache::refresh(const Terrain& terrain) {
+    for (Entry& e : entries) {
+        if (!e.stale) continue;
+        e.field->build(terrain, e.field->getGoalPx());
+        e.stale = false;
+    }
+}
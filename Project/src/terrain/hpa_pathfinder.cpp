@@ -0,0 +1,605 @@
+#include "terrain/hpa_pathfinder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+
+namespace {
+
+constexpr int CLUSTER_TILES = HpaPathfinder::CLUSTER * HpaPathfinder::CLUSTER;
+constexpr float INF = std::numeric_limits<float>::infinity();
+constexpr float DIAGONAL = 1.41421356f;
+// Openings at least this wide get an entrance at each end instead of one
+// in the middle
+constexpr int WIDE_ENTRANCE = 6;
+// Farthest a smoothed segment may reach, in path tiles
+constexpr int SMOOTH_LOOKAHEAD = 48;
+
+struct TilePoint {
+    int x;
+    int y;
+};
+
+float Octile(int dx, int dy) {
+    dx = std::abs(dx);
+    dy = std::abs(dy);
+    return (float)std::max(dx, dy) + (DIAGONAL - 1.0f) * (float)std::min(dx, dy);
+}
+
+// Dijkstra over the tiles of one cluster
+struct LocalSearch {
+    int x0 = 0;
+    int y0 = 0;
+    int w = 0;
+    int h = 0;
+    float cost[CLUSTER_TILES];
+    float dist[CLUSTER_TILES];
+    int16_t parent[CLUSTER_TILES];
+    std::vector<std::pair<float, int>> heap;
+
+    void load(const std::vector<float>& grid, int gridW, int gridH, int cx, int cy) {
+        x0 = cx * HpaPathfinder::CLUSTER;
+        y0 = cy * HpaPathfinder::CLUSTER;
+        w = std::min(HpaPathfinder::CLUSTER, gridW - x0);
+        h = std::min(HpaPathfinder::CLUSTER, gridH - y0);
+        for (int y = 0; y < h; y++) {
+            const float* row = &grid[(size_t)(y0 + y) * gridW + x0];
+            std::copy(row, row + w, cost + y * w);
+        }
+    }
+
+    bool open(int lx, int ly) const {
+        return lx >= 0 && lx < w && ly >= 0 && ly < h && cost[ly * w + lx] >= 0.0f;
+    }
+
+    // Settles tiles outward from (sx, sy); stops early once target (a local
+    // index) is settled, if given
+    void run(int sx, int sy, int target = -1) {
+        std::fill(dist, dist + w * h, INF);
+        heap.clear();
+        int source = (sy - y0) * w + (sx - x0);
+        if (cost[source] < 0.0f) return;
+        dist[source] = 0.0f;
+        parent[source] = -1;
+        heap.push_back({ 0.0f, source });
+
+        static const int DX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+        static const int DY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+            auto [d, i] = heap.back();
+            heap.pop_back();
+            if (d > dist[i]) continue;
+            if (i == target) return;
+
+            int lx = i % w;
+            int ly = i / w;
+            for (int k = 0; k < 8; k++) {
+                int nx = lx + DX[k];
+                int ny = ly + DY[k];
+                if (!open(nx, ny)) continue;
+                // Diagonals may not squeeze past a blocked corner
+                if (k >= 4 && (!open(nx, ly) || !open(lx, ny))) continue;
+                int j = ny * w + nx;
+                float nd = d + (k >= 4 ? DIAGONAL : 1.0f) * (cost[i] + cost[j]) * 0.5f;
+                if (nd < dist[j]) {
+                    dist[j] = nd;
+                    parent[j] = (int16_t)i;
+                    heap.push_back({ nd, j });
+                    std::push_heap(heap.begin(), heap.end(), std::greater<>());
+                }
+            }
+        }
+    }
+
+    int localIndex(int tx, int ty) const { return (ty - y0) * w + (tx - x0); }
+    float distAt(int tx, int ty) const { return dist[localIndex(tx, ty)]; }
+
+    // Appends the tiles from the source to (tx, ty)
+    void appendTo(int tx, int ty, std::vector<TilePoint>& out) const {
+        size_t first = out.size();
+        for (int i = (ty - y0) * w + (tx - x0); i >= 0; i = parent[i]) {
+            out.push_back({ x0 + i % w, y0 + i / w });
+        }
+        std::reverse(out.begin() + first, out.end());
+    }
+
+    // Appends the tiles after (tx, ty) on its way back to the source
+    void appendFrom(int tx, int ty, std::vector<TilePoint>& out) const {
+        for (int i = parent[(ty - y0) * w + (tx - x0)]; i >= 0; i = parent[i]) {
+            out.push_back({ x0 + i % w, y0 + i / w });
+        }
+    }
+};
+
+// Per-thread scratch for the graph search
+struct GraphSearch {
+    std::vector<float> g;
+    std::vector<int> parent;
+    std::vector<uint32_t> seen;
+    uint32_t stamp = 0;
+    std::vector<std::pair<float, int>> heap;
+
+    void reset(size_t nodeCount) {
+        if (seen.size() < nodeCount) {
+            g.resize(nodeCount);
+            parent.resize(nodeCount);
+            seen.resize(nodeCount, 0);
+        }
+        if (++stamp == 0) {
+            std::fill(seen.begin(), seen.end(), 0);
+            stamp = 1;
+        }
+        heap.clear();
+    }
+
+    float gOf(int n) const { return seen[n] == stamp ? g[n] : INF; }
+};
+
+// A vector of vectors as its length, then each vector
+template <typename T>
+void PutNested(BlobWriter& out, const std::vector<std::vector<T>>& lists) {
+    out.put((uint64_t)lists.size());
+    for (const std::vector<T>& list : lists) out.putVector(list);
+}
+
+template <typename T>
+bool GetNested(BlobReader& in, std::vector<std::vector<T>>& lists) {
+    uint64_t count = 0;
+    if (!in.get(count) || count > in.remaining() / sizeof(uint64_t)) return false;
+    lists.resize((size_t)count);
+    for (std::vector<T>& list : lists) {
+        if (!in.getVector(list)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+// ─────────────────────── graph ───────────────────────
+
+void HpaPathfinder::refreshCosts(const Terrain& terrain, int x0, int y0, int x1, int y1) {
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) tileCost[(size_t)y * width + x] = terrain.getWalkCost(x, y);
+    }
+}
+
+void HpaPathfinder::build(const Terrain& terrain) {
+    width = terrain.getWidth();
+    height = terrain.getHeight();
+    clustersX = (width + CLUSTER - 1) / CLUSTER;
+    clustersY = (height + CLUSTER - 1) / CLUSTER;
+    const int clusterCount = clustersX * clustersY;
+
+    nodes.clear();
+    freeNodes.clear();
+    clusterNodes.assign(clusterCount, {});
+    clusterPaths.assign(clusterCount, {});
+    borderNodes.assign(clusterCount * 2, {});
+
+    float fastest = 0.0f;
+    for (const Biome& b : terrain.getBiomes()) {
+        if (b.props.canWalk) fastest = std::max(fastest, b.props.moveSpeed);
+    }
+    minStepCost = fastest > 0.0f ? 1.0f / fastest : 1.0f;
+
+    tileCost.assign((size_t)width * height, -1.0f);
+    refreshCosts(terrain, 0, 0, width, height);
+    for (int b = 0; b < clusterCount * 2; b++) rebuildBorder(b);
+    for (int c = 0; c < clusterCount; c++) linkCluster(c);
+}
+
+void HpaPathfinder::save(BlobWriter& out) const {
+    out.put(width);
+    out.put(height);
+    out.put(clustersX);
+    out.put(clustersY);
+    out.put(minStepCost);
+    out.putVector(tileCost);
+    out.put((uint64_t)nodes.size());
+    for (const Node& n : nodes) {
+        out.put(n.tx);
+        out.put(n.ty);
+        out.put(n.cluster);
+        out.put(n.partner);
+        out.put(n.partnerCost);
+        out.putVector(n.intra);
+    }
+    out.putVector(freeNodes);
+    PutNested(out, clusterNodes);
+    PutNested(out, clusterPaths);
+    PutNested(out, borderNodes);
+}
+
+bool HpaPathfinder::load(BlobReader& in, const Terrain& terrain) {
+    clustersX = 0;
+    int cx = 0;
+    uint64_t nodeTotal = 0;
+    if (!in.get(width) || !in.get(height) || !in.get(cx) || !in.get(clustersY) || !in.get(minStepCost) ||
+        !in.getVector(tileCost) || !in.get(nodeTotal) || nodeTotal > in.remaining()) {
+        return false;
+    }
+    nodes.resize((size_t)nodeTotal);
+    for (Node& n : nodes) {
+        if (!in.get(n.tx) || !in.get(n.ty) || !in.get(n.cluster) || !in.get(n.partner) ||
+            !in.get(n.partnerCost) || !in.getVector(n.intra)) {
+            return false;
+        }
+    }
+    if (!in.getVector(freeNodes) || !GetNested(in, clusterNodes) || !GetNested(in, clusterPaths) ||
+        !GetNested(in, borderNodes)) {
+        return false;
+    }
+    if (width != terrain.getWidth() || height != terrain.getHeight() || cx != (width + CLUSTER - 1) / CLUSTER ||
+        clustersY != (height + CLUSTER - 1) / CLUSTER) {
+        return false;
+    }
+    const size_t clusterCount = (size_t)cx * clustersY;
+    if (tileCost.size() != (size_t)width * height || clusterNodes.size() != clusterCount ||
+        clusterPaths.size() != clusterCount || borderNodes.size() != clusterCount * 2) {
+        return false;
+    }
+    clustersX = cx;
+    if (!loadedGraphValid()) {
+        clustersX = 0;
+        return false;
+    }
+    return true;
+}
+
+// Every node id, cluster and path offset a loaded graph refers to is in
+// range, so queries and invalidate can index without checks
+bool HpaPathfinder::loadedGraphValid() const {
+    const int clusterCount = clustersX * clustersY;
+    const int nodeTotal = (int)nodes.size();
+    auto live = [&](int id) { return id >= 0 && id < nodeTotal && nodes[id].cluster >= 0; };
+
+    for (int id : freeNodes) {
+        if (id < 0 || id >= nodeTotal || nodes[id].cluster >= 0) return false;
+    }
+    for (const Node& n : nodes) {
+        if (n.cluster < 0) continue;
+        if (n.tx < 0 || n.tx >= width || n.ty < 0 || n.ty >= height || n.cluster != clusterOf(n.tx, n.ty)) {
+            return false;
+        }
+        if (n.partner != -1 && !live(n.partner)) return false;
+        // Local indices of this cluster's tiles, which may be clipped at the map edge
+        const int x0 = (n.cluster % clustersX) * CLUSTER;
+        const int y0 = (n.cluster / clustersX) * CLUSTER;
+        const int localTiles = std::min(CLUSTER, width - x0) * std::min(CLUSTER, height - y0);
+        const std::vector<uint8_t>& paths = clusterPaths[n.cluster];
+        for (const Edge& e : n.intra) {
+            if (!live(e.to) || nodes[e.to].cluster != n.cluster) return false;
+            if (e.path > paths.size() || e.pathLen > paths.size() - e.path) return false;
+            for (uint32_t k = 0; k < e.pathLen; k++) {
+                if (paths[e.path + k] >= localTiles) return false;
+            }
+        }
+    }
+    for (int c = 0; c < clusterCount; c++) {
+        for (int id : clusterNodes[c]) {
+            if (!live(id) || nodes[id].cluster != c) return false;
+        }
+    }
+    for (const std::vector<int>& border : borderNodes) {
+        for (int id : border) {
+            if (!live(id)) return false;
+        }
+    }
+    return minStepCost > 0.0f;
+}
+
+void HpaPathfinder::invalidate(const Terrain& terrain, TileRect rect) {
+    if (!isBuilt()) return;
+    // A tile edit also changes the openings it borders
+    int x0 = std::max(rect.x - 1, 0);
+    int y0 = std::max(rect.y - 1, 0);
+    int x1 = std::min(rect.x + rect.w + 1, width);
+    int y1 = std::min(rect.y + rect.h + 1, height);
+    if (x0 >= x1 || y0 >= y1) return;
+    refreshCosts(terrain, x0, y0, x1, y1);
+
+    const int clusterCount = clustersX * clustersY;
+    int cx0 = x0 / CLUSTER;
+    int cy0 = y0 / CLUSTER;
+    int cx1 = (x1 - 1) / CLUSTER;
+    int cy1 = (y1 - 1) / CLUSTER;
+
+    // Every border of the touched clusters, including those owned by the
+    // left and upper neighbours
+    for (int cy = std::max(cy0 - 1, 0); cy <= cy1; cy++) {
+        for (int cx = std::max(cx0 - 1, 0); cx <= cx1; cx++) {
+            int c = cy * clustersX + cx;
+            if (cy >= cy0) rebuildBorder(c);
+            if (cx >= cx0) rebuildBorder(clusterCount + c);
+        }
+    }
+
+    // The touched clusters and the neighbours across those borders
+    for (int cy = std::max(cy0 - 1, 0); cy <= std::min(cy1 + 1, clustersY - 1); cy++) {
+        for (int cx = std::max(cx0 - 1, 0); cx <= std::min(cx1 + 1, clustersX - 1); cx++) {
+            bool inX = cx >= cx0 && cx <= cx1;
+            bool inY = cy >= cy0 && cy <= cy1;
+            if (inX || inY) linkCluster(cy * clustersX + cx);
+        }
+    }
+}
+
+int HpaPathfinder::addNode(int tx, int ty) {
+    int id;
+    if (!freeNodes.empty()) {
+        id = freeNodes.back();
+        freeNodes.pop_back();
+        nodes[id] = Node();
+    } else {
+        id = (int)nodes.size();
+        nodes.emplace_back();
+    }
+    Node& n = nodes[id];
+    n.tx = tx;
+    n.ty = ty;
+    n.cluster = clusterOf(tx, ty);
+    clusterNodes[n.cluster].push_back(id);
+    return id;
+}
+
+void HpaPathfinder::rebuildBorder(int border) {
+    for (int id : borderNodes[border]) {
+        std::vector<int>& owner = clusterNodes[nodes[id].cluster];
+        owner.erase(std::find(owner.begin(), owner.end(), id));
+        nodes[id] = Node();
+        freeNodes.push_back(id);
+    }
+    borderNodes[border].clear();
+
+    const int clusterCount = clustersX * clustersY;
+    const bool bottom = border >= clusterCount;
+    const int c = bottom ? border - clusterCount : border;
+    const int cx = c % clustersX;
+    const int cy = c / clustersX;
+    if (!bottom && cx + 1 >= clustersX) return;
+    if (bottom && cy + 1 >= clustersY) return;
+
+    // Tiles along the border on this cluster's side; the partner is one step
+    // right or down
+    const int ox = bottom ? cx * CLUSTER : (cx + 1) * CLUSTER - 1;
+    const int oy = bottom ? (cy + 1) * CLUSTER - 1 : cy * CLUSTER;
+    const int len = bottom ? std::min(CLUSTER, width - ox) : std::min(CLUSTER, height - oy);
+    const int stepX = bottom ? 1 : 0;
+    const int stepY = bottom ? 0 : 1;
+    const int acrossX = bottom ? 0 : 1;
+    const int acrossY = bottom ? 1 : 0;
+
+    auto crossing = [&](int i) {
+        int x = ox + i * stepX;
+        int y = oy + i * stepY;
+        float near = costAt(x, y);
+        float far = costAt(x + acrossX, y + acrossY);
+        return (near < 0.0f || far < 0.0f) ? -1.0f : (near + far) * 0.5f;
+    };
+
+    auto addEntrance = [&](int i, float cost) {
+        int x = ox + i * stepX;
+        int y = oy + i * stepY;
+        int a = addNode(x, y);
+        int b = addNode(x + acrossX, y + acrossY);
+        nodes[a].partner = b;
+        nodes[a].partnerCost = cost;
+        nodes[b].partner = a;
+        nodes[b].partnerCost = cost;
+        borderNodes[border].push_back(a);
+        borderNodes[border].push_back(b);
+    };
+
+    for (int i = 0; i < len;) {
+        if (crossing(i) < 0.0f) {
+            i++;
+            continue;
+        }
+        int runStart = i;
+        while (i < len && crossing(i) >= 0.0f) i++;
+        int runEnd = i - 1;
+        if (runEnd - runStart + 1 >= WIDE_ENTRANCE) {
+            addEntrance(runStart, crossing(runStart));
+            addEntrance(runEnd, crossing(runEnd));
+        } else {
+            int mid = (runStart + runEnd) / 2;
+            addEntrance(mid, crossing(mid));
+        }
+    }
+}
+
+void HpaPathfinder::linkCluster(int cluster) {
+    thread_local LocalSearch search;
+    search.load(tileCost, width, height, cluster % clustersX, cluster / clustersX);
+
+    // Costs are symmetric, so one search links both directions of a pair
+    const std::vector<int>& members = clusterNodes[cluster];
+    std::vector<uint8_t>& paths = clusterPaths[cluster];
+    paths.clear();
+    for (int id : members) nodes[id].intra.clear();
+    for (size_t i = 0; i + 1 < members.size(); i++) {
+        Node& n = nodes[members[i]];
+        search.run(n.tx, n.ty);
+        for (size_t j = i + 1; j < members.size(); j++) {
+            Node& m = nodes[members[j]];
+            float d = search.distAt(m.tx, m.ty);
+            if (d == INF) continue;
+
+            // n -> m is the parent chain from m, reversed; m -> n walks it
+            // forwards and ends on n
+            uint32_t forward = (uint32_t)paths.size();
+            for (int t = search.localIndex(m.tx, m.ty); search.parent[t] >= 0; t = search.parent[t]) {
+                paths.push_back((uint8_t)t);
+            }
+            uint32_t len = (uint32_t)paths.size() - forward;
+            std::reverse(paths.begin() + forward, paths.end());
+            uint32_t backward = (uint32_t)paths.size();
+            for (uint32_t k = 1; k < len; k++) paths.push_back(paths[forward + len - 1 - k]);
+            if (len > 0) paths.push_back((uint8_t)search.localIndex(n.tx, n.ty));
+
+            n.intra.push_back({ members[j], d, forward, len });
+            m.intra.push_back({ members[i], d, backward, len });
+        }
+    }
+}
+
+// True when a unit walking the straight line between the two tile centres
+// only crosses open tiles, including both sides of any exact corner
+bool HpaPathfinder::lineWalkable(int ax, int ay, int bx, int by) const {
+    int dx = std::abs(bx - ax);
+    int dy = std::abs(by - ay);
+    int sx = bx > ax ? 1 : -1;
+    int sy = by > ay ? 1 : -1;
+    int error = dx - dy;
+    int x = ax;
+    int y = ay;
+    for (int n = dx + dy; n > 0; n--) {
+        if (error > 0) {
+            x += sx;
+            error -= 2 * dy;
+        } else if (error < 0) {
+            y += sy;
+            error += 2 * dx;
+        } else {
+            if (costAt(x + sx, y) < 0.0f || costAt(x, y + sy) < 0.0f) return false;
+            x += sx;
+            y += sy;
+            error += 2 * dx - 2 * dy;
+            n--;
+        }
+        if (costAt(x, y) < 0.0f) return false;
+    }
+    return true;
+}
+
+size_t HpaPathfinder::edgeCount() const {
+    size_t count = 0;
+    for (const std::vector<int>& members : clusterNodes) {
+        for (int id : members) count += nodes[id].intra.size() + (nodes[id].partner >= 0 ? 1 : 0);
+    }
+    return count;
+}
+
+// ─────────────────────── queries ───────────────────────
+
+bool HpaPathfinder::findPath(const Terrain& terrain, Vector2 fromPx, Vector2 toPx, std::vector<Vector2>& out) const {
+    out.clear();
+    if (!isBuilt()) return false;
+
+    auto toTile = [&](Vector2 p, int& tx, int& ty, bool& moved) {
+        tx = std::clamp((int)std::floor(p.x / Terrain::TILE_PX), 0, width - 1);
+        ty = std::clamp((int)std::floor(p.y / Terrain::TILE_PX), 0, height - 1);
+        moved = false;
+        if (costAt(tx, ty) >= 0.0f) return true;
+        moved = true;
+        return terrain.findNearestPassable(tx, ty, tx, ty) && costAt(tx, ty) >= 0.0f;
+    };
+    int sx, sy, gx, gy;
+    bool startMoved, goalMoved;
+    if (!toTile(fromPx, sx, sy, startMoved) || !toTile(toPx, gx, gy, goalMoved)) return false;
+
+    const int sc = clusterOf(sx, sy);
+    const int gc = clusterOf(gx, gy);
+    thread_local LocalSearch fromStart;
+    thread_local LocalSearch toGoal;
+    fromStart.load(tileCost, width, height, sc % clustersX, sc / clustersX);
+    fromStart.run(sx, sy);
+    toGoal.load(tileCost, width, height, gc % clustersX, gc / clustersX);
+    toGoal.run(gx, gy);
+
+    // Best complete route so far: straight inside one cluster, or through
+    // the graph ending at lastNode
+    float best = (sc == gc) ? fromStart.distAt(gx, gy) : INF;
+    int lastNode = -1;
+
+    thread_local GraphSearch graph;
+    graph.reset(nodes.size());
+    auto heuristic = [&](int id) { return Octile(nodes[id].tx - gx, nodes[id].ty - gy) * minStepCost; };
+    auto relax = [&](int id, float g, int from) {
+        if (g >= graph.gOf(id)) return;
+        graph.g[id] = g;
+        graph.parent[id] = from;
+        graph.seen[id] = graph.stamp;
+        graph.heap.push_back({ g + heuristic(id), id });
+        std::push_heap(graph.heap.begin(), graph.heap.end(), std::greater<>());
+    };
+
+    for (int id : clusterNodes[sc]) {
+        float d = fromStart.distAt(nodes[id].tx, nodes[id].ty);
+        if (d < INF) relax(id, d, -1);
+    }
+    while (!graph.heap.empty()) {
+        std::pop_heap(graph.heap.begin(), graph.heap.end(), std::greater<>());
+        auto [f, id] = graph.heap.back();
+        graph.heap.pop_back();
+        if (f >= best) break;
+        float g = graph.g[id];
+        if (f > g + heuristic(id)) continue; // stale entry
+
+        const Node& n = nodes[id];
+        if (n.cluster == gc) {
+            float rest = toGoal.distAt(n.tx, n.ty);
+            if (g + rest < best) {
+                best = g + rest;
+                lastNode = id;
+            }
+        }
+        if (n.partner >= 0) relax(n.partner, g + n.partnerCost, id);
+        for (const Edge& e : n.intra) relax(e.to, g + e.cost, id);
+    }
+    if (best == INF) return false;
+
+    // Refine every hop back into tiles
+    thread_local std::vector<int> chain;
+    thread_local std::vector<TilePoint> tiles;
+    chain.clear();
+    tiles.clear();
+    for (int id = lastNode; id >= 0; id = graph.parent[id]) chain.push_back(id);
+    std::reverse(chain.begin(), chain.end());
+
+    if (chain.empty()) {
+        fromStart.appendTo(gx, gy, tiles);
+    } else {
+        fromStart.appendTo(nodes[chain[0]].tx, nodes[chain[0]].ty, tiles);
+        for (size_t i = 1; i < chain.size(); i++) {
+            const Node& a = nodes[chain[i - 1]];
+            const Node& b = nodes[chain[i]];
+            if (a.cluster != b.cluster) {
+                tiles.push_back({ b.tx, b.ty });
+                continue;
+            }
+            const Edge* hop = nullptr;
+            for (const Edge& e : a.intra) {
+                if (e.to == chain[i]) hop = &e;
+            }
+            const uint8_t* local = clusterPaths[a.cluster].data() + hop->path;
+            int x0 = (a.cluster % clustersX) * CLUSTER;
+            int y0 = (a.cluster / clustersX) * CLUSTER;
+            int w = std::min(CLUSTER, width - x0);
+            for (uint32_t k = 0; k < hop->pathLen; k++) tiles.push_back({ x0 + local[k] % w, y0 + local[k] / w });
+        }
+        toGoal.appendFrom(nodes[chain.back()].tx, nodes[chain.back()].ty, tiles);
+    }
+
+    // Keep only the tiles a straight walk cannot skip
+    auto centre = [](TilePoint t) {
+        return Vector2{ ((float)t.x + 0.5f) * Terrain::TILE_PX, ((float)t.y + 0.5f) * Terrain::TILE_PX };
+    };
+    out.push_back(fromPx);
+    if (startMoved) out.push_back(centre(tiles.front()));
+    size_t anchor = 0;
+    const size_t last = tiles.size() - 1;
+    while (anchor < last) {
+        size_t reach = anchor + 1;
+        size_t limit = std::min(last, anchor + SMOOTH_LOOKAHEAD);
+        while (reach < limit && lineWalkable(tiles[anchor].x, tiles[anchor].y, tiles[reach + 1].x, tiles[reach + 1].y)) reach++;
+        if (reach < last) out.push_back(centre(tiles[reach]));
+        anchor = reach;
+    }
+    out.push_back(goalMoved ? centre(tiles.back()) : toPx);
+    return true;
+}
@@ -0,0 +1,161 @@
+#include "terrain/land_regions.h"
+
+#include <algorithm>
+
+namespace {
+
+// Label of tiles whose region is being recomputed
+constexpr int32_t ERASED = -2;
+const int DX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+const int DY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+bool Walkable(const Terrain& terrain, int x, int y) {
+    return terrain.getWalkCost(x, y) >= 0.0f;
+}
+
+} // namespace
+
+void LandRegions::build(const Terrain& terrain) {
+    width = terrain.getWidth();
+    height = terrain.getHeight();
+    labels.assign((size_t)width * height, NONE);
+    sizes.clear();
+    liveRegions = 0;
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (labels[(size_t)y * width + x] == NONE && Walkable(terrain, x, y)) {
+                fill(terrain, x, y, (int)sizes.size());
+            }
+        }
+    }
+}
+
+void LandRegions::save(BlobWriter& out) const {
+    out.put(width);
+    out.put(height);
+    out.put((uint64_t)liveRegions);
+    out.putVector(labels);
+    out.putVector(sizes);
+}
+
+bool LandRegions::load(BlobReader& in, const Terrain& terrain) {
+    uint64_t live = 0;
+    if (!in.get(width) || !in.get(height) || !in.get(live) || !in.getVector(labels) || !in.getVector(sizes)) return false;
+    liveRegions = (size_t)live;
+    if (width != terrain.getWidth() || height != terrain.getHeight() || labels.size() != (size_t)width * height ||
+        live > sizes.size()) {
+        width = 0;
+        return false;
+    }
+    for (int32_t l : labels) {
+        if (l != NONE && (l < 0 || l >= (int32_t)sizes.size())) {
+            width = 0;
+            return false;
+        }
+    }
+    return true;
+}
+
+void LandRegions::fill(const Terrain& terrain, int x, int y, int label) {
+    sizes.push_back(0);
+    liveRegions++;
+    int& size = sizes.back();
+
+    labels[(size_t)y * width + x] = label;
+    stack.clear();
+    stack.push_back(y * width + x);
+    while (!stack.empty()) {
+        int i = stack.back();
+        stack.pop_back();
+        size++;
+        int cx = i % width;
+        int cy = i / width;
+        for (int k = 0; k < 8; k++) {
+            int nx = cx + DX[k];
+            int ny = cy + DY[k];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+            int32_t& l = labels[(size_t)ny * width + nx];
+            if (l >= 0 || !Walkable(terrain, nx, ny)) continue;
+            if (k >= 4 && (!Walkable(terrain, nx, cy) || !Walkable(terrain, cx, ny))) continue;
+            l = label;
+            stack.push_back(ny * width + nx);
+        }
+    }
+}
+
+void LandRegions::update(const Terrain& terrain, TileRect rect) {
+    if (!isBuilt()) return;
+    // Tiles next to the edit may have gained or lost a link through it
+    int x0 = std::max(rect.x - 1, 0);
+    int y0 = std::max(rect.y - 1, 0);
+    int x1 = std::min(rect.x + rect.w + 1, width);
+    int y1 = std::min(rect.y + rect.h + 1, height);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    // Relabelling erases and refills each touched region, so when they cover
+    // most of the map a single fresh pass is cheaper
+    size_t touched = 0;
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            int32_t l = labels[(size_t)y * width + x];
+            if (l < 0 || sizes[l] < 0) continue;
+            touched += sizes[l];
+            sizes[l] = -sizes[l];
+        }
+    }
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            int32_t l = labels[(size_t)y * width + x];
+            if (l >= 0 && sizes[l] < 0) sizes[l] = -sizes[l];
+        }
+    }
+    if (touched * 2 > (size_t)width * height) {
+        build(terrain);
+        return;
+    }
+
+    // Erase every region that reaches into the edit, following the old labels
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            int32_t old = labels[(size_t)y * width + x];
+            if (old < 0) continue;
+            sizes[old] = 0;
+            liveRegions--;
+            labels[(size_t)y * width + x] = ERASED;
+            stack.clear();
+            stack.push_back(y * width + x);
+            while (!stack.empty()) {
+                int i = stack.back();
+                stack.pop_back();
+                int cx = i % width;
+                int cy = i / width;
+                for (int k = 0; k < 8; k++) {
+                    int nx = cx + DX[k];
+                    int ny = cy + DY[k];
+                    if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+                    int32_t& l = labels[(size_t)ny * width + nx];
+                    if (l != old) continue;
+                    l = ERASED;
+                    stack.push_back(ny * width + nx);
+                }
+            }
+        }
+    }
+
+    // Relabel from the edit outward. Every piece of an erased region
+    // touched the edit, so fills seeded here reach all of them, and since
+    // untouched walkable tiles keep their labels the fills stay inside
+    // the erased regions.
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            int32_t& l = labels[(size_t)y * width + x];
+            if (l >= 0) continue;
+            if (Walkable(terrain, x, y)) {
+                fill(terrain, x, y, (int)sizes.size());
+            } else {
+                l = NONE;
+            }
+        }
+    }
+}
@@ -0,0 +1,325 @@
+#include "terrain/noise.h"
+#include <atomic>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define WORLDBOX_NOISE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define WORLDBOX_TARGET_AVX2
+#else
+#define WORLDBOX_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// ─────────────────────── scalar reference ───────────────────────
+
+static inline float Fade(float t) {
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+static inline float Lerp(float a, float b, float t) {
+    return a + t * (b - a);
+}
+
+static inline float Grad(int hash, float x, float y) {
+    int h = hash & 15;
+    float u = h < 8 ? x : y;
+    float v = h < 4 ? y : (h == 12 || h == 14 ? x : 0.0f);
+    return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+}
+
+float PerlinNoise(const int* perm, float x, float y) {
+    int xi = (int)std::floor(x) & 255;
+    int yi = (int)std::floor(y) & 255;
+
+    float xf = x - std::floor(x);
+    float yf = y - std::floor(y);
+
+    float u = Fade(xf);
+    float v = Fade(yf);
+
+    int aa = perm[perm[xi]     + yi];
+    int ab = perm[perm[xi]     + yi + 1];
+    int ba = perm[perm[xi + 1] + yi];
+    int bb = perm[perm[xi + 1] + yi + 1];
+
+    float x1 = Lerp(Grad(aa, xf, yf),        Grad(ba, xf - 1.0f, yf), u);
+    float x2 = Lerp(Grad(ab, xf, yf - 1.0f), Grad(bb, xf - 1.0f, yf - 1.0f), u);
+
+    return Lerp(x1, x2, v);
+}
+
+float Fbm(const int* perm, float x, float y, int octaves) {
+    float value     = 0.0f;
+    float amplitude = 0.5f;
+    float frequency = 1.0f;
+    float maxValue  = 0.0f;
+
+    for (int i = 0; i < octaves; i++) {
+        value    += amplitude * PerlinNoise(perm, x * frequency, y * frequency);
+        maxValue += amplitude;
+        amplitude *= 0.5f;
+        frequency *= 2.0f;
+    }
+
+    return value / maxValue;
+}
+
+#ifdef WORLDBOX_NOISE_X86
+
+// ─────────────────────── SSE2, 4 points ───────────────────────
+
+// SSE2 has no floor; truncate and step down where that rounded up
+static inline __m128 Floor4(__m128 x) {
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f)));
+}
+
+static inline __m128 Fade4(__m128 t) {
+    __m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))),
+                              _mm_set1_ps(10.0f));
+    return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+}
+
+static inline __m128 Lerp4(__m128 a, __m128 b, __m128 t) {
+    return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+}
+
+static inline __m128 Select4(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128 Grad4(__m128i hash, __m128 x, __m128 y) {
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+
+    __m128 lt8 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8)));
+    __m128 lt4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+    __m128 is12or14 = _mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(h, _mm_set1_epi32(12)),
+                                                    _mm_cmpeq_epi32(h, _mm_set1_epi32(14))));
+    __m128 u = Select4(lt8, x, y);
+    __m128 v = Select4(lt4, y, _mm_and_ps(is12or14, x));
+
+    __m128 negU = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+    __m128 negV = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), _mm_set1_epi32(2)));
+    u = _mm_xor_ps(u, _mm_and_ps(negU, sign));
+    v = _mm_xor_ps(v, _mm_and_ps(negV, sign));
+    return _mm_add_ps(u, v);
+}
+
+static inline __m128 PerlinNoise4(const int* perm, __m128 x, __m128 y) {
+    __m128 fx = Floor4(x);
+    __m128 fy = Floor4(y);
+
+    alignas(16) int xi[4];
+    alignas(16) int yi[4];
+    _mm_store_si128((__m128i*)xi, _mm_and_si128(_mm_cvttps_epi32(fx), _mm_set1_epi32(255)));
+    _mm_store_si128((__m128i*)yi, _mm_and_si128(_mm_cvttps_epi32(fy), _mm_set1_epi32(255)));
+
+    // No gather before AVX2
+    alignas(16) int aa[4], ab[4], ba[4], bb[4];
+    for (int i = 0; i < 4; i++) {
+        aa[i] = perm[perm[xi[i]]     + yi[i]];
+        ab[i] = perm[perm[xi[i]]     + yi[i] + 1];
+        ba[i] = perm[perm[xi[i] + 1] + yi[i]];
+        bb[i] = perm[perm[xi[i] + 1] + yi[i] + 1];
+    }
+
+    __m128 xf = _mm_sub_ps(x, fx);
+    __m128 yf = _mm_sub_ps(y, fy);
+    __m128 u = Fade4(xf);
+    __m128 v = Fade4(yf);
+
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 xf1 = _mm_sub_ps(xf, one);
+    __m128 yf1 = _mm_sub_ps(yf, one);
+
+    __m128 x1 = Lerp4(Grad4(_mm_load_si128((const __m128i*)aa), xf, yf),
+                      Grad4(_mm_load_si128((const __m128i*)ba), xf1, yf), u);
+    __m128 x2 = Lerp4(Grad4(_mm_load_si128((const __m128i*)ab), xf, yf1),
+                      Grad4(_mm_load_si128((const __m128i*)bb), xf1, yf1), u);
+    return Lerp4(x1, x2, v);
+}
+
+static void FbmSse2(const int* perm, const float* xs, const float* ys, int count, int octaves, float* out) {
+    for (int i = 0; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(xs + i);
+        __m128 y = _mm_loadu_ps(ys + i);
+
+        __m128 value    = _mm_setzero_ps();
+        float amplitude = 0.5f;
+        float frequency = 1.0f;
+        float maxValue  = 0.0f;
+
+        for (int o = 0; o < octaves; o++) {
+            __m128 f = _mm_set1_ps(frequency);
+            __m128 n = PerlinNoise4(perm, _mm_mul_ps(x, f), _mm_mul_ps(y, f));
+            value = _mm_add_ps(value, _mm_mul_ps(_mm_set1_ps(amplitude), n));
+            maxValue  += amplitude;
+            amplitude *= 0.5f;
+            frequency *= 2.0f;
+        }
+
+        _mm_storeu_ps(out + i, _mm_div_ps(value, _mm_set1_ps(maxValue)));
+    }
+}
+
+// ─────────────────────── AVX2, 8 points ───────────────────────
+
+WORLDBOX_TARGET_AVX2
+static inline __m256 Fade8(__m256 t) {
+    __m256 inner = _mm256_add_ps(_mm256_mul_ps(t, _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)),
+                                                                _mm256_set1_ps(15.0f))),
+                                 _mm256_set1_ps(10.0f));
+    return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), inner);
+}
+
+WORLDBOX_TARGET_AVX2
+static inline __m256 Lerp8(__m256 a, __m256 b, __m256 t) {
+    return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+}
+
+WORLDBOX_TARGET_AVX2
+static inline __m256 Grad8(__m256i hash, __m256 x, __m256 y) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(15));
+
+    __m256 lt8 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(8), h));
+    __m256 lt4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+    __m256 is12or14 = _mm256_castsi256_ps(_mm256_or_si256(_mm256_cmpeq_epi32(h, _mm256_set1_epi32(12)),
+                                                          _mm256_cmpeq_epi32(h, _mm256_set1_epi32(14))));
+    __m256 u = _mm256_blendv_ps(y, x, lt8);
+    __m256 v = _mm256_blendv_ps(_mm256_and_ps(is12or14, x), y, lt4);
+
+    __m256i one = _mm256_set1_epi32(1);
+    __m256i two = _mm256_set1_epi32(2);
+    __m256 negU = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(h, one), one));
+    __m256 negV = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(h, two), two));
+    u = _mm256_xor_ps(u, _mm256_and_ps(negU, sign));
+    v = _mm256_xor_ps(v, _mm256_and_ps(negV, sign));
+    return _mm256_add_ps(u, v);
+}
+
+WORLDBOX_TARGET_AVX2
+static inline __m256 PerlinNoise8(const int* perm, __m256 x, __m256 y) {
+    __m256 fx = _mm256_floor_ps(x);
+    __m256 fy = _mm256_floor_ps(y);
+
+    const __m256i mask = _mm256_set1_epi32(255);
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i xi = _mm256_and_si256(_mm256_cvttps_epi32(fx), mask);
+    __m256i yi = _mm256_and_si256(_mm256_cvttps_epi32(fy), mask);
+
+    __m256i a = _mm256_i32gather_epi32(perm, xi, 4);
+    __m256i b = _mm256_i32gather_epi32(perm, _mm256_add_epi32(xi, one), 4);
+    __m256i aa = _mm256_i32gather_epi32(perm, _mm256_add_epi32(a, yi), 4);
+    __m256i ab = _mm256_i32gather_epi32(perm, _mm256_add_epi32(_mm256_add_epi32(a, yi), one), 4);
+    __m256i ba = _mm256_i32gather_epi32(perm, _mm256_add_epi32(b, yi), 4);
+    __m256i bb = _mm256_i32gather_epi32(perm, _mm256_add_epi32(_mm256_add_epi32(b, yi), one), 4);
+
+    __m256 xf = _mm256_sub_ps(x, fx);
+    __m256 yf = _mm256_sub_ps(y, fy);
+    __m256 u = Fade8(xf);
+    __m256 v = Fade8(yf);
+
+    const __m256 onef = _mm256_set1_ps(1.0f);
+    __m256 xf1 = _mm256_sub_ps(xf, onef);
+    __m256 yf1 = _mm256_sub_ps(yf, onef);
+
+    __m256 x1 = Lerp8(Grad8(aa, xf, yf), Grad8(ba, xf1, yf), u);
+    __m256 x2 = Lerp8(Grad8(ab, xf, yf1), Grad8(bb, xf1, yf1), u);
+    return Lerp8(x1, x2, v);
+}
+
+WORLDBOX_TARGET_AVX2
+static void FbmAvx2(const int* perm, const float* xs, const float* ys, int count, int octaves, float* out) {
+    for (int i = 0; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+
+        __m256 value    = _mm256_setzero_ps();
+        float amplitude = 0.5f;
+        float frequency = 1.0f;
+        float maxValue  = 0.0f;
+
+        for (int o = 0; o < octaves; o++) {
+            __m256 f = _mm256_set1_ps(frequency);
+            __m256 n = PerlinNoise8(perm, _mm256_mul_ps(x, f), _mm256_mul_ps(y, f));
+            value = _mm256_add_ps(value, _mm256_mul_ps(_mm256_set1_ps(amplitude), n));
+            maxValue  += amplitude;
+            amplitude *= 0.5f;
+            frequency *= 2.0f;
+        }
+
+        _mm256_storeu_ps(out + i, _mm256_div_ps(value, _mm256_set1_ps(maxValue)));
+    }
+}
+
+static bool CpuHasAvx2() {
+#if defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 1);
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx = (regs[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // WORLDBOX_NOISE_X86
+
+// ─────────────────────── dispatch ───────────────────────
+
+NoiseKernel DetectNoiseKernel() {
+#ifdef WORLDBOX_NOISE_X86
+    static const NoiseKernel best = CpuHasAvx2() ? NoiseKernel::AVX2 : NoiseKernel::SSE2;
+    return best;
+#else
+    return NoiseKernel::SCALAR;
+#endif
+}
+
+static std::atomic<int> activeKernel{ -1 };
+
+NoiseKernel GetNoiseKernel() {
+    int k = activeKernel.load(std::memory_order_relaxed);
+    return (k < 0) ? DetectNoiseKernel() : (NoiseKernel)k;
+}
+
+void SetNoiseKernel(NoiseKernel kernel) {
+    if ((int)kernel > (int)DetectNoiseKernel()) kernel = DetectNoiseKernel();
+    activeKernel.store((int)kernel, std::memory_order_relaxed);
+}
+
+const char* NoiseKernelName(NoiseKernel kernel) {
+    switch (kernel) {
+        case NoiseKernel::AVX2: return "AVX2";
+        case NoiseKernel::SSE2: return "SSE2";
+        default:                return "scalar";
+    }
+}
+
+void FbmBatch(const int* perm, const float* xs, const float* ys, int count, int octaves, float* out) {
+    int done = 0;
+#ifdef WORLDBOX_NOISE_X86
+    NoiseKernel kernel = GetNoiseKernel();
+    if (kernel == NoiseKernel::AVX2) {
+        int n = count & ~7;
+        FbmAvx2(perm, xs, ys, n, octaves, out);
+        done = n;
+    }
+    if (kernel != NoiseKernel::SCALAR) {
+        int n = done + ((count - done) & ~3);
+        FbmSse2(perm, xs + done, ys + done, n - done, octaves, out + done);
+        done = n;
+    }
+#endif
+    for (int i = done; i < count; i++) {
+        out[i] = Fbm(perm, xs[i], ys[i], octaves);
+    }
+}
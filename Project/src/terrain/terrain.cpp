@@ -1,10 +1,63 @@
 #include "terrain/terrain.h"
+#include "terrain/blob.h"
+#include "terrain/distance_field.h"
+#include "terrain/noise.h"
+#include <atomic>
 #include <cmath>
 #include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+// ─────────────────────── chunk store ───────────────────────
+
+struct Terrain::ChunkStore {
+    std::unique_ptr<std::atomic<Chunk*>[]> table;
+    size_t chunkCount = 0;
+    // Serializes loads; the fast path in chunkAt never takes it
+    std::mutex loadMutex;
+
+    // Evicted modified chunks, one fixed-size slot of packed tiles each
+    std::FILE* cache = nullptr;
+    bool cacheFailed = false;
+    std::vector<long> cacheSlot; // per chunk, -1 = not cached
+    long nextSlot = 0;
+
+    size_t budget = 0;
+    ChunkStats stats;
+
+    ~ChunkStore() {
+        for (size_t i = 0; i < chunkCount; i++) delete table[i].load(std::memory_order_relaxed);
+        if (cache) std::fclose(cache);
+    }
+
+    bool writeSlot(int ci, const Chunk& chunk) {
+        if (!cache && !cacheFailed) {
+            cache = std::tmpfile();
+            cacheFailed = (cache == nullptr);
+        }
+        if (!cache) return false;
+        if (cacheSlot[ci] < 0) cacheSlot[ci] = nextSlot++;
+        long offset = cacheSlot[ci] * (long)sizeof(chunk.tiles);
+        return std::fseek(cache, offset, SEEK_SET) == 0 &&
+               std::fwrite(chunk.tiles, sizeof(chunk.tiles), 1, cache) == 1;
+    }
+
+    bool readSlot(int ci, Chunk& chunk) {
+        long offset = cacheSlot[ci] * (long)sizeof(chunk.tiles);
+        return std::fseek(cache, offset, SEEK_SET) == 0 &&
+               std::fread(chunk.tiles, sizeof(chunk.tiles), 1, cache) == 1;
+    }
+};
+
+Terrain::Terrain() = default;
+Terrain::Terrain(Terrain&&) noexcept = default;
+Terrain& Terrain::operator=(Terrain&&) noexcept = default;
+Terrain::~Terrain() = default;
 
 Terrain::Terrain(int width, int height, unsigned int seed)
-    : width(width), height(height), seed(seed),
-      tiles(width * height) {
+    : width(width), height(height), seed(seed) {
 
     // ── Deep Water ──
     TileProperties deepWaterProps;
@@ -99,27 +152,220 @@ Terrain::Terrain(int width, int height, unsigned int seed)
     biomes.push_back({"Hills",         {138, 132, 92, 255},   0.67f, 0.80f, 0.0f, 1.0f, TileType::Stone, hillsProps});
     biomes.push_back({"Mountain",      {108, 98, 88, 255},    0.80f, 0.92f, 0.0f, 1.0f, TileType::Stone, mountainProps});
     biomes.push_back({"Snow Peak",     {232, 238, 250, 255},  0.92f, 1.0f,  0.0f, 1.0f, TileType::Stone, snowProps});
+
+    buildPermutation();
+    buildBiomeTables();
+    biomeLut.build(biomes);
+
+    chunksX = (width + CHUNK_MASK) >> CHUNK_SHIFT;
+    chunksY = (height + CHUNK_MASK) >> CHUNK_SHIFT;
+    store = std::make_unique<ChunkStore>();
+    store->chunkCount = (size_t)chunksX * chunksY;
+    store->table = std::make_unique<std::atomic<Chunk*>[]>(store->chunkCount);
+    store->cacheSlot.assign(store->chunkCount, -1);
+    chunkTable = store->table.get();
 }
 
-// ─────────────────────── noise helpers ───────────────────────
+Terrain::Chunk* Terrain::loadChunk(int ci) const {
+    std::lock_guard<std::mutex> lock(store->loadMutex);
+    Chunk* chunk = chunkTable[ci].load(std::memory_order_acquire);
+    if (chunk) return chunk; // another thread got here first
+
+    chunk = new Chunk();
+    int cx = ci % chunksX;
+    int cy = ci / chunksX;
+    if (store->cacheSlot[ci] >= 0) {
+        // The slot holds edits the seed can't reproduce, so regenerating
+        // would drop them without a trace
+        if (!store->readSlot(ci, *chunk)) {
+            delete chunk;
+            throw std::runtime_error("Terrain: failed to read an evicted chunk back from the cache");
+        }
+        for (int i = 0; i < CHUNK_TILES; i++) refreshTile(*chunk, i);
+        store->stats.loadedFromDisk++;
+    } else {
+        generateChunk(*chunk, cx, cy);
+        store->stats.generated++;
+    }
+    chunk->lastUsed.store(useEpoch, std::memory_order_relaxed);
+    chunkTable[ci].store(chunk, std::memory_order_release);
+    store->stats.resident++;
+    return chunk;
+}
+
+void Terrain::dropAllChunks() {
+    if (!store) return;
+    for (size_t i = 0; i < store->chunkCount; i++) {
+        delete chunkTable[i].exchange(nullptr, std::memory_order_relaxed);
+    }
+    std::fill(store->cacheSlot.begin(), store->cacheSlot.end(), -1);
+    store->nextSlot = 0;
+    store->stats.resident = 0;
+}
+
+void Terrain::setResidentChunkBudget(size_t chunks) {
+    if (store) store->budget = chunks;
+}
+
+void Terrain::trimResident() {
+    if (!store) return;
+    uint32_t epoch = useEpoch++;
+    if (store->budget == 0 || store->stats.resident <= store->budget) return;
+
+    std::vector<std::pair<uint32_t, int>> resident;
+    resident.reserve(store->stats.resident);
+    for (size_t i = 0; i < store->chunkCount; i++) {
+        Chunk* c = chunkTable[i].load(std::memory_order_relaxed);
+        if (c) resident.push_back({ c->lastUsed.load(std::memory_order_relaxed), (int)i });
+    }
+    std::sort(resident.begin(), resident.end());
+
+    size_t excess = resident.size() - store->budget;
+    for (size_t k = 0; k < resident.size() && excess > 0; k++) {
+        // Chunks touched during the last tick stay, even over budget
+        if (resident[k].first >= epoch) break;
+        int ci = resident[k].second;
+        Chunk* c = chunkTable[ci].load(std::memory_order_relaxed);
+        if (c->modified) {
+            // Edits cannot be regenerated; keep the chunk if the cache is unusable
+            if (!store->writeSlot(ci, *c)) continue;
+            store->stats.writtenToDisk++;
+        }
+        chunkTable[ci].store(nullptr, std::memory_order_relaxed);
+        delete c;
+        store->stats.resident--;
+        store->stats.evicted++;
+        excess--;
+    }
+}
+
+Terrain::ChunkStats Terrain::getChunkStats() const {
+    if (!store) return {};
+    ChunkStats stats = store->stats;
+    stats.residentBytes = stats.resident * sizeof(Chunk);
+    return stats;
+}
+
+// ─────────────────────── derived grids ───────────────────────
+
+void Terrain::buildBiomeTables() {
+    std::fill(std::begin(biomeMoveSpeed), std::end(biomeMoveSpeed), 1.0f);
+    std::fill(std::begin(biomeDamage), std::end(biomeDamage), 0.0f);
+    std::fill(std::begin(biomeFlags), std::end(biomeFlags), (uint8_t)0);
+
+    for (size_t i = 0; i < biomes.size() && i < NO_BIOME; i++) {
+        const TileProperties& p = biomes[i].props;
+        uint8_t flags = 0;
+        if (p.canWalk)         flags |= TILE_WALKABLE;
+        if (p.canBuild)        flags |= TILE_BUILDABLE;
+        if (p.isWater)         flags |= TILE_WATER;
+        if (p.canSwim)         flags |= TILE_SWIMMABLE;
+        if (p.damage > 0.0f)   flags |= TILE_DAMAGING;
+        biomeFlags[i] = flags;
+        biomeMoveSpeed[i] = p.moveSpeed;
+        biomeDamage[i] = p.damage;
+    }
+}
 
-float Terrain::fade(float t) const {
-    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+void Terrain::setBiomes(std::vector<Biome> newBiomes) {
+    if (newBiomes.size() > (size_t)MAX_BIOMES) throw std::length_error("Terrain: too many biomes");
+    biomes = std::move(newBiomes);
+    buildBiomeTables();
+    biomeLut.build(biomes);
+    // Chunks loaded later derive from the new tables anyway
+    if (!store) return;
+    for (size_t i = 0; i < store->chunkCount; i++) {
+        Chunk* c = chunkTable[i].load(std::memory_order_relaxed);
+        if (!c) continue;
+        for (int t = 0; t < CHUNK_TILES; t++) refreshTile(*c, t);
+    }
+    if (distances) distances->build(*this);
+}
+
+void Terrain::refreshTile(Chunk& chunk, int local) const {
+    int biome = chunk.tiles[local].biomeIndex;
+    uint8_t b = (biome >= 0 && biome < (int)biomes.size()) ? (uint8_t)biome : NO_BIOME;
+    chunk.biomes[local] = b;
+    chunk.flags[local] = biomeFlags[b];
+}
+
+void Terrain::refreshDerived(TileRect rect) {
+    int x0 = std::max(rect.x, 0);
+    int y0 = std::max(rect.y, 0);
+    int x1 = std::min(rect.x + rect.w, width);
+    int y1 = std::min(rect.y + rect.h, height);
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            Chunk& chunk = chunkAt(x, y);
+            refreshTile(chunk, localIndex(x, y));
+            chunk.modified = true;
+        }
+    }
+    if (distances) distances->update(*this, rect);
+}
+
+// ─────────────────────── packed tile ───────────────────────
+
+// Indexed by VegetationType / OreType
+static const char* const VEGETATION_YIELD_NAMES[] = { "wood", "wood", "wood", "wood", "wood", "wood", "wood" };
+static const char* const ORE_YIELD_NAMES[] = { "ore", "ore", "ore", "ore", "ore", "ore" };
+
+const char* VegetationYieldName(VegetationType type) {
+    return VEGETATION_YIELD_NAMES[(int)type];
+}
+
+const char* OreYieldName(OreType type) {
+    return ORE_YIELD_NAMES[(int)type];
+}
+
+static uint8_t QuantizeUnit8(float value) {
+    return (uint8_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f);
+}
+
+void Tile::setElevation(float value) {
+    elevationQ = (uint16_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f);
+}
+
+void Tile::setMoisture(float value) {
+    moistureQ = QuantizeUnit8(value);
+}
+
+void Tile::setTemperature(float value) {
+    temperatureQ = QuantizeUnit8(value);
 }
 
-float Terrain::lerp(float a, float b, float t) const {
-    return a + t * (b - a);
+VegetationData Tile::getVegetation() const {
+    VegetationData data;
+    data.type = (VegetationType)vegetationType;
+    data.isHarvestable = vegetationHarvestable != 0;
+    data.yieldAmount = vegetationYield;
+    return data;
 }
 
-float Terrain::grad(int hash, float x, float y) const {
-    int h = hash & 15;
-    float u = h < 8 ? x : y;
-    float v = h < 4 ? y : (h == 12 || h == 14 ? x : 0.0f);
-    return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+void Tile::setVegetation(const VegetationData& value) {
+    vegetationType = (uint8_t)value.type;
+    vegetationHarvestable = value.isHarvestable ? 1 : 0;
+    vegetationYield = (uint8_t)std::clamp(value.yieldAmount, 0, 255);
 }
 
-float Terrain::perlinNoise(float x, float y) const {
-    static int permutation[512] = {
+OreData Tile::getOre() const {
+    OreData data;
+    data.type = (OreType)oreType;
+    data.amount = oreAmount;
+    data.isHarvestable = oreHarvestable != 0;
+    return data;
+}
+
+void Tile::setOre(const OreData& value) {
+    oreType = (uint8_t)value.type;
+    oreAmount = (uint16_t)std::clamp(value.amount, 0, 65535);
+    oreHarvestable = value.isHarvestable ? 1 : 0;
+}
+
+// ─────────────────────── noise helpers ───────────────────────
+
+void Terrain::buildPermutation() {
+    static const int permutation[512] = {
         151,160,137,91,90,15,131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,
         8,99,37,240,21,10,23,190,6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,
         35,11,32,57,177,33,88,237,149,56,87,174,20,125,136,171,168,68,175,74,165,71,
@@ -148,74 +394,142 @@ float Terrain::perlinNoise(float x, float y) const {
     };
 
     int shift = seed % 256;
-    int perm[512];
     for (int i = 0; i < 512; i++) {
         perm[i] = permutation[(i + shift) % 256];
     }
+}
 
-    int xi = (int)std::floor(x) & 255;
-    int yi = (int)std::floor(y) & 255;
-
-    float xf = x - std::floor(x);
-    float yf = y - std::floor(y);
+// ─────────────────────── generation ───────────────────────
 
-    float u = fade(xf);
-    float v = fade(yf);
+void Terrain::generate(int threadCount) {
+    if (!store) return;
+    dropAllChunks();
+    const int chunkCount = (int)store->chunkCount;
+
+    if (threadCount <= 0) threadCount = (int)std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::max(1, std::min(threadCount, chunkCount));
+
+    // Chunks are independent, so any order gives the same map
+    std::atomic<int> nextChunk{0};
+    auto worker = [&]() {
+        for (int ci = nextChunk.fetch_add(1); ci < chunkCount; ci = nextChunk.fetch_add(1)) {
+            Chunk* chunk = new Chunk();
+            generateChunk(*chunk, ci % chunksX, ci / chunksX);
+            chunk->lastUsed.store(useEpoch, std::memory_order_relaxed);
+            chunkTable[ci].store(chunk, std::memory_order_release);
+        }
+    };
 
-    int aa = perm[perm[xi]     + yi];
-    int ab = perm[perm[xi]     + yi + 1];
-    int ba = perm[perm[xi + 1] + yi];
-    int bb = perm[perm[xi + 1] + yi + 1];
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (int t = 1; t < threadCount; t++) threads.emplace_back(worker);
+    worker();
+    for (std::thread& t : threads) t.join();
 
-    float x1 = lerp(grad(aa, xf, yf),        grad(ba, xf - 1.0f, yf), u);
-    float x2 = lerp(grad(ab, xf, yf - 1.0f), grad(bb, xf - 1.0f, yf - 1.0f), u);
+    store->stats.generated += chunkCount;
+    store->stats.resident = chunkCount;
 
-    return lerp(x1, x2, v);
+    distances = std::make_unique<DistanceField>();
+    distances->build(*this);
 }
 
-float Terrain::fbm(float x, float y, int octaves) const {
-    float value     = 0.0f;
-    float amplitude = 0.5f;
-    float frequency = 1.0f;
-    float maxValue  = 0.0f;
-
-    for (int i = 0; i < octaves; i++) {
-        value    += amplitude * perlinNoise(x * frequency, y * frequency);
-        maxValue += amplitude;
-        amplitude *= 0.5f;
-        frequency *= 2.0f;
+void Terrain::save(BlobWriter& out) const {
+    out.put(width);
+    out.put(height);
+    out.put(seed);
+    const int chunkCount = store ? (int)store->chunkCount : 0;
+    for (int ci = 0; ci < chunkCount; ci++) {
+        const Chunk& chunk = chunkAt((ci % chunksX) << CHUNK_SHIFT, (ci / chunksX) << CHUNK_SHIFT);
+        out.append(chunk.tiles, sizeof(chunk.tiles));
     }
-
-    return value / maxValue;
+    out.put((uint8_t)(distances ? 1 : 0));
+    if (distances) distances->save(out);
 }
 
-// ─────────────────────── generation ───────────────────────
+bool Terrain::load(BlobReader& in) {
+    int w = 0, h = 0;
+    unsigned int s = 0;
+    if (!in.get(w) || !in.get(h) || !in.get(s)) return false;
+    if (!store || w != width || h != height || s != seed) return false;
+    dropAllChunks();
+    distances.reset();
+
+    const int chunkCount = (int)store->chunkCount;
+    for (int ci = 0; ci < chunkCount; ci++) {
+        Chunk* chunk = new Chunk();
+        if (!in.read(chunk->tiles, sizeof(chunk->tiles))) {
+            delete chunk;
+            dropAllChunks();
+            return false;
+        }
+        for (int i = 0; i < CHUNK_TILES; i++) refreshTile(*chunk, i);
+        chunk->lastUsed.store(useEpoch, std::memory_order_relaxed);
+        chunkTable[ci].store(chunk, std::memory_order_release);
+    }
+    store->stats.loadedFromDisk += chunkCount;
+    store->stats.resident = chunkCount;
+
+    uint8_t hasDistances = 0;
+    if (!in.get(hasDistances)) return false;
+    if (hasDistances) {
+        distances = std::make_unique<DistanceField>();
+        if (!distances->load(in, *this)) {
+            distances.reset();
+            return false;
+        }
+    }
+    return true;
+}
 
-void Terrain::generate() {
+void Terrain::generateChunk(Chunk& chunk, int cx, int cy) const {
     float seedX = (float)((seed * 16807u) % 10000u);
     float seedY = (float)((seed * 48271u) % 10000u);
 
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            float nx = (float)x + seedX;
-            float ny = (float)y + seedY;
+    const int x0 = cx << CHUNK_SHIFT;
+    const int y0 = cy << CHUNK_SHIFT;
+    const int n = std::min(CHUNK_SIZE, width - x0);
+    const int y1 = std::min(y0 + CHUNK_SIZE, height);
+
+    // One chunk row of every noise layer at a time, so FbmBatch sees runs of
+    // adjacent tiles
+    float xs[CHUNK_SIZE], ys[CHUNK_SIZE];
+    float low[CHUNK_SIZE], mid[CHUNK_SIZE], warpX[CHUNK_SIZE], warpY[CHUNK_SIZE];
+    float detail[CHUNK_SIZE], ridges[CHUNK_SIZE];
+
+    auto layer = [&](float ny, float scale, float offset, int octaves, float* out) {
+        for (int i = 0; i < n; i++) {
+            xs[i] = ((float)(x0 + i) + seedX) * scale + offset;
+            ys[i] = ny * scale + offset;
+        }
+        FbmBatch(perm, xs, ys, n, octaves, out);
+    };
+
+    for (int y = y0; y < y1; y++) {
+        float ny = (float)y + seedY;
+
+        // --- Крупные формы (континенты) ---
+        layer(ny, 0.0015f, 0.0f, 2, low);
+        layer(ny, 0.005f,  0.0f, 3, mid);
+
+        // --- Детали рельефа с warp ---
+        layer(ny, 0.02f, 300.0f, 2, warpX);
+        layer(ny, 0.02f, 700.0f, 2, warpY);
+        for (int i = 0; i < n; i++) {
+            float nx = (float)(x0 + i) + seedX;
+            xs[i] = (nx + warpX[i] * 25.0f) * 0.03f + 500.0f;
+            ys[i] = (ny + warpY[i] * 25.0f) * 0.03f + 500.0f;
+        }
+        FbmBatch(perm, xs, ys, n, 5, detail);
 
-            // --- Крупные формы (континенты) ---
-            float continent_low  = fbm(nx * 0.0015f, ny * 0.0015f, 2);
-            float continent_mid  = fbm(nx * 0.005f,  ny * 0.005f,  3);
-            float continent_base = continent_low * 0.6f + continent_mid * 0.4f;
+        // --- Горы (ridge) ---
+        layer(ny, 0.012f, 1000.0f, 4, ridges);
+
+        for (int i = 0; i < n; i++) {
+            float continent_base = low[i] * 0.6f + mid[i] * 0.4f;
             continent_base = (continent_base + 1.0f) * 0.5f; // [0,1]
             continent_base = std::pow(continent_base, 1.2f); // контраст
 
-            // --- Детали рельефа с warp ---
-            float warpX = fbm(nx * 0.02f + 300.0f, ny * 0.02f + 300.0f, 2) * 25.0f;
-            float warpY = fbm(nx * 0.02f + 700.0f, ny * 0.02f + 700.0f, 2) * 25.0f;
-            float terrain_detail = fbm((nx + warpX) * 0.03f + 500.0f,
-                                       (ny + warpY) * 0.03f + 500.0f, 5);
-
-            // --- Горы (ridge) ---
-            float ridge = fbm(nx * 0.012f + 1000.0f, ny * 0.012f + 1000.0f, 4);
-            ridge = 1.0f - std::abs(ridge);
+            float ridge = 1.0f - std::abs(ridges[i]);
             ridge = std::pow(ridge, 2.5f);
 
             // --- Коэффициент суши (чтобы детали не создавали острова в воде) ---
@@ -223,49 +537,61 @@ void Terrain::generate() {
 
             // --- Финальная высота ---
             float elevation = continent_base;
-            elevation += (terrain_detail * 0.25f + ridge * 0.30f) * land_factor;
+            elevation += (detail[i] * 0.25f + ridge * 0.30f) * land_factor;
             elevation = std::clamp(elevation, 0.0f, 1.0f);
             elevation = std::pow(elevation, 1.3f); // дополнительный контраст
 
-            Tile tile;
-            tile.elevation  = elevation;
-            tile.biomeIndex = getBiomeIndex(elevation, 0.0f, 0.5f);
-            tile.type       = biomes[tile.biomeIndex].groundType;
-            setTile(x, y, tile);
+            int local = localIndex(x0 + i, y);
+            Tile& tile = chunk.tiles[local];
+            tile.setElevation(elevation);
+            tile.biomeIndex = (int8_t)getBiomeIndex(elevation, 0.0f, 0.5f);
+            tile.setType(biomes[tile.biomeIndex].groundType);
+            refreshTile(chunk, local);
         }
     }
+    // Tiles past the map edge keep no biome and no flags
+    for (int i = 0; i < CHUNK_TILES; i++) {
+        if (chunk.tiles[i].biomeIndex < 0) refreshTile(chunk, i);
+    }
 }
 
 // ─────────────────────── biome / tile queries ───────────────────────
 
-int Terrain::getBiomeIndex(float elevation, float moisture, float temperature) const {
-    for (size_t i = 0; i < biomes.size(); ++i) {
-        const Biome& b = biomes[i];
-        if (elevation >= b.minElevation && elevation <= b.maxElevation) {
-            return static_cast<int>(i);
-        }
-    }
-    return 0;
-}
-
 void Terrain::setTile(int x, int y, const Tile& tile) {
     if (x >= 0 && x < width && y >= 0 && y < height) {
-        tiles[y * width + x] = tile;
+        Chunk& chunk = chunkAt(x, y);
+        uint8_t oldFlags = chunk.flags[localIndex(x, y)];
+        chunk.tiles[localIndex(x, y)] = tile;
+        refreshTile(chunk, localIndex(x, y));
+        chunk.modified = true;
+        if (distances && ((oldFlags ^ chunk.flags[localIndex(x, y)]) & (TILE_WALKABLE | TILE_WATER))) {
+            distances->update(*this, { x, y, 1, 1 });
+        }
     }
 }
 
+// Edits made through a non-const reference must be followed by
+// refreshDerived, which also marks the chunk for the disk cache
 Tile& Terrain::getTile(int x, int y) {
-    return tiles[y * width + x];
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        static thread_local Tile outside;
+        outside = Tile();
+        return outside;
+    }
+    return chunkAt(x, y).tiles[localIndex(x, y)];
 }
 
 const Tile& Terrain::getTile(int x, int y) const {
-    return tiles[y * width + x];
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        static const Tile outside;
+        return outside;
+    }
+    return chunkAt(x, y).tiles[localIndex(x, y)];
 }
 
 const Tile* Terrain::getTileAt(float worldX, float worldY) const {
-    int tileSize = 8;
-    int tx = (int)(worldX / tileSize);
-    int ty = (int)(worldY / tileSize);
+    int tx = (int)(worldX / TILE_PX);
+    int ty = (int)(worldY / TILE_PX);
     if (tx < 0 || tx >= width || ty < 0 || ty >= height) return nullptr;
     return &getTile(tx, ty);
 }
@@ -277,11 +603,11 @@ const TileProperties* Terrain::getTilePropertiesAt(float worldX, float worldY) c
 }
 
 const TileProperties& Terrain::getTileProperties(int x, int y) const {
-    if (x < 0 || x >= width || y < 0 || y >= height) {
-        static TileProperties empty;
-        return empty;
-    }
-    return biomes[getTile(x, y).biomeIndex].props;
+    static TileProperties empty;
+    if (x < 0 || x >= width || y < 0 || y >= height) return empty;
+    int biome = getTile(x, y).biomeIndex;
+    if (biome < 0 || biome >= (int)biomes.size()) return empty;
+    return biomes[biome].props;
 }
 
 const Biome* Terrain::getBiomeAt(float worldX, float worldY) const {
@@ -290,28 +616,30 @@ const Biome* Terrain::getBiomeAt(float worldX, float worldY) const {
     return &biomes[tile->biomeIndex];
 }
 
-bool Terrain::canWalk(float worldX, float worldY) const {
-    const TileProperties* p = getTilePropertiesAt(worldX, worldY);
-    return p ? p->canWalk : false;
-}
-
-bool Terrain::canBuild(float worldX, float worldY) const {
-    const TileProperties* p = getTilePropertiesAt(worldX, worldY);
-    return p ? p->canBuild : false;
+std::optional<VegetationData> Terrain::getVegetationAt(float worldX, float worldY) const {
+    const Tile* tile = getTileAt(worldX, worldY);
+    if (!tile) return std::nullopt;
+    return tile->getVegetation();
 }
 
-float Terrain::getMoveSpeedAt(float worldX, float worldY) const {
-    const TileProperties* p = getTilePropertiesAt(worldX, worldY);
-    return p ? p->moveSpeed : 1.0f;
+std::optional<OreData> Terrain::getOreAt(float worldX, float worldY) const {
+    const Tile* tile = getTileAt(worldX, worldY);
+    if (!tile) return std::nullopt;
+    return tile->getOre();
 }
 
 bool Terrain::isPassable(int x, int y) const {
     if (x < 0 || x >= width || y < 0 || y >= height) return false;
-    return getTileProperties(x, y).canWalk;
+    return (chunkAt(x, y).flags[localIndex(x, y)] & TILE_WALKABLE) != 0;
 }
 
 bool Terrain::findNearestPassable(int targetX, int targetY,
                                    int& outX, int& outY, int maxRadius) const {
+    // Passable targets find a neighbour in the first ring anyway
+    if (distances && maxRadius <= DistanceField::RADIUS && targetX >= 0 && targetX < width &&
+        targetY >= 0 && targetY < height && !isPassable(targetX, targetY)) {
+        return distances->nearestPassable(targetX, targetY, outX, outY, maxRadius);
+    }
     for (int r = 1; r <= maxRadius; ++r) {
         for (int dy = -r; dy <= r; ++dy) {
             for (int dx = -r; dx <= r; ++dx) {
@@ -329,119 +657,19 @@ bool Terrain::findNearestPassable(int targetX, int targetY,
     return false;
 }
 
-// ─────────────────────── rendering ───────────────────────
-
-void Terrain::draw() const {
-    const int tileSize = 8;
-
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            const Tile& tile = getTile(x, y);
-            if (tile.biomeIndex < 0) {
-                DrawRectangle(x * tileSize, y * tileSize, tileSize, tileSize, BLACK);
-                continue;
-            }
-
-            const Biome& biome = biomes[tile.biomeIndex];
-            float r = (float)biome.color.r;
-            float g = (float)biome.color.g;
-            float b = (float)biome.color.b;
-
-            // Where this tile sits inside its own biome (0 = low edge, 1 = high)
-            float biomeSpan = biome.maxElevation - biome.minElevation;
-            float biomeT = (biomeSpan > 0.001f)
-                ? (tile.elevation - biome.minElevation) / biomeSpan
-                : 0.5f;
-
-            // ── Two cheap per-tile hashes for colour jitter ──
-            float h1 = std::sin((float)x * 12.9898f + (float)y * 78.233f)  * 43758.5453f;
-            h1 = h1 - std::floor(h1);                       // [0,1]
-            float h2 = std::sin((float)x * 63.726f  + (float)y * 10.873f)  * 28462.234f;
-            h2 = h2 - std::floor(h2);
-
-            float jitter = (h1 - 0.5f) * 2.0f;             // [-1,1]
-
-            if (biome.props.isWater) {
-                // ── Water: depth shading ──
-                // Deep = darker & more saturated; shallow = lighter & greener
-                float depth = 1.0f - biomeT;                // 1 = deepest
-                r = r * (0.55f + biomeT * 0.45f);
-                g = g * (0.60f + biomeT * 0.40f);
-                b = b * (0.70f + biomeT * 0.30f);
-
-                // Specular-ish sparkle on shallow water
-                if (biomeT > 0.6f) {
-                    float sparkle = h2 * (biomeT - 0.6f) * 40.0f;
-                    r += sparkle;
-                    g += sparkle;
-                    b += sparkle * 1.3f;
-                }
-
-                // Very subtle per-tile ripple
-                r += jitter * 6.0f;
-                g += jitter * 8.0f;
-                b += jitter * 10.0f;
-
-            } else {
-                // ── Land biomes ──
-
-                // Gentle brightness ramp across biome elevation band
-                float shade = 0.88f + biomeT * 0.12f;
-                r *= shade;
-                g *= shade;
-                b *= shade;
-
-                // Beach: warmer / cooler sand patches
-                if (tile.biomeIndex == 2) {                  // Beach
-                    float warmth = jitter * 14.0f;
-                    r += warmth;
-                    g += warmth * 0.7f;
-                    b -= std::abs(warmth) * 0.5f;
-                    // Wet sand near water edge
-                    if (biomeT < 0.3f) {
-                        float wet = (0.3f - biomeT) / 0.3f;
-                        r -= wet * 25.0f;
-                        g -= wet * 15.0f;
-                        b += wet * 10.0f;
-                    }
-                }
-                // Plains: yellow-green variation
-                else if (tile.biomeIndex == 3) {             // Plains
-                    r += jitter * 18.0f + h2 * 10.0f;
-                    g += jitter * 12.0f;
-                    b += jitter * 6.0f;
-                }
-                // Forest: dark / light canopy patches
-                else if (tile.biomeIndex == 4) {             // Forest
-                    float canopy = jitter * 16.0f;
-                    r += canopy * 0.4f;
-                    g += canopy;
-                    b += canopy * 0.3f;
-                }
-                // Hills+: general rocky jitter
-                else {
-                    r += jitter * 12.0f;
-                    g += jitter * 10.0f;
-                    b += jitter * 8.0f;
-                }
-
-                // ── Height-based whitening (snow/frost bleed) ──
-                if (tile.elevation > 0.68f) {
-                    float t = (tile.elevation - 0.68f) / 0.32f;  // 0→1
-                    float white = std::pow(t, 1.6f) * 0.55f;
-                    r = r + (255.0f - r) * white;
-                    g = g + (255.0f - g) * white;
-                    b = b + (255.0f - b) * white;
-                }
+int Terrain::getWaterDistance(int x, int y) const {
+    if (width == 0 || height == 0) return DistanceField::RADIUS + 1;
+    x = std::clamp(x, 0, width - 1);
+    y = std::clamp(y, 0, height - 1);
+    if (distances) return distances->waterDistance(x, y);
+    if (getTileFlags(x, y) & TILE_WATER) return 0;
+    for (int r = 1; r <= DistanceField::RADIUS; ++r) {
+        for (int dy = -r; dy <= r; ++dy) {
+            for (int dx = -r; dx <= r; ++dx) {
+                if (abs(dx) != r && abs(dy) != r) continue;
+                if (getTileFlags(x + dx, y + dy) & TILE_WATER) return r;
             }
-
-            // Clamp color components to valid range
-            r = std::clamp(r, 0.0f, 255.0f);
-            g = std::clamp(g, 0.0f, 255.0f);
-            b = std::clamp(b, 0.0f, 255.0f);
-
-            Color finalColor = { (unsigned char)r, (unsigned char)g, (unsigned char)b, 255 };
-            DrawRectangle(x * tileSize, y * tileSize, tileSize, tileSize, finalColor);
         }
     }
-}
\ No newline at end of file
+    return DistanceField::RADIUS + 1;
+}
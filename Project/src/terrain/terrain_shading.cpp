@@ -0,0 +1,118 @@
+#include "terrain/terrain_shading.h"
+#include <algorithm>
+#include <cmath>
+
+Color ShadeTerrainTile(const Terrain& terrain, int x, int y) {
+    const std::vector<Biome>& biomes = terrain.getBiomes();
+    const Tile& tile = terrain.getTile(x, y);
+    if (tile.biomeIndex < 0) return BLACK;
+
+    const Biome& biome = biomes[tile.biomeIndex];
+    const float elevation = tile.getElevation();
+    float r = (float)biome.color.r;
+    float g = (float)biome.color.g;
+    float b = (float)biome.color.b;
+
+    // Where this tile sits inside its own biome (0 = low edge, 1 = high)
+    float biomeSpan = biome.maxElevation - biome.minElevation;
+    float biomeT = (biomeSpan > 0.001f)
+        ? (elevation - biome.minElevation) / biomeSpan
+        : 0.5f;
+
+    // ── Two cheap per-tile hashes for colour jitter ──
+    float h1 = std::sin((float)x * 12.9898f + (float)y * 78.233f)  * 43758.5453f;
+    h1 = h1 - std::floor(h1);                       // [0,1]
+    float h2 = std::sin((float)x * 63.726f  + (float)y * 10.873f)  * 28462.234f;
+    h2 = h2 - std::floor(h2);
+
+    float jitter = (h1 - 0.5f) * 2.0f;             // [-1,1]
+
+    if (biome.props.isWater) {
+        // ── Water: depth shading ──
+        // Deep = darker & more saturated; shallow = lighter & greener
+        float depth = 1.0f - biomeT;                // 1 = deepest
+        r = r * (0.55f + biomeT * 0.45f);
+        g = g * (0.60f + biomeT * 0.40f);
+        b = b * (0.70f + biomeT * 0.30f);
+
+        // Specular-ish sparkle on shallow water
+        if (biomeT > 0.6f) {
+            float sparkle = h2 * (biomeT - 0.6f) * 40.0f;
+            r += sparkle;
+            g += sparkle;
+            b += sparkle * 1.3f;
+        }
+
+        // Very subtle per-tile ripple
+        r += jitter * 6.0f;
+        g += jitter * 8.0f;
+        b += jitter * 10.0f;
+
+    } else {
+        // ── Land biomes ──
+
+        // Gentle brightness ramp across biome elevation band
+        float shade = 0.88f + biomeT * 0.12f;
+        r *= shade;
+        g *= shade;
+        b *= shade;
+
+        // Beach: warmer / cooler sand patches
+        if (tile.biomeIndex == 2) {                  // Beach
+            float warmth = jitter * 14.0f;
+            r += warmth;
+            g += warmth * 0.7f;
+            b -= std::abs(warmth) * 0.5f;
+            // Wet sand near water edge
+            if (biomeT < 0.3f) {
+                float wet = (0.3f - biomeT) / 0.3f;
+                r -= wet * 25.0f;
+                g -= wet * 15.0f;
+                b += wet * 10.0f;
+            }
+        }
+        // Plains: yellow-green variation
+        else if (tile.biomeIndex == 3) {             // Plains
+            r += jitter * 18.0f + h2 * 10.0f;
+            g += jitter * 12.0f;
+            b += jitter * 6.0f;
+        }
+        // Forest: dark / light canopy patches
+        else if (tile.biomeIndex == 4) {             // Forest
+            float canopy = jitter * 16.0f;
+            r += canopy * 0.4f;
+            g += canopy;
+            b += canopy * 0.3f;
+        }
+        // Hills+: general rocky jitter
+        else {
+            r += jitter * 12.0f;
+            g += jitter * 10.0f;
+            b += jitter * 8.0f;
+        }
+
+        // ── Height-based whitening (snow/frost bleed) ──
+        if (elevation > 0.68f) {
+            float t = (elevation - 0.68f) / 0.32f;  // 0→1
+            float white = std::pow(t, 1.6f) * 0.55f;
+            r = r + (255.0f - r) * white;
+            g = g + (255.0f - g) * white;
+            b = b + (255.0f - b) * white;
+        }
+    }
+
+    // Clamp color components to valid range
+    r = std::clamp(r, 0.0f, 255.0f);
+    g = std::clamp(g, 0.0f, 255.0f);
+    b = std::clamp(b, 0.0f, 255.0f);
+
+    return Color{ (unsigned char)r, (unsigned char)g, (unsigned char)b, 255 };
+}
+
+void BakeTerrainColors(const Terrain& terrain, TileRect rect, Color* out) {
+    for (int y = rect.y; y < rect.y + rect.h; ++y) {
+        for (int x = rect.x; x < rect.x + rect.w; ++x) {
+            *out++ = ShadeTerrainTile(terrain, x, y);
+        }
+    }
+}
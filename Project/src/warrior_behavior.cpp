@@ -28,7 +28,7 @@ static Vector2 RotateFromBaseY(Vector2 local, Vector2 forward) {
     };
 }
 
-static void MoveTowards(World& world, NPC& npc, Vector2 target, float dt, float speedMul = 1.0f) {
+static void MoveTowards(World& world, NpcRef npc, Vector2 target, float dt, float speedMul = 1.0f) {
     float terrainSpeed = world.terrain.getMoveSpeedAt(npc.pos.x, npc.pos.y);
     if (terrainSpeed <= 0.0f) {
         npc.vel = {0, 0};
@@ -43,113 +43,10 @@ static void MoveTowards(World& world, NPC& npc, Vector2 target, float dt, float
     }
 
     Vector2 dir = SafeNormalizeEx(to);
-    npc.vel = Vector2Scale(dir, npc.speed * speedMul * terrainSpeed);
+    npc.vel = Vector2Scale(dir, npc.cold.speed * speedMul * terrainSpeed);
     npc.pos = Vector2Add(npc.pos, Vector2Scale(npc.vel, dt));
 }
 
-static int FindNearestBanditAny(const World& world, Vector2 from, float maxRangePx) {
-    const float maxR2 = maxRangePx * maxRangePx;
-    int best = -1;
-    float bestD2 = FLT_MAX;
-
-    for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const auto& o = world.npcs[i];
-        if (!o.alive) continue;
-        if (o.humanRole != NPC::HumanRole::BANDIT) continue;
-
-        float d2 = Dist2(o.pos, from);
-        if (d2 <= maxR2 && d2 < bestD2) {
-            bestD2 = d2;
-            best = i;
-        }
-    }
-
-    return best;
-}
-
-static int FindNearestBanditInGroup(const World& world, Vector2 from, int groupId) {
-    int best = -1;
-    float bestD2 = FLT_MAX;
-
-    for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const auto& o = world.npcs[i];
-        if (!o.alive) continue;
-        if (o.humanRole != NPC::HumanRole::BANDIT) continue;
-        if (o.banditGroupId != groupId) continue;
-
-        float d2 = Dist2(o.pos, from);
-        if (d2 < bestD2) {
-            bestD2 = d2;
-            best = i;
-        }
-    }
-
-    return best;
-}
-
-static int FindNearestEnemyNpcForSettlementWar(World& world, const NPC& attacker, int enemySettlementId, float maxDistPx) {
-    float bestD2 = maxDistPx * maxDistPx;
-    int bestIndex = -1;
-    int bestPriority = 999;
-
-    for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const NPC& other = world.npcs[i];
-        if (!other.alive || other.isDying) continue;
-        if (other.settlementId != enemySettlementId) continue;
-        if (other.id == attacker.id) continue;
-
-        int priority = 999;
-        if (other.humanRole == NPC::HumanRole::WARRIOR) priority = 0;
-        else if (other.humanRole == NPC::HumanRole::CAPTAIN) priority = 1;
-        else if (other.humanRole == NPC::HumanRole::CIVILIAN) priority = 2;
-        else continue;
-
-        float dx = other.pos.x - attacker.pos.x;
-        float dy = other.pos.y - attacker.pos.y;
-        float d2 = dx*dx + dy*dy;
-
-        if (d2 > bestD2) continue;
-
-        if (priority < bestPriority || (priority == bestPriority && d2 < bestD2)) {
-            bestPriority = priority;
-            bestD2 = d2;
-            bestIndex = i;
-        }
-    }
-
-    return bestIndex;
-}
-
-static int FindNearestEnemyCombatNearNpc(World& world, const NPC& npc, float radiusPx) {
-    float bestD2 = radiusPx * radiusPx;
-    int bestIndex = -1;
-    int bestPriority = 999;
-
-    for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const NPC& other = world.npcs[i];
-        if (!other.alive || other.isDying) continue;
-        if (other.settlementId == npc.settlementId) continue;
-
-        int priority = 999;
-        if (other.humanRole == NPC::HumanRole::WARRIOR) priority = 0;
-        else if (other.humanRole == NPC::HumanRole::CAPTAIN) priority = 1;
-        else continue;
-
-        float dx = other.pos.x - npc.pos.x;
-        float dy = other.pos.y - npc.pos.y;
-        float d2 = dx*dx + dy*dy;
-        if (d2 > bestD2) continue;
-
-        if (priority < bestPriority || (priority == bestPriority && d2 < bestD2)) {
-            bestPriority = priority;
-            bestD2 = d2;
-            bestIndex = i;
-        }
-    }
-
-    return bestIndex;
-}
-
 static int FindNearestAliveBarracksIndex(const Settlement& s, Vector2 fromPos)
 {
     float bestD2 = 1e30f;
@@ -173,80 +70,46 @@ static int FindNearestAliveBarracksIndex(const Settlement& s, Vector2 fromPos)
     return bestIndex;
 }
 
-static int FindNearestHostileTroopNearSettlement(World& world, int homeSettlementId, Vector2 homePos, float maxDistPx) {
-    float bestD2 = maxDistPx * maxDistPx;
-    int bestIndex = -1;
-    int bestPriority = 999;
-
-    for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const NPC& other = world.npcs[i];
-        if (!other.alive || other.isDying) continue;
-        if (other.settlementId == homeSettlementId) continue;
-
-        int priority = 999;
-        if (other.humanRole == NPC::HumanRole::WARRIOR) priority = 0;
-        else if (other.humanRole == NPC::HumanRole::CAPTAIN) priority = 1;
-        else if (other.humanRole == NPC::HumanRole::CIVILIAN) priority = 2;
-        else continue;
-
-        float dx = other.pos.x - homePos.x;
-        float dy = other.pos.y - homePos.y;
-        float d2 = dx*dx + dy*dy;
-        if (d2 > bestD2) continue;
-
-        if (priority < bestPriority || (priority == bestPriority && d2 < bestD2)) {
-            bestPriority = priority;
-            bestD2 = d2;
-            bestIndex = i;
-        }
-    }
-
-    return bestIndex;
-}
-
-static void TryMeleeAttack(World& world, NPC& attacker, NPC& target, float dt, float cooldownSeconds) {
-    attacker.attackCooldown -= dt;
-    if (attacker.attackCooldown > 0.0f) return;
+static void TryMeleeAttack(BehaviorContext& ctx, NpcRef attacker, int targetIndex, float dt, float cooldownSeconds) {
+    attacker.cold.attackCooldown -= dt;
+    if (attacker.cold.attackCooldown > 0.0f) return;
 
-    world.BeginNpcAttack(attacker, target.pos);
-    target.hp -= attacker.damage;
-    attacker.attackCooldown = cooldownSeconds;
-
-    if (target.hp <= 0.0f) {
-        target.hp = 0.0f;
-        world.BeginNpcDeath(target);
-    }
+    ctx.world.BeginNpcAttack(attacker, ctx.world.npcs.Pos(targetIndex));
+    ctx.DamageNpc(targetIndex, attacker.cold.damage);
+    attacker.cold.attackCooldown = cooldownSeconds;
 }
 
 // Updates warrior behavior
-void WarriorBehavior::Update(World& world, NPC& npc, float dt) {
-    if (npc.warAssigned &&
-        npc.warTargetSettlementId >= 0 &&
-        world.IsSettlementAliveAndValid(npc.warTargetSettlementId))
+void WarriorBehavior::Update(BehaviorContext& ctx, NpcRef npc, float dt) {
+    World& world = ctx.world;
+
+    if (npc.war.warAssigned &&
+        npc.war.warTargetSettlementId >= 0 &&
+        world.IsSettlementAliveAndValid(npc.war.warTargetSettlementId))
     {
         // Defensive mode uses own settlement center as anchor
-        if (npc.warIsDefender &&
+        if (npc.war.warIsDefender &&
             npc.settlementId >= 0 &&
             npc.settlementId < (int)world.settlements.size())
         {
-            npc.warTargetPos = world.settlements[npc.settlementId].centerPx;
+            npc.war.warTargetPos = world.settlements[npc.settlementId].centerPx;
         }
         else {
-            npc.warTargetPos = world.settlements[npc.warTargetSettlementId].centerPx;
+            npc.war.warTargetPos = world.settlements[npc.war.warTargetSettlementId].centerPx;
         }
 
         // If enemy combat units are nearby, break formation and fight freely
-        if (npc.warInBattle) {
-            int localEnemyIndex = FindNearestEnemyCombatNearNpc(world, npc, CELL_SIZE * 9.0f);
+        if (npc.war.warInBattle) {
+            int localEnemyIndex = world.FindNearestEnemyCombatNear(npc, CELL_SIZE * 9.0f);
             if (localEnemyIndex != -1) {
-                NPC& enemy = world.npcs[localEnemyIndex];
+                ConstNpcRef enemy = world.npcs[localEnemyIndex];
 
                 float dx = enemy.pos.x - npc.pos.x;
                 float dy = enemy.pos.y - npc.pos.y;
                 float d2 = dx*dx + dy*dy;
 
                 if (d2 <= 18.0f * 18.0f) {
-                    TryMeleeAttack(world, npc, enemy, dt, 0.9f);
+                    TryMeleeAttack(ctx, npc, localEnemyIndex, dt, 0.9f);
                 } else {
                     MoveTowards(world, npc, enemy.pos, dt);
                 }
@@ -262,8 +125,8 @@ void WarriorBehavior::Update(World& world, NPC& npc, float dt) {
         }
 
         // Keep cohesion only when not in active battle
-        if (npc.warCaptainId != 0) {
-            NPC* captain = world.FindNpcById(npc.warCaptainId);
+        if (npc.war.warCaptainId != 0) {
+            std::optional<ConstNpcRef> captain = world.FindNpcById(npc.war.warCaptainId);
             if (captain && captain->alive && !captain->isDying) {
                 float dxCap = captain->pos.x - npc.pos.x;
                 float dyCap = captain->pos.y - npc.pos.y;
@@ -277,16 +140,16 @@ void WarriorBehavior::Update(World& world, NPC& npc, float dt) {
         }
 
         // Normal war target acquisition while approaching
-        int enemyIndex = FindNearestEnemyNpcForSettlementWar(world, npc, npc.warTargetSettlementId, CELL_SIZE * 26.0f);
+        int enemyIndex = world.FindNearestEnemyForSettlementWar(npc, npc.war.warTargetSettlementId, CELL_SIZE * 26.0f);
         if (enemyIndex != -1) {
-            NPC& enemy = world.npcs[enemyIndex];
+            ConstNpcRef enemy = world.npcs[enemyIndex];
 
             float dx = enemy.pos.x - npc.pos.x;
             float dy = enemy.pos.y - npc.pos.y;
             float d2 = dx*dx + dy*dy;
 
             if (d2 <= 18.0f * 18.0f) {
-                TryMeleeAttack(world, npc, enemy, dt, 0.9f);
+                TryMeleeAttack(ctx, npc, enemyIndex, dt, 0.9f);
             } else {
                 MoveTowards(world, npc, enemy.pos, dt);
             }
@@ -295,8 +158,8 @@ void WarriorBehavior::Update(World& world, NPC& npc, float dt) {
         }
 
         // If enemy troops are gone, attack the barracks
-        if (!world.SettlementHasLivingCombatUnits(npc.warTargetSettlementId)) {
-            const Settlement& targetSettlement = world.settlements[npc.warTargetSettlementId];
+        if (!world.SettlementHasLivingCombatUnits(npc.war.warTargetSettlementId)) {
+            const Settlement& targetSettlement = world.settlements[npc.war.warTargetSettlementId];
             int barracksIndex = FindNearestAliveBarracksIndex(targetSettlement, npc.pos);
             if (barracksIndex != -1) {
                 const Barracks& targetBarracks = targetSettlement.barracksList[barracksIndex];
@@ -306,11 +169,11 @@ void WarriorBehavior::Update(World& world, NPC& npc, float dt) {
                 float d2 = dx*dx + dy*dy;
 
                 if (d2 <= 22.0f * 22.0f) {
-                    npc.attackCooldown -= dt;
-                    if (npc.attackCooldown <= 0.0f) {
+                    npc.cold.attackCooldown -= dt;
+                    if (npc.cold.attackCooldown <= 0.0f) {
                         world.BeginNpcAttack(npc, targetBarracks.posPx);
-                        world.DamageSettlementBarracks(npc.warTargetSettlementId, barracksIndex, npc.damage);
-                        npc.attackCooldown = 0.9f;
+                        ctx.DamageBarracks(npc.war.warTargetSettlementId, barracksIndex, npc.cold.damage);
+                        npc.cold.attackCooldown = 0.9f;
                     }
                 } else {
                     MoveTowards(world, npc, targetBarracks.posPx, dt);
@@ -320,16 +183,16 @@ void WarriorBehavior::Update(World& world, NPC& npc, float dt) {
         }
 
         // Continue advancing toward the war target
-        float dx = npc.warTargetPos.x - npc.pos.x;
-        float dy = npc.warTargetPos.y - npc.pos.y;
+        float dx = npc.war.warTargetPos.x - npc.pos.x;
+        float dy = npc.war.warTargetPos.y - npc.pos.y;
         float dist2 = dx*dx + dy*dy;
 
         if (dist2 > CELL_SIZE * CELL_SIZE * 1.5f) {
-            MoveTowards(world, npc, npc.warTargetPos, dt);
+            MoveTowards(world, npc, world.MarchWaypoint(npc, npc.war.warTargetPos), dt);
         } else {
             Vector2 pressurePos = {
-                npc.warTargetPos.x + (float)((npc.id % 3) - 1) * CELL_SIZE * 0.9f,
-                npc.warTargetPos.y + (float)(((npc.id / 3) % 3) - 1) * CELL_SIZE * 0.9f
+                npc.war.warTargetPos.x + (float)((npc.id % 3) - 1) * CELL_SIZE * 0.9f,
+                npc.war.warTargetPos.y + (float)(((npc.id / 3) % 3) - 1) * CELL_SIZE * 0.9f
             };
             MoveTowards(world, npc, pressurePos, dt);
         }
@@ -337,17 +200,17 @@ void WarriorBehavior::Update(World& world, NPC& npc, float dt) {
         return;
     }
 
-    if (npc.leaderCaptainId != 0 && !npc.warAssigned) {
-        NPC* cap = world.FindNpcById(npc.leaderCaptainId);
+    if (npc.squad.leaderCaptainId != 0 && !npc.war.warAssigned) {
+        std::optional<ConstNpcRef> cap = world.FindNpcById(npc.squad.leaderCaptainId);
 
         if (!cap || !cap->alive) {
-            npc.leaderCaptainId = 0;
-            npc.inCombat = false;
+            npc.squad.leaderCaptainId = 0;
+            npc.squad.inCombat = false;
         }
         else {
             // Leave combat if the leader is no longer attacking
-            if (!cap->captainHasAttackOrder) {
-                npc.inCombat = false;
+            if (!cap->captain.captainHasAttackOrder) {
+                npc.squad.inCombat = false;
             }
         }
     }
@@ -355,13 +218,13 @@ void WarriorBehavior::Update(World& world, NPC& npc, float dt) {
     if (npc.settlementId < 0 || npc.settlementId >= (int)world.settlements.size() ||
         !world.settlements[npc.settlementId].alive) {
 
-        npc.wanderTimer -= dt;
-        if (npc.wanderTimer <= 0.0f) {
-            npc.wanderTimer = RandomFloat(1.0f, 2.5f);
-            npc.wanderDir = SafeNormalizeEx(RandomUnit2D());
+        npc.cold.wanderTimer -= dt;
+        if (npc.cold.wanderTimer <= 0.0f) {
+            npc.cold.wanderTimer = RandomFloat(ctx.rng, 1.0f, 2.5f);
+            npc.cold.wanderDir = SafeNormalizeEx(RandomUnit2D(ctx.rng));
         }
 
-        npc.vel = Vector2Scale(npc.wanderDir, npc.speed);
+        npc.vel = Vector2Scale(npc.cold.wanderDir, npc.cold.speed);
         npc.pos = Vector2Add(npc.pos, Vector2Scale(npc.vel, dt));
         return;
     }
@@ -369,20 +232,20 @@ void WarriorBehavior::Update(World& world, NPC& npc, float dt) {
     const Settlement& s = world.settlements[npc.settlementId];
 
     // Follow the assigned captain when not in settlement war
-    if (npc.leaderCaptainId != 0 && !npc.warAssigned) {
-        NPC* cap = world.FindNpcById(npc.leaderCaptainId);
+    if (npc.squad.leaderCaptainId != 0 && !npc.war.warAssigned) {
+        std::optional<ConstNpcRef> cap = world.FindNpcById(npc.squad.leaderCaptainId);
 
         if (!cap || !cap->alive || cap->humanRole != NPC::HumanRole::CAPTAIN) {
-            npc.leaderCaptainId = 0;
-            npc.formationSlot = -1;
+            npc.squad.leaderCaptainId = 0;
+            npc.squad.formationSlot = -1;
         } else {
-            const bool combatMode = cap->captainHasAttackOrder && cap->captainAttackGroupId != -1;
+            const bool combatMode = cap->captain.captainHasAttackOrder && cap->captain.captainAttackGroupId != -1;
 
             if (combatMode) {
-                int bi = FindNearestBanditInGroup(world, npc.pos, cap->captainAttackGroupId);
+                int bi = world.FindNearestBandit(npc.pos, FLT_MAX, cap->captain.captainAttackGroupId);
 
                 if (bi != -1) {
-                    NPC& b = world.npcs[bi];
+                    ConstNpcRef b = world.npcs[bi];
                     const float meleeRange = 28.0f;
                     float d2 = Dist2(npc.pos, b.pos);
 
@@ -390,14 +253,14 @@ void WarriorBehavior::Update(World& world, NPC& npc, float dt) {
                         MoveTowards(world, npc, b.pos, dt, 1.15f);
                     } else {
                         npc.vel = {0, 0};
-                        TryMeleeAttack(world, npc, b, dt, 0.80f);
+                        TryMeleeAttack(ctx, npc, bi, dt, 0.80f);
                     }
                     return;
                 }
             }
 
             Vector2 forward = CaptainFormation::GetCaptainFacing(*cap);
-            Vector2 localOffset = CaptainFormation::GetSlotOffset(npc.formationSlot, combatMode);
+            Vector2 localOffset = CaptainFormation::GetSlotOffset(npc.squad.formationSlot, combatMode);
             Vector2 worldOffset = RotateFromBaseY(localOffset, forward);
             Vector2 slotTarget = Vector2Add(cap->pos, worldOffset);
 
@@ -417,41 +280,30 @@ void WarriorBehavior::Update(World& world, NPC& npc, float dt) {
     const float ALERT_R2  = ALERT_R * ALERT_R;
     const float GIVEUP_R2 = GIVEUP_R * GIVEUP_R;
 
-    int nearestBandit = -1;
-    float nearestD2 = FLT_MAX;
-
-    for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const auto& other = world.npcs[i];
-        if (!other.alive) continue;
-        if (other.humanRole != NPC::HumanRole::BANDIT) continue;
-
-        float d2 = Dist2(other.pos, npc.pos);
-        if (d2 < nearestD2) {
-            nearestD2 = d2;
-            nearestBandit = i;
-        }
-    }
+    // Bandits beyond GIVEUP_R never affect the state below
+    int nearestBandit = world.FindNearestBandit(npc.pos, GIVEUP_R);
+    float nearestD2 = (nearestBandit != -1) ? Dist2(world.npcs[nearestBandit].pos, npc.pos) : FLT_MAX;
 
     const bool banditInAlert = (nearestBandit != -1 && nearestD2 <= ALERT_R2);
     const bool banditInGiveup = (nearestBandit != -1 && nearestD2 <= GIVEUP_R2);
 
     if (banditInAlert) {
-        npc.inCombat = true;
-        npc.combatTargetPos = world.npcs[nearestBandit].pos;
-    } else if (npc.inCombat && !banditInGiveup) {
-        npc.inCombat = false;
-        npc.combatTargetPos = {0, 0};
-        npc.attackCooldown = 0.0f;
+        npc.squad.inCombat = true;
+        npc.squad.combatTargetPos = world.npcs[nearestBandit].pos;
+    } else if (npc.squad.inCombat && !banditInGiveup) {
+        npc.squad.inCombat = false;
+        npc.squad.combatTargetPos = {0, 0};
+        npc.cold.attackCooldown = 0.0f;
     }
 
-    if (npc.inCombat) {
-        int nearestBandit = FindNearestBanditAny(world, npc.pos, GIVEUP_R);
+    if (npc.squad.inCombat) {
+        int nearestBandit = world.FindNearestBandit(npc.pos, GIVEUP_R);
 
         // Leave combat if no valid target remains
         if (nearestBandit == -1) {
-            npc.inCombat = false;
-            npc.attackCooldown = 0;
-            npc.combatTargetPos = {0, 0};
+            npc.squad.inCombat = false;
+            npc.cold.attackCooldown = 0;
+            npc.squad.combatTargetPos = {0, 0};
             return;
         }
 
@@ -459,13 +311,13 @@ void WarriorBehavior::Update(World& world, NPC& npc, float dt) {
         float currentD2 = (nearestBandit != -1) ? Dist2(npc.pos, world.npcs[nearestBandit].pos) : FLT_MAX;
 
         if (nearestBandit != -1 && currentD2 > meleeRange * meleeRange) {
-            MoveTowards(world, npc, npc.combatTargetPos, dt, 1.25f);
+            MoveTowards(world, npc, npc.squad.combatTargetPos, dt, 1.25f);
         } else {
             npc.vel = {0, 0};
         }
 
         if (nearestBandit != -1 && currentD2 <= meleeRange * meleeRange) {
-            TryMeleeAttack(world, npc, world.npcs[nearestBandit], dt, 0.80f);
+            TryMeleeAttack(ctx, npc, nearestBandit, dt, 0.80f);
         }
 
         return;
@@ -475,27 +327,27 @@ void WarriorBehavior::Update(World& world, NPC& npc, float dt) {
     Vector2 camp = s.campfirePosPx;
     if (camp.x == 0.0f && camp.y == 0.0f) camp = s.centerPx;
 
-    if (!npc.formationAssigned) {
-        float angle = RandomFloat(0.0f, 2.0f * PI);
-        float radius = RandomFloat(20.0f, 50.0f);
+    if (!npc.squad.formationAssigned) {
+        float angle = RandomFloat(ctx.rng, 0.0f, 2.0f * PI);
+        float radius = RandomFloat(ctx.rng, 20.0f, 50.0f);
 
-        npc.formationOffset = { cosf(angle) * radius, sinf(angle) * radius };
-        npc.formationAssigned = true;
+        npc.squad.formationOffset = { cosf(angle) * radius, sinf(angle) * radius };
+        npc.squad.formationAssigned = true;
     }
 
-    Vector2 target = Vector2Add(camp, npc.formationOffset);
+    Vector2 target = Vector2Add(camp, npc.squad.formationOffset);
 
     float toT2 = Dist2(npc.pos, target);
     if (toT2 < 10.0f * 10.0f) {
-        npc.wanderTimer -= dt;
-        if (npc.wanderTimer <= 0.0f) {
-            npc.wanderTimer = RandomFloat(0.6f, 1.4f);
-            npc.wanderDir = SafeNormalizeEx(RandomUnit2D());
+        npc.cold.wanderTimer -= dt;
+        if (npc.cold.wanderTimer <= 0.0f) {
+            npc.cold.wanderTimer = RandomFloat(ctx.rng, 0.6f, 1.4f);
+            npc.cold.wanderDir = SafeNormalizeEx(RandomUnit2D(ctx.rng));
         }
-        npc.vel = Vector2Scale(npc.wanderDir, npc.speed * 0.6f);
+        npc.vel = Vector2Scale(npc.cold.wanderDir, npc.cold.speed * 0.6f);
     } else {
         Vector2 dir = SafeNormalizeEx(Vector2Subtract(target, npc.pos));
-        npc.vel = Vector2Scale(dir, npc.speed * 1.0f);
+        npc.vel = Vector2Scale(dir, npc.cold.speed * 1.0f);
     }
 
     npc.pos = Vector2Add(npc.pos, Vector2Scale(npc.vel, dt));
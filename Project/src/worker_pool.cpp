@@ -0,0 +1,86 @@
+#include "environment/worker_pool.h"
+
+WorkerPool::WorkerPool(int threadCount) {
+    if (threadCount <= 0) threadCount = (int)std::thread::hardware_concurrency();
+    if (threadCount <= 0) threadCount = 1;
+
+    for (int i = 1; i < threadCount; i++) {
+        workers.emplace_back([this]() { WorkerLoop(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) t.join();
+}
+
+void WorkerPool::ParallelFor(int count, int chunkSize, const std::function<void(int, int, int)>& fn) {
+    if (count <= 0) return;
+    if (chunkSize <= 0) chunkSize = 1;
+
+    const int chunks = (count + chunkSize - 1) / chunkSize;
+
+    // Nothing to share: run inline without waking anyone
+    if (workers.empty() || chunks == 1) {
+        for (int c = 0; c < chunks; c++) {
+            int begin = c * chunkSize;
+            int end = (begin + chunkSize < count) ? begin + chunkSize : count;
+            fn(c, begin, end);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        jobCount = count;
+        jobChunkSize = chunkSize;
+        jobChunks = chunks;
+        nextChunk.store(0);
+        busyWorkers = (int)workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    RunChunks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]() { return busyWorkers == 0; });
+    job = nullptr;
+}
+
+void WorkerPool::WorkerLoop() {
+    uint64_t seen = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]() { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+
+        RunChunks();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busyWorkers--;
+        }
+        done.notify_one();
+    }
+}
+
+void WorkerPool::RunChunks() {
+    for (;;) {
+        int c = nextChunk.fetch_add(1);
+        if (c >= jobChunks) return;
+
+        int begin = c * jobChunkSize;
+        int end = (begin + jobChunkSize < jobCount) ? begin + jobChunkSize : jobCount;
+        (*job)(c, begin, end);
+    }
+}
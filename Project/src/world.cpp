@@ -1,5 +1,3 @@
-#include <optional>
-#include <stdexcept>
 #include "environment/world.h"
 #include "npc/human_behavior.h"
 #include "npc/bandit_behavior.h"
@@ -7,20 +5,22 @@
 #include "npc/npc.h"
 #include <algorithm>
 #include <cfloat>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <unordered_map>
 #include "npc/Animal.h"
 #include "environment/Plant.h"
 // ------------------------------------------------------------
 
 // Returns a random spawn position on the world edge
-static Vector2 RandomOutsideSpawn(int w, int h) {
-    int side = GetRandomValue(0, 3);
+static Vector2 RandomOutsideSpawn(Rng& rng, int w, int h) {
+    int side = RandomInt(rng, 0, 3);
     switch (side) {
-        case 0: return {0.0f,        (float)GetRandomValue(0, h)};
-        case 1: return {(float)w,    (float)GetRandomValue(0, h)};
-        case 2: return {(float)GetRandomValue(0, w), 0.0f};
-        default:return {(float)GetRandomValue(0, w), (float)h};
+        case 0: return {0.0f,        (float)RandomInt(rng, 0, h)};
+        case 1: return {(float)w,    (float)RandomInt(rng, 0, h)};
+        case 2: return {(float)RandomInt(rng, 0, w), 0.0f};
+        default:return {(float)RandomInt(rng, 0, w), (float)h};
     }
 }
 static float ClampF(float v, float a, float b) { return (v < a) ? a : (v > b) ? b : v; }
@@ -48,15 +48,15 @@ static Vector2 NearestTileCenterPx(const World& world, const Settlement& s, Vect
     }
     return best;
 }
-static void ClampNpcInsideWorld(NPC& npc, int worldW, int worldH) {
-    float oldX = npc.pos.x;
-    float oldY = npc.pos.y;
+static void ClampNpcInsideWorld(Vector2& pos, Vector2& vel, int worldW, int worldH) {
+    float oldX = pos.x;
+    float oldY = pos.y;
 
-    npc.pos.x = ClampF(npc.pos.x, 0.0f, (float)worldW);
-    npc.pos.y = ClampF(npc.pos.y, 0.0f, (float)worldH);
+    pos.x = ClampF(pos.x, 0.0f, (float)worldW);
+    pos.y = ClampF(pos.y, 0.0f, (float)worldH);
 
-    if (npc.pos.x != oldX) npc.vel.x = 0.0f;
-    if (npc.pos.y != oldY) npc.vel.y = 0.0f;
+    if (pos.x != oldX) vel.x = 0.0f;
+    if (pos.y != oldY) vel.y = 0.0f;
 }
 static Vector2 ClosestPointInRectPx(Vector2 p, const Rectangle& rPx)
 {
@@ -65,13 +65,6 @@ static Vector2 ClosestPointInRectPx(Vector2 p, const Rectangle& rPx)
             ClampF(p.y, rPx.y, rPx.y + rPx.height)
     };
 }
-static std::string PathJoin(const char* a, const char* b) {
-    std::string s = a;
-    if (!s.empty() && s.back() != '/') s += "/";
-    s += b;
-    return s;
-}
-
 static bool RectsOverlap(const Rectangle &a, const Rectangle &b) {
     return (a.x < b.x + b.width) && (a.x + a.width > b.x) &&
            (a.y < b.y + b.height) && (a.y + a.height > b.y);
@@ -86,6 +79,16 @@ static Rectangle ZoneToPxRect(const Rectangle &z) {
     };
 }
 
+// Tiles under a pixel rectangle that lies on the tile grid, such as Settlement::boundsPx
+static TileRect BoundsTiles(const Rectangle& px) {
+    return TileRect{
+            (int)(px.x / CELL_SIZE),
+            (int)(px.y / CELL_SIZE),
+            (int)(px.width / CELL_SIZE),
+            (int)(px.height / CELL_SIZE)
+    };
+}
+
 static float Dist2World(Vector2 a, Vector2 b) {
     float dx = a.x - b.x;
     float dy = a.y - b.y;
@@ -101,7 +104,7 @@ static Vector2 TileIdToCenterPx(const World& world, int tileId) {
     };
 }
 
-static Vector2 PickRandomSettlementTileFarFrom(const World& world,
+static Vector2 PickRandomSettlementTileFarFrom(World& world,
                                                const Settlement& s,
                                                Vector2 avoidPx,
                                                float minDistPx)
@@ -125,7 +128,7 @@ static Vector2 PickRandomSettlementTileFarFrom(const World& world,
     }
 
     const std::vector<int>& pool = !preferred.empty() ? preferred : fallback;
-    int pickIndex = GetRandomValue(0, (int)pool.size() - 1);
+    int pickIndex = RandomInt(world.rng, 0, (int)pool.size() - 1);
     return TileIdToCenterPx(world, pool[pickIndex]);
 }
 
@@ -137,88 +140,20 @@ static bool IsCombatRoleForWar(NPC::HumanRole role) {
     return role == NPC::HumanRole::WARRIOR || role == NPC::HumanRole::CAPTAIN;
 }
 
-static bool IsCombatHumanRoleForBattle(NPC::HumanRole role) {
-    return role == NPC::HumanRole::WARRIOR || role == NPC::HumanRole::CAPTAIN;
-}
-
-static int CountEnemyCombatUnitsNearNpc(const World& world, const NPC& npc, float radiusPx) {
-    float radius2 = radiusPx * radiusPx;
-    int count = 0;
-
-    for (const auto& other : world.npcs) {
-        if (!other.alive || other.isDying) continue;
-        if (!IsCombatHumanRoleForBattle(other.humanRole)) continue;
-        if (other.settlementId == npc.settlementId) continue;
-
-        float dx = other.pos.x - npc.pos.x;
-        float dy = other.pos.y - npc.pos.y;
-        float d2 = dx*dx + dy*dy;
-        if (d2 <= radius2) {
-            count++;
-        }
-    }
-
-    return count;
-}
-
-static int FindNearestEnemyCombatNearNpc(World& world, const NPC& npc, float radiusPx) {
-    float bestD2 = radiusPx * radiusPx;
-    int bestIndex = -1;
-    int bestPriority = 999;
-
-    for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const NPC& other = world.npcs[i];
-        if (!other.alive || other.isDying) continue;
-        if (other.settlementId == npc.settlementId) continue;
-
-        int priority = 999;
-        if (other.humanRole == NPC::HumanRole::WARRIOR) priority = 0;
-        else if (other.humanRole == NPC::HumanRole::CAPTAIN) priority = 1;
-        else continue;
-
-        float dx = other.pos.x - npc.pos.x;
-        float dy = other.pos.y - npc.pos.y;
-        float d2 = dx*dx + dy*dy;
-        if (d2 > bestD2) continue;
-
-        if (priority < bestPriority || (priority == bestPriority && d2 < bestD2)) {
-            bestPriority = priority;
-            bestD2 = d2;
-            bestIndex = i;
-        }
-    }
-
-    return bestIndex;
-}
-
-static bool IsEnemyCombatNearNpc(const World& world, const NPC& npc, float radiusPx) {
-    float radius2 = radiusPx * radiusPx;
-
-    for (const auto& other : world.npcs) {
-        if (!other.alive || other.isDying) continue;
-        if (!IsCombatHumanRoleForBattle(other.humanRole)) continue;
-        if (other.settlementId == npc.settlementId) continue;
-
-        float dx = other.pos.x - npc.pos.x;
-        float dy = other.pos.y - npc.pos.y;
-        float d2 = dx*dx + dy*dy;
-        if (d2 <= radius2) return true;
-    }
-
-    return false;
-}
-
-static bool IsCombatNpc(const NPC& npc) {
-    return npc.humanRole == NPC::HumanRole::WARRIOR || npc.humanRole == NPC::HumanRole::CAPTAIN;
+static bool IsCaptainNpc(ConstNpcRef npc) {
+    return npc.humanRole == NPC::HumanRole::CAPTAIN;
 }
 
-static bool IsCaptainNpc(const NPC& npc) {
-    return npc.humanRole == NPC::HumanRole::CAPTAIN;
+// Living members of a settlement with the given role, ascending index
+static void QuerySettlementRole(const World& world, int settlementId, NPC::HumanRole role, std::vector<int>& out) {
+    NpcQueryFilter filter;
+    filter.Roles({role});
+    world.npcGrid.QuerySettlement(world.npcs, settlementId, filter, out);
 }
 
 static int CountAvailableSettlementCombatUnits(const World& world, int settlementId) {
     int count = 0;
-    for (const auto& npc : world.npcs) {
+    for (ConstNpcRef npc : world.npcs) {
         if (!npc.alive) continue;
         if (npc.isDying) continue;
         if (npc.settlementId != settlementId) continue;
@@ -229,25 +164,55 @@ static int CountAvailableSettlementCombatUnits(const World& world, int settlemen
 }
 
 static int CountAssignedWarriorsForCaptain(const World& world, int settlementId, uint32_t captainId) {
+    std::vector<int> warriors;
+    QuerySettlementRole(world, settlementId, NPC::HumanRole::WARRIOR, warriors);
+
     int count = 0;
-    for (const auto& npc : world.npcs) {
-        if (!npc.alive || npc.isDying) continue;
-        if (npc.settlementId != settlementId) continue;
-        if (npc.humanRole != NPC::HumanRole::WARRIOR) continue;
-        if (npc.warCaptainId == captainId) count++;
+    for (int i : warriors) {
+        if (world.npcs[i].war.warCaptainId == captainId) count++;
     }
     return count;
 }
 
-static int CountReadySquadsForSettlement(const World& world, int settlementId) {
-    int readySquads = 0;
+// Same result as CountAssignedWarriorsForCaptain for every living captain, in one pass
+static void CountAssignedWarriorsPerCaptain(const World& world, std::unordered_map<uint32_t, int>& out) {
+    out.clear();
 
-    for (const auto& npc : world.npcs) {
+    std::unordered_map<uint32_t, int> captainSettlement;
+    for (ConstNpcRef npc : world.npcs) {
         if (!npc.alive || npc.isDying) continue;
-        if (npc.settlementId != settlementId) continue;
         if (npc.humanRole != NPC::HumanRole::CAPTAIN) continue;
+        captainSettlement[npc.id] = npc.settlementId;
+    }
+
+    for (ConstNpcRef npc : world.npcs) {
+        if (!npc.alive || npc.isDying) continue;
+        if (npc.humanRole != NPC::HumanRole::WARRIOR) continue;
+        if (npc.war.warCaptainId == 0) continue;
 
-        int warriorCount = CountAssignedWarriorsForCaptain(world, settlementId, npc.id);
+        auto it = captainSettlement.find(npc.war.warCaptainId);
+        if (it != captainSettlement.end() && it->second == npc.settlementId) {
+            out[npc.war.warCaptainId]++;
+        }
+    }
+}
+
+static int LookupCount(const std::unordered_map<uint32_t, int>& counts, uint32_t id) {
+    auto it = counts.find(id);
+    return (it != counts.end()) ? it->second : 0;
+}
+
+static int CountReadySquadsForSettlement(const World& world, int settlementId,
+                                         const std::unordered_map<uint32_t, int>& warriorsPerCaptain) {
+    int readySquads = 0;
+
+    std::vector<int> captains;
+    QuerySettlementRole(world, settlementId, NPC::HumanRole::CAPTAIN, captains);
+
+    for (int i : captains) {
+        ConstNpcRef npc = world.npcs[i];
+
+        int warriorCount = LookupCount(warriorsPerCaptain, npc.id);
 
         // valid offensive/defensive squad:
         // 1 captain + at least 2 warriors
@@ -259,16 +224,18 @@ static int CountReadySquadsForSettlement(const World& world, int settlementId) {
     return readySquads;
 }
 
-static uint32_t FindNearestAvailableCaptainId(World& world, int settlementId, Vector2 pos) {
+static uint32_t FindNearestAvailableCaptainId(World& world, int settlementId, Vector2 pos,
+                                              const std::unordered_map<uint32_t, int>& warriorsPerCaptain) {
     float bestD2 = 1e30f;
     uint32_t bestId = 0;
 
-    for (auto& npc : world.npcs) {
-        if (!npc.alive || npc.isDying) continue;
-        if (npc.settlementId != settlementId) continue;
-        if (npc.humanRole != NPC::HumanRole::CAPTAIN) continue;
+    std::vector<int> captains;
+    QuerySettlementRole(world, settlementId, NPC::HumanRole::CAPTAIN, captains);
 
-        int warriorCount = CountAssignedWarriorsForCaptain(world, settlementId, npc.id);
+    for (int i : captains) {
+        ConstNpcRef npc = world.npcs[i];
+
+        int warriorCount = LookupCount(warriorsPerCaptain, npc.id);
         if (warriorCount >= 5) continue;
 
         float dx = npc.pos.x - pos.x;
@@ -288,21 +255,7 @@ static bool IsEnemySettlementTroopNearSettlement(const World& world, int settlem
     const Settlement& s = world.settlements[settlementId];
     if (!s.alive) return false;
 
-    float radius2 = radiusPx * radiusPx;
-
-    for (const auto& npc : world.npcs) {
-        if (!npc.alive || npc.isDying) continue;
-        if (!IsCombatNpc(npc)) continue;
-        if (npc.settlementId == settlementId) continue;
-        if (!npc.warAssigned) continue;
-
-        float dx = npc.pos.x - s.centerPx.x;
-        float dy = npc.pos.y - s.centerPx.y;
-        float d2 = dx*dx + dy*dy;
-        if (d2 <= radius2) return true;
-    }
-
-    return false;
+    return world.IsEnemyWarTroopNear(settlementId, s.centerPx, radiusPx);
 }
 
 static int ComputeSettlementWaveSize(const World& world, int settlementId) {
@@ -313,40 +266,6 @@ static int ComputeSettlementWaveSize(const World& world, int settlementId) {
     return preferred;
 }
 
-static int FindNearestEnemyNpcForSettlementWar(World& world, const NPC& attacker, int enemySettlementId, float maxDistPx) {
-    float bestD2 = maxDistPx * maxDistPx;
-    int bestIndex = -1;
-    int bestPriority = 999;
-
-    for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const NPC& other = world.npcs[i];
-        if (!other.alive || other.isDying) continue;
-        if (other.id == attacker.id) continue;
-
-        if (other.settlementId != enemySettlementId) continue;
-
-        int priority = 999;
-        if (other.humanRole == NPC::HumanRole::WARRIOR) priority = 0;
-        else if (other.humanRole == NPC::HumanRole::CAPTAIN) priority = 1;
-        else if (other.humanRole == NPC::HumanRole::CIVILIAN) priority = 2;
-        else continue;
-
-        float dx = other.pos.x - attacker.pos.x;
-        float dy = other.pos.y - attacker.pos.y;
-        float d2 = dx*dx + dy*dy;
-
-        if (d2 > bestD2) continue;
-
-        if (priority < bestPriority || (priority == bestPriority && d2 < bestD2)) {
-            bestPriority = priority;
-            bestD2 = d2;
-            bestIndex = i;
-        }
-    }
-
-    return bestIndex;
-}
-
 static bool IsBarracksInAttackRange(const Settlement& s, Vector2 pos, float rangePx)
 {
     if (!s.alive) return false;
@@ -386,48 +305,17 @@ static int FindNearestAliveBarracksIndex(const Settlement& s, Vector2 fromPos)
     return bestIndex;
 }
 
-static int FindNearestHostileTroopNearSettlement(World& world, int homeSettlementId, Vector2 homePos, float maxDistPx) {
-    float bestD2 = maxDistPx * maxDistPx;
-    int bestIndex = -1;
-    int bestPriority = 999;
-
-    for (int i = 0; i < (int)world.npcs.size(); i++) {
-        const NPC& other = world.npcs[i];
-        if (!other.alive || other.isDying) continue;
-        if (other.settlementId == homeSettlementId) continue;
-
-        int priority = 999;
-        if (other.humanRole == NPC::HumanRole::WARRIOR) priority = 0;
-        else if (other.humanRole == NPC::HumanRole::CAPTAIN) priority = 1;
-        else if (other.humanRole == NPC::HumanRole::CIVILIAN) priority = 2;
-        else continue;
-
-        float dx = other.pos.x - homePos.x;
-        float dy = other.pos.y - homePos.y;
-        float d2 = dx*dx + dy*dy;
-        if (d2 > bestD2) continue;
-
-        if (priority < bestPriority || (priority == bestPriority && d2 < bestD2)) {
-            bestPriority = priority;
-            bestD2 = d2;
-            bestIndex = i;
-        }
-    }
-
-    return bestIndex;
-}
-
 static void SpawnProducedWarrior(World& world, int settlementId, Vector2 pos) {
     NPC npc;
-    npc.id = world.nextNpcId++;
-    npc.type = NPC::Type::HUMAN;
+    npc.id = world.npcs.AllocateId();
+    npc.cold.type = NPC::Type::HUMAN;
     npc.humanRole = NPC::HumanRole::WARRIOR;
-    npc.skinId = (uint16_t)GetRandomValue(0, World::NPC_VARIANTS - 1);
+    npc.cold.skinId = (uint16_t)RandomInt(world.rng, 0, World::NPC_VARIANTS - 1);
     npc.pos = pos;
     npc.vel = {0,0};
-    npc.speed = 35.0f;
+    npc.cold.speed = 35.0f;
     npc.hp = 180.0f;
-    npc.damage = 16.0f;
+    npc.cold.damage = 16.0f;
     npc.settlementId = settlementId;
     npc.alive = true;
     world.npcs.push_back(npc);
@@ -435,219 +323,37 @@ static void SpawnProducedWarrior(World& world, int settlementId, Vector2 pos) {
 
 static void SpawnProducedCaptain(World& world, int settlementId, Vector2 pos) {
     NPC npc;
-    npc.id = world.nextNpcId++;
-    npc.type = NPC::Type::HUMAN;
+    npc.id = world.npcs.AllocateId();
+    npc.cold.type = NPC::Type::HUMAN;
     npc.humanRole = NPC::HumanRole::CAPTAIN;
-    npc.warriorRank = NPC::WarriorRank::CAPTAIN;
-    npc.isCaptain = true;
-    npc.skinId = (uint16_t)GetRandomValue(0, World::NPC_VARIANTS - 1);
+    npc.cold.warriorRank = NPC::WarriorRank::CAPTAIN;
+    npc.cold.isCaptain = true;
+    npc.cold.skinId = (uint16_t)RandomInt(world.rng, 0, World::NPC_VARIANTS - 1);
     npc.pos = pos;
     npc.vel = {0, 0};
-    npc.speed = 35.0f;
+    npc.cold.speed = 35.0f;
     npc.hp = 260.0f;
-    npc.damage = 22.0f;
-    npc.captainAutoMode = true;
-    npc.captainHasMoveOrder = false;
-    npc.captainHasAttackOrder = false;
-    npc.captainAttackGroupId = -1;
-    npc.captainAttackTargetId = 0;
+    npc.cold.damage = 22.0f;
+    npc.captain.captainAutoMode = true;
+    npc.captain.captainHasMoveOrder = false;
+    npc.captain.captainHasAttackOrder = false;
+    npc.captain.captainAttackGroupId = -1;
+    npc.captain.captainAttackTargetId = 0;
     npc.settlementId = settlementId;
     npc.alive = true;
     world.npcs.push_back(npc);
 }
 
-// Resolves an asset path relative to the working directory
-static std::string FindAssetPath(const char* relativePath)
-{
-    const char* wd = GetWorkingDirectory();
-
-    const char* candidates[] = {
-            "",
-            "../",
-            "../../",
-            "../../../"
-    };
-
-    for (const char* base : candidates) {
-        std::string full = PathJoin(wd, (std::string(base) + relativePath).c_str());
-        if (FileExists(full.c_str())) return full;
-    }
-
-    return "";
-}
-
-// Loads NPC sprite textures
-void World::LoadNpcSprites()
-{
-    if (npcSpritesLoaded) return;
-
-    auto loadOne = [&](Texture2D& outTex, bool& outLoaded, const char* relPath) {
-        std::string p = FindAssetPath(relPath);
-        if (p.empty()) {
-            TraceLog(LOG_ERROR, "NPC SPRITE missing: %s (WD=%s)", relPath, GetWorkingDirectory());
-            outLoaded = false;
-            return;
-        }
-
-        outTex = LoadTexture(p.c_str());
-        if (outTex.id == 0) {
-            TraceLog(LOG_ERROR, "Failed to LoadTexture: %s", p.c_str());
-            outLoaded = false;
-            return;
-        }
-
-        SetTextureFilter(outTex, TEXTURE_FILTER_POINT);
-        SetTextureWrap(outTex, TEXTURE_WRAP_CLAMP);
-        outLoaded = true;
-
-        TraceLog(LOG_INFO, "Loaded sprite: %s (%dx%d)", p.c_str(), outTex.width, outTex.height);
-    };
-
-    for (int i = 0; i < NPC_VARIANTS; i++) {
-        loadOne(npcTexCivilian[i], npcTexCivilianLoaded[i],
-                (std::string("assets/npc/civilian/civilian_") + std::to_string(i) + ".png").c_str());
-
-        loadOne(npcTexWarrior[i], npcTexWarriorLoaded[i],
-                (std::string("assets/npc/warrior/warrior_") + std::to_string(i) + ".png").c_str());
-
-        loadOne(npcTexBandit[i], npcTexBanditLoaded[i],
-                (std::string("assets/npc/bandit/bandit_") + std::to_string(i) + ".png").c_str());
-
-        loadOne(npcTexCaptain[i], npcTexCaptainLoaded[i],
-                (std::string("assets/npc/captain/captain_") + std::to_string(i) + ".png").c_str());
-    }
-
-    npcSpritesLoaded = true;
-
-    // --- ЗАГРУЗКА ЛОШАДИ ---
-    auto horsePath = FindAssetPath("assets/npc/animal/animal.png");
-
-// Используем std::optional: путь либо есть, либо его нет (nullopt)
-    std::optional<std::string> horsePathOpt = horsePath.empty() ? std::nullopt : std::make_optional(horsePath);
-
-    if (!horsePathOpt.has_value()) {
-        // ТРЕБОВАНИЕ ТЗ: Использование исключений (throw)
-        throw std::runtime_error("Critical error: Horse texture path not found!");
-    }
-
-    Animal::texture = LoadTexture(horsePathOpt->c_str());
-    if (Animal::texture.id > 0) {
-        SetTextureFilter(Animal::texture, TEXTURE_FILTER_POINT);
-        Animal::textureLoaded = true;
-    } else {
-        throw std::runtime_error("Failed to load Horse texture into GPU!");
-    }
-
-// --- ЗАГРУЗКА РАСТЕНИЙ ---
-
-// Цветок
-    auto flowerPath = FindAssetPath("assets/environment/flower/flower.png");
-    if (flowerPath.empty()) throw std::runtime_error("Flower texture not found!");
-    Plant::texFlower = LoadTexture(flowerPath.c_str());
-    SetTextureFilter(Plant::texFlower, TEXTURE_FILTER_POINT);
-
-// Дерево
-    auto treePath = FindAssetPath("assets/environment/tree/tree.png");
-    if (treePath.empty()) throw std::runtime_error("Tree texture not found!");
-    Plant::texTree = LoadTexture(treePath.c_str());
-    SetTextureFilter(Plant::texTree, TEXTURE_FILTER_POINT);
-
-    Plant::texturesLoaded = true;
-    npcSpritesLoaded = true;
-}
-
-void World::UnloadNpcSprites()
-{
-    for (int i = 0; i < NPC_VARIANTS; i++) {
-        if (npcTexCivilianLoaded[i]) { UnloadTexture(npcTexCivilian[i]); npcTexCivilianLoaded[i] = false; }
-        if (npcTexWarriorLoaded[i])  { UnloadTexture(npcTexWarrior[i]);  npcTexWarriorLoaded[i]  = false; }
-        if (npcTexBanditLoaded[i])   { UnloadTexture(npcTexBandit[i]);   npcTexBanditLoaded[i]   = false; }
-        if (npcTexCaptainLoaded[i])  { UnloadTexture(npcTexCaptain[i]);  npcTexCaptainLoaded[i]  = false; }
-    }
-    npcSpritesLoaded = false;
-
-    if (Animal::textureLoaded) {
-        UnloadTexture(Animal::texture);
-        Animal::textureLoaded = false;
-    }
-}
-
-void World::LoadFireSprites()
-{
-    auto loadOne = [&](Texture2D& outTex, bool& outLoaded, const char* relPath) {
-        std::string p = FindAssetPath(relPath);
-        if (p.empty()) {
-            TraceLog(LOG_ERROR, "FIRE missing: %s (WD=%s)", relPath, GetWorkingDirectory());
-            outLoaded = false;
-            return;
-        }
-        outTex = LoadTexture(p.c_str());
-        if (outTex.id == 0) {
-            TraceLog(LOG_ERROR, "Failed to LoadTexture fire: %s", p.c_str());
-            outLoaded = false;
-            return;
-        }
-        SetTextureFilter(outTex, TEXTURE_FILTER_POINT);
-        SetTextureWrap(outTex, TEXTURE_WRAP_CLAMP);
-        outLoaded = true;
-        TraceLog(LOG_INFO, "Loaded fire: %s", p.c_str());
-    };
-
-    for (int i = 0; i < FIRE_FRAMES; i++) {
-        std::string rel = "assets/environment/fire/fire_" + std::to_string(i) + ".png";
-        loadOne(fireTex[i], fireLoaded[i], rel.c_str());
-    }
-}
-
-void World::UnloadFireSprites()
-{
-    for (int i = 0; i < FIRE_FRAMES; i++) {
-        if (fireLoaded[i]) {
-            UnloadTexture(fireTex[i]);
-            fireLoaded[i] = false;
-        }
-    }
-}
-
-void World::LoadBarracksSprite()
-{
-    std::string p = FindAssetPath("assets/barracks/barracks_0.png");
-    if (p.empty()) {
-        TraceLog(LOG_WARNING, "BARRACKS missing: assets/barracks/barracks_0.png (WD=%s)", GetWorkingDirectory());
-        barracksTexLoaded = false;
-        return;
-    }
-
-    barracksTex = LoadTexture(p.c_str());
-    if (barracksTex.id == 0) {
-        TraceLog(LOG_ERROR, "Failed to LoadTexture barracks: %s", p.c_str());
-        barracksTexLoaded = false;
-        return;
-    }
-
-    SetTextureFilter(barracksTex, TEXTURE_FILTER_POINT);
-    barracksTexLoaded = true;
-
-    TraceLog(LOG_INFO, "Loaded barracks: %s", p.c_str());
-}
-
-void World::UnloadBarracksSprite()
-{
-    if (barracksTexLoaded) {
-        UnloadTexture(barracksTex);
-        barracksTexLoaded = false;
-    }
-}
-
 void World::UpdateCampfires()
 {
-    for (auto& s : settlements) {
+    for (int i = 0; i < (int)settlements.size(); i++) {
+        Settlement& s = settlements[i];
         if (!s.alive) continue;
 
         Vector2 c = s.centerPx;
 
         // Snap to the nearest settlement tile if the cached center drifts out
-        if (!PointInSettlementPx(s, c)) {
+        if (!PointInSettlementPx(i, c)) {
             c = NearestTileCenterPx(*this, s, c);
         }
 
@@ -693,16 +399,12 @@ void World::UpdateBarracks()
 
             if (overlaps) {
                 bool found = false;
-                std::vector<int> settlementTiles;
-                settlementTiles.reserve(s.tiles.size());
-                for (int tile : s.tiles) {
-                    settlementTiles.push_back(tile);
-                }
+                const std::vector<int>& settlementTiles = s.tiles;
 
                 for (int attempt = 0; attempt < 24 && !found; attempt++) {
                     if (settlementTiles.empty()) break;
 
-                    int pickIndex = GetRandomValue(0, (int)settlementTiles.size() - 1);
+                    int pickIndex = RandomInt(rng, 0, (int)settlementTiles.size() - 1);
                     int tileId = settlementTiles[pickIndex];
                     Vector2 p = TileIdToCenterPx(*this, tileId);
 
@@ -779,15 +481,102 @@ void World::UpdateBarracksProduction(float dt)
     }
 }
 
-bool World::PointInSettlementPx(const Settlement& s, Vector2 pos) const {
+bool World::PointInSettlementPx(int settlementId, Vector2 pos) const {
     int cx = (int)(pos.x / CELL_SIZE);
     int cy = (int)(pos.y / CELL_SIZE);
 
     if (cx < 0 || cy < 0 || cx >= cols || cy >= rows)
         return false;
 
-    int tileId = cy * cols + cx;
-    return s.tiles.find(tileId) != s.tiles.end();
+    return SettlementHasTile(settlementId, cy * cols + cx);
+}
+
+int World::GetTileOwner(int tileId) const {
+    if (tileId < 0 || tileId >= (int)tileOwner.size()) return -1;
+    return tileOwner[tileId];
+}
+
+bool World::SettlementHasTile(int settlementId, int tileId) const {
+    if (settlementId < 0 || settlementId >= (int)settlements.size()) return false;
+    if (GetTileOwner(tileId) == settlementId) return true;
+
+    // The owner grid is exact for alive settlements unless territories overlap
+    const Settlement& s = settlements[settlementId];
+    if (s.alive && !territoryContested && (int)tileOwner.size() == cols * rows) return false;
+    return std::find(s.tiles.begin(), s.tiles.end(), tileId) != s.tiles.end();
+}
+
+void World::ClaimSettlementTerritory(int settlementId) {
+    if ((int)tileOwner.size() != cols * rows) {
+        RebuildTerritoryOwners();
+        return;
+    }
+
+    int x0 = cols, y0 = rows, x1 = 0, y1 = 0;
+    for (int tile : settlements[settlementId].tiles) {
+        int owner = tileOwner[tile];
+        if (owner == settlementId) continue;
+
+        if (owner < 0 || !settlements[owner].alive) {
+            tileOwner[tile] = settlementId;
+            x0 = std::min(x0, tile % cols);
+            y0 = std::min(y0, tile / cols);
+            x1 = std::max(x1, tile % cols + 1);
+            y1 = std::max(y1, tile / cols + 1);
+        } else {
+            territoryContested = true;
+        }
+    }
+    if (x0 < x1) MarkTerritoryDirty({ x0, y0, x1 - x0, y1 - y0 });
+}
+
+void World::RebuildTerritoryOwners() {
+    std::vector<int> previous = std::move(tileOwner);
+    tileOwner.assign((size_t)cols * rows, -1);
+    territoryContested = false;
+
+    for (int sid = 0; sid < (int)settlements.size(); sid++) {
+        if (!settlements[sid].alive) continue;
+
+        for (int tile : settlements[sid].tiles) {
+            if (tileOwner[tile] < 0) {
+                tileOwner[tile] = sid;
+            } else if (tileOwner[tile] != sid) {
+                territoryContested = true;
+            }
+        }
+    }
+
+    // Dirty the tiles whose drawn owner changed
+    if (previous.size() != tileOwner.size()) {
+        MarkTerritoryDirty({ 0, 0, cols, rows });
+        return;
+    }
+    auto drawnOwner = [&](int owner) {
+        return (owner >= 0 && owner < (int)settlements.size() && settlements[owner].alive) ? owner : -1;
+    };
+    int x0 = cols, y0 = rows, x1 = 0, y1 = 0;
+    for (int tile = 0; tile < (int)tileOwner.size(); tile++) {
+        if (drawnOwner(previous[tile]) == drawnOwner(tileOwner[tile])) continue;
+        x0 = std::min(x0, tile % cols);
+        y0 = std::min(y0, tile / cols);
+        x1 = std::max(x1, tile % cols + 1);
+        y1 = std::max(y1, tile / cols + 1);
+    }
+    if (x0 < x1) MarkTerritoryDirty({ x0, y0, x1 - x0, y1 - y0 });
+}
+
+uint32_t World::NextTileMark() {
+    if (tileMark.size() != (size_t)cols * rows) {
+        tileMark.assign((size_t)cols * rows, 0u);
+        tileMarkEpoch = 0;
+    }
+
+    if (++tileMarkEpoch == 0) {
+        std::fill(tileMark.begin(), tileMark.end(), 0u);
+        tileMarkEpoch = 1;
+    }
+    return tileMarkEpoch;
 }
 
 bool World::SettlementHasLivingCombatUnits(int settlementId) const
@@ -795,7 +584,7 @@ bool World::SettlementHasLivingCombatUnits(int settlementId) const
     if (settlementId < 0 || settlementId >= (int)settlements.size()) return false;
     if (!settlements[settlementId].alive) return false;
 
-    for (const auto& npc : npcs) {
+    for (ConstNpcRef npc : npcs) {
         if (!npc.alive || npc.isDying) continue;
         if (npc.settlementId != settlementId) continue;
         if (!IsCombatRoleForWar(npc.humanRole)) continue;
@@ -867,17 +656,43 @@ Rectangle World::ComputeSettlementBoundsPx(const Settlement& s) {
 }
 
 
+// Settlements only touch through a tile listed by more than one of them, and
+// the owner grid flags that when it happens, so the common case is O(1).
+// Otherwise a settlement sharing a tile must hold a tile it does not own,
+// which limits the pair tests; each test is a stamp pass over both tile lists.
 void World::MergeSettlementsIfNeeded() {
+    if (!territoryContested) return;
+    if ((int)tileOwner.size() != cols * rows) RebuildTerritoryOwners();
+
+    std::vector<char> holdsForeign(settlements.size(), 0);
+    for (int sid = 0; sid < (int)settlements.size(); sid++) {
+        if (!settlements[sid].alive) continue;
+        for (int tile : settlements[sid].tiles) {
+            if (tileOwner[tile] != sid) {
+                holdsForeign[sid] = 1;
+                break;
+            }
+        }
+    }
+
     for (int i = 0; i < (int)settlements.size(); i++) {
         if (!settlements[i].alive) continue;
 
+        uint32_t mark = 0;
+
         for (int j = i + 1; j < (int)settlements.size(); j++) {
             if (!settlements[j].alive) continue;
+            if (!holdsForeign[i] && !holdsForeign[j]) continue;
+
+            if (mark == 0) {
+                mark = NextTileMark();
+                for (int tile : settlements[i].tiles) tileMark[tile] = mark;
+            }
 
             bool touching = false;
 
             for (int tile : settlements[j].tiles) {
-                if (settlements[i].tiles.count(tile)) {
+                if (tileMark[tile] == mark) {
                     touching = true;
                     break;
                 }
@@ -890,10 +705,14 @@ void World::MergeSettlementsIfNeeded() {
             }
 
             // Merge settlement j into settlement i
-            for (int tile : settlements[j].tiles)
-                settlements[i].tiles.insert(tile);
+            for (int tile : settlements[j].tiles) {
+                if (tileMark[tile] == mark) continue;
+                tileMark[tile] = mark;
+                settlements[i].tiles.push_back(tile);
+            }
+            holdsForeign[i] = 1;
 
-            for (auto& npc : npcs)
+            for (NpcRef npc : npcs)
                 if (npc.settlementId == j)
                     npc.settlementId = i;
 
@@ -911,19 +730,21 @@ void World::MergeSettlementsIfNeeded() {
             settlements[i].boundsPx = ComputeSettlementBoundsPx(settlements[i]);
         }
     }
+
+    RebuildTerritoryOwners();
 }
 
-static Vector2 RandomEdgeSpawn(int w, int h) {
-    int side = GetRandomValue(0, 3);
+static Vector2 RandomEdgeSpawn(Rng& rng, int w, int h) {
+    int side = RandomInt(rng, 0, 3);
     switch (side) {
         case 0:
-            return {0.0f, (float) GetRandomValue(0, h)};        // left
+            return {0.0f, (float) RandomInt(rng, 0, h)};        // left
         case 1:
-            return {(float) w, (float) GetRandomValue(0, h)};    // right
+            return {(float) w, (float) RandomInt(rng, 0, h)};    // right
         case 2:
-            return {(float) GetRandomValue(0, w), 0.0f};        // top
+            return {(float) RandomInt(rng, 0, w), 0.0f};        // top
         default:
-            return {(float) GetRandomValue(0, w), (float) h};   // bottom
+            return {(float) RandomInt(rng, 0, w), (float) h};   // bottom
     }
 }
 
@@ -931,24 +752,24 @@ void World::SpawnCivilian(Vector2 pos) {
     if (!terrain.canBuild(pos.x, pos.y)) return;
 
     NPC npc;
-    npc.id = nextNpcId++;
-    npc.type = NPC::Type::HUMAN;
+    npc.id = npcs.AllocateId();
+    npc.cold.type = NPC::Type::HUMAN;
     npc.humanRole = NPC::HumanRole::CIVILIAN;
-    npc.skinId = (uint16_t)GetRandomValue(0, 2); // 0..2
+    npc.cold.skinId = (uint16_t)RandomInt(rng, 0, 2); // 0..2
     npc.pos = pos;
     npc.vel = {0, 0};
-    npc.speed = 15.0f;
+    npc.cold.speed = 15.0f;
     npc.hp = 100.0f;
     npc.alive = true;
     npc.settlementId = -1;
-    npc.damage = 0.0f;
+    npc.cold.damage = 0.0f;
 
 
     // Join an existing settlement if the click lands inside one
     int sid = -1;
     for (int i = 0; i < (int) settlements.size(); i++) {
         if (!settlements[i].alive) continue;
-        if (PointInSettlementPx(settlements[i], pos)) {
+        if (PointInSettlementPx(i, pos)) {
             sid = i;
             break;
         }
@@ -961,12 +782,15 @@ void World::SpawnCivilian(Vector2 pos) {
 
     // Otherwise look for nearby free civilians to form a new settlement
     if (sid == -1) {
+        NpcQueryFilter freeCivFilter;
+        freeCivFilter.Roles({NPC::HumanRole::CIVILIAN}).InSettlement(-1).IncludeDying();
+
+        std::vector<int> candidates;
+        npcGrid.QueryRadius(npcs, pos, 90.0f, freeCivFilter, candidates);
+
         std::vector<int> nearbyFreeCivs;
-        for (int i = 0; i < (int) npcs.size(); i++) {
-            const auto &o = npcs[i];
-            if (!o.alive) continue;
-            if (o.humanRole != NPC::HumanRole::CIVILIAN) continue;
-            if (o.settlementId != -1) continue;
+        for (int i : candidates) {
+            ConstNpcRef o = npcs[i];
 
             float dx = o.pos.x - pos.x;
             float dy = o.pos.y - pos.y;
@@ -989,19 +813,20 @@ void World::SpawnCivilian(Vector2 pos) {
                     int tx = cx + dx;
                     int ty = cy + dy;
                     if (tx < 0 || ty < 0 || tx >= cols || ty >= rows) continue;
-                    s.tiles.insert(ty * cols + tx);
+                    s.tiles.push_back(ty * cols + tx);
                 }
             }
 
             s.color = Color{
-                    (unsigned char)GetRandomValue(80,255),
-                    (unsigned char)GetRandomValue(80,255),
-                    (unsigned char)GetRandomValue(80,255),
+                    (unsigned char)RandomInt(rng, 80,255),
+                    (unsigned char)RandomInt(rng, 80,255),
+                    (unsigned char)RandomInt(rng, 80,255),
                     255
             };
 
             settlements.push_back(s);
             int sid = (int)settlements.size() - 1;
+            ClaimSettlementTerritory(sid);
 
             settlements[sid].centerPx = ComputeSettlementCenterPx(settlements[sid]);
             settlements[sid].boundsPx = ComputeSettlementBoundsPx(settlements[sid]);
@@ -1018,21 +843,21 @@ void World::SpawnWarrior(Vector2 pos) {
     if (!terrain.canBuild(pos.x, pos.y)) return;
 
     NPC npc;
-    npc.id = nextNpcId++;
-    npc.type = NPC::Type::HUMAN;
+    npc.id = npcs.AllocateId();
+    npc.cold.type = NPC::Type::HUMAN;
     npc.humanRole = NPC::HumanRole::WARRIOR;
-    npc.skinId = (uint16_t)GetRandomValue(0, 2);
+    npc.cold.skinId = (uint16_t)RandomInt(rng, 0, 2);
     npc.pos = pos;
     npc.vel = {0,0};
-    npc.speed = 35.0f;
+    npc.cold.speed = 35.0f;
     npc.hp = 180.0f;
-    npc.damage =16.0f;
+    npc.cold.damage =16.0f;
     npc.settlementId = -1;
 
     // Attach spawned warriors to the clicked settlement when possible
     for (int i = 0; i < (int)settlements.size(); i++) {
         if (!settlements[i].alive) continue;
-        if (PointInSettlementPx(settlements[i], pos)) {
+        if (PointInSettlementPx(i, pos)) {
             npc.settlementId = i;
             break;
         }
@@ -1044,31 +869,31 @@ void World::SpawnCaptain(Vector2 pos) {
     if (!terrain.canBuild(pos.x, pos.y)) return;
 
     NPC npc;
-    npc.id = nextNpcId++;
-    npc.type = NPC::Type::HUMAN;
+    npc.id = npcs.AllocateId();
+    npc.cold.type = NPC::Type::HUMAN;
     npc.humanRole = NPC::HumanRole::CAPTAIN;
-    npc.warriorRank = NPC::WarriorRank::CAPTAIN;
-    npc.isCaptain = true;
+    npc.cold.warriorRank = NPC::WarriorRank::CAPTAIN;
+    npc.cold.isCaptain = true;
 
-    npc.skinId = (uint16_t)GetRandomValue(0, NPC_VARIANTS - 1);
+    npc.cold.skinId = (uint16_t)RandomInt(rng, 0, NPC_VARIANTS - 1);
     npc.pos = pos;
     npc.vel = {0, 0};
 
-    npc.speed = 35.0f;
+    npc.cold.speed = 35.0f;
     npc.hp = 260.0f;
-    npc.damage = 22.0f;
+    npc.cold.damage = 22.0f;
 
-    npc.captainAutoMode = true;
-    npc.captainHasMoveOrder = false;
-    npc.captainHasAttackOrder = false;
-    npc.captainAttackGroupId = -1;
-    npc.captainAttackTargetId = 0;
+    npc.captain.captainAutoMode = true;
+    npc.captain.captainHasMoveOrder = false;
+    npc.captain.captainHasAttackOrder = false;
+    npc.captain.captainAttackGroupId = -1;
+    npc.captain.captainAttackTargetId = 0;
 
     npc.settlementId = -1;
 
     for (int i = 0; i < (int)settlements.size(); i++) {
         if (!settlements[i].alive) continue;
-        if (PointInSettlementPx(settlements[i], pos)) {
+        if (PointInSettlementPx(i, pos)) {
             npc.settlementId = i;
             break;
         }
@@ -1076,29 +901,114 @@ void World::SpawnCaptain(Vector2 pos) {
 
     npcs.push_back(npc);
 }
-NPC* World::FindNpcById(uint32_t id) {
-    if (id == 0) return nullptr;
-    for (auto& n : npcs) {
-        if (n.alive && !n.isDying && n.id == id) return &n;
+std::optional<NpcRef> World::FindNpcById(uint32_t id) {
+    int i = npcs.IndexOf(id);
+    if (i < 0 || !npcs.IsActive(i)) return std::nullopt;
+    return npcs[i];
+}
+
+std::optional<ConstNpcRef> World::FindNpcById(uint32_t id) const {
+    int i = npcs.IndexOf(id);
+    if (i < 0 || !npcs.IsActive(i)) return std::nullopt;
+    return npcs[i];
+}
+
+Vector2 World::MarchWaypoint(NpcRef npc, Vector2 goal) const {
+    NPC::War& war = npc.war;
+    bool goalMoved = !war.warHasRoute || Vector2DistanceSqr(war.warRouteGoal, goal) > CELL_SIZE * CELL_SIZE;
+    if (!goalMoved && Vector2DistanceSqr(npc.pos, war.warWaypoint) > Terrain::TILE_PX * Terrain::TILE_PX) {
+        return war.warWaypoint;
+    }
+
+    // Attackers of a settlement share its flow field
+    if (const FlowField* field = warFlowFields.find(war.warTargetSettlementId)) {
+        if (Vector2DistanceSqr(field->getGoalPx(), goal) <= CELL_SIZE * CELL_SIZE) {
+            Vector2 next;
+            if (field->nextStep(npc.pos, next)) return next;
+            if (field->costAt(npc.pos) == 0.0f) return goal;
+        }
+    }
+
+    // Only the first stop of the route is kept; the rest is re-planned from there
+    thread_local std::vector<Vector2> route;
+    war.warHasRoute = true;
+    war.warRouteGoal = goal;
+    war.warWaypoint = goal;
+    // A failed search would visit every node it can reach; skip it
+    if (Reachable(npc.pos, goal) && pathfinder.findPath(terrain, npc.pos, goal, route) && route.size() > 1) {
+        war.warWaypoint = route[1];
     }
-    return nullptr;
+    return war.warWaypoint;
 }
 
-const NPC* World::FindNpcById(uint32_t id) const {
-    if (id == 0) return nullptr;
-    for (const auto& n : npcs) {
-        if (n.alive && !n.isDying && n.id == id) return &n;
+bool World::Reachable(Vector2 from, Vector2 to) const {
+    if (!landRegions.isBuilt()) return true;
+    int ends[2] = { -1, -1 };
+    Vector2 points[2] = { from, to };
+    for (int e = 0; e < 2; e++) {
+        int tx = (int)(points[e].x / Terrain::TILE_PX);
+        int ty = (int)(points[e].y / Terrain::TILE_PX);
+        ends[e] = landRegions.regionAt(tx, ty);
+        if (ends[e] == LandRegions::NONE && terrain.findNearestPassable(tx, ty, tx, ty, 3)) {
+            ends[e] = landRegions.regionAt(tx, ty);
+        }
+        if (ends[e] == LandRegions::NONE) return false;
     }
-    return nullptr;
+    return ends[0] == ends[1];
 }
 
-bool World::TryBuildBarracksAt(Vector2 worldPos)
+int World::FindNearestBandit(Vector2 from, float rangePx, int groupId) const {
+    NpcQueryFilter filter;
+    filter.Roles({NPC::HumanRole::BANDIT}).InBanditGroup(groupId).IncludeDying();
+    return npcGrid.FindNearest(npcs, from, rangePx, filter);
+}
+
+// Warriors first, then captains, nearest within the same priority
+int World::FindNearestEnemyCombatNear(ConstNpcRef npc, float radiusPx) const {
+    NpcQueryFilter filter;
+    filter.NotInSettlement(npc.settlementId);
+    return npcGrid.FindByRolePriority(npcs, npc.pos, radiusPx, filter,
+                                      {NPC::HumanRole::WARRIOR, NPC::HumanRole::CAPTAIN});
+}
+
+int World::FindNearestEnemyForSettlementWar(ConstNpcRef attacker, int enemySettlementId, float maxDistPx) const {
+    NpcQueryFilter filter;
+    filter.InSettlement(enemySettlementId).ExcludeId(attacker.id);
+    return npcGrid.FindByRolePriority(npcs, attacker.pos, maxDistPx, filter,
+                                      {NPC::HumanRole::WARRIOR, NPC::HumanRole::CAPTAIN,
+                                       NPC::HumanRole::CIVILIAN});
+}
+
+int World::FindNearestHostileTroopNear(int homeSettlementId, Vector2 homePos, float maxDistPx) const {
+    NpcQueryFilter filter;
+    filter.NotInSettlement(homeSettlementId);
+    return npcGrid.FindByRolePriority(npcs, homePos, maxDistPx, filter,
+                                      {NPC::HumanRole::WARRIOR, NPC::HumanRole::CAPTAIN,
+                                       NPC::HumanRole::CIVILIAN});
+}
+
+int World::CountEnemyCombatUnitsNear(ConstNpcRef npc, float radiusPx) const {
+    NpcQueryFilter filter;
+    filter.Roles({NPC::HumanRole::WARRIOR, NPC::HumanRole::CAPTAIN}).NotInSettlement(npc.settlementId);
+    return npcGrid.CountInRadius(npcs, npc.pos, radiusPx, filter);
+}
+
+// True if a war-assigned combat unit of another settlement is within radius
+bool World::IsEnemyWarTroopNear(int settlementId, Vector2 center, float radiusPx) const {
+    NpcQueryFilter filter;
+    filter.Roles({NPC::HumanRole::WARRIOR, NPC::HumanRole::CAPTAIN}).NotInSettlement(settlementId);
+    return npcGrid.AnyInRadiusIf(npcs, center, radiusPx, filter,
+                                 [](ConstNpcRef n) { return n.war.warAssigned; });
+}
+
+bool World::CanBuildBarracksAt(Vector2 worldPos, int* settlementId) const
 {
     if (!terrain.canBuild(worldPos.x, worldPos.y)) return false;
 
-    for (auto& s : settlements) {
+    for (int i = 0; i < (int)settlements.size(); i++) {
+        const Settlement& s = settlements[i];
         if (!s.alive) continue;
-        if (!PointInSettlementPx(s, worldPos)) continue;
+        if (!PointInSettlementPx(i, worldPos)) continue;
 
         float dxFire = worldPos.x - s.campfirePosPx.x;
         float dyFire = worldPos.y - s.campfirePosPx.y;
@@ -1115,7 +1025,7 @@ bool World::TryBuildBarracksAt(Vector2 worldPos)
         }
 
         int tileId = tileY * cols + tileX;
-        if (s.tiles.find(tileId) == s.tiles.end()) {
+        if (!SettlementHasTile(i, tileId)) {
             return false;
         }
 
@@ -1135,22 +1045,34 @@ bool World::TryBuildBarracksAt(Vector2 worldPos)
             }
         }
 
-        Barracks b;
-        b.alive = true;
-        b.posPx = snappedPos;
-        b.maxHp = 600.0f;
-        b.hp = b.maxHp;
-        b.warriorTimer = 10.0f;
-        b.captainTimer = 150.0f;
-
-        s.barracksList.push_back(b);
-
+        if (settlementId) *settlementId = i;
         return true;
     }
 
     return false;
 }
 
+bool World::TryBuildBarracksAt(Vector2 worldPos)
+{
+    int sid = -1;
+    if (!CanBuildBarracksAt(worldPos, &sid)) return false;
+
+    Barracks b;
+    b.alive = true;
+    b.posPx = {
+        ((int)(worldPos.x / CELL_SIZE) + 0.5f) * CELL_SIZE,
+        ((int)(worldPos.y / CELL_SIZE) + 0.5f) * CELL_SIZE
+    };
+    b.maxHp = 600.0f;
+    b.hp = b.maxHp;
+    b.warriorTimer = 10.0f;
+    b.captainTimer = 150.0f;
+
+    settlements[sid].barracksList.push_back(b);
+
+    return true;
+}
+
 bool World::IsSettlementAliveAndValid(int settlementId) const
 {
     return settlementId >= 0 &&
@@ -1163,6 +1085,7 @@ void World::StartSettlementWar(int attackerSettlementId, int targetSettlementId)
     if (attackerSettlementId == targetSettlementId) return;
     if (!IsSettlementAliveAndValid(attackerSettlementId)) return;
     if (!IsSettlementAliveAndValid(targetSettlementId)) return;
+    if (!Reachable(settlements[attackerSettlementId].centerPx, settlements[targetSettlementId].centerPx)) return;
 
     Settlement& a = settlements[attackerSettlementId];
     Settlement& b = settlements[targetSettlementId];
@@ -1202,19 +1125,19 @@ void World::StopSettlementWar(int settlementId)
     s.offensiveWaveReady = false;
     s.defensiveMobilization = false;
 
-    for (auto& npc : npcs) {
-        if (npc.warFromSettlementId == settlementId || npc.warTargetSettlementId == settlementId) {
-            npc.warAssigned = false;
-            npc.warFromSettlementId = -1;
-            npc.warTargetSettlementId = -1;
-            npc.warMarching = false;
-            npc.warTargetPos = {0.0f, 0.0f};
-            npc.warCaptainId = 0;
-            npc.warSquadIndex = -1;
-            npc.warIsDefender = false;
-            npc.warReady = false;
-            npc.warInBattle = false;
-            npc.warBattleLockTimer = 0.0f;
+    for (NpcRef npc : npcs) {
+        if (npc.war.warFromSettlementId == settlementId || npc.war.warTargetSettlementId == settlementId) {
+            npc.war.warAssigned = false;
+            npc.war.warFromSettlementId = -1;
+            npc.war.warTargetSettlementId = -1;
+            npc.war.warMarching = false;
+            npc.war.warTargetPos = {0.0f, 0.0f};
+            npc.war.warCaptainId = 0;
+            npc.war.warSquadIndex = -1;
+            npc.war.warIsDefender = false;
+            npc.war.warReady = false;
+            npc.war.warInBattle = false;
+            npc.war.warBattleLockTimer = 0.0f;
         }
     }
 
@@ -1228,19 +1151,19 @@ void World::StopSettlementWar(int settlementId)
         settlements[targetId].offensiveWaveReady = false;
         settlements[targetId].defensiveMobilization = false;
 
-        for (auto& npc : npcs) {
-            if (npc.warFromSettlementId == targetId || npc.warTargetSettlementId == targetId) {
-                npc.warAssigned = false;
-                npc.warFromSettlementId = -1;
-                npc.warTargetSettlementId = -1;
-                npc.warMarching = false;
-                npc.warTargetPos = {0.0f, 0.0f};
-                npc.warCaptainId = 0;
-                npc.warSquadIndex = -1;
-                npc.warIsDefender = false;
-                npc.warReady = false;
-                npc.warInBattle = false;
-                npc.warBattleLockTimer = 0.0f;
+        for (NpcRef npc : npcs) {
+            if (npc.war.warFromSettlementId == targetId || npc.war.warTargetSettlementId == targetId) {
+                npc.war.warAssigned = false;
+                npc.war.warFromSettlementId = -1;
+                npc.war.warTargetSettlementId = -1;
+                npc.war.warMarching = false;
+                npc.war.warTargetPos = {0.0f, 0.0f};
+                npc.war.warCaptainId = 0;
+                npc.war.warSquadIndex = -1;
+                npc.war.warIsDefender = false;
+                npc.war.warReady = false;
+                npc.war.warInBattle = false;
+                npc.war.warBattleLockTimer = 0.0f;
             }
         }
     }
@@ -1248,66 +1171,84 @@ void World::StopSettlementWar(int settlementId)
 
 void World::RefreshSettlementWarSquads()
 {
+    std::unordered_map<uint32_t, int> captainIndex;
+    for (int i = 0; i < (int)npcs.size(); i++) {
+        ConstNpcRef npc = npcs[i];
+        if (!npc.alive || npc.isDying) continue;
+        if (npc.humanRole == NPC::HumanRole::CAPTAIN) captainIndex[npc.id] = i;
+    }
+
     // Clear broken captain references
-    for (auto& npc : npcs) {
+    for (NpcRef npc : npcs) {
         if (!npc.alive || npc.isDying) continue;
         if (npc.humanRole != NPC::HumanRole::WARRIOR) continue;
 
-        if (npc.warCaptainId != 0) {
-            NPC* cap = FindNpcById(npc.warCaptainId);
-            if (!cap || cap->settlementId != npc.settlementId || cap->humanRole != NPC::HumanRole::CAPTAIN) {
-                npc.warCaptainId = 0;
-                npc.warSquadIndex = -1;
-                npc.warReady = false;
+        if (npc.war.warCaptainId != 0) {
+            auto it = captainIndex.find(npc.war.warCaptainId);
+            if (it == captainIndex.end() || npcs[it->second].settlementId != npc.settlementId) {
+                npc.war.warCaptainId = 0;
+                npc.war.warSquadIndex = -1;
+                npc.war.warReady = false;
             }
         }
     }
 
+    std::unordered_map<uint32_t, int> warriorsPerCaptain;
+    CountAssignedWarriorsPerCaptain(*this, warriorsPerCaptain);
+
     // Assign free warriors to nearest available captain inside same settlement
-    for (auto& npc : npcs) {
+    for (NpcRef npc : npcs) {
         if (!npc.alive || npc.isDying) continue;
         if (npc.humanRole != NPC::HumanRole::WARRIOR) continue;
         if (npc.settlementId < 0) continue;
-        if (npc.warAssigned) continue; // do not rewire active marching/defending units
-        if (npc.warCaptainId != 0) continue;
+        if (npc.war.warAssigned) continue; // do not rewire active marching/defending units
+        if (npc.war.warCaptainId != 0) continue;
 
-        uint32_t captainId = FindNearestAvailableCaptainId(*this, npc.settlementId, npc.pos);
+        uint32_t captainId = FindNearestAvailableCaptainId(*this, npc.settlementId, npc.pos, warriorsPerCaptain);
         if (captainId == 0) continue;
 
-        npc.warCaptainId = captainId;
-        npc.warReady = true;
+        npc.war.warCaptainId = captainId;
+        npc.war.warReady = true;
+        warriorsPerCaptain[captainId]++;
     }
 
     // Reset squad indexes
-    for (auto& npc : npcs) {
+    for (NpcRef npc : npcs) {
         if (!npc.alive || npc.isDying) continue;
         if (npc.settlementId < 0) continue;
         if (npc.humanRole == NPC::HumanRole::CAPTAIN || npc.humanRole == NPC::HumanRole::WARRIOR) {
-            npc.warSquadIndex = -1;
+            npc.war.warSquadIndex = -1;
         }
     }
 
     int nextSquadIndex = 0;
-    for (auto& captain : npcs) {
+    for (NpcRef captain : npcs) {
         if (!captain.alive || captain.isDying) continue;
         if (captain.humanRole != NPC::HumanRole::CAPTAIN) continue;
         if (captain.settlementId < 0) continue;
 
-        int warriorCount = CountAssignedWarriorsForCaptain(*this, captain.settlementId, captain.id);
+        int warriorCount = LookupCount(warriorsPerCaptain, captain.id);
         if (warriorCount >= 2) {
-            captain.warSquadIndex = nextSquadIndex++;
-
-            for (auto& warrior : npcs) {
-                if (!warrior.alive || warrior.isDying) continue;
-                if (warrior.settlementId != captain.settlementId) continue;
-                if (warrior.humanRole != NPC::HumanRole::WARRIOR) continue;
-                if (warrior.warCaptainId == captain.id) {
-                    warrior.warSquadIndex = captain.warSquadIndex;
-                    warrior.warReady = true;
-                }
-            }
+            captain.war.warSquadIndex = nextSquadIndex++;
         }
     }
+
+    // Warriors take the squad index of their captain
+    for (NpcRef warrior : npcs) {
+        if (!warrior.alive || warrior.isDying) continue;
+        if (warrior.humanRole != NPC::HumanRole::WARRIOR) continue;
+        if (warrior.war.warCaptainId == 0) continue;
+
+        auto it = captainIndex.find(warrior.war.warCaptainId);
+        if (it == captainIndex.end()) continue;
+
+        ConstNpcRef captain = npcs[it->second];
+        if (captain.settlementId < 0 || captain.settlementId != warrior.settlementId) continue;
+        if (captain.war.warSquadIndex < 0) continue;
+
+        warrior.war.warSquadIndex = captain.war.warSquadIndex;
+        warrior.war.warReady = true;
+    }
 }
 
 void World::UpdateSettlementWarPreparation(float dt)
@@ -1316,6 +1257,9 @@ void World::UpdateSettlementWarPreparation(float dt)
 
     RefreshSettlementWarSquads();
 
+    std::unordered_map<uint32_t, int> warriorsPerCaptain;
+    CountAssignedWarriorsPerCaptain(*this, warriorsPerCaptain);
+
     for (int sid = 0; sid < (int)settlements.size(); sid++) {
         Settlement& s = settlements[sid];
         if (!s.alive) continue;
@@ -1327,7 +1271,7 @@ void World::UpdateSettlementWarPreparation(float dt)
             continue;
         }
 
-        s.preparedSquadCount = CountReadySquadsForSettlement(*this, sid);
+        s.preparedSquadCount = CountReadySquadsForSettlement(*this, sid, warriorsPerCaptain);
         s.offensiveWaveReady = (s.preparedSquadCount >= 3);
     }
 }
@@ -1352,12 +1296,12 @@ void World::UpdateSettlementWarAssignments()
 
         // If an offensive wave is already alive, do not relaunch yet
         bool anyOffensiveAlive = false;
-        for (const auto& npc : npcs) {
+        for (ConstNpcRef npc : npcs) {
             if (!npc.alive || npc.isDying) continue;
-            if (!npc.warAssigned) continue;
-            if (npc.warFromSettlementId != sid) continue;
-            if (npc.warTargetSettlementId != s.warTargetSettlementId) continue;
-            if (npc.warIsDefender) continue;
+            if (!npc.war.warAssigned) continue;
+            if (npc.war.warFromSettlementId != sid) continue;
+            if (npc.war.warTargetSettlementId != s.warTargetSettlementId) continue;
+            if (npc.war.warIsDefender) continue;
             anyOffensiveAlive = true;
             break;
         }
@@ -1368,62 +1312,64 @@ void World::UpdateSettlementWarAssignments()
         }
 
         // Clean stale offensive flags before launching a new wave
-        for (auto& npc : npcs) {
+        for (NpcRef npc : npcs) {
             if (!npc.alive || npc.isDying) continue;
-            if (!npc.warAssigned) continue;
-            if (npc.warFromSettlementId != sid) continue;
-            if (npc.warIsDefender) continue;
+            if (!npc.war.warAssigned) continue;
+            if (npc.war.warFromSettlementId != sid) continue;
+            if (npc.war.warIsDefender) continue;
 
-            npc.warAssigned = false;
-            npc.warMarching = false;
-            npc.warTargetSettlementId = -1;
-            npc.warTargetPos = {0.0f, 0.0f};
+            npc.war.warAssigned = false;
+            npc.war.warMarching = false;
+            npc.war.warTargetSettlementId = -1;
+            npc.war.warTargetPos = {0.0f, 0.0f};
         }
 
         int launchedSquads = 0;
         int launchedUnits = 0;
 
-        for (auto& captain : npcs) {
-            if (!captain.alive || captain.isDying) continue;
-            if (captain.settlementId != sid) continue;
-            if (captain.humanRole != NPC::HumanRole::CAPTAIN) continue;
-            if (captain.warSquadIndex < 0) continue;
+        std::vector<int> captains;
+        QuerySettlementRole(*this, sid, NPC::HumanRole::CAPTAIN, captains);
+
+        for (int ci : captains) {
+            NpcRef captain = npcs[ci];
+            if (captain.war.warSquadIndex < 0) continue;
 
             int warriorCount = CountAssignedWarriorsForCaptain(*this, sid, captain.id);
             if (warriorCount < 2) continue;
 
-            captain.warAssigned = true;
-            captain.warFromSettlementId = sid;
-            captain.warTargetSettlementId = s.warTargetSettlementId;
-            captain.warMarching = true;
-            captain.warTargetPos = settlements[s.warTargetSettlementId].centerPx;
-            captain.warIsDefender = false;
-            captain.warReady = true;
+            captain.war.warAssigned = true;
+            captain.war.warFromSettlementId = sid;
+            captain.war.warTargetSettlementId = s.warTargetSettlementId;
+            captain.war.warMarching = true;
+            captain.war.warTargetPos = settlements[s.warTargetSettlementId].centerPx;
+            captain.war.warIsDefender = false;
+            captain.war.warReady = true;
 
             // Settlement war must not be blocked by stale player/manual state
-            captain.manualControl = false;
-            captain.hasMoveTarget = false;
-            captain.captainHasMoveOrder = false;
-            captain.captainHasAttackOrder = false;
-            captain.captainAttackGroupId = -1;
-            captain.captainAttackTargetId = 0;
+            captain.captain.manualControl = false;
+            captain.captain.hasMoveTarget = false;
+            captain.captain.captainHasMoveOrder = false;
+            captain.captain.captainHasAttackOrder = false;
+            captain.captain.captainAttackGroupId = -1;
+            captain.captain.captainAttackTargetId = 0;
 
             launchedUnits++;
 
+            std::vector<int> warriors;
+            QuerySettlementRole(*this, sid, NPC::HumanRole::WARRIOR, warriors);
+
             int assignedToCaptain = 0;
-            for (auto& warrior : npcs) {
-                if (!warrior.alive || warrior.isDying) continue;
-                if (warrior.settlementId != sid) continue;
-                if (warrior.humanRole != NPC::HumanRole::WARRIOR) continue;
-                if (warrior.warCaptainId != captain.id) continue;
-
-                warrior.warAssigned = true;
-                warrior.warFromSettlementId = sid;
-                warrior.warTargetSettlementId = s.warTargetSettlementId;
-                warrior.warMarching = true;
-                warrior.warTargetPos = settlements[s.warTargetSettlementId].centerPx;
-                warrior.warIsDefender = false;
-                warrior.warReady = true;
+            for (int wi : warriors) {
+                NpcRef warrior = npcs[wi];
+                if (warrior.war.warCaptainId != captain.id) continue;
+
+                warrior.war.warAssigned = true;
+                warrior.war.warFromSettlementId = sid;
+                warrior.war.warTargetSettlementId = s.warTargetSettlementId;
+                warrior.war.warMarching = true;
+                warrior.war.warTargetPos = settlements[s.warTargetSettlementId].centerPx;
+                warrior.war.warIsDefender = false;
+                warrior.war.warReady = true;
 
                 assignedToCaptain++;
                 launchedUnits++;
@@ -1440,16 +1386,16 @@ void World::UpdateSettlementWarAssignments()
             s.warWaveSize = launchedUnits;
         } else {
             // failed launch: fully roll back offensive assignment for this settlement
-            for (auto& npc : npcs) {
+            for (NpcRef npc : npcs) {
                 if (!npc.alive || npc.isDying) continue;
-                if (!npc.warAssigned) continue;
-                if (npc.warFromSettlementId != sid) continue;
-                if (npc.warIsDefender) continue;
-
-                npc.warAssigned = false;
-                npc.warMarching = false;
-                npc.warTargetSettlementId = -1;
-                npc.warTargetPos = {0.0f, 0.0f};
+                if (!npc.war.warAssigned) continue;
+                if (npc.war.warFromSettlementId != sid) continue;
+                if (npc.war.warIsDefender) continue;
+
+                npc.war.warAssigned = false;
+                npc.war.warMarching = false;
+                npc.war.warTargetSettlementId = -1;
+                npc.war.warTargetPos = {0.0f, 0.0f};
             }
             s.attackWaveLaunched = false;
             s.warWaveSize = 0;
@@ -1473,67 +1419,89 @@ void World::UpdateSettlementDefense(float dt)
 
         if (!underAttack) {
             // Release only defender state when danger is gone
-            for (auto& npc : npcs) {
+            for (NpcRef npc : npcs) {
                 if (!npc.alive || npc.isDying) continue;
-                if (!npc.warAssigned) continue;
-                if (!npc.warIsDefender) continue;
-                if (npc.warFromSettlementId != sid) continue;
-
-                npc.warAssigned = false;
-                npc.warMarching = false;
-                npc.warTargetSettlementId = -1;
-                npc.warTargetPos = {0.0f, 0.0f};
-                npc.warIsDefender = false;
-                npc.warInBattle = false;
-                npc.warBattleLockTimer = 0.0f;
+                if (!npc.war.warAssigned) continue;
+                if (!npc.war.warIsDefender) continue;
+                if (npc.war.warFromSettlementId != sid) continue;
+
+                npc.war.warAssigned = false;
+                npc.war.warMarching = false;
+                npc.war.warTargetSettlementId = -1;
+                npc.war.warTargetPos = {0.0f, 0.0f};
+                npc.war.warIsDefender = false;
+                npc.war.warInBattle = false;
+                npc.war.warBattleLockTimer = 0.0f;
             }
             continue;
         }
 
-        int hostileIndex = FindNearestHostileTroopNearSettlement(*this, sid, s.centerPx, CELL_SIZE * 20.0f);
+        int hostileIndex = FindNearestHostileTroopNear(sid, s.centerPx, CELL_SIZE * 20.0f);
         if (hostileIndex == -1) continue;
 
         int targetEnemySettlement = npcs[hostileIndex].settlementId;
         if (targetEnemySettlement < 0) continue;
 
+        std::vector<int> members;
+
         // Mobilize all available captains first
-        for (auto& captain : npcs) {
-            if (!captain.alive || captain.isDying) continue;
-            if (captain.settlementId != sid) continue;
-            if (captain.humanRole != NPC::HumanRole::CAPTAIN) continue;
-
-            captain.warAssigned = true;
-            captain.warFromSettlementId = sid;
-            captain.warTargetSettlementId = targetEnemySettlement;
-            captain.warMarching = false;
-            captain.warTargetPos = s.centerPx;
-            captain.warIsDefender = true;
-            captain.warReady = true;
+        QuerySettlementRole(*this, sid, NPC::HumanRole::CAPTAIN, members);
+        for (int ci : members) {
+            NpcRef captain = npcs[ci];
+
+            captain.war.warAssigned = true;
+            captain.war.warFromSettlementId = sid;
+            captain.war.warTargetSettlementId = targetEnemySettlement;
+            captain.war.warMarching = false;
+            captain.war.warTargetPos = s.centerPx;
+            captain.war.warIsDefender = true;
+            captain.war.warReady = true;
 
             // Settlement defense must not be blocked by stale player/manual state
-            captain.manualControl = false;
-            captain.hasMoveTarget = false;
-            captain.captainHasMoveOrder = false;
-            captain.captainHasAttackOrder = false;
-            captain.captainAttackGroupId = -1;
-            captain.captainAttackTargetId = 0;
+            captain.captain.manualControl = false;
+            captain.captain.hasMoveTarget = false;
+            captain.captain.captainHasMoveOrder = false;
+            captain.captain.captainHasAttackOrder = false;
+            captain.captain.captainAttackGroupId = -1;
+            captain.captain.captainAttackTargetId = 0;
         }
 
         // Mobilize all available warriors too, even if captain link is absent or broken
-        for (auto& warrior : npcs) {
-            if (!warrior.alive || warrior.isDying) continue;
-            if (warrior.settlementId != sid) continue;
-            if (warrior.humanRole != NPC::HumanRole::WARRIOR) continue;
+        QuerySettlementRole(*this, sid, NPC::HumanRole::WARRIOR, members);
+        for (int wi : members) {
+            NpcRef warrior = npcs[wi];
+
+            warrior.war.warAssigned = true;
+            warrior.war.warFromSettlementId = sid;
+            warrior.war.warTargetSettlementId = targetEnemySettlement;
+            warrior.war.warMarching = false;
+            warrior.war.warTargetPos = s.centerPx;
+            warrior.war.warIsDefender = true;
+            warrior.war.warReady = true;
+        }
+    }
+}
+
+void World::SyncWarFlowFields()
+{
+    // Whole-map fields are not worth building on streamed maps
+    if (!pathfinder.isBuilt()) return;
 
-            warrior.warAssigned = true;
-            warrior.warFromSettlementId = sid;
-            warrior.warTargetSettlementId = targetEnemySettlement;
-            warrior.warMarching = false;
-            warrior.warTargetPos = s.centerPx;
-            warrior.warIsDefender = true;
-            warrior.warReady = true;
+    warFlowRefs.resize(settlements.size(), 0);
+    for (int sid = 0; sid < (int)settlements.size(); sid++) {
+        int wars = 0;
+        if (settlements[sid].alive) {
+            for (const Settlement& s : settlements) {
+                if (s.alive && s.warActive && s.warTargetSettlementId == sid) wars++;
+            }
+        }
+        for (; warFlowRefs[sid] < wars; warFlowRefs[sid]++) {
+            warFlowFields.acquire(terrain, sid, settlements[sid].centerPx);
         }
+        for (; warFlowRefs[sid] > wars; warFlowRefs[sid]--) warFlowFields.release(sid);
+        if (wars > 0) warFlowFields.retarget(terrain, sid, settlements[sid].centerPx);
     }
+    warFlowFields.refresh(terrain);
 }
 
 void World::UpdateSettlementWars(float dt)
@@ -1542,47 +1510,47 @@ void World::UpdateSettlementWars(float dt)
     UpdateSettlementDefense(dt);
     const float defenseRadius = CELL_SIZE * 10.0f;
 
-    for (auto& npc : npcs) {
+    for (NpcRef npc : npcs) {
         if (!npc.alive || npc.isDying) continue;
 
-        if (npc.warAssigned) {
-            int localEnemyCombatCount = CountEnemyCombatUnitsNearNpc(*this, npc, CELL_SIZE * 8.0f);
+        if (npc.war.warAssigned) {
+            int localEnemyCombatCount = CountEnemyCombatUnitsNear(npc, CELL_SIZE * 8.0f);
 
             if (localEnemyCombatCount > 0) {
-                npc.warInBattle = true;
-                npc.warBattleLockTimer = 1.5f;
-            } else if (npc.warBattleLockTimer > 0.0f) {
-                npc.warBattleLockTimer -= dt;
-                if (npc.warBattleLockTimer <= 0.0f) {
-                    npc.warBattleLockTimer = 0.0f;
-                    npc.warInBattle = false;
+                npc.war.warInBattle = true;
+                npc.war.warBattleLockTimer = 1.5f;
+            } else if (npc.war.warBattleLockTimer > 0.0f) {
+                npc.war.warBattleLockTimer -= dt;
+                if (npc.war.warBattleLockTimer <= 0.0f) {
+                    npc.war.warBattleLockTimer = 0.0f;
+                    npc.war.warInBattle = false;
                 }
             } else {
-                npc.warInBattle = false;
+                npc.war.warInBattle = false;
             }
         } else {
-            npc.warInBattle = false;
-            npc.warBattleLockTimer = 0.0f;
+            npc.war.warInBattle = false;
+            npc.war.warBattleLockTimer = 0.0f;
         }
     }
 
     // Release stale defender assignments if no hostile troops remain near their home settlement
-    for (auto& npc : npcs) {
+    for (NpcRef npc : npcs) {
         if (!npc.alive || npc.isDying) continue;
-        if (!npc.warAssigned) continue;
-        if (!npc.warIsDefender) continue;
+        if (!npc.war.warAssigned) continue;
+        if (!npc.war.warIsDefender) continue;
         if (npc.settlementId < 0 || npc.settlementId >= (int)settlements.size()) continue;
         if (!settlements[npc.settlementId].alive) continue;
 
         bool stillUnderAttack = IsEnemySettlementTroopNearSettlement(*this, npc.settlementId, defenseRadius);
         if (!stillUnderAttack) {
-            npc.warAssigned = false;
-            npc.warMarching = false;
-            npc.warTargetSettlementId = -1;
-            npc.warTargetPos = {0.0f, 0.0f};
-            npc.warIsDefender = false;
-            npc.warInBattle = false;
-            npc.warBattleLockTimer = 0.0f;
+            npc.war.warAssigned = false;
+            npc.war.warMarching = false;
+            npc.war.warTargetSettlementId = -1;
+            npc.war.warTargetPos = {0.0f, 0.0f};
+            npc.war.warIsDefender = false;
+            npc.war.warInBattle = false;
+            npc.war.warBattleLockTimer = 0.0f;
         }
     }
 
@@ -1597,12 +1565,12 @@ void World::UpdateSettlementWars(float dt)
         }
 
         bool anyOffensiveAssignedAlive = false;
-        for (const auto& npc : npcs) {
+        for (ConstNpcRef npc : npcs) {
             if (!npc.alive || npc.isDying) continue;
-            if (!npc.warAssigned) continue;
-            if (npc.warFromSettlementId != sid) continue;
-            if (npc.warTargetSettlementId != s.warTargetSettlementId) continue;
-            if (npc.warIsDefender) continue;
+            if (!npc.war.warAssigned) continue;
+            if (npc.war.warFromSettlementId != sid) continue;
+            if (npc.war.warTargetSettlementId != s.warTargetSettlementId) continue;
+            if (npc.war.warIsDefender) continue;
 
             anyOffensiveAssignedAlive = true;
             break;
@@ -1619,7 +1587,7 @@ void World::UpdateSettlementWars(float dt)
     UpdateSettlementWarAssignments();
 }
 
-void World::BeginNpcAttack(NPC& npc, Vector2 targetPos) {
+void World::BeginNpcAttack(NpcRef npc, Vector2 targetPos) {
     Vector2 dir = Vector2Subtract(targetPos, npc.pos);
 
     if (Vector2Length(dir) <= 0.001f) {
@@ -1632,142 +1600,270 @@ void World::BeginNpcAttack(NPC& npc, Vector2 targetPos) {
         dir = Vector2Normalize(dir);
     }
 
-    npc.isAttacking = true;
-    npc.attackAnimTimer = npc.attackAnimDuration;
-    npc.attackAnimDir = dir;
+    npc.cold.isAttacking = true;
+    npc.cold.attackAnimTimer = npc.cold.attackAnimDuration;
+    npc.cold.attackAnimDir = dir;
 }
 
-void World::BeginNpcDeath(NPC& npc) {
+void World::ApplyNpcIntent(const NpcIntent& intent) {
+    switch (intent.kind) {
+        case NpcIntent::Kind::DAMAGE_NPC: {
+            NpcRef target = npcs[intent.target];
+            target.hp -= intent.amount;
+            if (target.hp <= 0.0f) {
+                target.hp = 0.0f;
+                BeginNpcDeath(target);
+            }
+            break;
+        }
+
+        case NpcIntent::Kind::DAMAGE_BARRACKS:
+            DamageSettlementBarracks(intent.target, intent.barracksIndex, intent.amount);
+            break;
+
+        case NpcIntent::Kind::JOIN_SQUAD: {
+            NpcRef warrior = npcs[intent.target];
+            if (warrior.squad.leaderCaptainId != 0 && warrior.squad.leaderCaptainId != intent.captainId) break;
+            warrior.squad.leaderCaptainId = intent.captainId;
+            warrior.squad.formationSlot = intent.formationSlot;
+            break;
+        }
+
+        case NpcIntent::Kind::LEAVE_SQUAD: {
+            NpcRef warrior = npcs[intent.target];
+            if (warrior.squad.leaderCaptainId != intent.captainId) break;
+            warrior.squad.leaderCaptainId = 0;
+            warrior.squad.formationSlot = -1;
+            break;
+        }
+    }
+}
+
+void World::BeginNpcDeath(NpcRef npc) {
     if (!npc.alive || npc.isDying) return;
 
     npc.alive = false;
     npc.isDying = true;
-    npc.deathTimer = 0.0f;
+    npc.cold.deathTimer = 0.0f;
     npc.hp = 0.0f;
     npc.vel = {0.0f, 0.0f};
-    npc.attackCooldown = 0.0f;
-    npc.inCombat = false;
-
-    npc.manualControl = false;
-    npc.hasMoveTarget = false;
-    npc.captainHasMoveOrder = false;
-    npc.captainHasAttackOrder = false;
-    npc.captainAttackGroupId = -1;
-    npc.captainAttackTargetId = 0;
-    npc.warAssigned = false;
-    npc.warFromSettlementId = -1;
-    npc.warTargetSettlementId = -1;
-    npc.warMarching = false;
-    npc.warTargetPos = {0.0f, 0.0f};
-    npc.warCaptainId = 0;
-    npc.warSquadIndex = -1;
-    npc.warIsDefender = false;
-    npc.warReady = false;
-    npc.warInBattle = false;
-    npc.warBattleLockTimer = 0.0f;
+    npc.cold.attackCooldown = 0.0f;
+    npc.squad.inCombat = false;
+
+    npc.captain.manualControl = false;
+    npc.captain.hasMoveTarget = false;
+    npc.captain.captainHasMoveOrder = false;
+    npc.captain.captainHasAttackOrder = false;
+    npc.captain.captainAttackGroupId = -1;
+    npc.captain.captainAttackTargetId = 0;
+    npc.war.warAssigned = false;
+    npc.war.warFromSettlementId = -1;
+    npc.war.warTargetSettlementId = -1;
+    npc.war.warMarching = false;
+    npc.war.warTargetPos = {0.0f, 0.0f};
+    npc.war.warCaptainId = 0;
+    npc.war.warSquadIndex = -1;
+    npc.war.warIsDefender = false;
+    npc.war.warReady = false;
+    npc.war.warInBattle = false;
+    npc.war.warBattleLockTimer = 0.0f;
 
     if (selectedCaptainId == npc.id) {
         selectedCaptainId = 0;
     }
 
     if (npc.humanRole == NPC::HumanRole::CAPTAIN) {
-        for (auto& other : npcs) {
-            if (other.leaderCaptainId == npc.id) {
-                other.leaderCaptainId = 0;
-                other.formationSlot = -1;
+        for (NpcRef other : npcs) {
+            if (other.squad.leaderCaptainId == npc.id) {
+                other.squad.leaderCaptainId = 0;
+                other.squad.formationSlot = -1;
 
                 // During settlement war, followers must keep fighting and not fall back to idle/home behavior
-                if (!other.warAssigned) {
-                    other.inCombat = false;
+                if (!other.war.warAssigned) {
+                    other.squad.inCombat = false;
                 }
             }
 
             // If the dead captain was the warrior's war captain, detach only the captain reference,
             // but keep the warrior in war state so he continues fighting
-            if (other.warCaptainId == npc.id) {
-                other.warCaptainId = 0;
-                other.warReady = true;
-                other.warInBattle = true;
-                other.warBattleLockTimer = 1.5f;
+            if (other.war.warCaptainId == npc.id) {
+                other.war.warCaptainId = 0;
+                other.war.warReady = true;
+                other.war.warInBattle = true;
+                other.war.warBattleLockTimer = 1.5f;
             }
         }
     }
 
-    npc.leaderCaptainId = 0;
-    npc.formationSlot = -1;
+    npc.squad.leaderCaptainId = 0;
+    npc.squad.formationSlot = -1;
 }
 
-void World::IssueCaptainMoveOrder(uint32_t captainId, Vector2 targetPx) {
-    NPC* cap = FindNpcById(captainId);
-    if (!cap) return;
-    if (cap->humanRole != NPC::HumanRole::CAPTAIN) return;
+bool World::IssueCaptainMoveOrder(uint32_t captainId, Vector2 targetPx) {
+    std::optional<NpcRef> cap = FindNpcById(captainId);
+    if (!cap) return false;
+    if (cap->humanRole != NPC::HumanRole::CAPTAIN) return false;
+    if (!Reachable(cap->pos, targetPx)) return false;
 
     selectedCaptainId = captainId;
 
-    cap->captainAutoMode = false;
-    cap->captainHasMoveOrder = true;
-    cap->captainMoveTarget = targetPx;
+    cap->captain.captainAutoMode = false;
+    cap->captain.captainHasMoveOrder = true;
+    cap->captain.captainMoveTarget = targetPx;
 
-    cap->captainHasAttackOrder = false;
-    cap->captainAttackGroupId = -1;
-    cap->captainAttackTargetId = 0;
+    cap->captain.captainHasAttackOrder = false;
+    cap->captain.captainAttackGroupId = -1;
+    cap->captain.captainAttackTargetId = 0;
 
     // Keep older captain command fields synchronized
-    cap->manualControl = true;
-    cap->hasMoveTarget = true;
-    cap->moveTargetPx = targetPx;
-}
-
-static void DrawBanditTriangle(Vector2 pos, float size, Color color) {
-    Vector2 p1 = {pos.x, pos.y + size};
-    Vector2 p2 = {pos.x + size, pos.y - size};
-    Vector2 p3 = {pos.x - size, pos.y - size};
-    DrawTriangle(p1, p2, p3, color);
-    DrawTriangleLines(p1, p2, p3, BLACK);
+    cap->captain.manualControl = true;
+    cap->captain.hasMoveTarget = true;
+    cap->captain.moveTargetPx = targetPx;
+    return true;
 }
 
-// Initializes world state and runtime resources
+// Initializes world state
 void World::Init()
 {
     cols = worldW / CELL_SIZE;
     rows = worldH / CELL_SIZE;
+    initStagesDone = 0;
 
-    terrain = Terrain(cols, rows, worldSeed);
-    terrain.generate();
+    rng.Seed(worldSeed);
+    tickCount = 0;
 
     settlements.clear();
     npcs.clear();
-
+    npcGrid.Clear();
 
     plants.clear();
+    plantsRevision++;
     animals.clear();
+    meteors.clear();
 
     banditSpawnTimer = 0.0f;
     nextBanditGroupId = 1;
 
-    LoadNpcSprites();
+    terrain = Terrain(cols, rows, worldSeed);
+    pathfinder = HpaPathfinder();
+    landRegions = LandRegions();
+    warFlowFields = FlowFieldCache();
+    warFlowRefs.clear();
+    const bool eager = (size_t)cols * rows <= EAGER_TERRAIN_TILES;
+    const std::string cachePath = (eager && !generatedCacheDir.empty()) ? GeneratedCachePath() : std::string();
+    initFromCache = !cachePath.empty() && LoadGeneratedWorld(cachePath);
+    if (initFromCache) {
+        // Terrain, graphs, nature and rng all came from the file
+    } else if (eager) {
+        terrain.generate();
+        initStagesDone = 1;
+        pathfinder.build(terrain);
+        initStagesDone = 2;
+        landRegions.build(terrain);
+    } else {
+        terrain.setResidentChunkBudget(TERRAIN_CHUNK_BUDGET);
+    }
+    initStagesDone = 3;
+    terrainDirty.clear();
+    MarkTerrainDirty({ 0, 0, cols, rows });
 
-    LoadFireSprites();
-    LoadBarracksSprite();
     UpdateCampfires();
     settlements.clear();
+    RebuildTerritoryOwners();
+    territoryDirty.clear();
+    MarkTerritoryDirty({ 0, 0, cols, rows });
     npcs.clear();
-    nextNpcId = 1;
     selectedCaptainId = 0;
 
-    GenerateNature(2000, 20);
+    if (!initFromCache) {
+        GenerateNature(2000, 20);
+        if (!cachePath.empty()) SaveGeneratedWorld(cachePath);
+    }
+    initStagesDone = INIT_STAGES;
 }
-void World::Shutdown()
-{
-    UnloadNpcSprites();
-    UnloadFireSprites();
-    UnloadBarracksSprite();
+
+// Advances one NPC's timers and behavior; touches other NPCs only through ctx
+static void UpdateNpcTick(BehaviorContext& ctx, NpcRef npc, float dt) {
+    if (npc.isDying) {
+        npc.cold.deathTimer += dt;
+        if (npc.cold.deathTimer > npc.cold.deathDuration) {
+            npc.cold.deathTimer = npc.cold.deathDuration;
+        }
+        return;
+    }
+
+    if (npc.cold.attackAnimTimer > 0.0f) {
+        npc.cold.attackAnimTimer -= dt;
+        if (npc.cold.attackAnimTimer <= 0.0f) {
+            npc.cold.attackAnimTimer = 0.0f;
+            npc.cold.isAttacking = false;
+        }
+    } else {
+        npc.cold.isAttacking = false;
+    }
+
+    if (npc.cold.type == NPC::Type::HUMAN && npc.alive) {
+        HumanBehavior::Update(ctx, npc, dt);
+    }
+
+    if (npc.alive) {
+        ClampNpcInsideWorld(npc.pos, npc.vel, ctx.world.worldW, ctx.world.worldH);
+    }
+}
+
+void World::SetWorkerCount(int count) {
+    workerCount = (count > 0) ? count : 0;
+    workers.reset();
+}
+
+void World::UpdateNpcsSerial(float dt) {
+    BehaviorContext ctx{ *this, rng, nullptr };
+    for (NpcRef npc : npcs) {
+        UpdateNpcTick(ctx, npc, dt);
+    }
 }
 
+// Read phase: each NPC updates its own record in place and sees the others
+// through npcs, a read view of the shared fields as they were before the
+// pass. Commit phase: intents are applied in chunk order, which is index
+// order, once the updated store is back in npcs.
+void World::UpdateNpcsParallel(float dt) {
+    if (!workers) workers = std::make_unique<WorkerPool>(workerCount);
+
+    const int count = (int)npcs.size();
+    const int chunks = (count + NPC_CHUNK - 1) / NPC_CHUNK;
+    if ((int)chunkIntents.size() < chunks) chunkIntents.resize(chunks);
+
+    npcsNext.CopySharedFrom(npcs);
+    std::swap(npcs, npcsNext);
+
+    workers->ParallelFor(count, NPC_CHUNK, [&](int chunk, int begin, int end) {
+        std::vector<NpcIntent>& intents = chunkIntents[chunk];
+        intents.clear();
 
+        for (int i = begin; i < end; i++) {
+            // Per-NPC stream so draws do not depend on which thread ran first
+            Rng npcRng;
+            npcRng.Seed(((uint64_t)worldSeed << 32) ^ tickCount, npcsNext.Id(i));
+
+            BehaviorContext ctx{ *this, npcRng, &intents };
+            UpdateNpcTick(ctx, npcsNext[i], dt);
+        }
+    });
+
+    std::swap(npcs, npcsNext);
+
+    for (int c = 0; c < chunks; c++) {
+        for (const NpcIntent& intent : chunkIntents[c]) ApplyNpcIntent(intent);
+    }
+}
 
 // Updates the world simulation for one frame
 void World::Update(float dt, const Terrain* terrain) {
+    tickCount++;
+
+    // Chunks left untouched last tick may go; nothing holds tile pointers here
+    this->terrain.trimResident();
 
     // Spawn new bandit groups
     banditSpawnTimer -= dt;
@@ -1775,8 +1871,25 @@ void World::Update(float dt, const Terrain* terrain) {
     if (banditSpawnTimer <= 0.0f) {
         banditSpawnTimer = 45.0f;
 
-        int count = GetRandomValue(5, 8);
-        Vector2 spawnPos = RandomOutsideSpawn(worldW, worldH);
+        int count = RandomInt(rng, 5, 8);
+        Vector2 spawnPos = RandomOutsideSpawn(rng, worldW, worldH);
+        // Land the group where it can walk to a settlement; with none
+        // reachable after a few edge points the wave is skipped
+        bool anySettlement = false;
+        bool reachable = false;
+        for (int attempt = 0; attempt < 4 && !reachable; attempt++) {
+            if (attempt > 0) spawnPos = RandomOutsideSpawn(rng, worldW, worldH);
+            for (const Settlement& s : settlements) {
+                if (!s.alive) continue;
+                anySettlement = true;
+                if (Reachable(spawnPos, s.centerPx)) {
+                    reachable = true;
+                    break;
+                }
+            }
+            if (!anySettlement) break;
+        }
+        if (anySettlement && !reachable) count = 0;
 
         Vector2 toWorldCenter = {
                 worldW * 0.5f - spawnPos.x,
@@ -1787,63 +1900,34 @@ void World::Update(float dt, const Terrain* terrain) {
 
         for (int i = 0; i < count; i++) {
             NPC npc;
-            npc.id = nextNpcId++;
-            npc.type = NPC::Type::HUMAN;
+            npc.id = npcs.AllocateId();
+            npc.cold.type = NPC::Type::HUMAN;
             npc.humanRole = NPC::HumanRole::BANDIT;
-            npc.skinId = (uint16_t)GetRandomValue(0, 2);
+            npc.cold.skinId = (uint16_t)RandomInt(rng, 0, 2);
             npc.settlementId = -1;
 
             npc.banditGroupId = gid;
-            npc.banditGroupDir = dir;
+            npc.bandit.banditGroupDir = dir;
 
-            npc.speed = 40.0f;
+            npc.cold.speed = 40.0f;
             npc.hp = 140.0f;
-            npc.damage = 14.0f;
+            npc.cold.damage = 14.0f;
             npc.pos = {
-                    spawnPos.x + (float)GetRandomValue(-10, 10),
-                    spawnPos.y + (float)GetRandomValue(-10, 10)
+                    spawnPos.x + (float)RandomInt(rng, -10, 10),
+                    spawnPos.y + (float)RandomInt(rng, -10, 10)
             };
-            npc.vel = {dir.x * npc.speed, dir.y * npc.speed};
+            npc.vel = {dir.x * npc.cold.speed, dir.y * npc.cold.speed};
 
-            ClampNpcInsideWorld(npc, worldW, worldH);
+            ClampNpcInsideWorld(npc.pos, npc.vel, worldW, worldH);
             npcs.push_back(npc);
         }
     }
 
     // Update NPC behavior
-    for (auto& npc : npcs) {
-        if (npc.isDying) {
-            npc.deathTimer += dt;
-            if (npc.deathTimer > npc.deathDuration) {
-                npc.deathTimer = npc.deathDuration;
-            }
-            continue;
-        }
-
-        if (npc.attackAnimTimer > 0.0f) {
-            npc.attackAnimTimer -= dt;
-            if (npc.attackAnimTimer <= 0.0f) {
-                npc.attackAnimTimer = 0.0f;
-                npc.isAttacking = false;
-            }
-        } else {
-            npc.isAttacking = false;
-        }
-
-        if (npc.type == NPC::Type::HUMAN && npc.alive) {
-            HumanBehavior::Update(*this, npc, dt);
-        }
-
-        if (npc.alive) {
-            ClampNpcInsideWorld(npc, worldW, worldH);
-        }
-    }
-
-    // Advance fire animation
-    fireAnimT += dt;
-    if (fireAnimT >= fireAnimSpeed) {
-        fireAnimT = 0.0f;
-        fireFrame = (fireFrame + 1) % FIRE_FRAMES;
+    if (updateMode == UpdateMode::PARALLEL) {
+        UpdateNpcsParallel(dt);
+    } else {
+        UpdateNpcsSerial(dt);
     }
 
     UpdateCampfires();
@@ -1851,7 +1935,7 @@ void World::Update(float dt, const Terrain* terrain) {
     UpdateBarracksProduction(dt);
 
     // Bind wild humans to the first settlement they enter
-    for (auto& npc : npcs) {
+    for (NpcRef npc : npcs) {
         if (!npc.alive || npc.isDying) continue;
         if (npc.settlementId != -1) continue;
 
@@ -1863,26 +1947,22 @@ void World::Update(float dt, const Terrain* terrain) {
 
         for (int i = 0; i < (int)settlements.size(); i++) {
             if (!settlements[i].alive) continue;
-            if (PointInSettlementPx(settlements[i], npc.pos)) {
+            if (PointInSettlementPx(i, npc.pos)) {
                 npc.settlementId = i;
                 break;
             }
         }
     }
 
-    npcs.erase(
-            std::remove_if(npcs.begin(), npcs.end(),
-                           [](const NPC& n) {
-                               return !n.alive && (!n.isDying || n.deathTimer >= n.deathDuration);
-                           }),
-            npcs.end()
-    );
+    npcs.RemoveIf([](ConstNpcRef n) {
+        return !n.alive && (!n.isDying || n.cold.deathTimer >= n.cold.deathDuration);
+    });
 
     for (auto& s : settlements) {
         if (!s.alive) continue;
 
         bool anyoneLeft = false;
-        for (const auto& npc : npcs) {
+        for (ConstNpcRef npc : npcs) {
             if (!npc.alive || npc.isDying) continue;
             if (npc.settlementId == (&s - &settlements[0]) &&
                 npc.humanRole != NPC::HumanRole::BANDIT) {
@@ -1897,6 +1977,7 @@ void World::Update(float dt, const Terrain* terrain) {
                 StopSettlementWar(settlementIndex);
             }
             s.alive = false;
+            MarkTerritoryDirty(BoundsTiles(s.boundsPx));
         }
     }
     for (auto& plant : plants) {
@@ -1911,24 +1992,86 @@ void World::Update(float dt, const Terrain* terrain) {
     UpdateArmageddon(dt);
 
     MergeSettlementsIfNeeded();
+
+    // Index survivors once their settlement ids are final for this tick
+    npcGrid.Rebuild(npcs, worldW, worldH, (float)CELL_SIZE);
+
     UpdateCampfires();
     UpdateBarracks();
     UpdateSettlementWars(dt);
+    SyncWarFlowFields();
+}
+
+// Mixes raw bytes into a running FNV-1a hash
+template <typename T>
+static void HashBytes(uint64_t& h, const T& value) {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    for (unsigned char b : bytes) {
+        h ^= b;
+        h *= 1099511628211ULL;
+    }
+}
+
+uint64_t World::ComputeStateHash() const {
+    uint64_t h = 14695981039346656037ULL;
+
+    HashBytes(h, tickCount);
+    HashBytes(h, banditSpawnTimer);
+
+    for (ConstNpcRef n : npcs) {
+        HashBytes(h, n.id);
+        HashBytes(h, n.pos.x);
+        HashBytes(h, n.pos.y);
+        HashBytes(h, n.vel.x);
+        HashBytes(h, n.vel.y);
+        HashBytes(h, n.hp);
+        HashBytes(h, n.alive);
+        HashBytes(h, n.isDying);
+        HashBytes(h, n.humanRole);
+        HashBytes(h, n.settlementId);
+        HashBytes(h, n.squad.leaderCaptainId);
+    }
+
+    for (const Settlement& s : settlements) {
+        HashBytes(h, s.alive);
+        HashBytes(h, (uint64_t)s.tiles.size());
+        HashBytes(h, (uint64_t)s.barracksList.size());
+        HashBytes(h, s.warActive);
+        HashBytes(h, s.warTargetSettlementId);
+    }
+
+    for (const Plant& p : plants) {
+        HashBytes(h, p.growthStage);
+    }
+    for (const auto& a : animals) {
+        HashBytes(h, a->position.x);
+        HashBytes(h, a->position.y);
+    }
+    for (const Meteor& m : meteors) {
+        HashBytes(h, m.pos.y);
+        HashBytes(h, m.state);
+    }
+
+    Rng probe = rng;
+    HashBytes(h, probe.NextU32());
+    return h;
 }
 
 void World::SpawnAnimal(Vector2 pos) {
-    animals.push_back(std::make_unique<Animal>(pos));
+    animals.push_back(std::make_unique<Animal>(pos, rng));
 }
 
 void World::SpawnPlant(Vector2 pos, float treeChance) {
-    plants.push_back(Plant(pos, treeChance));
+    plants.push_back(Plant(pos, treeChance, rng));
+    plantsRevision++;
 }
 
 void World::GenerateNature(int plantCount, int animalCount) {
     const auto& biomes = terrain.getBiomes();
     
     for (int i = 0; i < plantCount; i++) {
-        Vector2 pos = { (float)GetRandomValue(0, worldW), (float)GetRandomValue(0, worldH) };
+        Vector2 pos = { (float)RandomInt(rng, 0, worldW), (float)RandomInt(rng, 0, worldH) };
         
         const Biome* biome = terrain.getBiomeAt(pos.x, pos.y);
         if (biome && biome->props.canBuild) {
@@ -1939,7 +2082,7 @@ void World::GenerateNature(int plantCount, int animalCount) {
     }
     
     for (int i = 0; i < animalCount; i++) {
-        Vector2 pos = { (float)GetRandomValue(0, worldW), (float)GetRandomValue(0, worldH) };
+        Vector2 pos = { (float)RandomInt(rng, 0, worldW), (float)RandomInt(rng, 0, worldH) };
         
         const Biome* biome = terrain.getBiomeAt(pos.x, pos.y);
         if (biome && !biome->props.isWater && biome->props.canWalk) {
@@ -1952,6 +2095,36 @@ void World::SpawnMeteor(Vector2 targetPos) {
     meteors.emplace_back(targetPos);
 }
 
+// Queues rect, clipped to width x height, on list
+static void PushDirtyRect(std::vector<TileRect>& list, TileRect rect, int width, int height) {
+    int x0 = std::max(rect.x, 0);
+    int y0 = std::max(rect.y, 0);
+    int x1 = std::min(rect.x + rect.w, width);
+    int y1 = std::min(rect.y + rect.h, height);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    // Nobody drains the list in headless runs, so keep it short
+    const size_t MAX_DIRTY_RECTS = 32;
+    if (list.size() >= MAX_DIRTY_RECTS) {
+        for (const TileRect& r : list) {
+            x0 = std::min(x0, r.x);
+            y0 = std::min(y0, r.y);
+            x1 = std::max(x1, r.x + r.w);
+            y1 = std::max(y1, r.y + r.h);
+        }
+        list.clear();
+    }
+    list.push_back({ x0, y0, x1 - x0, y1 - y0 });
+}
+
+void World::MarkTerrainDirty(TileRect rect) {
+    PushDirtyRect(terrainDirty, rect, terrain.getWidth(), terrain.getHeight());
+}
+
+void World::MarkTerritoryDirty(TileRect rect) {
+    PushDirtyRect(territoryDirty, rect, cols, rows);
+}
+
 void World::UpdateMeteors(float dt) {
     for (auto& meteor : meteors) {
         meteor.Update(dt);
@@ -1963,6 +2136,9 @@ void World::UpdateMeteors(float dt) {
             int tileRadius = (int)(radius / 8.0f) + 1;
             int centerTileX = (int)(impactPos.x / 8.0f);
             int centerTileY = (int)(impactPos.y / 8.0f);
+
+            int reach = tileRadius + 3;
+            TileRect crater = { centerTileX - reach, centerTileY - reach, 2 * reach + 1, 2 * reach + 1 };
             
             for (int dy = -tileRadius - 3; dy <= tileRadius + 3; dy++) {
                 for (int dx = -tileRadius - 3; dx <= tileRadius + 3; dx++) {
@@ -1976,24 +2152,32 @@ void World::UpdateMeteors(float dt) {
                     if (dist < radius) {
                         Tile& tile = terrain.getTile(tx, ty);
                         float elevationReduction = 0.04f * (1.0f - dist / radius);
-                        tile.elevation = std::max(0.0f, tile.elevation - elevationReduction);
-                        tile.biomeIndex = terrain.getBiomeIndex(tile.elevation, tile.moisture, tile.temperature);
+                        tile.setElevation(std::max(0.0f, tile.getElevation() - elevationReduction));
+                        tile.biomeIndex = (int8_t)terrain.getBiomeIndex(tile.getElevation(), tile.getMoisture(), tile.getTemperature());
                     }
                     else if (dist < radius + 30.0f && dist >= radius) {
-                        if (GetRandomValue(0, 100) < 30) {
+                        if (RandomInt(rng, 0, 100) < 30) {
                             Tile& tile = terrain.getTile(tx, ty);
-                            if (tile.elevation > 0.38f && tile.elevation < 0.83f) {
+                            float elevation = tile.getElevation();
+                            if (elevation > 0.38f && elevation < 0.83f) {
                                 float debrisAmount = 0.03f;
-                                tile.elevation += debrisAmount;
-                                if (tile.elevation > 0.85f) tile.elevation = 0.85f;
-                                tile.biomeIndex = terrain.getBiomeIndex(tile.elevation, tile.moisture, tile.temperature);
+                                elevation += debrisAmount;
+                                if (elevation > 0.85f) elevation = 0.85f;
+                                tile.setElevation(elevation);
+                                tile.biomeIndex = (int8_t)terrain.getBiomeIndex(tile.getElevation(), tile.getMoisture(), tile.getTemperature());
                             }
                         }
                     }
                 }
             }
             
-            for (auto& npc : npcs) {
+            terrain.refreshDerived(crater);
+            MarkTerrainDirty(crater);
+            pathfinder.invalidate(terrain, crater);
+            landRegions.update(terrain, crater);
+            warFlowFields.invalidate();
+
+            for (NpcRef npc : npcs) {
                 if (!npc.alive) continue;
                 float dist = Vector2Distance(npc.pos, impactPos);
                 if (dist < radius) {
@@ -2025,6 +2209,7 @@ void World::UpdateMeteors(float dt) {
                     plants[i-1].health -= meteor.damage;
                     if (plants[i-1].health <= 0) {
                         plants.erase(plants.begin() + i - 1);
+                        plantsRevision++;
                     }
                 }
             }
@@ -2035,6 +2220,7 @@ void World::UpdateMeteors(float dt) {
                 if (distCampfire < radius) {
                     s.alive = false;
                     s.campfirePosPx = {0, 0};
+                    MarkTerritoryDirty(BoundsTiles(s.boundsPx));
                 }
 
                 for (auto& b : s.barracksList) {
@@ -2059,21 +2245,6 @@ void World::UpdateMeteors(float dt) {
 }
 
 
-//специально для никитоса
-void World::DrawMeteors() const {
-    for (const auto& meteor : meteors) {
-        if (meteor.state == Meteor::FALLING) {
-            DrawCircleV(meteor.pos, 12.0f, Color{255, 80, 20, 255});
-            DrawCircleV(meteor.pos, 8.0f, Color{255, 200, 50, 255});
-        } else if (meteor.state == Meteor::EXPLODING) {
-            float pulse = 1.0f - (meteor.explosionTimer / meteor.explosionDuration);
-            float radius = meteor.radius * pulse;
-            DrawCircleV(meteor.targetPos, radius, Color{255, 60, 10, (unsigned char)(100 * pulse)});
-            DrawCircleV(meteor.targetPos, radius * 0.7f, Color{255, 150, 30, (unsigned char)(150 * pulse)});
-        }
-    }
-}
-
 void World::StartArmageddon() {
     armageddonMode = true;
     armageddonTimer = 0.0f;
@@ -2090,328 +2261,10 @@ void World::UpdateArmageddon(float dt) {
     armageddonTimer -= 3 * dt;
     if (armageddonTimer <= 0.0f) {
         Vector2 randomPos = {
-            (float)GetRandomValue(0, worldW),
-            (float)GetRandomValue(0, worldH)
+            (float)RandomInt(rng, 0, worldW),
+            (float)RandomInt(rng, 0, worldH)
         };
         SpawnMeteor(randomPos);
         armageddonTimer = armageddonInterval;
     }
 }
-
-
-// Returns a fully opaque settlement color
-Color GetSafeSettlementColor(const World &w, int sid) {
-    Color c = {220, 220, 220, 255};
-
-    if (sid >= 0 && sid < (int)w.settlements.size() && w.settlements[sid].alive) {
-        c = w.settlements[sid].color;
-    }
-
-    c.a = 255;
-    return c;
-}
-
-// Draws a solid diamond marker
-static void DrawDiamondSolid(Vector2 center, int r, Color col)
-{
-    col.a = 255;
-
-    int cx = (int)center.x;
-    int cy = (int)center.y;
-
-    for (int dy = -r; dy <= 0; dy++) {
-        int half = r + dy;
-        DrawLine(cx - half, cy + dy, cx + half, cy + dy, col);
-    }
-
-    for (int dy = 1; dy <= r; dy++) {
-        int half = r - dy;
-        DrawLine(cx - half, cy + dy, cx + half, cy + dy, col);
-    }
-}
-
-// Draws a diamond outline marker
-static void DrawDiamondOutline(Vector2 center, int r, Color col)
-{
-    col.a = 255;
-    int cx = (int)center.x;
-    int cy = (int)center.y;
-
-    Vector2 top    = {(float)cx,     (float)(cy - r)};
-    Vector2 right  = {(float)(cx+r), (float)cy};
-    Vector2 bottom = {(float)cx,     (float)(cy + r)};
-    Vector2 left   = {(float)(cx-r), (float)cy};
-
-    DrawLineV(top, right, col);
-    DrawLineV(right, bottom, col);
-    DrawLineV(bottom, left, col);
-    DrawLineV(left, top, col);
-}
-
-void World::Draw() const {
-
-    terrain.draw();
-    for (const auto& plant : plants) {
-        plant.Draw();
-    }
-    for (const auto& animal : animals) {
-        if (!animal->alive) continue;
-        animal->Draw();
-    }
-
-    // settlements
-    for (const auto& s : settlements) {
-        if (!s.alive) continue;
-
-        Color fill = Fade(s.color, 0.25f);
-
-        for (int tile : s.tiles) {
-            int cx = tile % cols;
-            int cy = tile / cols;
-
-            DrawRectangle(
-                    cx * CELL_SIZE,
-                    cy * CELL_SIZE,
-                    CELL_SIZE,
-                    CELL_SIZE,
-                    fill
-            );
-        }
-    }
-
-    for (int i = 0; i < (int)settlements.size(); i++) {
-        const Settlement& s = settlements[i];
-        if (!s.alive) continue;
-        if (!s.warActive) continue;
-
-        Color c = s.offensiveWaveReady ? Color{220,60,60,255} : Color{220,190,60,255};
-        DrawRectangleLinesEx(s.boundsPx, 2.0f, c);
-
-        if (s.defensiveMobilization) {
-            DrawCircleV(s.centerPx, 6.0f, Color{255,140,60,220});
-        }
-
-        if (s.warTargetSettlementId >= 0 &&
-            s.warTargetSettlementId < (int)settlements.size() &&
-            settlements[s.warTargetSettlementId].alive) {
-            DrawLineV(s.centerPx, settlements[s.warTargetSettlementId].centerPx, Color{220, 60, 60, 180});
-        }
-    }
-
-    // Draw all barracks
-    for (const auto& s : settlements) {
-        if (!s.alive) continue;
-
-        for (const auto& b : s.barracksList) {
-            if (!b.alive) continue;
-
-            float w = (float)CELL_SIZE * 8.0f;
-            float h = (float)CELL_SIZE * 8.0f;
-
-            if (barracksTexLoaded && barracksTex.id != 0) {
-                Rectangle src{0, 0, (float)barracksTex.width, (float)barracksTex.height};
-                Rectangle dst{
-                        floorf(b.posPx.x - w * 0.5f),
-                        floorf(b.posPx.y - h * 0.92f),
-                        w,
-                        h
-                };
-                DrawTexturePro(barracksTex, src, dst, Vector2{0,0}, 0.0f, WHITE);
-            } else {
-                Rectangle base{
-                        floorf(b.posPx.x - w * 0.5f),
-                        floorf(b.posPx.y - h * 0.82f),
-                        w, h
-                };
-                DrawRectangleRec(base, Color{110, 80, 45, 255});
-                DrawRectangleLinesEx(base, 1.0f, BLACK);
-                DrawRectangle((int)(base.x + w * 0.30f), (int)(base.y + h * 0.55f),
-                              (int)(w * 0.40f), (int)(h * 0.25f), Color{70, 45, 20, 255});
-            }
-
-            if (b.maxHp > 0.0f) {
-                float hpRatio = b.hp / b.maxHp;
-                if (hpRatio < 0.0f) hpRatio = 0.0f;
-                if (hpRatio > 1.0f) hpRatio = 1.0f;
-
-                float barW = w * 0.8f;
-                float barH = 4.0f;
-                float barX = floorf(b.posPx.x - barW * 0.5f);
-                float barY = floorf(b.posPx.y - h * 0.95f);
-
-                DrawRectangle((int)barX, (int)barY, (int)barW, (int)barH, Color{40, 20, 20, 220});
-
-                int fillW = (int)floorf(barW * hpRatio);
-                if (fillW > 0) {
-                    DrawRectangle((int)barX, (int)barY, fillW, (int)barH, Color{210, 70, 70, 255});
-                }
-            }
-        }
-    }
-
-    // Draw NPCs at a fixed world scale
-    for (const auto& npc : npcs) {
-
-        if (!npc.alive && !npc.isDying) continue;
-
-        int v = (int)(npc.skinId % NPC_VARIANTS);
-
-        const Texture2D* tex = nullptr;
-        bool loaded = false;
-
-
-        switch (npc.humanRole) {
-            case NPC::HumanRole::CIVILIAN:
-                tex = &npcTexCivilian[v];
-                loaded = npcTexCivilianLoaded[v];
-                break;
-            case NPC::HumanRole::WARRIOR:
-                tex = &npcTexWarrior[v];
-                loaded = npcTexWarriorLoaded[v];
-                break;
-            case NPC::HumanRole::BANDIT:
-                tex = &npcTexBandit[v];
-                loaded = npcTexBanditLoaded[v];
-                break;
-            case NPC::HumanRole::CAPTAIN:
-                tex = &npcTexCaptain[v];
-                loaded = npcTexCaptainLoaded[v];
-                break;
-            default:
-                break;
-        }
-        float mult = 1.0f;
-        if (npc.humanRole == NPC::HumanRole::CIVILIAN) mult = 1.15f;
-        if (npc.humanRole == NPC::HumanRole::BANDIT)   mult = 1.05f;
-        if (npc.humanRole == NPC::HumanRole::CAPTAIN)  mult = 1.6f;
-
-        float w = (float)CELL_SIZE * 2.0f * mult;
-        float h = (float)CELL_SIZE * 2.0f * mult;
-
-        Rectangle dst{
-                floorf(npc.pos.x - w * 0.5f),
-                floorf(npc.pos.y - h * 0.5f),
-                w, h
-        };
-
-        if (!tex || !loaded || tex->id == 0) {
-            float size = CELL_SIZE * 0.4f;
-            Color c = GetSafeSettlementColor(*this, npc.settlementId);
-            Vector2 drawPos = npc.pos;
-
-            if (npc.isDying) {
-                float t = Clamp(npc.deathTimer / npc.deathDuration, 0.0f, 1.0f);
-                c.a = (unsigned char)(255.0f * (1.0f - 0.70f * t));
-            }
-
-            if (npc.attackAnimTimer > 0.0f && !npc.isDying) {
-                float t = 1.0f - (npc.attackAnimTimer / npc.attackAnimDuration);
-                t = Clamp(t, 0.0f, 1.0f);
-                float pulse = sinf(t * PI);
-                float push = 6.0f * pulse;
-                drawPos.x += npc.attackAnimDir.x * push;
-                drawPos.y += npc.attackAnimDir.y * push;
-            }
-
-            switch (npc.humanRole) {
-                case NPC::HumanRole::CIVILIAN:
-                    DrawCircleV(drawPos, size, c);
-                    break;
-                case NPC::HumanRole::WARRIOR:
-                    DrawRectangle(drawPos.x-size, drawPos.y-size, size*2, size*2, c);
-                    break;
-                case NPC::HumanRole::BANDIT: {
-                    Color banditCol = Color{160,80,200,255};
-                    if (npc.isDying) {
-                        float t = Clamp(npc.deathTimer / npc.deathDuration, 0.0f, 1.0f);
-                        banditCol.a = (unsigned char)(255.0f * (1.0f - 0.70f * t));
-                    }
-                    DrawTriangle(
-                            {drawPos.x, drawPos.y + CELL_SIZE*0.7f},
-                            {drawPos.x + CELL_SIZE*0.7f, drawPos.y - CELL_SIZE*0.7f},
-                            {drawPos.x - CELL_SIZE*0.7f, drawPos.y - CELL_SIZE*0.7f},
-                            banditCol);
-                    break;
-                }
-                default:
-                    break;
-            }
-            continue;
-        }
-
-        Rectangle src{ 0.0f, 0.0f, (float)tex->width, (float)tex->height };
-
-        Rectangle drawDst = dst;
-        Color tint = WHITE;
-
-        if (npc.isDying) {
-            float t = Clamp(npc.deathTimer / npc.deathDuration, 0.0f, 1.0f);
-
-            drawDst.y += floorf(10.0f * t);
-            drawDst.x -= floorf(w * 0.06f * t);
-            drawDst.width = w * (1.0f + 0.12f * t);
-            drawDst.height = h * (1.0f - 0.55f * t);
-
-            tint.a = (unsigned char)(255.0f * (1.0f - 0.70f * t));
-        }
-
-        if (npc.attackAnimTimer > 0.0f && !npc.isDying) {
-            float t = 1.0f - (npc.attackAnimTimer / npc.attackAnimDuration);
-            t = Clamp(t, 0.0f, 1.0f);
-            float pulse = sinf(t * PI);
-
-            float push = 6.0f * pulse;
-            drawDst.x += npc.attackAnimDir.x * push;
-            drawDst.y += npc.attackAnimDir.y * push;
-
-            drawDst.x -= (drawDst.width * 0.04f * pulse);
-            drawDst.width *= (1.0f + 0.08f * pulse);
-            drawDst.height *= (1.0f - 0.06f * pulse);
-        }
-
-        DrawTexturePro(*tex, src, drawDst, Vector2{0,0}, 0.0f, tint);
-        if (npc.humanRole == NPC::HumanRole::CAPTAIN && npc.id == selectedCaptainId) {
-            DrawCircleLines((int)npc.pos.x, (int)npc.pos.y, CELL_SIZE * 1.3f, YELLOW);
-            DrawCircleLines((int)npc.pos.x, (int)npc.pos.y, CELL_SIZE * 1.3f + 1.0f, BLACK);
-        }
-
-        // Draw a settlement marker above the NPC
-        if (npc.settlementId != -1) {
-            Color sc = GetSafeSettlementColor(*this, npc.settlementId);
-            sc.a = 255;
-
-            Vector2 c = {
-                    (float)((int)npc.pos.x),
-                    (float)((int)(npc.pos.y - h - 8.0f))
-            };
-
-            const int r = 3;
-            DrawDiamondSolid(c, r, sc);
-            DrawDiamondOutline(c, r, BLACK);
-        }
-    }
-
-    // Draw campfires
-    int f = fireFrame;
-    if (f < 0 || f >= FIRE_FRAMES) f = 0;
-
-    for (const auto& s : settlements) {
-        if (!s.alive) continue;
-        if (!fireLoaded[f] || fireTex[f].id == 0) continue;
-
-        float w = (float)CELL_SIZE * 4.0f;
-        float h = (float)CELL_SIZE * 4.0f;
-
-        Rectangle src{0,0,(float)fireTex[f].width,(float)fireTex[f].height};
-        Rectangle dst{
-                floorf(s.campfirePosPx.x - w*0.5f),
-                floorf(s.campfirePosPx.y - h*0.5f),
-                w, h
-        };
-
-
-        DrawTexturePro(fireTex[f], src, dst, {0,0}, 0.0f, WHITE);
-    }
-
-    DrawMeteors();
-}
@@ -0,0 +1,132 @@
+#include "environment/world.h"
+#include "terrain/blob.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+// File layout: a fixed header naming what was generated, then the terrain,
+// route graph, land regions, plants, animals and the RNG state that
+// GenerateNature left behind
+namespace {
+
+constexpr uint32_t CACHE_MAGIC = 0x43574257; // "WBWC"
+
+struct CacheHeader {
+    uint32_t magic = CACHE_MAGIC;
+    uint32_t version = World::GENERATOR_VERSION;
+    uint32_t seed = 0;
+    int32_t worldW = 0;
+    int32_t worldH = 0;
+    // Guards against a Tile layout change made without a version bump
+    uint32_t tileBytes = (uint32_t)sizeof(Tile);
+};
+
+bool SameHeader(const CacheHeader& a, const CacheHeader& b) {
+    return a.magic == b.magic && a.version == b.version && a.seed == b.seed &&
+           a.worldW == b.worldW && a.worldH == b.worldH && a.tileBytes == b.tileBytes;
+}
+
+// Deletes all but the `keep` most recently used world files in dir. Loads
+// touch their file, so write times order the files by last use.
+void PruneCacheDir(const std::filesystem::path& dir, size_t keep) {
+    std::error_code ec;
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(dir, ec)) {
+        const std::filesystem::path& p = entry.path();
+        if (p.extension() != ".bin" || p.filename().string().rfind("world_", 0) != 0) continue;
+        std::filesystem::file_time_type written = entry.last_write_time(ec);
+        if (!ec) files.emplace_back(written, p);
+    }
+    if (files.size() <= keep) return;
+    std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (size_t i = keep; i < files.size(); i++) std::filesystem::remove(files[i].second, ec);
+}
+
+} // namespace
+
+std::string World::GeneratedCachePath() const {
+    char name[96];
+    std::snprintf(name, sizeof(name), "world_%u_%dx%d_v%u.bin", worldSeed, worldW, worldH, GENERATOR_VERSION);
+    return (std::filesystem::path(generatedCacheDir) / name).string();
+}
+
+bool World::SaveGeneratedWorld(const std::string& path) const {
+    CacheHeader header;
+    header.seed = worldSeed;
+    header.worldW = worldW;
+    header.worldH = worldH;
+
+    BlobWriter out;
+    out.put(header);
+    terrain.save(out);
+    pathfinder.save(out);
+    landRegions.save(out);
+    out.put((uint64_t)plants.size());
+    for (const Plant& p : plants) p.save(out);
+    out.put((uint64_t)animals.size());
+    for (const std::unique_ptr<Animal>& a : animals) a->save(out);
+    out.put(rng);
+
+    // Written aside and renamed, so a reader never sees half a file
+    std::error_code ec;
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path(), ec);
+    std::string tmp = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool written = std::fwrite(out.data().data(), 1, out.data().size(), f) == out.data().size();
+    written = (std::fclose(f) == 0) && written;
+    if (written) std::filesystem::rename(tmp, target, ec);
+    if (!written || ec) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    PruneCacheDir(target.has_parent_path() ? target.parent_path() : std::filesystem::path("."), generatedCacheLimit);
+    return true;
+}
+
+bool World::LoadGeneratedWorld(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+    BlobReader in(file.data(), file.size());
+
+    CacheHeader expected;
+    expected.seed = worldSeed;
+    expected.worldW = worldW;
+    expected.worldH = worldH;
+    CacheHeader header;
+    if (!in.get(header) || !SameHeader(header, expected)) return false;
+
+    if (!terrain.load(in) || !pathfinder.load(in, terrain) || !landRegions.load(in, terrain)) return false;
+
+    std::vector<Plant> loadedPlants;
+    std::vector<std::unique_ptr<Animal>> loadedAnimals;
+    Rng unused;
+    uint64_t count = 0;
+    if (!in.get(count) || count > in.remaining()) return false;
+    loadedPlants.reserve((size_t)count);
+    for (uint64_t i = 0; i < count; i++) {
+        loadedPlants.emplace_back(Vector2{ 0.0f, 0.0f }, 0.0f, unused);
+        if (!loadedPlants.back().load(in)) return false;
+    }
+    if (!in.get(count) || count > in.remaining()) return false;
+    loadedAnimals.reserve((size_t)count);
+    for (uint64_t i = 0; i < count; i++) {
+        loadedAnimals.push_back(std::make_unique<Animal>(Vector2{ 0.0f, 0.0f }, unused));
+        if (!loadedAnimals.back()->load(in)) return false;
+    }
+    Rng loadedRng;
+    if (!in.get(loadedRng) || in.remaining() != 0) return false;
+
+    plants = std::move(loadedPlants);
+    plantsRevision++;
+    animals = std::move(loadedAnimals);
+    rng = loadedRng;
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+    return true;
+}
@@ -0,0 +1,291 @@
+#include "environment/world_snapshot.h"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <utility>
+
+#include "environment/world.h"
+#include "terrain/terrain_shading.h"
+
+int PointBuckets::BucketOf(Vector2 p) const {
+    int bx = std::clamp((int)(p.x / bucketPx), 0, bucketsX - 1);
+    int by = std::clamp((int)(p.y / bucketPx), 0, bucketsY - 1);
+    return by * bucketsX + bx;
+}
+
+void PointBuckets::Query(Rectangle rect, std::vector<int>& out) const {
+    out.clear();
+    if (bucketsX <= 0 || bucketsY <= 0) return;
+    int bx0 = std::clamp((int)std::floor(rect.x / bucketPx), 0, bucketsX - 1);
+    int by0 = std::clamp((int)std::floor(rect.y / bucketPx), 0, bucketsY - 1);
+    int bx1 = std::clamp((int)std::floor((rect.x + rect.width) / bucketPx), 0, bucketsX - 1);
+    int by1 = std::clamp((int)std::floor((rect.y + rect.height) / bucketPx), 0, bucketsY - 1);
+    for (int by = by0; by <= by1; by++) {
+        for (int bx = bx0; bx <= bx1; bx++) {
+            int b = by * bucketsX + bx;
+            out.insert(out.end(), items.begin() + start[b], items.begin() + start[b + 1]);
+        }
+    }
+    std::sort(out.begin(), out.end());
+}
+
+bool TileLayerSnapshot::ChangesSince(uint64_t have, std::vector<TileRect>& out) const {
+    out.clear();
+    if (have == revision) return true;
+    if (have > revision || changes.empty() || changes.front().revision > have + 1) return false;
+    for (const Change& c : changes) {
+        if (c.revision > have) out.push_back(c.rect);
+    }
+    return true;
+}
+
+void TileLayerSnapshot::CopyFrom(const TileLayerSnapshot& source) {
+    if (revision == source.revision && width == source.width && height == source.height) return;
+
+    std::vector<TileRect> rects;
+    if (width != source.width || height != source.height || !source.ChangesSince(revision, rects)) {
+        width = source.width;
+        height = source.height;
+        pixels = source.pixels;
+    } else {
+        for (const TileRect& r : rects) {
+            for (int y = r.y; y < r.y + r.h; y++) {
+                const Color* row = &source.pixels[(size_t)y * width + r.x];
+                std::copy(row, row + r.w, &pixels[(size_t)y * width + r.x]);
+            }
+        }
+    }
+    revision = source.revision;
+    changes = source.changes;
+}
+
+void BakeTerritoryColors(const World& world, TileRect rect, Color* out) {
+    for (int y = 0; y < rect.h; y++) {
+        const int* owners = &world.tileOwner[(size_t)(rect.y + y) * world.cols + rect.x];
+        Color* row = out + (size_t)y * rect.w;
+        for (int x = 0; x < rect.w; x++) {
+            int owner = owners[x];
+            bool drawn = owner >= 0 && owner < (int)world.settlements.size() && world.settlements[owner].alive;
+            if (!drawn) {
+                row[x] = BLANK;
+                continue;
+            }
+            // Fade(color, 0.25f), spelled out: the simulation does not link raylib
+            const Color& c = world.settlements[owner].color;
+            row[x] = Color{ c.r, c.g, c.b, (unsigned char)(255.0f * 0.25f) };
+        }
+    }
+}
+
+namespace {
+
+// Copies a baked rect into the layer and logs it as a change
+void StoreRect(TileLayerSnapshot& layer, TileRect r, const Color* baked) {
+    for (int y = 0; y < r.h; y++) {
+        std::copy(baked + (size_t)y * r.w, baked + (size_t)(y + 1) * r.w,
+                  &layer.pixels[(size_t)(r.y + y) * layer.width + r.x]);
+    }
+    layer.revision++;
+    layer.changes.push_back({ layer.revision, r });
+    if (layer.changes.size() > TileLayerSnapshot::MAX_CHANGES) layer.changes.erase(layer.changes.begin());
+}
+
+// Re-bakes the layer's dirty rects, or all of it after a size change, and
+// logs each as a change
+template <typename Bake>
+void SyncLayer(TileLayerSnapshot& layer, int width, int height, std::vector<TileRect>& dirty,
+               std::vector<Color>& scratch, Bake bake) {
+    if (layer.width != width || layer.height != height) {
+        layer.width = width;
+        layer.height = height;
+        layer.pixels.resize((size_t)width * height);
+        bake(TileRect{ 0, 0, width, height }, layer.pixels.data());
+        layer.revision++;
+        layer.changes.clear();
+        dirty.clear();
+        return;
+    }
+
+    for (const TileRect& r : dirty) {
+        if (r.w <= 0 || r.h <= 0) continue;
+        scratch.resize((size_t)r.w * r.h);
+        bake(r, scratch.data());
+        StoreRect(layer, r, scratch.data());
+    }
+    dirty.clear();
+}
+
+} // namespace
+
+void WorldSnapshotWriter::SyncTerrain(World& world) {
+    const Terrain& t = world.terrain;
+    const int width = t.getWidth();
+    const int height = t.getHeight();
+    const int chunksX = (width + Terrain::CHUNK_MASK) >> Terrain::CHUNK_SHIFT;
+    const int chunksY = (height + Terrain::CHUNK_MASK) >> Terrain::CHUNK_SHIFT;
+
+    // A new map, or Init marking all of it dirty, starts over from blank
+    bool fresh = terrain.width != width || terrain.height != height;
+    for (const TileRect& r : world.terrainDirty) {
+        if (r.x <= 0 && r.y <= 0 && r.x + r.w >= width && r.y + r.h >= height) fresh = true;
+    }
+    if (fresh) {
+        terrain.width = width;
+        terrain.height = height;
+        terrain.pixels.assign((size_t)width * height, BLANK);
+        terrain.changes.clear();
+        terrainBaked.assign((size_t)chunksX * chunksY, 0);
+        world.terrainDirty.clear();
+    }
+
+    auto bake = [&](TileRect r) {
+        scratch.resize((size_t)r.w * r.h);
+        BakeTerrainColors(t, r, scratch.data());
+        if (!fresh) {
+            StoreRect(terrain, r, scratch.data());
+            return;
+        }
+        for (int y = 0; y < r.h; y++) {
+            std::copy(&scratch[(size_t)y * r.w], &scratch[(size_t)(y + 1) * r.w],
+                      &terrain.pixels[(size_t)(r.y + y) * width + r.x]);
+        }
+    };
+
+    // Dirty rects over baked, resident chunks are re-baked as is. Otherwise
+    // their chunks are re-baked whole by the pass below, now or once loaded.
+    for (const TileRect& r : world.terrainDirty) {
+        if (r.w <= 0 || r.h <= 0) continue;
+        int cx0 = r.x >> Terrain::CHUNK_SHIFT, cx1 = (r.x + r.w - 1) >> Terrain::CHUNK_SHIFT;
+        int cy0 = r.y >> Terrain::CHUNK_SHIFT, cy1 = (r.y + r.h - 1) >> Terrain::CHUNK_SHIFT;
+        bool ready = true;
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                if (!terrainBaked[cy * chunksX + cx] || !t.isChunkResident(cx, cy)) ready = false;
+            }
+        }
+        if (ready) {
+            bake(r);
+            continue;
+        }
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) terrainBaked[cy * chunksX + cx] = 0;
+        }
+    }
+    world.terrainDirty.clear();
+
+    for (int cy = 0; cy < chunksY; cy++) {
+        for (int cx = 0; cx < chunksX; cx++) {
+            int ci = cy * chunksX + cx;
+            if (terrainBaked[ci] || !t.isChunkResident(cx, cy)) continue;
+            int x = cx << Terrain::CHUNK_SHIFT;
+            int y = cy << Terrain::CHUNK_SHIFT;
+            bake(TileRect{ x, y, std::min(Terrain::CHUNK_SIZE, width - x), std::min(Terrain::CHUNK_SIZE, height - y) });
+            terrainBaked[ci] = 1;
+        }
+    }
+    if (fresh) terrain.revision++;
+}
+
+void WorldSnapshotWriter::SyncTerritory(World& world) {
+    if ((int)world.tileOwner.size() != world.cols * world.rows) return;
+    SyncLayer(territory, world.cols, world.rows, world.territoryDirty, scratch,
+              [&](TileRect r, Color* out) { BakeTerritoryColors(world, r, out); });
+}
+
+void WorldSnapshotWriter::Capture(World& world, WorldSnapshot& out, const Vector2* previewPos) {
+    out.tick = world.tickCount;
+    out.worldW = world.worldW;
+    out.worldH = world.worldH;
+
+    out.npcs.clear();
+    for (ConstNpcRef npc : world.npcs) {
+        if (!npc.alive && !npc.isDying) continue;
+        NpcSnapshot n{};
+        n.pos = npc.pos;
+        n.attackDir = npc.cold.attackAnimDir;
+        n.id = npc.id;
+        n.settlementId = npc.settlementId;
+        n.role = (uint8_t)npc.humanRole;
+        n.variant = (uint8_t)(npc.cold.skinId % World::NPC_VARIANTS);
+        n.dying = npc.isDying ? 1 : 0;
+        n.deathT = npc.isDying ? std::clamp(npc.cold.deathTimer / npc.cold.deathDuration, 0.0f, 1.0f) : 0.0f;
+        n.attackT = (npc.cold.attackAnimTimer > 0.0f && !npc.isDying)
+                ? std::clamp(1.0f - npc.cold.attackAnimTimer / npc.cold.attackAnimDuration, 0.0f, 1.0f)
+                : -1.0f;
+        out.npcs.push_back(n);
+    }
+    out.npcBuckets.Build((int)out.npcs.size(), (float)world.worldW, (float)world.worldH,
+                         [&](int i) { return out.npcs[i].pos; });
+
+    out.plants.resize(world.plants.size());
+    for (size_t i = 0; i < world.plants.size(); i++) {
+        const Plant& p = world.plants[i];
+        out.plants[i] = { p.position, p.growthStage, p.color, (uint8_t)p.type };
+    }
+    out.plantsRevision = world.plantsRevision;
+
+    out.animals.clear();
+    for (const auto& animal : world.animals) {
+        if (!animal->alive) continue;
+        out.animals.push_back({ animal->position, (uint8_t)(animal->velocity.x < 0 ? 1 : 0) });
+    }
+
+    out.settlements.resize(world.settlements.size());
+    out.barracks.clear();
+    for (size_t i = 0; i < world.settlements.size(); i++) {
+        const Settlement& s = world.settlements[i];
+        SettlementSnapshot& o = out.settlements[i];
+        o.boundsPx = s.boundsPx;
+        o.centerPx = s.centerPx;
+        o.campfirePosPx = s.campfirePosPx;
+        o.color = s.color;
+        o.warTargetSettlementId = s.warTargetSettlementId;
+        o.alive = s.alive;
+        o.warActive = s.warActive;
+        o.offensiveWaveReady = s.offensiveWaveReady;
+        o.defensiveMobilization = s.defensiveMobilization;
+        o.firstBarracks = (int32_t)out.barracks.size();
+        for (const Barracks& b : s.barracksList) {
+            if (!b.alive) continue;
+            float hpRatio = b.maxHp > 0.0f ? std::clamp(b.hp / b.maxHp, 0.0f, 1.0f) : -1.0f;
+            out.barracks.push_back({ b.posPx, hpRatio });
+        }
+        o.barracksCount = (int32_t)out.barracks.size() - o.firstBarracks;
+    }
+
+    out.meteors.clear();
+    for (const Meteor& m : world.meteors) {
+        float pulse = m.state == Meteor::EXPLODING ? 1.0f - (m.explosionTimer / m.explosionDuration) : 0.0f;
+        out.meteors.push_back({ m.pos, m.targetPos, m.radius, pulse, (uint8_t)m.state });
+    }
+
+    SyncTerrain(world);
+    SyncTerritory(world);
+    out.terrain.CopyFrom(terrain);
+    out.territory.CopyFrom(territory);
+
+    out.selectedCaptainId = 0;
+    out.selectedCaptainMode = WorldSnapshot::CaptainMode::AUTO;
+    out.selectedCaptainSquad = 0;
+    if (world.selectedCaptainId != 0) {
+        std::optional<ConstNpcRef> cap = std::as_const(world).FindNpcById(world.selectedCaptainId);
+        if (cap && cap->humanRole == NPC::HumanRole::CAPTAIN) {
+            out.selectedCaptainId = cap->id;
+            if (cap->captain.captainHasAttackOrder) {
+                out.selectedCaptainMode = WorldSnapshot::CaptainMode::MANUAL_ATTACK;
+            } else if (!cap->captain.captainAutoMode && cap->captain.captainHasMoveOrder) {
+                out.selectedCaptainMode = WorldSnapshot::CaptainMode::MANUAL_MOVE;
+            } else if (!cap->captain.captainAutoMode) {
+                out.selectedCaptainMode = WorldSnapshot::CaptainMode::MANUAL_IDLE;
+            }
+            for (ConstNpcRef n : world.npcs) {
+                if (n.alive && n.humanRole == NPC::HumanRole::WARRIOR && n.squad.leaderCaptainId == cap->id) {
+                    out.selectedCaptainSquad++;
+                }
+            }
+        }
+    }
+    out.armageddonMode = world.armageddonMode;
+    out.barracksPreviewOk = previewPos && world.CanBuildBarracksAt(*previewPos);
+}
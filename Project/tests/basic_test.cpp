@@ -12,6 +12,127 @@ TEST(TerrainTest, InitWithParamsDoesNotCrash) {
     terrain.generate();
 }
 
+TEST(TerrainTest, GenerateIndependentOfThreadCount) {
+    Terrain serial(150, 90, 1337);
+    serial.generate(1);
+    Terrain parallel(150, 90, 1337);
+    parallel.generate(4);
+
+    for (int y = 0; y < 90; y++) {
+        for (int x = 0; x < 150; x++) {
+            ASSERT_EQ(serial.getTile(x, y).getElevation(), parallel.getTile(x, y).getElevation());
+            ASSERT_EQ(serial.getTile(x, y).biomeIndex, parallel.getTile(x, y).biomeIndex);
+        }
+    }
+}
+
+// Chunks generated on first touch match a whole-map generate
+TEST(TerrainTest, LazyChunksMatchEagerGeneration) {
+    Terrain eager(150, 90, 1337);
+    eager.generate();
+    Terrain lazy(150, 90, 1337);
+    EXPECT_EQ(lazy.getChunkStats().resident, 0u);
+
+    for (int y = 89; y >= 0; y--) {
+        for (int x = 149; x >= 0; x--) {
+            ASSERT_EQ(eager.getTile(x, y).getElevation(), lazy.getTile(x, y).getElevation());
+            ASSERT_EQ(eager.getTile(x, y).biomeIndex, lazy.getTile(x, y).biomeIndex);
+            ASSERT_EQ(eager.isPassable(x, y), lazy.isPassable(x, y));
+        }
+    }
+    EXPECT_EQ(lazy.getChunkStats().resident, 3u * 2u);
+}
+
+// Evicted chunks come back with their edits, through the disk cache
+TEST(TerrainTest, EvictedChunksKeepEdits) {
+    Terrain terrain(256, 64, 7);
+    terrain.setResidentChunkBudget(1);
+
+    Tile lava = terrain.getTile(10, 10);
+    lava.biomeIndex = 0;
+    lava.setElevation(0.123f);
+    terrain.setTile(10, 10, lava);
+    float untouched = terrain.getTile(130, 10).getElevation();
+
+    // Touch only the last chunk, then let a tick pass so the rest are cold
+    terrain.trimResident();
+    terrain.getTile(250, 5);
+    terrain.trimResident();
+
+    Terrain::ChunkStats stats = terrain.getChunkStats();
+    EXPECT_EQ(stats.resident, 1u);
+    EXPECT_EQ(stats.evicted, 2u);
+    EXPECT_EQ(stats.writtenToDisk, 1u);
+
+    EXPECT_EQ(terrain.getTile(10, 10).biomeIndex, 0);
+    EXPECT_EQ(terrain.getTile(10, 10).getElevation(), lava.getElevation());
+    EXPECT_FALSE(terrain.isPassable(10, 10));
+    EXPECT_EQ(terrain.getTile(130, 10).getElevation(), untouched);
+    EXPECT_EQ(terrain.getChunkStats().loadedFromDisk, 1u);
+}
+
+// A chunk read back from the cache is not rewritten on its next eviction,
+// and its slot still holds the edit for the reload after that
+TEST(TerrainTest, EditsSurviveRepeatedEviction) {
+    Terrain terrain(128, 64, 11);
+    terrain.setResidentChunkBudget(1);
+
+    Tile edited = terrain.getTile(3, 3);
+    edited.biomeIndex = 0;
+    edited.setElevation(0.456f);
+    terrain.setTile(3, 3, edited);
+
+    for (int round = 0; round < 3; round++) {
+        terrain.trimResident();
+        terrain.getTile(100, 3);
+        terrain.trimResident();
+        EXPECT_EQ(terrain.getChunkStats().resident, 1u);
+
+        EXPECT_EQ(terrain.getTile(3, 3).biomeIndex, 0);
+        EXPECT_EQ(terrain.getTile(3, 3).getElevation(), edited.getElevation());
+        EXPECT_FALSE(terrain.isPassable(3, 3));
+    }
+    EXPECT_EQ(terrain.getChunkStats().writtenToDisk, 1u);
+    EXPECT_EQ(terrain.getChunkStats().loadedFromDisk, 3u);
+}
+
+// The byte grids agree with the biome table, before and after tile edits
+TEST(TerrainTest, DerivedGridsMatchTileProperties) {
+    Terrain terrain(90, 60, 42);
+    terrain.generate();
+
+    auto expectMatches = [&](int x, int y) {
+        float wx = x * 8.0f + 4.0f;
+        float wy = y * 8.0f + 4.0f;
+        const TileProperties* p = terrain.getTilePropertiesAt(wx, wy);
+        ASSERT_NE(p, nullptr);
+        EXPECT_EQ(terrain.canWalk(wx, wy), p->canWalk);
+        EXPECT_EQ(terrain.canBuild(wx, wy), p->canBuild);
+        EXPECT_EQ(terrain.isWaterAt(wx, wy), p->isWater);
+        EXPECT_EQ(terrain.getMoveSpeedAt(wx, wy), p->moveSpeed);
+        EXPECT_EQ(terrain.getDamageAt(wx, wy), p->damage);
+        EXPECT_EQ(terrain.isPassable(x, y), p->canWalk);
+    };
+
+    for (int y = 0; y < 60; y++) {
+        for (int x = 0; x < 90; x++) expectMatches(x, y);
+    }
+
+    Tile water = terrain.getTile(10, 10);
+    water.biomeIndex = 0;
+    terrain.setTile(10, 10, water);
+    EXPECT_FALSE(terrain.canWalk(84.0f, 84.0f));
+    expectMatches(10, 10);
+
+    terrain.getTile(20, 20).biomeIndex = 3;
+    terrain.refreshDerived({ 20, 20, 1, 1 });
+    EXPECT_TRUE(terrain.canBuild(164.0f, 164.0f));
+    expectMatches(20, 20);
+
+    EXPECT_FALSE(terrain.canWalk(-100.0f, 10.0f));
+    EXPECT_EQ(terrain.getMoveSpeedAt(1e6f, 10.0f), 1.0f);
+}
+
 TEST(TerrainTest, GetTileDoesNotCrash) {
     Terrain terrain(100, 100, 42);
     terrain.generate();
@@ -33,6 +154,14 @@ TEST(TerrainTest, GetTilePropertiesDoesNotCrash) {
     (void)props;
 }
 
+TEST(TerrainTest, GetTilePropertiesOfTileWithoutBiome) {
+    Terrain terrain(32, 32, 42);
+    terrain.generate();
+    terrain.getTile(5, 5).biomeIndex = -1;
+    EXPECT_FALSE(terrain.getTileProperties(5, 5).isWater);
+    EXPECT_EQ(terrain.getTileProperties(5, 5).moveSpeed, TileProperties{}.moveSpeed);
+}
+
 TEST(TerrainTest, CanWalkDoesNotCrash) {
     Terrain terrain(100, 100, 42);
     terrain.generate();
@@ -55,7 +184,8 @@ TEST(TerrainTest, IsPassableDoesNotCrash) {
 }
 
 TEST(PlantTest, InitDoesNotCrash) {
-    Plant plant({100.0f, 100.0f});
+    Rng rng(1);
+    Plant plant({100.0f, 100.0f}, 0.5f, rng);
 }
 
 TEST(TileTest, DefaultConstructionDoesNotCrash) {
@@ -63,6 +193,45 @@ TEST(TileTest, DefaultConstructionDoesNotCrash) {
     (void)tile;
 }
 
+TEST(TileTest, PackedFieldsRoundTrip) {
+    EXPECT_LE(sizeof(Tile), 16u);
+
+    Tile tile;
+    EXPECT_EQ(tile.biomeIndex, -1);
+    EXPECT_EQ(tile.getType(), TileType::None);
+    EXPECT_STREQ(tile.getVegetation().yieldName(), "wood");
+    EXPECT_STREQ(tile.getOre().yieldName(), "ore");
+
+    tile.setElevation(0.4321f);
+    tile.setMoisture(0.25f);
+    tile.setTemperature(2.0f);
+    tile.setType(TileType::Lava);
+    tile.setFeature(TerrainFeature::Oasis);
+    EXPECT_NEAR(tile.getElevation(), 0.4321f, 1.0f / 65535.0f);
+    EXPECT_NEAR(tile.getMoisture(), 0.25f, 1.0f / 255.0f);
+    EXPECT_FLOAT_EQ(tile.getTemperature(), 1.0f);
+    EXPECT_EQ(tile.getType(), TileType::Lava);
+    EXPECT_EQ(tile.getFeature(), TerrainFeature::Oasis);
+
+    VegetationData vegetation;
+    vegetation.type = VegetationType::Bamboo;
+    vegetation.isHarvestable = false;
+    vegetation.yieldAmount = 7;
+    tile.setVegetation(vegetation);
+    OreData ore;
+    ore.type = OreType::Copper;
+    ore.amount = 1200;
+    tile.setOre(ore);
+
+    EXPECT_EQ(tile.getVegetation().type, VegetationType::Bamboo);
+    EXPECT_FALSE(tile.getVegetation().isHarvestable);
+    EXPECT_EQ(tile.getVegetation().yieldAmount, 7);
+    EXPECT_EQ(tile.getOre().type, OreType::Copper);
+    EXPECT_EQ(tile.getOre().amount, 1200);
+    EXPECT_TRUE(tile.getOre().isHarvestable);
+    EXPECT_EQ(tile.getType(), TileType::Lava);
+}
+
 TEST(TilePropertiesTest, DefaultConstructionDoesNotCrash) {
     TileProperties props;
     (void)props;
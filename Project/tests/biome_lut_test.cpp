@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "environment/random.h"
+#include "terrain/biome_lut.h"
+#include "terrain/terrain.h"
+
+// Linear scan Terrain::getBiomeIndex used before the table
+static int ReferenceBiomeIndex(const std::vector<Biome>& biomes, float elevation) {
+    for (size_t i = 0; i < biomes.size(); ++i) {
+        if (elevation >= biomes[i].minElevation && elevation <= biomes[i].maxElevation) return (int)i;
+    }
+    return 0;
+}
+
+// Every edge, the floats on either side of it, specials and a uniform sweep
+static void ExpectMatchesScan(const std::vector<Biome>& biomes, const BiomeLut& lut) {
+    const float inf = std::numeric_limits<float>::infinity();
+    std::vector<float> probes = { -inf, inf, std::nanf(""), -1.0f, 0.0f, -0.0f, 1.0f, 2.0f };
+    for (const Biome& b : biomes) {
+        for (float e : { b.minElevation, b.maxElevation }) {
+            probes.push_back(e);
+            probes.push_back(std::nextafter(e, -inf));
+            probes.push_back(std::nextafter(e, inf));
+        }
+    }
+    for (int i = 0; i <= 20000; i++) probes.push_back(-0.25f + 1.5f * (float)i / 20000.0f);
+
+    for (float e : probes) {
+        ASSERT_EQ(lut.lookup(e), ReferenceBiomeIndex(biomes, e)) << "elevation " << e;
+    }
+}
+
+TEST(BiomeLutTest, MatchesScanForTerrainCatalogue) {
+    Terrain terrain(4, 4, 1);
+    BiomeLut lut;
+    lut.build(terrain.getBiomes());
+    ExpectMatchesScan(terrain.getBiomes(), lut);
+}
+
+// Large catalogue with overlapping, nested, empty and inverted bands
+TEST(BiomeLutTest, MatchesScanForLargeOverlappingCatalogue) {
+    Rng rng(77);
+    std::vector<Biome> biomes(300);
+    for (Biome& b : biomes) {
+        b.minElevation = RandomFloat(rng, -0.1f, 1.1f);
+        b.maxElevation = b.minElevation + RandomFloat(rng, -0.05f, 0.2f);
+    }
+    biomes[17].maxElevation = biomes[17].minElevation;
+
+    BiomeLut lut;
+    lut.build(biomes);
+    ExpectMatchesScan(biomes, lut);
+}
+
+TEST(BiomeLutTest, TerrainRebuildsOnNewCatalogue) {
+    Terrain terrain(16, 16, 3);
+    terrain.generate();
+
+    std::vector<Biome> biomes = terrain.getBiomes();
+    std::swap(biomes[0], biomes[1]);
+    terrain.setBiomes(biomes);
+
+    for (float e : { 0.0f, 0.1f, 0.3f, 0.5f, 0.95f }) {
+        EXPECT_EQ(terrain.getBiomeIndex(e, 0.0f, 0.5f), ReferenceBiomeIndex(biomes, e));
+    }
+    EXPECT_EQ(terrain.canWalk(4.0f, 4.0f), biomes[terrain.getTile(0, 0).biomeIndex].props.canWalk);
+}
+
+// Tile::biomeIndex can't address a 129th biome, so the catalogue is refused
+TEST(BiomeLutTest, TerrainRejectsCatalogueBeyondTileIndex) {
+    Terrain terrain(16, 16, 3);
+    terrain.generate();
+    std::vector<Biome> before = terrain.getBiomes();
+
+    terrain.setBiomes(std::vector<Biome>(Terrain::MAX_BIOMES));
+    EXPECT_EQ(terrain.getBiomeCount(), Terrain::MAX_BIOMES);
+
+    terrain.setBiomes(before);
+    EXPECT_THROW(terrain.setBiomes(std::vector<Biome>(Terrain::MAX_BIOMES + 1)), std::length_error);
+    EXPECT_EQ(terrain.getBiomeCount(), (int)before.size());
+}
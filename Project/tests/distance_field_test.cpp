@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include "environment/random.h"
+#include "terrain/distance_field.h"
+
+// The ring search findNearestPassable did before the transform
+static bool RingSearch(const Terrain& terrain, int tx, int ty, int& outX, int& outY, int maxRadius) {
+    for (int r = 1; r <= maxRadius; ++r) {
+        for (int dy = -r; dy <= r; ++dy) {
+            for (int dx = -r; dx <= r; ++dx) {
+                if (std::abs(dx) != r && std::abs(dy) != r) continue;
+                if (terrain.isPassable(tx + dx, ty + dy)) {
+                    outX = tx + dx;
+                    outY = ty + dy;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+static int WaterDistance(const Terrain& terrain, int tx, int ty) {
+    for (int r = 0; r <= DistanceField::RADIUS; ++r) {
+        for (int dy = -r; dy <= r; ++dy) {
+            for (int dx = -r; dx <= r; ++dx) {
+                if (std::abs(dx) != r && std::abs(dy) != r) continue;
+                if (terrain.getTileFlags(tx + dx, ty + dy) & Terrain::TILE_WATER) return r;
+            }
+        }
+    }
+    return DistanceField::RADIUS + 1;
+}
+
+static void ExpectMatchesRingSearch(const Terrain& terrain) {
+    for (int y = 0; y < terrain.getHeight(); y++) {
+        for (int x = 0; x < terrain.getWidth(); x++) {
+            ASSERT_EQ(terrain.getWaterDistance(x, y), WaterDistance(terrain, x, y)) << x << "," << y;
+            for (int radius : { 3, 10, DistanceField::RADIUS }) {
+                int ax = -1, ay = -1, bx = -1, by = -1;
+                bool found = terrain.findNearestPassable(x, y, ax, ay, radius);
+                ASSERT_EQ(found, RingSearch(terrain, x, y, bx, by, radius)) << x << "," << y;
+                ASSERT_EQ(ax, bx) << x << "," << y;
+                ASSERT_EQ(ay, by) << x << "," << y;
+            }
+        }
+    }
+}
+
+// Lookups give the tile the ring search finds first, before and after
+// edits through setTile and refreshDerived
+TEST(DistanceFieldTest, MatchesRingSearchAcrossEdits) {
+    Terrain terrain(160, 120, 1337);
+    terrain.generate();
+    ExpectMatchesRingSearch(terrain);
+
+    Rng rng(9);
+    for (int k = 0; k < 8; k++) {
+        int cx = RandomInt(rng, 0, 159);
+        int cy = RandomInt(rng, 0, 119);
+        int biome = (k % 2) ? 0 : 3;
+        if (k < 4) {
+            for (int y = cy - 5; y <= cy + 5; y++) {
+                for (int x = cx - 5; x <= cx + 5; x++) {
+                    Tile tile = terrain.getTile(x, y);
+                    tile.biomeIndex = (int8_t)biome;
+                    terrain.setTile(x, y, tile);
+                }
+            }
+        } else {
+            for (int y = cy - 5; y <= cy + 5; y++) {
+                for (int x = cx - 5; x <= cx + 5; x++) terrain.getTile(x, y).biomeIndex = (int8_t)biome;
+            }
+            terrain.refreshDerived({ cx - 5, cy - 5, 11, 11 });
+        }
+    }
+    ExpectMatchesRingSearch(terrain);
+}
+
+// A saved field loads back only onto a map of its size, and a seed
+// pointing off the map rejects the whole file
+TEST(DistanceFieldTest, LoadRejectsOutOfRangeSeeds) {
+    Terrain terrain(64, 48, 1337);
+    terrain.generate();
+    DistanceField field;
+    field.build(terrain);
+    BlobWriter out;
+    field.save(out);
+    std::vector<uint8_t> bytes = out.data();
+
+    DistanceField loaded;
+    BlobReader good(bytes.data(), bytes.size());
+    EXPECT_TRUE(loaded.load(good, terrain));
+
+    Terrain other(48, 64, 1337);
+    BlobReader resized(bytes.data(), bytes.size());
+    EXPECT_FALSE(loaded.load(resized, other));
+
+    // width, height, then the passable seeds' count; tile (0, 0) steps left
+    bytes[2 * sizeof(int) + sizeof(uint64_t)] = (uint8_t)-1;
+    BlobReader damaged(bytes.data(), bytes.size());
+    EXPECT_FALSE(loaded.load(damaged, terrain));
+}
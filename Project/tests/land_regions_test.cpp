@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include "environment/random.h"
+#include "terrain/land_regions.h"
+
+static const int DEEP_WATER = 0;
+static const int PLAINS = 3;
+
+static void Paint(Terrain& terrain, int x, int y, int biome) {
+    Tile tile = terrain.getTile(x, y);
+    tile.biomeIndex = (int8_t)biome;
+    terrain.setTile(x, y, tile);
+}
+
+static Vector2 TileCentre(int x, int y) {
+    return { (x + 0.5f) * Terrain::TILE_PX, (y + 0.5f) * Terrain::TILE_PX };
+}
+
+// Walls split the land; opening and closing a gap in one merges and
+// splits its regions again while the far side keeps its label
+TEST(LandRegionsTest, WallSplitsAndGapsMerge) {
+    Terrain terrain(128, 48, 1);
+    for (int y = 0; y < 48; y++) {
+        for (int x = 0; x < 128; x++) Paint(terrain, x, y, (x == 30 || x == 40) ? DEEP_WATER : PLAINS);
+    }
+
+    LandRegions regions;
+    regions.build(terrain);
+    EXPECT_EQ(regions.regionCount(), 3u);
+    EXPECT_FALSE(regions.sameRegion(TileCentre(5, 5), TileCentre(35, 5)));
+    EXPECT_TRUE(regions.sameRegion(TileCentre(5, 5), TileCentre(29, 47)));
+    EXPECT_FALSE(regions.sameRegion(TileCentre(30, 5), TileCentre(30, 5)));
+    EXPECT_EQ(regions.regionSize(regions.regionAt(5, 5)), 30 * 48);
+    int farSide = regions.regionAt(100, 5);
+
+    Paint(terrain, 30, 20, PLAINS);
+    regions.update(terrain, { 30, 20, 1, 1 });
+    EXPECT_EQ(regions.regionCount(), 2u);
+    EXPECT_TRUE(regions.sameRegion(TileCentre(5, 5), TileCentre(35, 5)));
+    EXPECT_EQ(regions.regionSize(regions.regionAt(5, 5)), 39 * 48 + 1);
+
+    Paint(terrain, 30, 20, DEEP_WATER);
+    regions.update(terrain, { 30, 20, 1, 1 });
+    EXPECT_EQ(regions.regionCount(), 3u);
+    EXPECT_FALSE(regions.sameRegion(TileCentre(5, 5), TileCentre(35, 5)));
+    EXPECT_EQ(regions.regionAt(100, 5), farSide);
+}
+
+// Updating after each edit agrees with labelling the edited map from scratch
+TEST(LandRegionsTest, UpdateMatchesFullBuild) {
+    Terrain terrain(150, 100, 1337);
+    terrain.generate();
+    LandRegions incremental;
+    incremental.build(terrain);
+
+    Rng rng(5);
+    for (int k = 0; k < 12; k++) {
+        int cx = RandomInt(rng, 0, 149);
+        int cy = RandomInt(rng, 0, 99);
+        for (int y = cy - 4; y <= cy + 4; y++) {
+            for (int x = cx - 4; x <= cx + 4; x++) {
+                if (x >= 0 && x < 150 && y >= 0 && y < 100) Paint(terrain, x, y, (k % 3) ? DEEP_WATER : PLAINS);
+            }
+        }
+        incremental.update(terrain, { cx - 4, cy - 4, 9, 9 });
+    }
+
+    LandRegions full;
+    full.build(terrain);
+    EXPECT_EQ(incremental.regionCount(), full.regionCount());
+    for (int q = 0; q < 2000; q++) {
+        Vector2 a = TileCentre(RandomInt(rng, 0, 149), RandomInt(rng, 0, 99));
+        Vector2 b = TileCentre(RandomInt(rng, 0, 149), RandomInt(rng, 0, 99));
+        ASSERT_EQ(incremental.sameRegion(a, b), full.sameRegion(a, b));
+        ASSERT_EQ(incremental.regionSize(incremental.regionAtPx(a)), full.regionSize(full.regionAtPx(a)));
+    }
+}
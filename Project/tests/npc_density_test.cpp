@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "environment/npc_density.h"
+#include "environment/worker_pool.h"
+
+// Two settlements and a scatter of NPCs, some unsettled and some off the view
+static WorldSnapshot MakeCrowd(int count) {
+    WorldSnapshot s;
+    s.worldW = 1024;
+    s.worldH = 512;
+    s.settlements.resize(2);
+    s.settlements[0].alive = 1;
+    s.settlements[0].color = { 200, 40, 40, 255 };
+    s.settlements[1].alive = 0;
+    s.settlements[1].color = { 40, 40, 200, 255 };
+    for (int i = 0; i < count; i++) {
+        NpcSnapshot n{};
+        n.pos = { (float)((i * 37) % 1100), (float)((i * 91) % 520) };
+        n.settlementId = (i % 3) - 1;
+        s.npcs.push_back(n);
+    }
+    return s;
+}
+
+TEST(NpcDensityTest, CountsAndColoursPerCell) {
+    WorldSnapshot s = MakeCrowd(300);
+    std::vector<int> all(s.npcs.size());
+    for (int i = 0; i < (int)all.size(); i++) all[i] = i;
+
+    NpcDensityGrid grid;
+    Rectangle view = { 100.0f, 50.0f, 600.0f, 300.0f };
+    grid.Build(s, all, view, 32);
+    EXPECT_EQ(grid.originX, 3);
+    EXPECT_EQ(grid.originY, 1);
+
+    // Brute force: each NPC inside the grid lands in exactly one cell
+    uint32_t inside = 0, total = 0, red = 0;
+    for (const NpcSnapshot& n : s.npcs) {
+        int cx = (int)(n.pos.x / 32) - grid.originX;
+        int cy = (int)(n.pos.y / 32) - grid.originY;
+        if (cx < 0 || cx >= grid.width || cy < 0 || cy >= grid.height) continue;
+        inside++;
+        // Only settlement 0 is alive; the rest count as light grey
+        red += n.settlementId == 0 ? 200 : 220;
+    }
+    uint32_t redSum = 0;
+    for (int y = 0; y < grid.height; y++) {
+        for (int x = 0; x < grid.width; x++) {
+            total += grid.At(x, y).count;
+            redSum += grid.At(x, y).r;
+        }
+    }
+    EXPECT_GT(inside, 0u);
+    EXPECT_LT(inside, (uint32_t)s.npcs.size());
+    EXPECT_EQ(total, inside);
+    EXPECT_EQ(redSum, red);
+}
+
+// Chunks counted on a pool sum to the same grid as one serial pass
+TEST(NpcDensityTest, ParallelMatchesSerial) {
+    WorldSnapshot s = MakeCrowd(20000);
+    std::vector<int> all(s.npcs.size());
+    for (int i = 0; i < (int)all.size(); i++) all[i] = i;
+    Rectangle view = { 0.0f, 0.0f, 1024.0f, 512.0f };
+
+    NpcDensityGrid serial;
+    serial.Build(s, all, view, 16);
+    for (int threads : { 2, 4 }) {
+        WorkerPool pool(threads);
+        NpcDensityGrid parallel;
+        parallel.Build(s, all, view, 16, &pool);
+        ASSERT_EQ(parallel.cells.size(), serial.cells.size());
+        for (size_t i = 0; i < serial.cells.size(); i++) {
+            ASSERT_EQ(parallel.cells[i].count, serial.cells[i].count) << "cell " << i;
+            ASSERT_EQ(parallel.cells[i].g, serial.cells[i].g) << "cell " << i;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include "npc/npc_store.h"
+
+static NpcStore MakeStore(int count, std::vector<uint32_t>& ids) {
+    NpcStore npcs;
+    ids.clear();
+    for (int i = 0; i < count; i++) {
+        NPC npc;
+        npc.id = npcs.AllocateId();
+        npc.pos = { (float)i, 0.0f };
+        npcs.push_back(npc);
+        ids.push_back(npc.id);
+    }
+    return npcs;
+}
+
+// Ids keep resolving to the same NPC after RemoveIf shifts it down
+TEST(NpcStoreTest, IdsFollowCompaction) {
+    std::vector<uint32_t> ids;
+    NpcStore npcs = MakeStore(100, ids);
+
+    npcs.RemoveIf([](ConstNpcRef n) { return (int)n.pos.x % 3 == 0; });
+
+    for (int i = 0; i < 100; i++) {
+        int index = npcs.IndexOf(ids[i]);
+        if (i % 3 == 0) {
+            EXPECT_EQ(index, -1);
+        } else {
+            ASSERT_GE(index, 0);
+            EXPECT_EQ(npcs.Pos(index).x, (float)i);
+            EXPECT_EQ(npcs.Id(index), ids[i]);
+        }
+    }
+    EXPECT_EQ(npcs.IndexOf(0), -1);
+}
+
+// A recycled slot gets a new generation, so the old id stays dead
+TEST(NpcStoreTest, StaleIdDoesNotMatchRecycledSlot) {
+    std::vector<uint32_t> ids;
+    NpcStore npcs = MakeStore(4, ids);
+
+    npcs.RemoveIf([&](ConstNpcRef n) { return n.id == ids[1]; });
+
+    NPC npc;
+    npc.id = npcs.AllocateId();
+    npc.pos = { 50.0f, 0.0f };
+    npcs.push_back(npc);
+
+    EXPECT_EQ(npc.id & NpcStore::ID_SLOT_MASK, ids[1] & NpcStore::ID_SLOT_MASK);
+    EXPECT_NE(npc.id, ids[1]);
+    EXPECT_EQ(npcs.IndexOf(ids[1]), -1);
+    EXPECT_EQ(npcs.Pos(npcs.IndexOf(npc.id)).x, 50.0f);
+}
+
+// Past MAX_ID_SLOTS outstanding ids the slot number would overflow into the
+// generation bits, so AllocateId refuses instead
+TEST(NpcStoreTest, AllocateIdFailsPastSlotLimit) {
+    NpcStore npcs;
+    uint32_t last = 0;
+    for (uint32_t i = 0; i < NpcStore::MAX_ID_SLOTS; i++) last = npcs.AllocateId();
+    EXPECT_EQ(last & NpcStore::ID_SLOT_MASK, NpcStore::ID_SLOT_MASK);
+    EXPECT_EQ(last >> NpcStore::ID_SLOT_BITS, 0u);
+    EXPECT_THROW(npcs.AllocateId(), std::length_error);
+}
+
+// A slot that has used every generation is retired instead of wrapping to
+// generation 0, where it would match ids from its first use again
+TEST(NpcStoreTest, SlotAtMaxGenerationIsRetired) {
+    NpcStore npcs;
+    uint32_t first = 0;
+    for (uint32_t g = 0; g <= NpcStore::MAX_GENERATION; g++) {
+        NPC npc;
+        npc.id = npcs.AllocateId();
+        npcs.push_back(npc);
+        if (g == 0) first = npc.id;
+        EXPECT_EQ(npc.id & NpcStore::ID_SLOT_MASK, first & NpcStore::ID_SLOT_MASK);
+        EXPECT_EQ(npc.id >> NpcStore::ID_SLOT_BITS, g);
+        npcs.RemoveIf([](ConstNpcRef) { return true; });
+    }
+
+    for (int i = 0; i < 8; i++) {
+        EXPECT_NE(npcs.AllocateId() & NpcStore::ID_SLOT_MASK, first & NpcStore::ID_SLOT_MASK);
+    }
+}
+
+// Freed slots are reused in release order, not most recent first
+TEST(NpcStoreTest, FreedSlotsAreReusedOldestFirst) {
+    std::vector<uint32_t> ids;
+    NpcStore npcs = MakeStore(3, ids);
+
+    npcs.RemoveIf([&](ConstNpcRef n) { return n.id == ids[0]; });
+    npcs.RemoveIf([&](ConstNpcRef n) { return n.id == ids[2]; });
+
+    EXPECT_EQ(npcs.AllocateId() & NpcStore::ID_SLOT_MASK, ids[0] & NpcStore::ID_SLOT_MASK);
+    EXPECT_EQ(npcs.AllocateId() & NpcStore::ID_SLOT_MASK, ids[2] & NpcStore::ID_SLOT_MASK);
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "environment/random.h"
+#include "terrain/flow_field.h"
+#include "terrain/hpa_pathfinder.h"
+
+static const int DEEP_WATER = 0;
+static const int PLAINS = 3;
+
+static void Paint(Terrain& terrain, int x, int y, int biome) {
+    Tile tile = terrain.getTile(x, y);
+    tile.biomeIndex = (int8_t)biome;
+    terrain.setTile(x, y, tile);
+}
+
+static Vector2 TileCentre(int x, int y) {
+    return { (x + 0.5f) * Terrain::TILE_PX, (y + 0.5f) * Terrain::TILE_PX };
+}
+
+// Every point along the route stands on a walkable tile
+static bool RouteWalkable(const Terrain& terrain, const std::vector<Vector2>& route) {
+    for (size_t i = 1; i < route.size(); i++) {
+        Vector2 a = route[i - 1];
+        Vector2 b = route[i];
+        float len = std::sqrt((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+        int steps = (int)(len * 2.0f) + 1;
+        for (int s = 0; s <= steps; s++) {
+            float t = (float)s / (float)steps;
+            if (!terrain.canWalk(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t)) return false;
+        }
+    }
+    return true;
+}
+
+// A wall with one gap: the route goes through it, and edits to the gap
+// open and close the route once the touched clusters are rebuilt
+TEST(PathfindingTest, RoutesThroughGapAndFollowsEdits) {
+    Terrain terrain(64, 48, 1);
+    for (int y = 0; y < 48; y++) {
+        for (int x = 0; x < 64; x++) Paint(terrain, x, y, (x == 30 && y < 40) ? DEEP_WATER : PLAINS);
+    }
+    for (int x = 30; x < 64; x++) Paint(terrain, x, 42, DEEP_WATER);
+
+    HpaPathfinder pathfinder;
+    pathfinder.build(terrain);
+    std::vector<Vector2> route;
+    ASSERT_TRUE(pathfinder.findPath(terrain, TileCentre(5, 5), TileCentre(60, 5), route));
+    EXPECT_TRUE(RouteWalkable(terrain, route));
+    EXPECT_EQ(route.front().x, TileCentre(5, 5).x);
+    EXPECT_EQ(route.back().x, TileCentre(60, 5).x);
+    bool throughGap = false;
+    for (const Vector2& p : route) throughGap |= (p.y >= 39 * Terrain::TILE_PX && p.y < 42 * Terrain::TILE_PX);
+    EXPECT_TRUE(throughGap);
+
+    for (int y = 40; y < 42; y++) Paint(terrain, 30, y, DEEP_WATER);
+    pathfinder.invalidate(terrain, { 30, 40, 1, 2 });
+    EXPECT_FALSE(pathfinder.findPath(terrain, TileCentre(5, 5), TileCentre(60, 5), route));
+
+    Paint(terrain, 30, 20, PLAINS);
+    pathfinder.invalidate(terrain, { 30, 20, 1, 1 });
+    ASSERT_TRUE(pathfinder.findPath(terrain, TileCentre(5, 5), TileCentre(60, 5), route));
+    EXPECT_TRUE(RouteWalkable(terrain, route));
+}
+
+// Rebuilding only the edited clusters gives the same graph as a full build
+TEST(PathfindingTest, InvalidateMatchesFullBuild) {
+    Terrain terrain(150, 100, 1337);
+    terrain.generate();
+    HpaPathfinder incremental;
+    incremental.build(terrain);
+
+    Rng rng(3);
+    for (int k = 0; k < 6; k++) {
+        int cx = RandomInt(rng, 0, 149);
+        int cy = RandomInt(rng, 0, 99);
+        for (int y = cy - 3; y <= cy + 3; y++) {
+            for (int x = cx - 3; x <= cx + 3; x++) {
+                if (x >= 0 && x < 150 && y >= 0 && y < 100) Paint(terrain, x, y, (k % 2) ? DEEP_WATER : PLAINS);
+            }
+        }
+        incremental.invalidate(terrain, { cx - 3, cy - 3, 7, 7 });
+    }
+
+    HpaPathfinder full;
+    full.build(terrain);
+    EXPECT_EQ(incremental.nodeCount(), full.nodeCount());
+    EXPECT_EQ(incremental.edgeCount(), full.edgeCount());
+
+    std::vector<Vector2> a, b;
+    for (int q = 0; q < 200; q++) {
+        Vector2 from = TileCentre(RandomInt(rng, 0, 149), RandomInt(rng, 0, 99));
+        Vector2 to = TileCentre(RandomInt(rng, 0, 149), RandomInt(rng, 0, 99));
+        bool found = incremental.findPath(terrain, from, to, a);
+        ASSERT_EQ(found, full.findPath(terrain, from, to, b));
+        if (found && terrain.canWalk(from.x, from.y)) {
+            EXPECT_TRUE(RouteWalkable(terrain, a));
+        }
+    }
+}
+
+// Following the field from anywhere reachable ends on the goal tile, with
+// the remaining cost falling at every step
+TEST(FlowFieldTest, StepsLeadDownhillToGoal) {
+    Terrain terrain(64, 48, 1);
+    for (int y = 0; y < 48; y++) {
+        for (int x = 0; x < 64; x++) Paint(terrain, x, y, (x == 30 && y < 40) ? DEEP_WATER : PLAINS);
+    }
+
+    FlowField field;
+    ASSERT_TRUE(field.build(terrain, TileCentre(60, 5)));
+    EXPECT_EQ(field.costAt(TileCentre(60, 5)), 0.0f);
+    EXPECT_TRUE(std::isinf(field.costAt(TileCentre(30, 5))));
+
+    Vector2 pos = TileCentre(5, 5);
+    int steps = 0;
+    float deepest = pos.y;
+    Vector2 next;
+    while (field.nextStep(pos, next) && steps < 1000) {
+        ASSERT_TRUE(terrain.canWalk(next.x, next.y));
+        EXPECT_LT(field.costAt(next), field.costAt(pos));
+        pos = next;
+        deepest = std::max(deepest, pos.y);
+        steps++;
+    }
+    EXPECT_EQ(pos.x, TileCentre(60, 5).x);
+    EXPECT_EQ(pos.y, TileCentre(60, 5).y);
+    EXPECT_GE(deepest, TileCentre(30, 40).y);
+}
+
+// Fields live while referenced and are rebuilt after terrain edits
+TEST(FlowFieldTest, CacheCountsReferencesAndRebuildsStaleFields) {
+    Terrain terrain(64, 48, 1);
+    for (int y = 0; y < 48; y++) {
+        for (int x = 0; x < 64; x++) Paint(terrain, x, y, (x == 30 && y < 40) ? DEEP_WATER : PLAINS);
+    }
+
+    FlowFieldCache cache;
+    cache.acquire(terrain, 7, TileCentre(60, 5));
+    cache.acquire(terrain, 7, TileCentre(60, 5));
+    EXPECT_EQ(cache.refCount(7), 2);
+    ASSERT_NE(cache.find(7), nullptr);
+    EXPECT_FALSE(std::isinf(cache.find(7)->costAt(TileCentre(5, 5))));
+
+    for (int y = 40; y < 48; y++) Paint(terrain, 30, y, DEEP_WATER);
+    cache.invalidate();
+    cache.refresh(terrain);
+    EXPECT_TRUE(std::isinf(cache.find(7)->costAt(TileCentre(5, 5))));
+
+    cache.release(7);
+    EXPECT_NE(cache.find(7), nullptr);
+    cache.release(7);
+    EXPECT_EQ(cache.find(7), nullptr);
+    EXPECT_EQ(cache.size(), 0u);
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "environment/spatial_grid.h"
+
+static NpcStore MakeNpcs(int count, int worldW, int worldH) {
+    NpcStore npcs;
+    uint32_t state = 12345u;
+    auto next = [&]() {
+        state = state * 1664525u + 1013904223u;
+        return (float)(state >> 8) / (float)(1u << 24);
+    };
+
+    for (int i = 0; i < count; i++) {
+        NPC npc;
+        npc.id = (uint32_t)i + 1;
+        npc.pos = { next() * worldW, next() * worldH };
+        npc.humanRole = (NPC::HumanRole)(1 + i % 4);
+        npc.settlementId = i % 5 - 1;
+        npcs.push_back(npc);
+    }
+    return npcs;
+}
+
+TEST(SpatialGridTest, RadiusQueryMatchesFullScan) {
+    NpcStore npcs = MakeNpcs(2000, 1400, 900);
+    NpcSpatialGrid grid;
+    grid.Rebuild(npcs, 1400, 900, 8.0f);
+
+    NpcQueryFilter filter;
+    filter.Roles({NPC::HumanRole::WARRIOR, NPC::HumanRole::CAPTAIN}).NotInSettlement(2);
+
+    Vector2 center = { 700.0f, 450.0f };
+    std::vector<int> result;
+    grid.QueryRadius(npcs, center, 120.0f, filter, result);
+
+    std::vector<int> expected;
+    for (int i = 0; i < (int)npcs.size(); i++) {
+        float dx = npcs[i].pos.x - center.x;
+        float dy = npcs[i].pos.y - center.y;
+        if (filter.Accepts(npcs[i]) && dx * dx + dy * dy <= 120.0f * 120.0f) expected.push_back(i);
+    }
+
+    EXPECT_EQ(result, expected);
+    EXPECT_EQ(grid.CountInRadius(npcs, center, 120.0f, filter), (int)expected.size());
+}
+
+TEST(SpatialGridTest, NearestSearchesWholeWorld) {
+    NpcStore npcs = MakeNpcs(50, 1400, 900);
+    NPC far;
+    far.id = 999;
+    far.humanRole = NPC::HumanRole::BANDIT;
+    far.banditGroupId = 7;
+    far.pos = { -40.0f, 1390.0f };
+    npcs.push_back(far);
+
+    NpcSpatialGrid grid;
+    grid.Rebuild(npcs, 1400, 900, 8.0f);
+
+    NpcQueryFilter filter;
+    filter.Roles({NPC::HumanRole::BANDIT}).InBanditGroup(7);
+    EXPECT_EQ(grid.FindNearest(npcs, { 1300.0f, 10.0f }, FLT_MAX, filter), (int)npcs.size() - 1);
+}
+
+TEST(SpatialGridTest, NpcsAddedAfterRebuildAreFound) {
+    NpcStore npcs = MakeNpcs(100, 1400, 900);
+    NpcSpatialGrid grid;
+    grid.Rebuild(npcs, 1400, 900, 8.0f);
+
+    NPC late;
+    late.id = 500;
+    late.humanRole = NPC::HumanRole::CIVILIAN;
+    late.pos = { 10.0f, 10.0f };
+    npcs.push_back(late);
+
+    std::vector<int> nearest;
+    grid.FindKNearest(npcs, { 11.0f, 11.0f }, 1, FLT_MAX, NpcQueryFilter{}, nearest);
+    ASSERT_EQ(nearest.size(), 1u);
+    EXPECT_EQ(nearest[0], (int)npcs.size() - 1);
+}
+
+TEST(SpatialGridTest, DeadNpcsAreIgnored) {
+    NpcStore npcs = MakeNpcs(10, 100, 100);
+    for (NpcRef npc : npcs) npc.alive = false;
+
+    NpcSpatialGrid grid;
+    grid.Rebuild(npcs, 100, 100, 8.0f);
+
+    EXPECT_FALSE(grid.AnyInRadius(npcs, { 50.0f, 50.0f }, 1000.0f, NpcQueryFilter{}));
+    EXPECT_EQ(grid.FindNearest(npcs, { 50.0f, 50.0f }, FLT_MAX, NpcQueryFilter{}), -1);
+}
+
+// The bandit scans the grid replaced skipped only dead NPCs; with
+// IncludeDying it must pick the same targets, dying ones included
+TEST(SpatialGridTest, IncludeDyingMatchesLegacyBanditScans) {
+    NpcStore npcs = MakeNpcs(2000, 1400, 900);
+    for (int i = 0; i < (int)npcs.size(); i++) {
+        if (i % 3 == 0) npcs[i].isDying = true;
+        if (i % 7 == 0) npcs[i].alive = false;
+    }
+    NpcSpatialGrid grid;
+    grid.Rebuild(npcs, 1400, 900, 8.0f);
+
+    NpcQueryFilter bandits;
+    bandits.Roles({NPC::HumanRole::BANDIT}).IncludeDying();
+    NpcQueryFilter warriors;
+    warriors.Roles({NPC::HumanRole::WARRIOR}).IncludeDying();
+
+    bool sawDying = false;
+    for (int probe = 0; probe < 200; probe++) {
+        Vector2 from = npcs.Pos(probe * 7);
+        for (float range : { 24.0f, 140.0f, FLT_MAX }) {
+            // FindNearestBanditInRange / FindNearestBanditAny
+            int expected = -1;
+            float bestD2 = FLT_MAX;
+            for (int i = 0; i < (int)npcs.size(); i++) {
+                if (!npcs[i].alive || npcs[i].humanRole != NPC::HumanRole::BANDIT) continue;
+                float dx = npcs[i].pos.x - from.x;
+                float dy = npcs[i].pos.y - from.y;
+                float d2 = dx * dx + dy * dy;
+                if (d2 <= range * range && d2 < bestD2) {
+                    bestD2 = d2;
+                    expected = i;
+                }
+            }
+            int found = grid.FindNearest(npcs, from, range, bandits);
+            EXPECT_EQ(found, expected) << probe << " " << range;
+            if (found >= 0 && npcs.IsDying(found)) sawDying = true;
+        }
+
+        // Bandit aggro: every living warrior in range, in index order
+        std::vector<int> expected;
+        for (int i = 0; i < (int)npcs.size(); i++) {
+            if (!npcs[i].alive || npcs[i].humanRole != NPC::HumanRole::WARRIOR) continue;
+            float dx = npcs[i].pos.x - from.x;
+            float dy = npcs[i].pos.y - from.y;
+            if (dx * dx + dy * dy <= 140.0f * 140.0f) expected.push_back(i);
+        }
+        std::vector<int> result;
+        grid.QueryRadius(npcs, from, 140.0f, warriors, result);
+        EXPECT_EQ(result, expected) << probe;
+    }
+    EXPECT_TRUE(sawDying);
+
+    // Without the flag dying NPCs stay excluded
+    std::vector<int> active;
+    grid.QueryRadius(npcs, { 700.0f, 450.0f }, 2000.0f, NpcQueryFilter{}, active);
+    for (int i : active) EXPECT_FALSE(npcs.IsDying(i));
+}
@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "terrain/terrain_shading.h"
+
+static bool SameColor(Color a, Color b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+TEST(TerrainShadingTest, BakedRegionMatchesPerTileShade) {
+    Terrain terrain(120, 80, 42);
+    terrain.generate();
+
+    TileRect rect = { 30, 20, 17, 9 };
+    std::vector<Color> colors((size_t)rect.w * rect.h);
+    BakeTerrainColors(terrain, rect, colors.data());
+
+    for (int y = 0; y < rect.h; y++) {
+        for (int x = 0; x < rect.w; x++) {
+            Color expected = ShadeTerrainTile(terrain, rect.x + x, rect.y + y);
+            EXPECT_TRUE(SameColor(colors[(size_t)y * rect.w + x], expected));
+            EXPECT_EQ(expected.a, 255);
+        }
+    }
+}
+
+TEST(TerrainShadingTest, ShadeFollowsTileChanges) {
+    Terrain terrain(64, 64, 7);
+    terrain.generate();
+
+    Tile& tile = terrain.getTile(10, 10);
+    tile.biomeIndex = -1;
+    EXPECT_TRUE(SameColor(ShadeTerrainTile(terrain, 10, 10), BLACK));
+
+    // Water tiles stay blue-dominant through the depth shading
+    for (int i = 0; i < terrain.getBiomeCount(); i++) {
+        if (!terrain.getBiomes()[i].props.isWater) continue;
+        tile.biomeIndex = (int8_t)i;
+        tile.setElevation(terrain.getBiomes()[i].minElevation);
+        Color c = ShadeTerrainTile(terrain, 10, 10);
+        EXPECT_GT(c.b, c.r);
+    }
+}
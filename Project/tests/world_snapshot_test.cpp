@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include "environment/sim_thread.h"
+#include "environment/snapshot_buffer.h"
+#include "environment/world.h"
+#include "environment/world_snapshot.h"
+#include "terrain/terrain_shading.h"
+
+static bool SameColor(Color a, Color b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+// A World with a few people near its first buildable tile
+static void InitPopulatedWorld(World& world) {
+    world.worldW = 1400;
+    world.worldH = 900;
+    world.worldSeed = 4242;
+    world.Init();
+
+    Vector2 home = { -1.0f, -1.0f };
+    for (int i = world.cols * world.rows / 2; i < world.cols * world.rows && home.x < 0.0f; i++) {
+        Vector2 p = CellToPxCenter(i % world.cols, i / world.cols);
+        if (world.terrain.canBuild(p.x, p.y)) home = p;
+    }
+    ASSERT_GE(home.x, 0.0f);
+    for (int i = 0; i < 6; i++) world.SpawnCivilian({ home.x + i * 3.0f, home.y });
+    world.SpawnCaptain({ home.x - 6.0f, home.y });
+}
+
+// Values published one after another are taken whole and in order
+TEST(TripleBufferTest, ReaderTakesNewestWholeValue) {
+    struct Pair { int a = 0; int b = 0; };
+    TripleBuffer<Pair> buffer;
+    EXPECT_FALSE(buffer.Acquire());
+
+    buffer.Back() = { 1, 7 };
+    buffer.Publish();
+    buffer.Back() = { 2, 14 };
+    buffer.Publish();
+    EXPECT_TRUE(buffer.Acquire());
+    EXPECT_EQ(buffer.Front().a, 2);
+    EXPECT_FALSE(buffer.Acquire());
+    EXPECT_EQ(buffer.Front().a, 2);
+
+    // Across threads the reader never sees a half-written value
+    const int count = 200000;
+    std::thread writer([&] {
+        for (int i = 3; i < count; i++) {
+            buffer.Back() = { i, i * 7 };
+            buffer.Publish();
+        }
+    });
+    int last = 2;
+    while (last < count - 1) {
+        if (!buffer.Acquire()) continue;
+        const Pair& p = buffer.Front();
+        ASSERT_EQ(p.b, p.a * 7);
+        ASSERT_GT(p.a, last);
+        last = p.a;
+    }
+    writer.join();
+}
+
+// A copy a few revisions behind catches up through the change log; one
+// behind the log's start falls back to a full copy
+TEST(WorldSnapshotTest, TileLayerCatchesUpByRevision) {
+    TileLayerSnapshot source;
+    source.width = 8;
+    source.height = 4;
+    source.pixels.assign(32, BLACK);
+    source.revision = 1;
+
+    TileLayerSnapshot copy;
+    copy.CopyFrom(source);
+    EXPECT_EQ(copy.revision, 1u);
+
+    auto change = [&](TileRect r, Color c) {
+        for (int y = r.y; y < r.y + r.h; y++) {
+            for (int x = r.x; x < r.x + r.w; x++) source.pixels[y * source.width + x] = c;
+        }
+        source.revision++;
+        source.changes.push_back({ source.revision, r });
+        if (source.changes.size() > TileLayerSnapshot::MAX_CHANGES) source.changes.erase(source.changes.begin());
+    };
+
+    change({ 1, 1, 2, 2 }, RED);
+    change({ 5, 0, 3, 1 }, BLUE);
+    std::vector<TileRect> rects;
+    ASSERT_TRUE(source.ChangesSince(1, rects));
+    EXPECT_EQ(rects.size(), 2u);
+    copy.CopyFrom(source);
+    EXPECT_EQ(copy.revision, source.revision);
+    EXPECT_EQ(std::memcmp(copy.pixels.data(), source.pixels.data(), 32 * sizeof(Color)), 0);
+
+    uint64_t stale = copy.revision;
+    for (int i = 0; i < (int)TileLayerSnapshot::MAX_CHANGES + 1; i++) {
+        change({ i % 8, i % 4, 1, 1 }, Color{ (unsigned char)i, 0, 0, 255 });
+    }
+    EXPECT_FALSE(source.ChangesSince(stale, rects));
+    copy.CopyFrom(source);
+    EXPECT_EQ(std::memcmp(copy.pixels.data(), source.pixels.data(), 32 * sizeof(Color)), 0);
+}
+
+// Captures carry the living NPCs and keep the terrain layer equal to a full
+// bake, including after a meteor reshapes it and after skipped captures
+TEST(WorldSnapshotTest, CaptureMatchesWorld) {
+    World world;
+    InitPopulatedWorld(world);
+    WorldSnapshotWriter writer;
+    WorldSnapshot first;
+    WorldSnapshot second;
+    writer.Capture(world, first);
+    EXPECT_TRUE(world.terrainDirty.empty());
+    EXPECT_TRUE(world.territoryDirty.empty());
+
+    int alive = 0;
+    for (ConstNpcRef n : world.npcs) alive += (n.alive || n.isDying) ? 1 : 0;
+    EXPECT_EQ((int)first.npcs.size(), alive);
+    EXPECT_EQ(first.worldW, world.worldW);
+    EXPECT_EQ(first.plants.size(), world.plants.size());
+
+    world.SpawnMeteor({ 700.0f, 450.0f });
+    for (int t = 0; t < 600; t++) {
+        world.Update(1.0f / 60.0f, &world.terrain);
+        writer.Capture(world, (t % 2) ? second : first);
+    }
+
+    const WorldSnapshot& last = second;
+    EXPECT_EQ(last.tick, world.tickCount);
+    ASSERT_EQ(last.terrain.width, world.terrain.getWidth());
+    std::vector<Color> expected((size_t)last.terrain.width * last.terrain.height);
+    BakeTerrainColors(world.terrain, { 0, 0, last.terrain.width, last.terrain.height }, expected.data());
+    for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_TRUE(SameColor(last.terrain.pixels[i], expected[i])) << "tile " << i;
+    }
+    EXPECT_GT(last.terrain.revision, 1u);
+}
+
+// Commands posted from another thread run between ticks and show up in the
+// published snapshots
+TEST(SimulationThreadTest, PostedCommandsReachSnapshots) {
+    World world;
+    InitPopulatedWorld(world);
+    const size_t before = world.npcs.size();
+
+    SimulationThread sim(world, 60.0f);
+    sim.Start();
+    EXPECT_EQ(sim.Acquire().npcs.size(), before);
+
+    Vector2 pos = world.npcs[0].pos;
+    sim.Post([pos](World& w) {
+        for (int i = 0; i < 5; i++) w.SpawnWarrior({ pos.x + i * 4.0f, pos.y - 6.0f });
+    });
+
+    bool seen = false;
+    uint64_t firstTick = sim.Acquire().tick;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!seen && std::chrono::steady_clock::now() < deadline) {
+        const WorldSnapshot& s = sim.Acquire();
+        int warriors = 0;
+        for (const NpcSnapshot& n : s.npcs) warriors += n.role == (uint8_t)NPC::HumanRole::WARRIOR ? 1 : 0;
+        seen = warriors >= 5 && s.tick > firstTick;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    sim.Stop();
+    EXPECT_TRUE(seen);
+    EXPECT_FALSE(sim.IsRunning());
+}
+
+// On a streamed map a capture bakes only the chunks already in memory, so
+// it never pushes the terrain past its chunk budget
+TEST(WorldSnapshotTest, StreamedCaptureStaysWithinChunkBudget) {
+    World world;
+    world.worldW = 4160 * CELL_SIZE;
+    world.worldH = 4096 * CELL_SIZE;
+    world.worldSeed = 99;
+    world.Init();
+    ASSERT_GT((size_t)world.cols * world.rows, World::EAGER_TERRAIN_TILES);
+
+    world.Update(1.0f / 60.0f, &world.terrain);
+    const size_t resident = world.terrain.getChunkStats().resident;
+    ASSERT_LE(resident, World::TERRAIN_CHUNK_BUDGET);
+
+    WorldSnapshotWriter writer;
+    WorldSnapshot snapshot;
+    writer.Capture(world, snapshot);
+    EXPECT_EQ(world.terrain.getChunkStats().resident, resident);
+    ASSERT_EQ(snapshot.terrain.width, world.terrain.getWidth());
+
+    // Resident chunks are baked; a never-loaded one stays blank until it loads
+    int cx = -1, cy = -1;
+    for (int y = 0; y < world.rows >> Terrain::CHUNK_SHIFT && cx < 0; y++) {
+        for (int x = 0; x < world.cols >> Terrain::CHUNK_SHIFT && cx < 0; x++) {
+            if (!world.terrain.isChunkResident(x, y)) { cx = x; cy = y; }
+        }
+    }
+    ASSERT_GE(cx, 0);
+    int tx = cx << Terrain::CHUNK_SHIFT;
+    int ty = cy << Terrain::CHUNK_SHIFT;
+    EXPECT_TRUE(SameColor(snapshot.terrain.pixels[(size_t)ty * world.cols + tx], BLANK));
+
+    Color expected;
+    BakeTerrainColors(world.terrain, { tx, ty, 1, 1 }, &expected);
+    writer.Capture(world, snapshot);
+    EXPECT_TRUE(SameColor(snapshot.terrain.pixels[(size_t)ty * world.cols + tx], expected));
+}
@@ -0,0 +1,323 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include "environment/fixed_step.h"
+#include "environment/world.h"
+
+// World runs with no window and no textures loaded
+TEST(WorldTest, HeadlessInitAndUpdate) {
+    World world;
+    world.worldW = 1400;
+    world.worldH = 900;
+    world.worldSeed = 4242;
+    world.Init();
+
+    EXPECT_EQ(world.cols, 1400 / CELL_SIZE);
+    EXPECT_EQ(world.rows, 900 / CELL_SIZE);
+    EXPECT_FALSE(world.plants.empty());
+    EXPECT_EQ(world.initStagesDone, World::INIT_STAGES);
+
+    Vector2 home = { -1.0f, -1.0f };
+    for (int i = 0; i < world.cols * world.rows && home.x < 0.0f; i++) {
+        Vector2 p = CellToPxCenter(i % world.cols, i / world.cols);
+        if (world.terrain.canBuild(p.x, p.y)) home = p;
+    }
+    ASSERT_GE(home.x, 0.0f);
+
+    for (int i = 0; i < 4; i++) world.SpawnCivilian({ home.x + i * 3.0f, home.y });
+    world.SpawnWarrior({ home.x, home.y - 6.0f });
+    ASSERT_FALSE(world.settlements.empty());
+
+    for (int t = 0; t < 600; t++) {
+        world.Update(1.0f / 60.0f, &world.terrain);
+    }
+
+    EXPECT_FALSE(world.npcs.empty());
+}
+
+// Populates a world near its first buildable tile and runs it with a fixed dt
+static uint64_t RunSeededWorld(unsigned int seed, int ticks, const std::string& cacheDir = "",
+                               bool* fromCache = nullptr) {
+    World world;
+    world.worldW = 1400;
+    world.worldH = 900;
+    world.worldSeed = seed;
+    world.generatedCacheDir = cacheDir;
+    world.Init();
+    if (fromCache) *fromCache = world.initFromCache;
+
+    Vector2 home = { -1.0f, -1.0f };
+    for (int i = world.cols * world.rows / 2; i < world.cols * world.rows && home.x < 0.0f; i++) {
+        Vector2 p = CellToPxCenter(i % world.cols, i / world.cols);
+        if (world.terrain.canBuild(p.x, p.y)) home = p;
+    }
+    if (home.x < 0.0f) return 0;
+
+    for (int i = 0; i < 6; i++) world.SpawnCivilian({ home.x + i * 3.0f, home.y });
+    for (int i = 0; i < 4; i++) world.SpawnWarrior({ home.x + i * 4.0f, home.y - 6.0f });
+    world.SpawnCaptain({ home.x - 6.0f, home.y });
+
+    for (int t = 0; t < ticks; t++) {
+        if (t == ticks / 2) world.SpawnMeteor(home);
+        world.Update(1.0f / 60.0f, &world.terrain);
+    }
+    return world.ComputeStateHash();
+}
+
+TEST(WorldTest, SameSeedGivesIdenticalState) {
+    EXPECT_EQ(RunSeededWorld(4242, 900), RunSeededWorld(4242, 900));
+    EXPECT_NE(RunSeededWorld(4242, 900), RunSeededWorld(4243, 900));
+}
+
+// The first Init writes the cache and the second loads it; both runs end in
+// the same state as one with no cache. A damaged file is regenerated.
+TEST(WorldTest, GeneratedWorldCacheReplaysIdentically) {
+    std::string dir = testing::TempDir() + "worldbox_cache_test";
+    std::filesystem::remove_all(dir);
+
+    bool fromCache = true;
+    uint64_t expected = RunSeededWorld(4242, 600);
+    EXPECT_EQ(RunSeededWorld(4242, 600, dir, &fromCache), expected);
+    EXPECT_FALSE(fromCache);
+    EXPECT_EQ(RunSeededWorld(4242, 600, dir, &fromCache), expected);
+    EXPECT_TRUE(fromCache);
+
+    World probe;
+    probe.worldW = 1400;
+    probe.worldH = 900;
+    probe.worldSeed = 4242;
+    probe.generatedCacheDir = dir;
+    std::string path = probe.GeneratedCachePath();
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+    EXPECT_EQ(RunSeededWorld(4242, 600, dir, &fromCache), expected);
+    EXPECT_FALSE(fromCache);
+    EXPECT_EQ(RunSeededWorld(4242, 600, dir, &fromCache), expected);
+    EXPECT_TRUE(fromCache);
+
+    std::filesystem::remove_all(dir);
+}
+
+// Past generatedCacheLimit files a save evicts the one least recently
+// saved or loaded
+TEST(WorldTest, GeneratedWorldCacheKeepsRecentlyUsedFiles) {
+    std::string dir = testing::TempDir() + "worldbox_cache_limit_test";
+    std::filesystem::remove_all(dir);
+    World world;
+    world.worldW = 1400;
+    world.worldH = 900;
+    world.generatedCacheDir = dir;
+    world.generatedCacheLimit = 2;
+    auto init = [&](unsigned int seed) {
+        world.worldSeed = seed;
+        world.Init();
+        return world.initFromCache;
+    };
+    auto cached = [&](unsigned int seed) {
+        world.worldSeed = seed;
+        return std::filesystem::exists(world.GeneratedCachePath());
+    };
+
+    EXPECT_FALSE(init(1));
+    EXPECT_FALSE(init(2));
+    EXPECT_TRUE(init(1));
+    EXPECT_FALSE(init(3));
+    EXPECT_TRUE(cached(1));
+    EXPECT_FALSE(cached(2));
+    EXPECT_TRUE(cached(3));
+
+    std::filesystem::remove_all(dir);
+}
+
+// Two armed settlements at war, large enough to span several parallel chunks
+static uint64_t RunParallelWar(int workers, int ticks) {
+    World world;
+    world.worldW = 1400;
+    world.worldH = 900;
+    world.worldSeed = 77;
+    world.Init();
+    world.updateMode = World::UpdateMode::PARALLEL;
+    world.SetWorkerCount(workers);
+
+    std::vector<Vector2> land;
+    for (int i = 0; i < world.cols * world.rows; i += 7) {
+        Vector2 p = CellToPxCenter(i % world.cols, i / world.cols);
+        if (world.terrain.canBuild(p.x, p.y)) land.push_back(p);
+    }
+    if (land.size() < 2) return 0;
+
+    for (int k = 0; k < 2; k++) {
+        Vector2 p = land[k * land.size() / 2 + land.size() / 4];
+        for (int c = 0; c < 4; c++) world.SpawnCivilian({ p.x + c * 3.0f, p.y });
+        for (int c = 0; c < 300; c++) world.SpawnWarrior({ p.x + (c % 20) * 2.0f, p.y - 6.0f - (c / 20) * 2.0f });
+        for (int c = 0; c < 3; c++) world.SpawnCaptain({ p.x - 6.0f, p.y + c * 4.0f });
+    }
+    if (world.settlements.size() >= 2) world.StartSettlementWar(0, 1);
+
+    for (int t = 0; t < ticks; t++) world.Update(1.0f / 60.0f, &world.terrain);
+    return world.ComputeStateHash();
+}
+
+// Parallel mode gives the same state whether one thread or several run it
+TEST(WorldTest, ParallelUpdateIndependentOfWorkerCount) {
+    // Long enough for the armies to meet, so damage and death intents are committed
+    EXPECT_EQ(RunParallelWar(1, 900), RunParallelWar(4, 900));
+}
+
+// Two settlements founded with overlapping squares merge into one territory
+TEST(WorldTest, OverlappingSettlementsMergeThroughOwnerGrid) {
+    World world;
+    world.worldW = 1400;
+    world.worldH = 900;
+    world.worldSeed = 4242;
+    world.Init();
+
+    // 100 px apart: outside each other's territory, but the squares overlap
+    Vector2 home = { -1.0f, -1.0f };
+    for (int i = 0; i < world.cols * world.rows && home.x < 0.0f; i++) {
+        Vector2 p = CellToPxCenter(i % world.cols, i / world.cols);
+        if (world.terrain.canBuild(p.x, p.y) && world.terrain.canBuild(p.x + 100.0f, p.y)) home = p;
+    }
+    ASSERT_GE(home.x, 0.0f);
+
+    for (int i = 0; i < 3; i++) world.SpawnCivilian({ home.x + i, home.y });
+    for (int i = 0; i < 3; i++) world.SpawnCivilian({ home.x + 100.0f + i, home.y });
+    ASSERT_EQ(world.settlements.size(), 2u);
+    EXPECT_TRUE(world.territoryContested);
+
+    world.MergeSettlementsIfNeeded();
+
+    int alive = 0;
+    for (int id = 0; id < (int)world.settlements.size(); id++) {
+        const Settlement& s = world.settlements[id];
+        if (!s.alive) continue;
+        alive++;
+        for (int tile : s.tiles) {
+            EXPECT_EQ(world.GetTileOwner(tile), id);
+            EXPECT_TRUE(world.SettlementHasTile(id, tile));
+        }
+    }
+    EXPECT_EQ(alive, 1);
+    EXPECT_FALSE(world.territoryContested);
+}
+
+// Init dirties the whole map and a meteor impact dirties the tiles it reshapes
+TEST(WorldTest, MeteorImpactMarksTerrainDirty) {
+    World world;
+    world.worldW = 1400;
+    world.worldH = 900;
+    world.worldSeed = 4242;
+    world.Init();
+
+    ASSERT_EQ(world.terrainDirty.size(), 1u);
+    EXPECT_EQ(world.terrainDirty[0].w, world.cols);
+    EXPECT_EQ(world.terrainDirty[0].h, world.rows);
+    world.terrainDirty.clear();
+
+    Vector2 target = { 700.0f, 450.0f };
+    world.SpawnMeteor(target);
+    for (int t = 0; t < 600 && world.terrainDirty.empty(); t++) {
+        world.Update(1.0f / 60.0f, &world.terrain);
+    }
+
+    ASSERT_EQ(world.terrainDirty.size(), 1u);
+    const TileRect& r = world.terrainDirty[0];
+    int tx = (int)(target.x / CELL_SIZE);
+    int ty = (int)(target.y / CELL_SIZE);
+    EXPECT_TRUE(tx >= r.x && tx < r.x + r.w && ty >= r.y && ty < r.y + r.h);
+    EXPECT_LT(r.w, world.cols);
+}
+
+// Tile owners as drawn: -1 unless the owner is alive
+static std::vector<int> DrawnTerritory(const World& world) {
+    std::vector<int> drawn(world.tileOwner.size(), -1);
+    for (size_t i = 0; i < drawn.size(); i++) {
+        int owner = world.tileOwner[i];
+        if (owner >= 0 && world.settlements[owner].alive) drawn[i] = owner;
+    }
+    return drawn;
+}
+
+// Every tile whose drawn owner changed lies in a dirty rect, and the rects
+// stay smaller than the map
+static void ExpectTerritoryChangeMarked(World& world, const std::vector<int>& before) {
+    std::vector<int> after = DrawnTerritory(world);
+    int changed = 0;
+    for (int tile = 0; tile < (int)after.size(); tile++) {
+        if (after[tile] == before[tile]) continue;
+        changed++;
+        int tx = tile % world.cols;
+        int ty = tile / world.cols;
+        bool covered = false;
+        for (const TileRect& r : world.territoryDirty) {
+            covered |= tx >= r.x && tx < r.x + r.w && ty >= r.y && ty < r.y + r.h;
+        }
+        EXPECT_TRUE(covered) << "tile " << tx << "," << ty;
+    }
+    EXPECT_GT(changed, 0);
+    for (const TileRect& r : world.territoryDirty) EXPECT_LT(r.w * r.h, world.cols * world.rows);
+    world.territoryDirty.clear();
+}
+
+// Creating, merging and losing settlements dirties the territory they change
+TEST(WorldTest, TerritoryChangesMarkDirtyRegions) {
+    World world;
+    world.worldW = 1400;
+    world.worldH = 900;
+    world.worldSeed = 4242;
+    world.Init();
+
+    ASSERT_EQ(world.territoryDirty.size(), 1u);
+    EXPECT_EQ(world.territoryDirty[0].w, world.cols);
+    EXPECT_EQ(world.territoryDirty[0].h, world.rows);
+    world.territoryDirty.clear();
+
+    Vector2 home = { -1.0f, -1.0f };
+    for (int i = 0; i < world.cols * world.rows && home.x < 0.0f; i++) {
+        Vector2 p = CellToPxCenter(i % world.cols, i / world.cols);
+        if (world.terrain.canBuild(p.x, p.y) && world.terrain.canBuild(p.x + 100.0f, p.y)) home = p;
+    }
+    ASSERT_GE(home.x, 0.0f);
+
+    std::vector<int> before = DrawnTerritory(world);
+    for (int i = 0; i < 3; i++) world.SpawnCivilian({ home.x + i, home.y });
+    ASSERT_EQ(world.settlements.size(), 1u);
+    ExpectTerritoryChangeMarked(world, before);
+
+    before = DrawnTerritory(world);
+    for (int i = 0; i < 3; i++) world.SpawnCivilian({ home.x + 100.0f + i, home.y });
+    ASSERT_EQ(world.settlements.size(), 2u);
+    ExpectTerritoryChangeMarked(world, before);
+
+    before = DrawnTerritory(world);
+    world.MergeSettlementsIfNeeded();
+    ExpectTerritoryChangeMarked(world, before);
+
+    // With everyone gone the settlement dies on the next update
+    before = DrawnTerritory(world);
+    for (NpcRef npc : world.npcs) npc.alive = false;
+    world.Update(1.0f / 60.0f, &world.terrain);
+    for (const Settlement& s : world.settlements) EXPECT_FALSE(s.alive);
+    ExpectTerritoryChangeMarked(world, before);
+}
+
+TEST(RngTest, IntStaysInRangeAndRepeats) {
+    Rng a(99);
+    Rng b(99);
+    for (int i = 0; i < 1000; i++) {
+        int v = RandomInt(a, -3, 5);
+        EXPECT_GE(v, -3);
+        EXPECT_LE(v, 5);
+        EXPECT_EQ(v, RandomInt(b, 5, -3));
+    }
+    EXPECT_TRUE(a == b);
+}
+
+TEST(FixedStepperTest, AccumulatesAndCapsCatchUp) {
+    FixedStepper clock(50.0f, 4);
+    EXPECT_FLOAT_EQ(clock.GetTickDt(), 0.02f);
+
+    EXPECT_EQ(clock.Advance(0.01f), 0);
+    EXPECT_EQ(clock.Advance(0.011f), 1);
+    EXPECT_EQ(clock.Advance(0.5f), 4);
+    EXPECT_EQ(clock.GetDroppedTicks(), 21);
+    EXPECT_LT(clock.GetAlpha(), 1.0f);
+}